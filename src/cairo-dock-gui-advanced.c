@@ -1414,7 +1414,7 @@ static gboolean _cairo_dock_add_one_module_widget (GldiModule *pModule, const gc
 	///if (pModule->cConfFilePath == NULL && ! g_bEasterEggs)  // option perso : les plug-ins non utilises sont grises et ne rajoutent pas leur .conf au theme courant.
 	///	pModule->cConfFilePath = cairo_dock_check_module_conf_file (pModule->pVisitCard);
 	int iActive;
-	if (! pModule->pInterface->stopModule)
+	if (gldi_module_is_loaded (pModule) && ! pModule->pInterface->stopModule)  // a module that is not loaded yet can be activated and deactivated (see gldi_module_is_auto_loaded).
 		iActive = -1;
 	else if (g_pPrimaryContainer == NULL && cActiveModules != NULL)  // avant chargement du theme.
 	{
@@ -2185,7 +2185,7 @@ static void _present_group_widget (CairoDockGroupDescription *pGroupDescription,
 	
 	g_signal_handlers_block_by_func (s_pActivateButton, on_click_activate_current_group, NULL);
 	GldiModule *pModule = gldi_module_get (pGroupDescription->cGroupName);
-	if (pModule != NULL && pModule->pInterface->stopModule != NULL)
+	if (pModule != NULL && (! gldi_module_is_loaded (pModule) || pModule->pInterface->stopModule != NULL))
 	{
 		gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (s_pActivateButton), pModule->pInstancesList != NULL);
 		gtk_widget_set_sensitive (s_pActivateButton, TRUE);
@@ -43,7 +43,7 @@
 #include "cairo-dock-dock-factory.h"
 #include "cairo-dock-dock-facility.h"
 #include "cairo-dock-themes-manager.h"  // cairo_dock_update_conf_file
-#include "cairo-dock-file-manager.h"  // cairo_dock_copy_file
+#include "cairo-dock-file-manager.h"  // cairo_dock_copy_file_into_directory
 #include "cairo-dock-log.h"
 #include "cairo-dock-utils.h"  // cairo_dock_launch_command_sync
 #include "cairo-dock-desklet-manager.h"
@@ -388,7 +388,7 @@ static void _cairo_dock_add_autostart (G_GNUC_UNUSED GtkMenuItem *pMenuItem, G_G
 			return ;
 		}
 	}
-	cairo_dock_copy_file ("/usr/share/applications/cairo-dock.desktop", cCairoAutoStartDirPath);
+	cairo_dock_copy_file_into_directory ("/usr/share/applications/cairo-dock.desktop", cCairoAutoStartDirPath);
 	g_free (cCairoAutoStartDirPath);
 }
 
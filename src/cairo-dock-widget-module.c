@@ -25,7 +25,7 @@
 #include "cairo-dock-module-instance-manager.h"
 #include "cairo-dock-gui-factory.h"
 #include "cairo-dock-log.h"
-#include "cairo-dock-file-manager.h"  // cairo_dock_copy_file
+#include "cairo-dock-file-manager.h"  // cairo_dock_copy_file_into_directory
 #include "cairo-dock-themes-manager.h"  // cairo_dock_write_keys_to_conf_file
 #include "cairo-dock-gui-manager.h"
 #include "cairo-dock-gui-commons.h"
@@ -65,7 +65,7 @@ static gchar *_get_valid_module_conf_file (GldiModule *pModule)
 		// if no conf-file, copy the default one into the folder and take this one.
 		if (cInstanceFilePath == NULL)  // no conf file present yet.
 		{
-			gboolean r = cairo_dock_copy_file (pModule->cConfFilePath, cUserDataDirPath);
+			gboolean r = cairo_dock_copy_file_into_directory (pModule->cConfFilePath, cUserDataDirPath);
 			if (r)  // copy ok
 				cInstanceFilePath = g_strdup_printf ("%s/%s", cUserDataDirPath, pModule->pVisitCard->cConfFileName);
 		}
@@ -134,6 +134,7 @@ static void _build_module_widget (ModuleWidget *pModuleWidget)
 	pModuleWidget->widget.pWidgetList = pWidgetList;
 	pModuleWidget->widget.pDataGarbage = pDataGarbage;
 	
+	gldi_module_load (pModuleWidget->pModule);  // the module may not be loaded yet if it's not active; we need its interface to build its custom widgets.
 	if (pModuleWidget->pModule->pInterface->load_custom_widget != NULL)
 	{
 		pModuleWidget->pModule->pInterface->load_custom_widget (pModuleWidget->pModuleInstance, pKeyFile, pWidgetList);
@@ -928,6 +928,8 @@ int main (int argc, char** argv)
 
 	gldi_free_all ();
 
+	cairo_dock_cleanup_connections ();
+
 	#if (LIBRSVG_MAJOR_VERSION == 2 && LIBRSVG_MINOR_VERSION < 36)
 	rsvg_term ();
 	#endif
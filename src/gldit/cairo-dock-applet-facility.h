@@ -652,6 +652,12 @@ gldi_shortkey_new (cShortKey, myApplet->pModule->pVisitCard->cTitle, cDescriptio
 */
 #define CD_APPLET_RENDER_NEW_DATA_ON_MY_ICON(pValues) cairo_dock_render_new_data_on_icon (myIcon, myContainer, myDrawContext, pValues)
 
+/** Feed the Data Renderer of the applet's icon from a Data Feed written by an external program (see cairo-dock-data-feed.h), instead of rendering each new value with CD_APPLET_RENDER_NEW_DATA_ON_MY_ICON. The values are read and drawn at the rate of the animations.
+*@param cFeedName name of the feed, or NULL to stop reading the current one.
+*@return TRUE if the feed could be opened.
+*/
+#define CD_APPLET_SET_DATA_FEED_ON_MY_ICON(cFeedName) cairo_dock_set_data_feed_on_icon (myIcon, cFeedName)
+
 /** Completely remove the Data Renderer of the applet's icon, including the values associated with.
 */
 #define CD_APPLET_REMOVE_MY_DATA_RENDERER cairo_dock_remove_data_renderer_on_icon (myIcon)
@@ -57,6 +57,9 @@ extern CairoDock *g_pMainDock;
 extern CairoDockDesktopEnv g_iDesktopEnv;
 
 static GHashTable *s_hClassTable = NULL;
+static GQueue s_pLaunchingClasses = G_QUEUE_INIT;  // classes being launched, ordered by deadline (they all get the same delay, so it's just the launching order)
+static guint s_iSidStartupTimeout = 0;  // a single timeout for all the launching classes, set on the nearest deadline
+#define CAIRO_DOCK_STARTUP_TIMEOUT 15  // in seconds, for applications that take a really long time to start
 
 
 static void cairo_dock_free_class_appli (CairoDockClassAppli *pClassAppli)
@@ -73,8 +76,8 @@ static void cairo_dock_free_class_appli (CairoDockClassAppli *pClassAppli)
 		g_strfreev (pClassAppli->pMimeTypes);
 	g_list_foreach (pClassAppli->pMenuItems, (GFunc)g_strfreev, NULL);
 	g_list_free (pClassAppli->pMenuItems);
-	if (pClassAppli->iSidOpeningTimeout != 0)
-		g_source_remove (pClassAppli->iSidOpeningTimeout);
+	if (pClassAppli->iStartupDeadline != 0)
+		g_queue_remove (&s_pLaunchingClasses, pClassAppli);  // the shared timeout will just find nothing to do
 	g_free (pClassAppli);
 }
 
@@ -2002,14 +2005,62 @@ void cairo_dock_set_data_from_class (const gchar *cClass, Icon *pIcon)
 
 
 
-static gboolean _stop_opening_timeout (const gchar *cClass)
+static void _stop_launching (CairoDockClassAppli *pClassAppli)
 {
-	CairoDockClassAppli *pClassAppli = cairo_dock_get_class (cClass);
-	g_return_val_if_fail (pClassAppli != NULL, FALSE);
-	pClassAppli->iSidOpeningTimeout = 0;
-	gldi_class_startup_notify_end (cClass);
+	// unset the icons as launching
+	GList* ic;
+	Icon *icon;
+	for (ic = pClassAppli->pIconsOfClass; ic != NULL; ic = ic->next)
+	{
+		icon = ic->data;
+		gldi_icon_stop_marking_as_launching (icon);
+	}
+	for (ic = pClassAppli->pAppliOfClass; ic != NULL; ic = ic->next)
+	{
+		icon = ic->data;
+		gldi_icon_stop_marking_as_launching (icon);
+	}
+
+	// unset the class as launching and remove it from the deadlines
+	pClassAppli->bIsLaunching = FALSE;
+	if (pClassAppli->iStartupDeadline != 0)
+	{
+		pClassAppli->iStartupDeadline = 0;
+		g_queue_remove (&s_pLaunchingClasses, pClassAppli);  // mostly the head, since applications tend to start in the order they were launched
+		if (g_queue_is_empty (&s_pLaunchingClasses) && s_iSidStartupTimeout != 0)
+		{
+			g_source_remove (s_iSidStartupTimeout);
+			s_iSidStartupTimeout = 0;
+		}
+	}
+}
+
+static gboolean _on_startup_timeout (gpointer data);
+static void _schedule_startup_timeout (void)
+{
+	CairoDockClassAppli *pClassAppli = g_queue_peek_head (&s_pLaunchingClasses);
+	if (pClassAppli == NULL || s_iSidStartupTimeout != 0)  // nothing to wait for, or already waiting for a deadline that is not later than this one
+		return;
+	gint64 iDelay = (pClassAppli->iStartupDeadline - g_get_monotonic_time ()) / 1000;  // in ms
+	s_iSidStartupTimeout = g_timeout_add (MAX (0, iDelay), _on_startup_timeout, NULL);
+}
+
+static gboolean _on_startup_timeout (G_GNUC_UNUSED gpointer data)
+{
+	s_iSidStartupTimeout = 0;
+	// stop all the classes whose deadline is over
+	gint64 iNow = g_get_monotonic_time ();
+	CairoDockClassAppli *pClassAppli;
+	while ((pClassAppli = g_queue_peek_head (&s_pLaunchingClasses)) != NULL
+	&& pClassAppli->iStartupDeadline <= iNow)
+	{
+		_stop_launching (pClassAppli);  // removes it from the queue
+	}
+	// and wait for the next one
+	_schedule_startup_timeout ();
 	return FALSE;
 }
+
 void gldi_class_startup_notify (Icon *pIcon)
 {
 	const gchar *cClass = pIcon->cClass;
@@ -2017,11 +2068,14 @@ void gldi_class_startup_notify (Icon *pIcon)
 	if (! pClassAppli || pClassAppli->bIsLaunching)
 		return;
 
-	// mark the class as launching and set a timeout
+	// mark the class as launching and give it a deadline
 	pClassAppli->bIsLaunching = TRUE;
-	if (pClassAppli->iSidOpeningTimeout == 0)
-		pClassAppli->iSidOpeningTimeout = g_timeout_add_seconds (15,  // 15 seconds, for applications that take a really long time to start
-		(GSourceFunc) _stop_opening_timeout, g_strdup (cClass));  /// TODO: there is a memory leak here...
+	if (pClassAppli->iStartupDeadline == 0)
+	{
+		pClassAppli->iStartupDeadline = g_get_monotonic_time () + (gint64)CAIRO_DOCK_STARTUP_TIMEOUT * G_USEC_PER_SEC;
+		g_queue_push_tail (&s_pLaunchingClasses, pClassAppli);  // same delay for all => the queue stays sorted
+		_schedule_startup_timeout ();
+	}
 
 	// notify about the startup
 	gldi_desktop_notify_startup (cClass);
@@ -2036,31 +2090,11 @@ void gldi_class_startup_notify_end (const gchar *cClass)
 	if (! pClassAppli || ! pClassAppli->bIsLaunching)
 		return;
 
-	// unset the icons as launching
-	GList* ic;
-	Icon *icon;
-	for (ic = pClassAppli->pIconsOfClass; ic != NULL; ic = ic->next)
-	{
-		icon = ic->data;
-		gldi_icon_stop_marking_as_launching (icon);
-	}
-	for (ic = pClassAppli->pAppliOfClass; ic != NULL; ic = ic->next)
-	{
-		icon = ic->data;
-		gldi_icon_stop_marking_as_launching (icon);
-	}
-
-	// unset the class as launching and stop a timeout
-	pClassAppli->bIsLaunching = FALSE;
-	if (pClassAppli->iSidOpeningTimeout != 0)
-	{
-		g_source_remove (pClassAppli->iSidOpeningTimeout);
-		pClassAppli->iSidOpeningTimeout = 0;
-	}
+	_stop_launching (pClassAppli);
 }
 
 gboolean gldi_class_is_starting (const gchar *cClass)
 {
 	CairoDockClassAppli *pClassAppli = _cairo_dock_lookup_class_appli (cClass);
-	return (pClassAppli != NULL && pClassAppli->iSidOpeningTimeout != 0);
+	return (pClassAppli != NULL && pClassAppli->iStartupDeadline != 0);
 }
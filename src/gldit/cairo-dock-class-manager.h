@@ -50,7 +50,7 @@ struct _CairoDockClassAppli {
 	GList *pMenuItems;
 	gint iAge;  // age of the first created window of this class
 	gchar *cDockName;  // unique name of the class sub-dock
-	guint iSidOpeningTimeout;  // timeout to stop the launching, if not stopped by the application before
+	gint64 iStartupDeadline;  // monotonic time at which the launching is stopped, if not stopped by the application before; 0 if not launching
 	gboolean bIsLaunching;  // flag to mark a class as being launched
 	gboolean bHasStartupNotify;  // TRUE if the application sends a "remove" event when its launch is complete (not used yet)
 };
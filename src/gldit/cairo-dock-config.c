@@ -49,17 +49,60 @@ static char DES_crypt_key[64] =
 #include "cairo-dock-file-manager.h"  // cairo_dock_get_file_size
 #include "cairo-dock-user-icon-manager.h"  // gldi_user_icons_new_from_directory
 #include "cairo-dock-core.h"  // gldi_free_all
+#include "cairo-dock-keyfile-utilities.h"  // cairo_dock_set_conf_files_journal, cairo_dock_begin_conf_files_snapshot
 #include "cairo-dock-config.h"
 
 gboolean g_bEasterEggs = FALSE;
 
+extern gchar *g_cCurrentThemePath;
 extern gchar *g_cCurrentLaunchersPath;
+extern gchar *g_cCairoDockDataDir;
 extern gchar *g_cConfFile;
 extern gboolean g_bUseOpenGL;
 
 static gboolean s_bLoading = FALSE;
 
 
+// The value of a key may be missing from its group in old conf files: look for it in the same group in upper case, in the "Cairo Dock" group and at its default place, in this order.
+// Lookups are done with g_key_file_has_key, so that no GError is built for each place where it's not; the group and key hash tables of the GKeyFile make them cheap.
+// Returns the group of the next place (starting from 'iPlace') where the key is (to be freed), or NULL if there is none; call it again to go on with the next places if the value found there is not valid.
+static gchar *_find_old_key (GKeyFile *pKeyFile, const gchar *cGroupName, const gchar *cKeyName, gboolean bInMainGroup, const gchar *cDefaultGroupName, const gchar *cDefaultKeyName, int *iPlace, const gchar **cOldKeyName)
+{
+	*cOldKeyName = cKeyName;
+	if (*iPlace == 0)
+	{
+		*iPlace = 1;
+		gchar *cGroupNameUpperCase = g_ascii_strup (cGroupName, -1);
+		if (g_key_file_has_key (pKeyFile, cGroupNameUpperCase, cKeyName, NULL))
+			return cGroupNameUpperCase;
+		g_free (cGroupNameUpperCase);
+	}
+	
+	if (*iPlace == 1)
+	{
+		*iPlace = 2;
+		if (bInMainGroup && g_key_file_has_key (pKeyFile, "Cairo Dock", cKeyName, NULL))
+			return g_strdup ("Cairo Dock");
+	}
+	
+	if (*iPlace == 2)
+	{
+		*iPlace = 3;
+		if (cDefaultGroupName == NULL && cDefaultKeyName == NULL)  // same place as the key itself.
+			return NULL;
+		if (cDefaultGroupName == NULL)
+			cDefaultGroupName = cGroupName;
+		if (cDefaultKeyName == NULL)
+			cDefaultKeyName = cKeyName;
+		if (g_key_file_has_key (pKeyFile, cDefaultGroupName, cDefaultKeyName, NULL))
+		{
+			*cOldKeyName = cDefaultKeyName;
+			return g_strdup (cDefaultGroupName);
+		}
+	}
+	return NULL;
+}
+
 gboolean cairo_dock_get_boolean_key_value (GKeyFile *pKeyFile, const gchar *cGroupName, const gchar *cKeyName, gboolean *bFlushConfFileNeeded, gboolean bDefaultValue, const gchar *cDefaultGroupName, const gchar *cDefaultKeyName)
 {
 	GError *erreur = NULL;
@@ -71,29 +114,23 @@ gboolean cairo_dock_get_boolean_key_value (GKeyFile *pKeyFile, const gchar *cGro
 		g_error_free (erreur);
 		erreur = NULL;
 
-		gchar* cGroupNameUpperCase = g_ascii_strup (cGroupName, -1);
-		bValue = g_key_file_get_boolean (pKeyFile, cGroupNameUpperCase, cKeyName, &erreur);
-		g_free (cGroupNameUpperCase);
-		if (erreur != NULL)
+		bValue = bDefaultValue;
+		const gchar *cOldKeyName;
+		gchar *cOldGroupName;
+		int iPlace = 0;
+		while ((cOldGroupName = _find_old_key (pKeyFile, cGroupName, cKeyName, TRUE, cDefaultGroupName, cDefaultKeyName, &iPlace, &cOldKeyName)) != NULL)
 		{
-			g_error_free (erreur);
-			erreur = NULL;
-			bValue = g_key_file_get_boolean (pKeyFile, "Cairo Dock", cKeyName, &erreur);
-			if (erreur != NULL)
+			gboolean bValueFound = g_key_file_get_boolean (pKeyFile, cOldGroupName, cOldKeyName, &erreur);
+			g_free (cOldGroupName);
+			if (erreur != NULL)  // not a valid value, try the next place.
 			{
 				g_error_free (erreur);
 				erreur = NULL;
-				bValue = g_key_file_get_boolean (pKeyFile, (cDefaultGroupName != NULL ? cDefaultGroupName : cGroupName), (cDefaultKeyName != NULL ? cDefaultKeyName : cKeyName), &erreur);
-				if (erreur != NULL)
-				{
-					g_error_free (erreur);
-					bValue = bDefaultValue;
-				}
-				else
-					cd_message (" (recuperee)");
+				continue;
 			}
-			else
-				cd_message (" (recuperee)");
+			cd_message (" (recuperee)");
+			bValue = bValueFound;
+			break;
 		}
 
 		g_key_file_set_boolean (pKeyFile, cGroupName, cKeyName, bValue);
@@ -114,30 +151,24 @@ int cairo_dock_get_integer_key_value (GKeyFile *pKeyFile, const gchar *cGroupNam
 		g_error_free (erreur);
 		erreur = NULL;
 
-		gchar* cGroupNameUpperCase = g_ascii_strup (cGroupName, -1);
-		iValue = g_key_file_get_integer (pKeyFile, cGroupNameUpperCase, cKeyName, &erreur);
-		if (erreur != NULL)
+		iValue = iDefaultValue;
+		const gchar *cOldKeyName;
+		gchar *cOldGroupName;
+		int iPlace = 0;
+		while ((cOldGroupName = _find_old_key (pKeyFile, cGroupName, cKeyName, TRUE, cDefaultGroupName, cDefaultKeyName, &iPlace, &cOldKeyName)) != NULL)
 		{
-			g_error_free (erreur);
-			erreur = NULL;
-			iValue = g_key_file_get_integer (pKeyFile, "Cairo Dock", cKeyName, &erreur);
-			if (erreur != NULL)
+			int iValueFound = g_key_file_get_integer (pKeyFile, cOldGroupName, cOldKeyName, &erreur);
+			g_free (cOldGroupName);
+			if (erreur != NULL)  // not a valid value, try the next place.
 			{
 				g_error_free (erreur);
 				erreur = NULL;
-				iValue = g_key_file_get_integer (pKeyFile, (cDefaultGroupName != NULL ? cDefaultGroupName : cGroupName), (cDefaultKeyName != NULL ? cDefaultKeyName : cKeyName), &erreur);
-				if (erreur != NULL)
-				{
-					g_error_free (erreur);
-					iValue = iDefaultValue;
-				}
-				else
-					cd_message (" (recuperee)");
+				continue;
 			}
-			else
-				cd_message (" (recuperee)");
+			cd_message (" (recuperee)");
+			iValue = iValueFound;
+			break;
 		}
-		g_free (cGroupNameUpperCase);
 
 		g_key_file_set_integer (pKeyFile, cGroupName, cKeyName, iValue);
 		if (bFlushConfFileNeeded != NULL)
@@ -157,30 +188,24 @@ double cairo_dock_get_double_key_value (GKeyFile *pKeyFile, const gchar *cGroupN
 		g_error_free (erreur);
 		erreur = NULL;
 
-		gchar* cGroupNameUpperCase = g_ascii_strup (cGroupName, -1);
-		fValue = g_key_file_get_double (pKeyFile, cGroupNameUpperCase, cKeyName, &erreur);
-		if (erreur != NULL)
+		fValue = fDefaultValue;
+		const gchar *cOldKeyName;
+		gchar *cOldGroupName;
+		int iPlace = 0;
+		while ((cOldGroupName = _find_old_key (pKeyFile, cGroupName, cKeyName, TRUE, cDefaultGroupName, cDefaultKeyName, &iPlace, &cOldKeyName)) != NULL)
 		{
-			g_error_free (erreur);
-			erreur = NULL;
-			fValue = g_key_file_get_double (pKeyFile, "Cairo Dock", cKeyName, &erreur);
-			if (erreur != NULL)
+			double fValueFound = g_key_file_get_double (pKeyFile, cOldGroupName, cOldKeyName, &erreur);
+			g_free (cOldGroupName);
+			if (erreur != NULL)  // not a valid value, try the next place.
 			{
 				g_error_free (erreur);
 				erreur = NULL;
-				fValue = g_key_file_get_double (pKeyFile, (cDefaultGroupName != NULL ? cDefaultGroupName : cGroupName), (cDefaultKeyName != NULL ? cDefaultKeyName : cKeyName), &erreur);
-				if (erreur != NULL)
-				{
-					g_error_free (erreur);
-					fValue = fDefaultValue;
-				}
-				else
-					cd_message (" (recuperee)");
+				continue;
 			}
-			else
-				cd_message (" (recuperee)");
+			cd_message (" (recuperee)");
+			fValue = fValueFound;
+			break;
 		}
-		g_free (cGroupNameUpperCase);
 
 		g_key_file_set_double (pKeyFile, cGroupName, cKeyName, fValue);
 		if (bFlushConfFileNeeded != NULL)
@@ -200,30 +225,25 @@ gchar *cairo_dock_get_string_key_value (GKeyFile *pKeyFile, const gchar *cGroupN
 		g_error_free (erreur);
 		erreur = NULL;
 
-		gchar* cGroupNameUpperCase = g_ascii_strup (cGroupName, -1);
-		cValue = g_key_file_get_string (pKeyFile, cGroupNameUpperCase, cKeyName, &erreur);
-		if (erreur != NULL)
+		cValue = g_strdup (cDefaultValue);
+		const gchar *cOldKeyName;
+		gchar *cOldGroupName;
+		int iPlace = 0;
+		while ((cOldGroupName = _find_old_key (pKeyFile, cGroupName, cKeyName, TRUE, cDefaultGroupName, cDefaultKeyName, &iPlace, &cOldKeyName)) != NULL)
 		{
-			g_error_free (erreur);
-			erreur = NULL;
-			cValue = g_key_file_get_string (pKeyFile, "Cairo Dock", cKeyName, &erreur);
-			if (erreur != NULL)
+			gchar *cValueFound = g_key_file_get_string (pKeyFile, cOldGroupName, cOldKeyName, &erreur);
+			g_free (cOldGroupName);
+			if (erreur != NULL)  // not a valid value, try the next place.
 			{
 				g_error_free (erreur);
 				erreur = NULL;
-				cValue = g_key_file_get_string (pKeyFile, (cDefaultGroupName != NULL ? cDefaultGroupName : cGroupName), (cDefaultKeyName != NULL ? cDefaultKeyName : cKeyName), &erreur);
-				if (erreur != NULL)
-				{
-					g_error_free (erreur);
-					cValue = g_strdup (cDefaultValue);
-				}
-				else
-					cd_message (" (recuperee)");
+				continue;
 			}
-			else
-				cd_message (" (recuperee)");
+			cd_message (" (recuperee)");
+			g_free (cValue);
+			cValue = cValueFound;
+			break;
 		}
-		g_free (cGroupNameUpperCase);
 
 		g_key_file_set_string (pKeyFile, cGroupName, cKeyName, (cValue != NULL ? cValue : ""));
 		if (bFlushConfFileNeeded != NULL)
@@ -252,42 +272,24 @@ void cairo_dock_get_integer_list_key_value (GKeyFile *pKeyFile, const gchar *cGr
 		g_error_free (erreur);
 		erreur = NULL;
 
-		gchar* cGroupNameUpperCase = g_ascii_strup (cGroupName, -1);
-		iValuesList = g_key_file_get_integer_list (pKeyFile, cGroupNameUpperCase, cKeyName, &length, &erreur);
-		if (erreur != NULL)
+		const gchar *cOldKeyName;
+		gchar *cOldGroupName;
+		int iPlace = 0;
+		while ((cOldGroupName = _find_old_key (pKeyFile, cGroupName, cKeyName, TRUE, cDefaultGroupName, cDefaultKeyName, &iPlace, &cOldKeyName)) != NULL)
 		{
-			g_error_free (erreur);
-			erreur = NULL;
-			iValuesList = g_key_file_get_integer_list (pKeyFile, "Cairo Dock", cKeyName, &length, &erreur);
-			if (erreur != NULL)
+			iValuesList = g_key_file_get_integer_list (pKeyFile, cOldGroupName, cOldKeyName, &length, &erreur);
+			g_free (cOldGroupName);
+			if (erreur != NULL)  // not a valid value, try the next place.
 			{
 				g_error_free (erreur);
 				erreur = NULL;
-				iValuesList = g_key_file_get_integer_list (pKeyFile, (cDefaultGroupName != NULL ? cDefaultGroupName : cGroupName), (cDefaultKeyName != NULL ? cDefaultKeyName : cKeyName), &length, &erreur);
-				if (erreur != NULL)
-				{
-					g_error_free (erreur);
-				}
-				else
-				{
-					cd_message (" (recuperee)");
-					if (length > 0)
-						memcpy (iValueBuffer, iValuesList, MIN (iNbElements, length) * sizeof (int));
-				}
-			}
-			else
-			{
-				cd_message (" (recuperee)");
-				if (length > 0)
-					memcpy (iValueBuffer, iValuesList, MIN (iNbElements, length) * sizeof (int));
+				continue;
 			}
-		}
-		else
-		{
+			cd_message (" (recuperee)");
 			if (length > 0)
 				memcpy (iValueBuffer, iValuesList, MIN (iNbElements, length) * sizeof (int));
+			break;
 		}
-		g_free (cGroupNameUpperCase);
 		
 		if (iDefaultValues != NULL)  // on ne modifie les valeurs actuelles que si on a explicitement passe des valeurs par defaut en entree; sinon on considere que l'on va traiter le cas en aval.
 			g_key_file_set_integer_list (pKeyFile, cGroupName, cKeyName, iValueBuffer, iNbElements);
@@ -317,43 +319,25 @@ void cairo_dock_get_double_list_key_value (GKeyFile *pKeyFile, const gchar *cGro
 		g_error_free (erreur);
 		erreur = NULL;
 
-		gchar* cGroupNameUpperCase = g_ascii_strup (cGroupName, -1);
-		fValuesList = g_key_file_get_double_list (pKeyFile, cGroupNameUpperCase, cKeyName, &length, &erreur);
-		if (erreur != NULL)
+		const gchar *cOldKeyName;
+		gchar *cOldGroupName;
+		int iPlace = 0;
+		while ((cOldGroupName = _find_old_key (pKeyFile, cGroupName, cKeyName, TRUE, cDefaultGroupName, cDefaultKeyName, &iPlace, &cOldKeyName)) != NULL)
 		{
-			g_error_free (erreur);
-			erreur = NULL;
-			fValuesList = g_key_file_get_double_list (pKeyFile, "Cairo Dock", cKeyName, &length, &erreur);
-			if (erreur != NULL)
+			fValuesList = g_key_file_get_double_list (pKeyFile, cOldGroupName, cOldKeyName, &length, &erreur);
+			g_free (cOldGroupName);
+			if (erreur != NULL)  // not a valid value, try the next place.
 			{
 				g_error_free (erreur);
 				erreur = NULL;
-				fValuesList = g_key_file_get_double_list (pKeyFile, (cDefaultGroupName != NULL ? cDefaultGroupName : cGroupName), (cDefaultKeyName != NULL ? cDefaultKeyName : cKeyName), &length, &erreur);
-				if (erreur != NULL)
-				{
-					g_error_free (erreur);
-				}
-				else
-				{
-					cd_message (" (recuperee)");
-					if (length > 0)
-						memcpy (fValueBuffer, fValuesList, MIN (iNbElements, length) * sizeof (double));
-				}
-			}
-			else
-			{
-				cd_message (" (recuperee)");
-				if (length > 0)
-					memcpy (fValueBuffer, fValuesList, MIN (iNbElements, length) * sizeof (double));
+				continue;
 			}
-		}
-		else
-		{
+			cd_message (" (recuperee)");
 			if (length > 0)
 				memcpy (fValueBuffer, fValuesList, MIN (iNbElements, length) * sizeof (double));
+			break;
 		}
-		g_free (cGroupNameUpperCase);
-
+		
 		g_key_file_set_double_list (pKeyFile, cGroupName, cKeyName, fValueBuffer, iNbElements);
 		if (bFlushConfFileNeeded != NULL)
 			*bFlushConfFileNeeded = TRUE;
@@ -384,27 +368,33 @@ gchar **cairo_dock_get_string_list_key_value (GKeyFile *pKeyFile, const gchar *c
 		g_error_free (erreur);
 		erreur = NULL;
 
-		gchar* cGroupNameUpperCase = g_ascii_strup (cGroupName, -1);
-		cValuesList = g_key_file_get_string_list (pKeyFile, cGroupNameUpperCase, cKeyName, length, &erreur);
-		if (erreur != NULL)
+		const gchar *cOldKeyName;
+		gchar *cOldGroupName;
+		int iPlace = 0;
+		while ((cOldGroupName = _find_old_key (pKeyFile, cGroupName, cKeyName, FALSE, cDefaultGroupName, cDefaultKeyName, &iPlace, &cOldKeyName)) != NULL)
 		{
-			g_error_free (erreur);
-			erreur = NULL;
-			cValuesList = g_key_file_get_string_list (pKeyFile, (cDefaultGroupName != NULL ? cDefaultGroupName : cGroupName), (cDefaultKeyName != NULL ? cDefaultKeyName : cKeyName), length, &erreur);
-			if (erreur != NULL)
+			cValuesList = g_key_file_get_string_list (pKeyFile, cOldGroupName, cOldKeyName, length, &erreur);
+			g_free (cOldGroupName);
+			if (erreur != NULL)  // not a valid value, try the next place.
 			{
 				g_error_free (erreur);
-				cValuesList = g_strsplit (cDefaultValues, ";", -1);  // "" -> NULL.
-				int i = 0;
-				if (cValuesList != NULL)
-				{
-					while (cValuesList[i] != NULL)
-						i ++;
-				}
-				*length = i;
+				erreur = NULL;
+				cValuesList = NULL;
+				continue;
 			}
+			break;
+		}
+		if (cValuesList == NULL)
+		{
+			cValuesList = g_strsplit (cDefaultValues, ";", -1);  // "" -> NULL.
+			int i = 0;
+			if (cValuesList != NULL)
+			{
+				while (cValuesList[i] != NULL)
+					i ++;
+			}
+			*length = i;
 		}
-		g_free (cGroupNameUpperCase);
 
 		if (*length > 0)
 			g_key_file_set_string_list (pKeyFile, cGroupName, cKeyName, (const gchar **)cValuesList, *length);
@@ -451,7 +441,15 @@ void cairo_dock_load_current_theme (void)
 	
 	//\___________________ Free everything.
 	gldi_free_all ();  // do nothing if there is nothing to unload.
-		
+	
+	//\___________________ Write the updates of the conf files that the previous session couldn't write, and journal the next ones.
+	gchar *cJournalPath = g_strdup_printf ("%s/.conf-journal", g_cCairoDockDataDir);
+	cairo_dock_set_conf_files_journal (cJournalPath);
+	g_free (cJournalPath);
+	
+	//\___________________ Take the conf files that haven't changed since the previous load from its snapshot.
+	cairo_dock_begin_conf_files_snapshot (g_cCurrentThemePath);
+	
 	//\___________________ Get all managers config.
 	gldi_managers_get_config (g_cConfFile, GLDI_VERSION);  /// en fait, CAIRO_DOCK_VERSION ...
 	
@@ -473,6 +471,9 @@ void cairo_dock_load_current_theme (void)
 	//\___________________ Start the applications manager (will load the icons if the option is enabled).
 	cairo_dock_start_applications_manager (pMainDock);
 	
+	//\___________________ Keep the conf files we've read for the next time.
+	cairo_dock_end_conf_files_snapshot ();
+	
 	s_bLoading = FALSE;
 }
 
@@ -36,6 +36,7 @@
 #include "cairo-dock-animations.h"  // cairo_dock_animation_will_be_visible
 #include "cairo-dock-desktop-manager.h"  // gldi_desktop_get_width
 #include "cairo-dock-menu.h"  // gldi_menu_new
+#include "cairo-dock-overlay.h"  // cairo_dock_icon_image_changed
 #define _MANAGER_DEF_
 #include "cairo-dock-container.h"
 
@@ -185,6 +186,7 @@ void cairo_dock_redraw_container_area (GldiContainer *pContainer, GdkRectangle *
 void cairo_dock_redraw_icon (Icon *icon)
 {
 	g_return_if_fail (icon != NULL);
+	cairo_dock_icon_image_changed (icon);  // the icon is redrawn because its image has changed, most of the time.
 	GldiContainer *pContainer = cairo_dock_get_icon_container (icon);
 	g_return_if_fail (pContainer != NULL);
 	GdkRectangle rect;
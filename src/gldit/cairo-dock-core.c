@@ -43,6 +43,7 @@
 #include "cairo-dock-module-instance-manager.h"
 #include "cairo-dock-packages.h"
 #include "cairo-dock-style-manager.h"
+#include "cairo-dock-keyfile-utilities.h"  // cairo_dock_flush_conf_files
 #include "cairo-dock-indicator-manager.h"
 #include "cairo-dock-keybinder.h"
 #include "cairo-dock-data-renderer-manager.h"
@@ -134,4 +135,7 @@ void gldi_free_all (void)
 	gldi_modules_deactivate_all ();  /// TODO: try to do that in the unload of the manager...
 	
 	cairo_dock_reset_docks_table ();  // detruit tous les docks, vide la table, et met le main-dock a NULL.
+	
+	// write the conf files that have been updated lately.
+	cairo_dock_flush_conf_files ();
 }
@@ -0,0 +1,133 @@
+/*
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include <unistd.h>  // close
+#include <fcntl.h>  // O_RDONLY
+#include <sys/mman.h>  // shm_open, mmap
+#include <sys/stat.h>  // fstat
+
+#include "cairo-dock-log.h"
+#include "cairo-dock-data-feed.h"
+
+struct _CairoDataFeed {
+	const CairoDataFeedHeader *pHeader;  // mapped read-only; only iWriteCount changes.
+	const gfloat *pSamples;  // the ring, right after the header.
+	gsize iSize;  // size of the mapping.
+	guint iNbValues;
+	guint iNbSamples;
+	guint64 iReadCount;  // number of samples already read (or skipped).
+};
+
+#define _get_write_count(pFeed) __atomic_load_n (&(pFeed)->pHeader->iWriteCount, __ATOMIC_ACQUIRE)
+
+CairoDataFeed *cairo_data_feed_open (const gchar *cName, int iNbValues)
+{
+	g_return_val_if_fail (cName != NULL && *cName != '\0' && strchr (cName, '/') == NULL, NULL);
+
+	//\_______________ map the shared memory.
+	gchar *cShmName = g_strdup_printf ("/cairo-dock-feed-%s", cName);
+	int fd = shm_open (cShmName, O_RDONLY, 0);
+	g_free (cShmName);
+	if (fd < 0)
+	{
+		cd_warning ("no data feed '%s'", cName);
+		return NULL;
+	}
+	struct stat st;
+	void *pMap = MAP_FAILED;
+	if (fstat (fd, &st) == 0 && st.st_size >= (off_t)sizeof (CairoDataFeedHeader))
+		pMap = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);  // the mapping stays valid.
+	if (pMap == MAP_FAILED)
+	{
+		cd_warning ("couldn't map the data feed '%s'", cName);
+		return NULL;
+	}
+
+	//\_______________ check that it's a feed for us.
+	const CairoDataFeedHeader *pHeader = pMap;
+	if (pHeader->iMagic != CAIRO_DATA_FEED_MAGIC
+	|| pHeader->iVersion != CAIRO_DATA_FEED_VERSION
+	|| pHeader->iNbValues != (guint32)iNbValues
+	|| pHeader->iNbSamples < 2
+	|| (gsize)st.st_size < sizeof (CairoDataFeedHeader) + (gsize)pHeader->iNbSamples * pHeader->iNbValues * sizeof (gfloat))
+	{
+		cd_warning ("the data feed '%s' is not valid or doesn't provide %d values", cName, iNbValues);
+		munmap (pMap, st.st_size);
+		return NULL;
+	}
+
+	CairoDataFeed *pFeed = g_new0 (CairoDataFeed, 1);
+	pFeed->pHeader = pHeader;
+	pFeed->pSamples = (const gfloat *)(pHeader + 1);
+	pFeed->iSize = st.st_size;
+	pFeed->iNbValues = pHeader->iNbValues;
+	pFeed->iNbSamples = pHeader->iNbSamples;
+	pFeed->iReadCount = _get_write_count (pFeed);  // only the samples written from now on are read.
+	return pFeed;
+}
+
+int cairo_data_feed_read (CairoDataFeed *pFeed, gdouble *pValues, int iMaxSamples)
+{
+	g_return_val_if_fail (pFeed != NULL, 0);
+	guint64 iWriteCount = _get_write_count (pFeed);
+	if (iWriteCount < pFeed->iReadCount)  // the producer has been restarted.
+		pFeed->iReadCount = iWriteCount;
+	if (iWriteCount == pFeed->iReadCount || iMaxSamples < 1)
+		return 0;
+
+	//\_______________ take the samples that are not being overwritten: the next slot is the one of the oldest sample, it may be written right now.
+	guint64 iFirst = pFeed->iReadCount;
+	guint64 iLimit = MIN ((guint64)iMaxSamples, (guint64)pFeed->iNbSamples - 1);
+	if (iWriteCount - iFirst > iLimit)
+		iFirst = iWriteCount - iLimit;
+
+	guint iNbValues = pFeed->iNbValues;
+	guint64 n;
+	guint j;
+	const gfloat *pSample;
+	for (n = iFirst; n < iWriteCount; n ++)
+	{
+		pSample = &pFeed->pSamples[(n % pFeed->iNbSamples) * iNbValues];
+		for (j = 0; j < iNbValues; j ++)
+			pValues[(n - iFirst) * iNbValues + j] = pSample[j];
+	}
+
+	//\_______________ the producer may have overtaken us during the copy, in which case the oldest samples we copied are garbage.
+	__atomic_thread_fence (__ATOMIC_ACQUIRE);
+	guint64 iNewWriteCount = _get_write_count (pFeed);
+	int iNbRead = iWriteCount - iFirst;
+	if (iNewWriteCount > iFirst + pFeed->iNbSamples - 1)
+	{
+		guint64 iNbLost = MIN (iNewWriteCount - (iFirst + pFeed->iNbSamples - 1), (guint64)iNbRead);
+		iNbRead -= iNbLost;
+		memmove (pValues, &pValues[iNbLost * iNbValues], iNbRead * iNbValues * sizeof (gdouble));
+	}
+	pFeed->iReadCount = iWriteCount;
+	return iNbRead;
+}
+
+void cairo_data_feed_close (CairoDataFeed *pFeed)
+{
+	if (pFeed == NULL)
+		return;
+	munmap ((gpointer)pFeed->pHeader, pFeed->iSize);
+	g_free (pFeed);
+}
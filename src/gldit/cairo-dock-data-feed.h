@@ -0,0 +1,79 @@
+/*
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __CAIRO_DOCK_DATA_FEED__
+#define  __CAIRO_DOCK_DATA_FEED__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+*@file cairo-dock-data-feed.h A Data Feed is a ring of samples in shared memory, written by an external program and read by the dock, to feed a Data Renderer without a DBus call per sample.
+*
+* The producer creates the shared memory object "/cairo-dock-feed-<name>" (see shm_open(3)), of size sizeof(CairoDataFeedHeader) + iNbSamples * iNbValues * sizeof(float), and fills the header.
+* To write a sample, it writes the iNbValues floats at the index (iWriteCount % iNbSamples) of the ring, and then increments iWriteCount.
+* The feed is then set on the icon with cairo_dock_set_data_feed_on_icon (CD_APPLET_SET_DATA_FEED_ON_MY_ICON in an applet); tests/DataFeedProducer.py is an example of producer.
+* The dock reads the new samples at its own pace, without any system call; if the producer is too fast, the oldest samples are skipped. After a second without any new sample, the feeds are only checked once per second, until a sample arrives.
+*/
+
+/// Magic number at the start of a Data Feed ("CDDF").
+#define CAIRO_DATA_FEED_MAGIC 0x46444443
+/// Version of the layout of a Data Feed.
+#define CAIRO_DATA_FEED_VERSION 1
+
+/// Header of a Data Feed, at the start of the shared memory. It is followed by the ring of samples, each one made of iNbValues floats.
+typedef struct _CairoDataFeedHeader {
+	/// CAIRO_DATA_FEED_MAGIC
+	guint32 iMagic;
+	/// CAIRO_DATA_FEED_VERSION
+	guint32 iVersion;
+	/// number of values in a sample, must be the number of values of the Data Renderer.
+	guint32 iNbValues;
+	/// number of samples in the ring.
+	guint32 iNbSamples;
+	/// number of samples written since the creation of the feed. It must be updated after the sample is written.
+	guint64 iWriteCount;
+} CairoDataFeedHeader;
+
+typedef struct _CairoDataFeed CairoDataFeed;
+
+/** Open a Data Feed created by an external program.
+*@param cName name of the feed
+*@param iNbValues number of values expected in a sample
+*@return the feed, or NULL if it doesn't exist or doesn't match. Close it with cairo_data_feed_close.
+*/
+CairoDataFeed *cairo_data_feed_open (const gchar *cName, int iNbValues);
+
+/** Read the samples that have been written since the last read. It doesn't involve any system call.
+*@param pFeed the feed
+*@param pValues a buffer of at least iMaxSamples * iNbValues doubles, filled with the samples, the oldest first
+*@param iMaxSamples maximum number of samples to read; if more are available, the oldest ones are skipped.
+*@return the number of samples read
+*/
+int cairo_data_feed_read (CairoDataFeed *pFeed, gdouble *pValues, int iMaxSamples);
+
+/** Close a Data Feed. The shared memory is left to the producer.
+*@param pFeed the feed
+*/
+void cairo_data_feed_close (CairoDataFeed *pFeed);
+
+G_END_DECLS
+#endif
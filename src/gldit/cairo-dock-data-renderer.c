@@ -42,26 +42,56 @@
 #include "cairo-dock-gauge.h"
 #include "cairo-dock-graph.h"
 #include "cairo-dock-progressbar.h"
+#include "cairo-dock-data-feed.h"
 #include "cairo-dock-data-renderer.h"
 
 extern gboolean g_bUseOpenGL;
 
+static GList *s_pPendingIcons = NULL;  // icons whose data-renderer has new values to be drawn.
+static guint s_iSidRenderPending = 0;
+static GList *s_pFeedIcons = NULL;  // icons whose data-renderer reads its values from a data feed.
+static guint s_iSidReadFeeds = 0;
+static guint s_iFeedDelay = 0;  // current delay between 2 reads.
+static gint s_iNbEmptyReads = 0;  // number of reads in a row that got nothing.
+static gdouble *s_pFeedBuffer = NULL;  // samples read from a feed.
+static int s_iFeedBufferSize = 0;
+
+#define CD_DATA_FEED_DELAY 40  // ms; about the rate of the animations, so that the values are drawn as soon as the next frame.
+#define CD_DATA_FEED_IDLE_DELAY 1000  // ms; once the feeds have been silent for a while, so that the dock is not woken up for nothing.
+#define CD_DATA_FEED_MAX_EMPTY_READS 25  // 1s at the normal rate.
+
+static void _add_feed_icon (Icon *pIcon);
+static void _remove_feed_icon (Icon *pIcon);
+
 #define cairo_dock_set_data_renderer_on_icon(pIcon, pRenderer) (pIcon)->pDataRenderer = pRenderer
 #define CD_MIN_TEXT_WITH 24
 
+static void _resize_values_buffer (CairoDataToRenderer *pData, int iNewMemorySize)
+{
+	// each value has its own ring, so they have to be moved one by one; the values keep their index in the ring, the new ones are set to 0.
+	int iOldMemorySize = pData->iMemorySize;
+	int iNbCopied = MIN (iOldMemorySize, iNewMemorySize);
+	gfloat *pValuesBuffer = g_new0 (gfloat, pData->iNbValues * iNewMemorySize);
+	int i;
+	for (i = 0; i < pData->iNbValues; i ++)
+	{
+		memcpy (&pValuesBuffer[i*iNewMemorySize], &pData->pValuesBuffer[i*iOldMemorySize], iNbCopied * sizeof (gfloat));
+	}
+	g_free (pData->pValuesBuffer);
+	pData->pValuesBuffer = pValuesBuffer;
+	pData->iMemorySize = iNewMemorySize;
+	if (pData->iCurrentIndex >= iNewMemorySize)
+		pData->iCurrentIndex = iNewMemorySize - 1;
+}
+
 static void _cairo_dock_init_data_renderer (CairoDataRenderer *pRenderer, CairoDataRendererAttribute *pAttribute)
 {
 	//\_______________ On alloue la structure des donnees.
 	pRenderer->data.iNbValues = MAX (1, pAttribute->iNbValues);
 	pRenderer->data.iMemorySize = MAX (2, pAttribute->iMemorySize);  // au moins la derniere valeur et la nouvelle.
-	pRenderer->data.pValuesBuffer = g_new0 (gdouble, pRenderer->data.iNbValues * pRenderer->data.iMemorySize);
-	pRenderer->data.pTabValues = g_new (gdouble *, pRenderer->data.iMemorySize);
-	int i;
-	for (i = 0; i < pRenderer->data.iMemorySize; i ++)
-	{
-		pRenderer->data.pTabValues[i] = &pRenderer->data.pValuesBuffer[i*pRenderer->data.iNbValues];
-	}
+	pRenderer->data.pValuesBuffer = g_new0 (gfloat, pRenderer->data.iNbValues * pRenderer->data.iMemorySize);
 	pRenderer->data.iCurrentIndex = -1;
+	int i;
 	pRenderer->data.pMinMaxValues = g_new (gdouble, 2 * pRenderer->data.iNbValues);
 	if (pAttribute->pMinMaxValues != NULL)
 	{
@@ -336,9 +366,15 @@ static void _cairo_dock_render_to_context (CairoDataRenderer *pRenderer, Icon *p
 	cairo_restore (pCairoContext);
 	
 	if (pRenderer->bUseOverlay && pRenderer->pOverlay != NULL)
+	{
 		cairo_dock_end_draw_image_buffer_cairo (&pRenderer->pOverlay->image);
+		cairo_dock_overlay_changed (pRenderer->pOverlay);
+	}
 	else
+	{
 		cairo_dock_end_draw_image_buffer_cairo (&pIcon->image);
+		cairo_dock_icon_image_changed (pIcon);
+	}
 	/**if (CAIRO_DOCK_CONTAINER_IS_OPENGL (pContainer))
 	{
 		if (pRenderer->bUseOverlay)
@@ -545,6 +581,7 @@ void cairo_dock_add_new_data_renderer_on_icon (Icon *pIcon, GldiContainer *pCont
 {
 	//\___________________ if a previous renderer exists, keep its data alive.
 	CairoDataToRenderer *pData = NULL;
+	CairoDataFeed *pFeed = NULL;
 	CairoDataRenderer *pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
 	//g_print ("%s (%s, %p)\n", __func__, pIcon->cName, pRenderer);
 	if (pRenderer != NULL)
@@ -558,25 +595,11 @@ void cairo_dock_add_new_data_renderer_on_icon (Icon *pIcon, GldiContainer *pCont
 			
 			pAttribute->iMemorySize = MAX (2, pAttribute->iMemorySize);
 			if (pData->iMemorySize != pAttribute->iMemorySize)  // on redimensionne le tampon des valeurs.
-			{
-				int iOldMemorySize = pData->iMemorySize;
-				pData->iMemorySize = pAttribute->iMemorySize;
-				pData->pValuesBuffer = g_realloc (pData->pValuesBuffer, pData->iMemorySize * pData->iNbValues * sizeof (gdouble));
-				if (pData->iMemorySize > iOldMemorySize)
-				{
-					memset (&pData->pValuesBuffer[iOldMemorySize * pData->iNbValues], 0, (pData->iMemorySize - iOldMemorySize) * pData->iNbValues * sizeof (gdouble));
-				}
-				
-				g_free (pData->pTabValues);
-				pData->pTabValues = g_new (gdouble *, pData->iMemorySize);
-				int i;
-				for (i = 0; i < pData->iMemorySize; i ++)
-				{
-					pData->pTabValues[i] = &pData->pValuesBuffer[i*pData->iNbValues];
-				}
-				if (pData->iCurrentIndex >= pData->iMemorySize)
-					pData->iCurrentIndex = pData->iMemorySize - 1;
-			}
+				_resize_values_buffer (pData, pAttribute->iMemorySize);
+			
+			pFeed = pRenderer->pFeed;  // the samples still have the right size, keep reading them.
+			pRenderer->pFeed = NULL;
+			_remove_feed_icon (pIcon);
 		}
 		
 		//\_____________ remove the current data-renderer
@@ -588,7 +611,10 @@ void cairo_dock_add_new_data_renderer_on_icon (Icon *pIcon, GldiContainer *pCont
 	
 	cairo_dock_set_data_renderer_on_icon (pIcon, pRenderer);
 	if (pRenderer == NULL)
+	{
+		cairo_data_feed_close (pFeed);
 		return ;
+	}
 	
 	//\___________________ load it.
 	_cairo_dock_init_data_renderer (pRenderer, pAttribute);
@@ -619,6 +645,11 @@ void cairo_dock_add_new_data_renderer_on_icon (Icon *pIcon, GldiContainer *pCont
 		g_free (pData);
 		_refresh (pRenderer, pIcon, pContainer);
 	}
+	if (pFeed != NULL)
+	{
+		pRenderer->pFeed = pFeed;
+		_add_feed_icon (pIcon);
+	}
 }
 
 
@@ -641,31 +672,10 @@ static gboolean _render_delayed (Icon *pIcon)
 	pRenderer->iSidRenderIdle = 0;
 	return FALSE;
 }
-void cairo_dock_render_new_data_on_icon (Icon *pIcon, GldiContainer *pContainer, cairo_t *pCairoContext, double *pNewValues)
+static void _render_new_data (CairoDataRenderer *pRenderer, Icon *pIcon, GldiContainer *pContainer, cairo_t *pCairoContext)
 {
-	CairoDataRenderer *pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
-	g_return_if_fail (pRenderer != NULL);
-	
-	//\___________________ On met a jour les valeurs du renderer.
 	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
-	pData->iCurrentIndex ++;
-	if (pData->iCurrentIndex >= pData->iMemorySize)
-		pData->iCurrentIndex -= pData->iMemorySize;
-	double fNewValue;
 	int i;
-	for (i = 0; i < pData->iNbValues; i ++)
-	{
-		fNewValue = pNewValues[i];
-		if (pRenderer->bUpdateMinMax && fNewValue > CAIRO_DATA_RENDERER_UNDEF_VALUE + 1)
-		{
-			if (fNewValue < pData->pMinMaxValues[2*i])
-				pData->pMinMaxValues[2*i] = fNewValue;
-			if (fNewValue > pData->pMinMaxValues[2*i+1])
-				pData->pMinMaxValues[2*i+1] = MAX (fNewValue, pData->pMinMaxValues[2*i]+.1);
-		}
-		pData->pTabValues[pData->iCurrentIndex][i] = fNewValue;
-	}
-	pData->bHasValue = TRUE;
 	
 	//\___________________ On met a jour le dessin de l'icone.
 	if (CAIRO_DOCK_CONTAINER_IS_OPENGL (pContainer) && pRenderer->interface.render_opengl)
@@ -713,13 +723,182 @@ void cairo_dock_render_new_data_on_icon (Icon *pIcon, GldiContainer *pContainer,
 				str ++;
 			}
 		}
-		gldi_icon_set_quick_info (pIcon, cBuffer);
+		if (g_strcmp0 (cBuffer, pIcon->cQuickInfo) != 0)  // the text is often the same (ex.: a constant value, or a rounded one), in which case the quick-info doesn't need to be reloaded.
+			gldi_icon_set_quick_info (pIcon, cBuffer);
 		g_free (cBuffer);
 	}
 	
 	cairo_dock_redraw_icon (pIcon);
 }
 
+static gboolean _render_pending_data (G_GNUC_UNUSED gpointer data)
+{
+	GList *pIcons = s_pPendingIcons;
+	s_pPendingIcons = NULL;
+	s_iSidRenderPending = 0;
+	
+	Icon *pIcon;
+	CairoDataRenderer *pRenderer;
+	GList *ic;
+	for (ic = pIcons; ic != NULL; ic = ic->next)
+	{
+		pIcon = ic->data;
+		pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
+		if (pRenderer == NULL || ! pRenderer->bPendingRender)
+			continue;
+		pRenderer->bPendingRender = FALSE;
+		if (pIcon->pContainer != NULL)
+			_render_new_data (pRenderer, pIcon, pIcon->pContainer, NULL);
+	}
+	g_list_free (pIcons);
+	return FALSE;
+}
+
+static void _record_new_values (CairoDataRenderer *pRenderer, const double *pNewValues)
+{
+	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
+	pData->iCurrentIndex ++;
+	if (pData->iCurrentIndex >= pData->iMemorySize)
+		pData->iCurrentIndex -= pData->iMemorySize;
+	double fNewValue;
+	int i;
+	for (i = 0; i < pData->iNbValues; i ++)
+	{
+		fNewValue = pNewValues[i];
+		if (pRenderer->bUpdateMinMax && fNewValue > CAIRO_DATA_RENDERER_UNDEF_VALUE + 1)
+		{
+			if (fNewValue < pData->pMinMaxValues[2*i])
+				pData->pMinMaxValues[2*i] = fNewValue;
+			if (fNewValue > pData->pMinMaxValues[2*i+1])
+				pData->pMinMaxValues[2*i+1] = MAX (fNewValue, pData->pMinMaxValues[2*i]+.1);
+		}
+		pData->pValuesBuffer[i * pData->iMemorySize + pData->iCurrentIndex] = fNewValue;
+	}
+	pData->bHasValue = TRUE;
+	pData->iNbPushedValues ++;
+}
+
+static void _queue_render (CairoDataRenderer *pRenderer, Icon *pIcon)
+{
+	if (pRenderer->bPendingRender)
+		return;
+	pRenderer->bPendingRender = TRUE;
+	s_pPendingIcons = g_list_prepend (s_pPendingIcons, pIcon);
+	if (s_iSidRenderPending == 0)
+		s_iSidRenderPending = g_idle_add_full (G_PRIORITY_HIGH_IDLE, (GSourceFunc)_render_pending_data, NULL, NULL);  // before GTK redraws the windows
+}
+
+void cairo_dock_render_new_data_on_icon (Icon *pIcon, GldiContainer *pContainer, cairo_t *pCairoContext, double *pNewValues)
+{
+	CairoDataRenderer *pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
+	g_return_if_fail (pRenderer != NULL);
+	
+	//\___________________ On met a jour les valeurs du renderer.
+	_record_new_values (pRenderer, pNewValues);
+	
+	//\___________________ On met a jour le dessin de l'icone.
+	if (pCairoContext != NULL || pContainer == NULL)  // the caller wants the drawing to be done now, on its context.
+	{
+		_render_new_data (pRenderer, pIcon, pContainer, pCairoContext);
+	}
+	else  // draw it on the next frame, along with the other renderers that got new values in the meantime; that way the dock is only redrawn once.
+	{
+		_queue_render (pRenderer, pIcon);
+	}
+}
+
+
+  ////////////////
+ /// DATA FEED ///
+////////////////
+
+static gboolean _read_data_feeds (G_GNUC_UNUSED gpointer data)
+{
+	Icon *pIcon;
+	CairoDataRenderer *pRenderer;
+	int iNbValues, iNbSamples, n;
+	gboolean bGotData = FALSE;
+	GList *ic;
+	for (ic = s_pFeedIcons; ic != NULL; ic = ic->next)
+	{
+		pIcon = ic->data;
+		pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
+		iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
+		iNbSamples = cairo_data_renderer_get_history_size (pRenderer);  // older samples would be overwritten in the history anyway.
+		if (s_iFeedBufferSize < iNbSamples * iNbValues)
+		{
+			s_iFeedBufferSize = iNbSamples * iNbValues;
+			s_pFeedBuffer = g_renew (gdouble, s_pFeedBuffer, s_iFeedBufferSize);
+		}
+		
+		iNbSamples = cairo_data_feed_read (pRenderer->pFeed, s_pFeedBuffer, iNbSamples);
+		if (iNbSamples == 0)
+			continue;
+		bGotData = TRUE;
+		for (n = 0; n < iNbSamples; n ++)
+			_record_new_values (pRenderer, &s_pFeedBuffer[n * iNbValues]);
+		if (pIcon->pContainer != NULL)
+			_queue_render (pRenderer, pIcon);
+	}
+	
+	// read the feeds at the rate of the animations while they're fed, and only from time to time when they're silent.
+	if (bGotData)
+		s_iNbEmptyReads = 0;
+	else if (s_iNbEmptyReads < CD_DATA_FEED_MAX_EMPTY_READS)
+		s_iNbEmptyReads ++;
+	guint iDelay = (s_iNbEmptyReads < CD_DATA_FEED_MAX_EMPTY_READS ? CD_DATA_FEED_DELAY : CD_DATA_FEED_IDLE_DELAY);
+	if (iDelay == s_iFeedDelay)
+		return TRUE;
+	s_iFeedDelay = iDelay;
+	s_iSidReadFeeds = g_timeout_add (iDelay, (GSourceFunc)_read_data_feeds, NULL);
+	return FALSE;
+}
+
+static void _add_feed_icon (Icon *pIcon)
+{
+	s_pFeedIcons = g_list_prepend (s_pFeedIcons, pIcon);
+	s_iNbEmptyReads = 0;
+	if (s_iSidReadFeeds == 0)
+	{
+		s_iFeedDelay = CD_DATA_FEED_DELAY;
+		s_iSidReadFeeds = g_timeout_add (CD_DATA_FEED_DELAY, (GSourceFunc)_read_data_feeds, NULL);
+	}
+}
+
+static void _remove_feed_icon (Icon *pIcon)
+{
+	s_pFeedIcons = g_list_remove (s_pFeedIcons, pIcon);
+	if (s_pFeedIcons == NULL && s_iSidReadFeeds != 0)
+	{
+		g_source_remove (s_iSidReadFeeds);
+		s_iSidReadFeeds = 0;
+		g_free (s_pFeedBuffer);
+		s_pFeedBuffer = NULL;
+		s_iFeedBufferSize = 0;
+	}
+}
+
+gboolean cairo_dock_set_data_feed_on_icon (Icon *pIcon, const gchar *cFeedName)
+{
+	CairoDataRenderer *pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
+	g_return_val_if_fail (pRenderer != NULL, FALSE);
+	
+	if (pRenderer->pFeed != NULL)
+	{
+		cairo_data_feed_close (pRenderer->pFeed);
+		pRenderer->pFeed = NULL;
+		_remove_feed_icon (pIcon);
+	}
+	if (cFeedName == NULL)
+		return TRUE;
+	
+	pRenderer->pFeed = cairo_data_feed_open (cFeedName, cairo_data_renderer_get_nb_values (pRenderer));
+	if (pRenderer->pFeed == NULL)
+		return FALSE;
+	_add_feed_icon (pIcon);
+	return TRUE;
+}
+
 
 
 void cairo_dock_free_data_renderer (CairoDataRenderer *pRenderer)
@@ -734,9 +913,10 @@ void cairo_dock_free_data_renderer (CairoDataRenderer *pRenderer)
 		pRenderer->interface.unload (pRenderer);
 	
 	g_free (pRenderer->data.pValuesBuffer);
-	g_free (pRenderer->data.pTabValues);
 	g_free (pRenderer->data.pMinMaxValues);
 	
+	cairo_data_feed_close (pRenderer->pFeed);
+	
 	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
 	if (pRenderer->pEmblems != NULL)
 	{
@@ -785,6 +965,10 @@ void cairo_dock_remove_data_renderer_on_icon (Icon *pIcon)
 		if (! pRenderer->bCanRenderValueAsText && pRenderer->bWriteValues)
 			gldi_icon_set_quick_info (pIcon, NULL);
 		
+		s_pPendingIcons = g_list_remove (s_pPendingIcons, pIcon);  // even if this renderer has nothing pending, the icon may have been queued by a previous one.
+		if (pRenderer->pFeed != NULL)
+			_remove_feed_icon (pIcon);
+		
 		cairo_dock_free_data_renderer (pRenderer);
 		cairo_dock_set_data_renderer_on_icon (pIcon, NULL);
 	}
@@ -822,31 +1006,89 @@ void cairo_dock_resize_data_renderer_history (Icon *pIcon, int iNewMemorySize)
 	if (pData->iMemorySize == iNewMemorySize)
 		return ;
 	
-	int iOldMemorySize = pData->iMemorySize;
-	pData->iMemorySize = iNewMemorySize;
-	pData->pValuesBuffer = g_realloc (pData->pValuesBuffer, pData->iMemorySize * pData->iNbValues * sizeof (gdouble));
-	if (iNewMemorySize > iOldMemorySize)
+	_resize_values_buffer (pData, iNewMemorySize);
+}
+
+void cairo_dock_refresh_data_renderer (Icon *pIcon, GldiContainer *pContainer)
+{
+	CairoDataRenderer *pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
+	g_return_if_fail (pRenderer != NULL);
+	
+	_refresh (pRenderer, pIcon, pContainer);
+}
+
+
+static void _normalize_values (const gfloat *pValues, int n, gfloat fMin, gfloat fScale, gfloat *pBuffer)
+{
+	// no branch and only floats, so that the compiler can process several values at once (SIMD).
+	const gfloat fUndef = CAIRO_DATA_RENDERER_UNDEF_VALUE;
+	gfloat x, y;
+	int k;
+	for (k = 0; k < n; k ++)
 	{
-		memset (&pData->pValuesBuffer[iOldMemorySize * pData->iNbValues], 0, (iNewMemorySize - iOldMemorySize) * pData->iNbValues * sizeof (gdouble));
+		x = pValues[k];
+		y = (x - fMin) * fScale;
+		y = (y < 0.f ? 0.f : y);
+		y = (y > 1.f ? 1.f : y);
+		pBuffer[k] = (x > fUndef + 1.f ? y : fUndef);
 	}
+}
+
+void cairo_data_renderer_get_normalized_history (CairoDataRenderer *pRenderer, int i, int n, gfloat *pBuffer)
+{
+	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
+	int iMemorySize = pData->iMemorySize;
+	n = MIN (n, iMemorySize);
+	if (n < 1)
+		return;
+	double fMin = cairo_data_renderer_get_min_value (pRenderer, i);
+	double fMax = cairo_data_renderer_get_max_value (pRenderer, i);
+	gfloat fScale = (fMax > fMin ? 1. / (fMax - fMin) : 0.);
+	const gfloat *pValues = &pData->pValuesBuffer[i * iMemorySize];
 	
-	g_free (pData->pTabValues);
-	pData->pTabValues = g_new (gdouble *, pData->iMemorySize);
-	int i;
-	for (i = 0; i < pData->iMemorySize; i ++)
+	// the n last values are the n values up to the current index in the ring, so they are in 1 or 2 contiguous blocks.
+	int iCurrentIndex = MAX (0, pData->iCurrentIndex);
+	int iFirstIndex = iCurrentIndex - n + 1;
+	if (iFirstIndex < 0)  // the history wraps around the end of the ring.
 	{
-		pData->pTabValues[i] = &pData->pValuesBuffer[i*pData->iNbValues];
+		_normalize_values (&pValues[iMemorySize + iFirstIndex], - iFirstIndex, fMin, fScale, pBuffer);
+		_normalize_values (pValues, iCurrentIndex + 1, fMin, fScale, &pBuffer[- iFirstIndex]);
+	}
+	else
+	{
+		_normalize_values (&pValues[iFirstIndex], n, fMin, fScale, pBuffer);
 	}
-	if (pData->iCurrentIndex >= pData->iMemorySize)
-		pData->iCurrentIndex = pData->iMemorySize - 1;
 }
 
-void cairo_dock_refresh_data_renderer (Icon *pIcon, GldiContainer *pContainer)
+
+void cairo_data_renderer_compute_angle_table (CairoDataRendererAngleTable *pTable, int iNbAngles, double fAngleStart, double fAngleStop)
 {
-	CairoDataRenderer *pRenderer = cairo_dock_get_icon_data_renderer (pIcon);
-	g_return_if_fail (pRenderer != NULL);
+	iNbAngles = MAX (2, iNbAngles);
+	if (pTable->iNbAngles == iNbAngles && pTable->fAngleStart == fAngleStart && pTable->fAngleStop == fAngleStop)  // already up-to-date
+		return;
 	
-	_refresh (pRenderer, pIcon, pContainer);
+	pTable->pCos = g_realloc (pTable->pCos, iNbAngles * sizeof (gdouble));
+	pTable->pSin = g_realloc (pTable->pSin, iNbAngles * sizeof (gdouble));
+	pTable->iNbAngles = iNbAngles;
+	pTable->fAngleStart = fAngleStart;
+	pTable->fAngleStop = fAngleStop;
+	
+	double fStep = (fAngleStop - fAngleStart) / (iNbAngles - 1);
+	double a;
+	int k;
+	for (k = 0; k < iNbAngles; k ++)
+	{
+		a = fAngleStart + k * fStep;
+		pTable->pCos[k] = cos (a);
+		pTable->pSin[k] = sin (a);
+	}
+}
+
+void cairo_data_renderer_reset_angle_table (CairoDataRendererAngleTable *pTable)
+{
+	g_free (pTable->pCos);
+	g_free (pTable->pSin);
+	memset (pTable, 0, sizeof (CairoDataRendererAngleTable));
 }
 
 
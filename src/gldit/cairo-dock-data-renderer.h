@@ -26,6 +26,7 @@
 #include "cairo-dock-struct.h"
 #include "cairo-dock-packages.h"
 #include "cairo-dock-overlay.h"
+#include "cairo-dock-data-feed.h"
 G_BEGIN_DECLS
 
 /**
@@ -54,14 +55,15 @@ typedef enum _RendererRotateTheme {
 // Structures
 //
 
+// Since 3.5, the values are stored as floats, per series (they used to be doubles, per time, with pTabValues pointing on each time); code reading the buffer directly must be rebuilt and adapted. The cairo_data_renderer_get_value* macros work the same as before.
 struct _CairoDataToRenderer {
 	gint iNbValues;
 	gint iMemorySize;
-	gdouble *pValuesBuffer;
-	gdouble **pTabValues;
+	gfloat *pValuesBuffer;  // the history of each value, one after the other: the i-th value at the index t of the ring is at i*iMemorySize+t.
 	gdouble *pMinMaxValues;
 	gint iCurrentIndex;
 	gboolean bHasValue;  // TRUE as soon as a value has been set in the history
+	guint iNbPushedValues;  // number of values pushed so far; unlike iCurrentIndex it never wraps, so it tells how many values are new since a given time.
 };
 
 #define CAIRO_DOCK_DATA_FORMAT_MAX_LEN 20
@@ -143,6 +145,14 @@ struct _CairoDataRendererText {
 	GLuint iTexture;
 };
 
+/// Cos and sin of a set of angles regularly spread over a range, computed once when a renderer is (re)loaded, instead of at each frame.
+struct _CairoDataRendererAngleTable {
+	gint iNbAngles;
+	gdouble fAngleStart, fAngleStop;  // in radians, both included.
+	gdouble *pCos;
+	gdouble *pSin;
+};
+
 
 /// Generic DataRenderer. Any implementation of a DataRenderer will derive from this class.
 struct _CairoDataRenderer {
@@ -193,7 +203,9 @@ struct _CairoDataRenderer {
 	/// latency due to the smooth movement (0 means the displayed value is the current one, 1 the previous)
 	gdouble fLatency;
 	guint iSidRenderIdle;  // source ID to delay the rendering in OpenGL until the container is fully resized
+	gboolean bPendingRender;  // TRUE if new values have been recorded but not drawn yet.
 	CairoOverlay *pOverlay;
+	CairoDataFeed *pFeed;  // optional shared-memory ring the values are read from.
 };
 
 
@@ -235,6 +247,12 @@ void cairo_dock_reload_data_renderer_on_icon (Icon *pIcon, GldiContainer *pConta
 *@param iNewMemorySize the new size of history*/
 void cairo_dock_resize_data_renderer_history (Icon *pIcon, int iNewMemorySize);
 
+/** Feed the DataRenderer of an icon from a Data Feed, that is to say a ring of samples in shared memory written by an external program (see cairo-dock-data-feed.h). The new samples are read and drawn at the rate of the animations, however fast they are written. Values can still be added with cairo_dock_render_new_data_on_icon. The feed is kept if the DataRenderer is replaced with the same number of values.
+*@param pIcon the icon
+*@param cFeedName name of the feed, or NULL to stop reading the current one
+*@return TRUE if the feed could be opened*/
+gboolean cairo_dock_set_data_feed_on_icon (Icon *pIcon, const gchar *cFeedName);
+
 /** Redraw the DataRenderer of an icon, with the current values.
 *@param pIcon the icon
 *@param pContainer the icon's container*/
@@ -247,6 +265,33 @@ void cairo_dock_render_overlays_to_texture (CairoDataRenderer *pRenderer, int iN
 
 void cairo_data_renderer_get_size (CairoDataRenderer *pRenderer, gint *iWidth, gint *iHeight);
 
+/** Get the n last values of the i-th value at once, normalized between 0 and 1. This is much faster than calling cairo_data_renderer_get_normalized_value on each of them, and should be used to draw a history.
+*@param pRenderer a data renderer
+*@param i the number of the value
+*@param n number of values to get, at most the size of the history
+*@param pBuffer a buffer of at least n floats, filled with the oldest value first and the current one last; undefined values are left to CAIRO_DATA_RENDERER_UNDEF_VALUE.
+*/
+void cairo_data_renderer_get_normalized_history (CairoDataRenderer *pRenderer, int i, int n, gfloat *pBuffer);
+
+/** Fill a table with the cos and sin of iNbAngles angles regularly spread from fAngleStart to fAngleStop. Nothing is done if the table already holds these angles, so it can be called each time the renderer is reloaded.
+*@param pTable the table (initially zeroed)
+*@param iNbAngles number of angles, at least 2
+*@param fAngleStart first angle, in radians
+*@param fAngleStop last angle, in radians
+*/
+void cairo_data_renderer_compute_angle_table (CairoDataRendererAngleTable *pTable, int iNbAngles, double fAngleStart, double fAngleStop);
+
+/** Free the content of a table of angles. It can be filled again afterwards.
+*@param pTable the table
+*/
+void cairo_data_renderer_reset_angle_table (CairoDataRendererAngleTable *pTable);
+
+/** Get the index of the angle of a table that is the nearest to a value, for a range of values mapped linearly onto the range of the angles.
+*@param pTable the table
+*@param fValue a value in [0,1]
+*@return an index in the table*/
+#define cairo_data_renderer_get_angle_index(pTable, fValue) ((int) (MAX (0., MIN (1., fValue)) * ((pTable)->iNbAngles - 1) + .5))
+
 ///
 /// Structure Access
 ///
@@ -298,12 +343,12 @@ void cairo_data_renderer_get_size (CairoDataRenderer *pRenderer, gint *iWidth, g
 *@param i the number of the value
 *@param t the time (in number of steps)
 *@return a double*/
-#define cairo_data_renderer_get_value(pRenderer, i, t) pRenderer->data.pTabValues[pRenderer->data.iCurrentIndex+t > pRenderer->data.iMemorySize ? pRenderer->data.iCurrentIndex+t-pRenderer->data.iMemorySize : pRenderer->data.iCurrentIndex+t < 0 ? pRenderer->data.iCurrentIndex+t+pRenderer->data.iMemorySize : pRenderer->data.iCurrentIndex+t][i]
+#define cairo_data_renderer_get_value(pRenderer, i, t) pRenderer->data.pValuesBuffer[(i) * pRenderer->data.iMemorySize + (pRenderer->data.iCurrentIndex+t >= pRenderer->data.iMemorySize ? pRenderer->data.iCurrentIndex+t-pRenderer->data.iMemorySize : pRenderer->data.iCurrentIndex+t < 0 ? pRenderer->data.iCurrentIndex+t+pRenderer->data.iMemorySize : pRenderer->data.iCurrentIndex+t)]
 /**Get the current i-th value.
 *@param pRenderer a data renderer
 *@param i the number of the value
 *@return a double*/
-#define cairo_data_renderer_get_current_value(pRenderer, i) pRenderer->data.pTabValues[pRenderer->data.iCurrentIndex][i]
+#define cairo_data_renderer_get_current_value(pRenderer, i) pRenderer->data.pValuesBuffer[(i) * pRenderer->data.iMemorySize + pRenderer->data.iCurrentIndex]
 /**Get the previous i-th value.
 *@param pRenderer a data renderer
 *@param i the number of the value
@@ -507,7 +507,10 @@ gboolean cairo_dock_render_icon_notification (G_GNUC_UNUSED gpointer pUserData,
 	{
 		if (icon->image.pSurface != NULL)
 		{
-			cairo_dock_draw_icon_cairo (icon, pDock, pCairoContext);
+			if (cairo_dock_draw_icon_and_overlays_cairo (icon, CAIRO_CONTAINER (pDock), pCairoContext))  // at rest, the icon and its overlays are drawn at once.
+				cairo_dock_draw_icon_reflect_cairo (icon, CAIRO_CONTAINER (pDock), pCairoContext);
+			else
+				cairo_dock_draw_icon_cairo (icon, pDock, pCairoContext);
 		}
 	}
 	else
@@ -17,12 +17,19 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#define _GNU_SOURCE  // copy_file_range, symlink
 #include <stdlib.h>      // atoi
 #include <string.h>      // memset
 #include <sys/stat.h>    // stat
 #include <fcntl.h>  // open
 #include <sys/sendfile.h>  // sendfile
 #include <errno.h>  // errno
+#include <unistd.h>  // read, write, symlink, copy_file_range
+#ifdef __linux__
+#include <sys/ioctl.h>  // ioctl
+#include <linux/fs.h>  // FICLONE
+#endif
+#include <glib/gstdio.h>  // g_lstat, g_remove, g_rmdir
 
 #include "gldi-config.h"
 #include "cairo-dock-dock-factory.h"
@@ -486,12 +493,60 @@ int cairo_dock_get_file_size (const gchar *cFilePath)
 		return 0;
 }
 
+static gboolean _copy_file_data (int src_fd, int dest_fd, off_t iSize)
+{
+	off_t iCopied = 0;
+	ssize_t n = 0;
+	#ifdef FICLONE
+	if (ioctl (dest_fd, FICLONE, src_fd) == 0)  // share the data on a copy-on-write filesystem (btrfs, xfs), nothing is copied at all.
+		return TRUE;
+	#endif
+	#ifdef HAVE_COPY_FILE_RANGE
+	while (iCopied < iSize && (n = copy_file_range (src_fd, NULL, dest_fd, NULL, iSize - iCopied, 0)) > 0)  // in-kernel copy, that can be done by the filesystem itself.
+		iCopied += n;
+	#endif
+	#ifndef __FreeBSD__  // on BSD, sendfile only sends to a socket.
+	while (iCopied < iSize && (n = sendfile (dest_fd, src_fd, NULL, iSize - iCopied)) > 0)  // in-kernel transfer (zero copy to user space); Linux >= 2.6.33 for a regular file as the output.
+		iCopied += n;
+	#endif
+	if (iCopied >= iSize)
+		return TRUE;
+	
+	// error (or not supported), fallback to a read-write method; the offsets of both files have followed what was copied so far.
+	char buf[64*1024];
+	while ((n = read (src_fd, buf, sizeof (buf))) > 0)
+	{
+		char *ptr = buf;
+		ssize_t w;
+		while (n > 0)
+		{
+			w = write (dest_fd, ptr, n);
+			if (w < 0)
+				return FALSE;
+			ptr += w;
+			n -= w;
+		}
+	}
+	return (n == 0);
+}
+
 gboolean cairo_dock_copy_file (const gchar *cFilePath, const gchar *cDestPath)
 {
 	gboolean ret = TRUE;
 	// open both files
 	int src_fd = open (cFilePath, O_RDONLY);
-	int dest_fd = open (cDestPath, O_CREAT | O_WRONLY, S_IRUSR|S_IWUSR | S_IRGRP | S_IROTH);  // mode=644
+	if (src_fd < 0)
+	{
+		cd_warning ("couldn't open file '%s' (%s)", cFilePath, strerror(errno));
+		return FALSE;
+	}
+	int dest_fd = open (cDestPath, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR|S_IWUSR | S_IRGRP | S_IROTH);  // mode=644; replace the content of an existing file.
+	if (dest_fd < 0)
+	{
+		cd_warning ("couldn't open file '%s' (%s)", cDestPath, strerror(errno));
+		close (src_fd);
+		return FALSE;
+	}
 	struct stat stat;
 	// get data size to be copied
 	if (fstat (src_fd, &stat) < 0)
@@ -499,42 +554,98 @@ gboolean cairo_dock_copy_file (const gchar *cFilePath, const gchar *cDestPath)
 		cd_warning ("couldn't get info of file '%s' (%s)", cFilePath, strerror(errno));
 		ret = FALSE;
 	}
-	else
+	else if (! _copy_file_data (src_fd, dest_fd, stat.st_size))
 	{
-		// perform in-kernel transfer (zero copy to user space)
-		int size;
-		#ifdef __FreeBSD__
-		size = sendfile (src_fd, dest_fd, 0, stat.st_size, NULL, NULL, 0);
-		#else  // Linux >= 2.6.33 for being able to have a regular file as the output socket
-		size = sendfile (dest_fd, src_fd, NULL, stat.st_size);  // note the inversion between both calls ^_^;
-		#endif
-		if (size < 0)  // error, fallback to a read-write method
+		cd_warning ("couldn't copy file '%s' to '%s' (%s)", cFilePath, cDestPath, strerror(errno));
+		ret = FALSE;
+	}
+	close (dest_fd);
+	close (src_fd);
+	return ret;
+}
+
+gboolean cairo_dock_copy_file_into_directory (const gchar *cFilePath, const gchar *cDirPath)
+{
+	gchar *cFileName = g_path_get_basename (cFilePath);
+	gchar *cDestFilePath = g_strdup_printf ("%s/%s", cDirPath, cFileName);
+	gboolean ret = cairo_dock_copy_file (cFilePath, cDestFilePath);
+	g_free (cDestFilePath);
+	g_free (cFileName);
+	return ret;
+}
+
+gboolean cairo_dock_copy_directory (const gchar *cDirPath, const gchar *cDestDirPath)
+{
+	if (g_mkdir_with_parents (cDestDirPath, 7*8*8+7*8+5) != 0)
+	{
+		cd_warning ("couldn't create directory %s", cDestDirPath);
+		return FALSE;
+	}
+	GDir *dir = g_dir_open (cDirPath, 0, NULL);
+	if (dir == NULL)
+		return FALSE;
+	
+	gboolean ret = TRUE;
+	const gchar *cFileName;
+	gchar *cFilePath, *cDestFilePath;
+	GStatBuf st;
+	while ((cFileName = g_dir_read_name (dir)) != NULL)  // like 'cp -r', hidden files are copied too, and links are copied as links.
+	{
+		cFilePath = g_strdup_printf ("%s/%s", cDirPath, cFileName);
+		cDestFilePath = g_strdup_printf ("%s/%s", cDestDirPath, cFileName);
+		if (g_lstat (cFilePath, &st) != 0)
+			ret = FALSE;
+		else if (S_ISDIR (st.st_mode))
+			ret &= cairo_dock_copy_directory (cFilePath, cDestFilePath);
+		else if (S_ISLNK (st.st_mode))
 		{
-			cd_debug ("couldn't fast-copy file '%s' to '%s' (%s)", cFilePath, cDestPath, strerror(errno));
-			// read data
-			char *buf = g_new (char, stat.st_size);
-			size = read (src_fd, buf, stat.st_size);
-			if (size < 0)
-			{
-				cd_warning ("couldn't read file '%s' (%s)", cFilePath, strerror(errno));
+			gchar *cTarget = g_file_read_link (cFilePath, NULL);
+			g_remove (cDestFilePath);
+			if (cTarget == NULL || symlink (cTarget, cDestFilePath) != 0)
 				ret = FALSE;
-			}
-			else
+			g_free (cTarget);
+		}
+		else
+			ret &= cairo_dock_copy_file (cFilePath, cDestFilePath);
+		g_free (cDestFilePath);
+		g_free (cFilePath);
+	}
+	g_dir_close (dir);
+	return ret;
+}
+
+gboolean cairo_dock_remove_directory (const gchar *cPath)
+{
+	GStatBuf st;
+	if (g_lstat (cPath, &st) != 0)  // nothing to remove.
+		return (errno == ENOENT);
+	if (S_ISDIR (st.st_mode))
+	{
+		GDir *dir = g_dir_open (cPath, 0, NULL);
+		if (dir != NULL)
+		{
+			const gchar *cFileName;
+			gchar *cFilePath;
+			while ((cFileName = g_dir_read_name (dir)) != NULL)
 			{
-				// copy data
-				size = write (dest_fd, buf, stat.st_size);
-				if (size < 0)
-				{
-					cd_warning ("couldn't write to file '%s' (%s)", cDestPath, strerror(errno));
-					ret = FALSE;
-				}
+				cFilePath = g_strdup_printf ("%s/%s", cPath, cFileName);
+				cairo_dock_remove_directory (cFilePath);
+				g_free (cFilePath);
 			}
-			g_free (buf);
+			g_dir_close (dir);
+		}
+		if (g_rmdir (cPath) != 0)
+		{
+			cd_warning ("couldn't remove directory '%s' (%s)", cPath, strerror(errno));
+			return FALSE;
 		}
 	}
-	close (dest_fd);
-	close (src_fd);
-	return ret;
+	else if (g_remove (cPath) != 0)  // a file or a link (its target is left untouched).
+	{
+		cd_warning ("couldn't remove file '%s' (%s)", cPath, strerror(errno));
+		return FALSE;
+	}
+	return TRUE;
 }
 
 
@@ -255,8 +255,33 @@ gboolean cairo_dock_fm_move_into_directory (const gchar *cURI, Icon *icon, GldiC
 */
 int cairo_dock_get_file_size (const gchar *cFilePath);
 
+/** Copy a file. The destination is replaced if it exists. The data are shared or copied by the kernel when possible.
+*@param cFilePath path of the file to copy.
+*@param cDestPath path of the new file.
+*@return TRUE if the file has been copied.
+*/
 gboolean cairo_dock_copy_file (const gchar *cFilePath, const gchar *cDestPath);
 
+/** Copy a file into a folder, under the same name, the same way as 'cp <file> <folder>'.
+*@param cFilePath path of the file to copy.
+*@param cDirPath path of the folder.
+*@return TRUE if the file has been copied.
+*/
+gboolean cairo_dock_copy_file_into_directory (const gchar *cFilePath, const gchar *cDirPath);
+
+/** Copy a folder and all its content, the same way as 'cp -r' into a folder that may already exist: existing files are replaced, other files are left untouched.
+*@param cDirPath path of the folder to copy.
+*@param cDestDirPath path of the new folder; it is created if needed.
+*@return TRUE if everything has been copied.
+*/
+gboolean cairo_dock_copy_directory (const gchar *cDirPath, const gchar *cDestDirPath);
+
+/** Remove a file or a folder and all its content, the same way as 'rm -rf'.
+*@param cPath path of the file or folder.
+*@return TRUE if it doesn't exist any more.
+*/
+gboolean cairo_dock_remove_directory (const gchar *cPath);
+
 
 /** Get process ID given its name
  * @param cProcessName name of the process
@@ -21,6 +21,7 @@
 #include <unistd.h>
 #define __USE_XOPEN_EXTENDED
 #include <stdlib.h>
+#include <time.h>  // time
 #include <glib/gstdio.h>
 #include <glib/gi18n.h>
 
@@ -316,7 +317,131 @@ static gboolean on_delete_async_widget (GtkWidget *pWidget, G_GNUC_UNUSED GdkEve
 	return FALSE;  // propagate event
 }
 
-static inline void _set_preview_image (const gchar *cPreviewFilePath, GtkImage *pPreviewImage, GtkWidget *pPreviewImageFrame)
+// Previews are scaled down once and cached as PNG files, like the thumbnails of the file managers, so that big previews are not decoded (or downloaded) again each time they're selected.
+#define CAIRO_DOCK_PREVIEW_CACHE_MAX_AGE (24 * 3600)  // remote previews are downloaded again after 1 day.
+#define CAIRO_DOCK_PREVIEW_CACHE_PRUNE_AGE (30 * 24 * 3600)  // thumbnails not refreshed for 1 month are removed.
+#define CAIRO_DOCK_PREVIEW_CACHE_MAX_SIZE (20 * 1024 * 1024)  // beyond this size, the oldest thumbnails are removed.
+typedef struct {
+	gchar *cPath;
+	time_t iMTime;
+	goffset iSize;
+	} CairoDockThumbnail;
+static gboolean s_bPreviewCachePruned = FALSE;
+
+static gchar *_get_preview_cache_path (const gchar *cSource)
+{
+	gchar *cHash = g_compute_checksum_for_string (G_CHECKSUM_MD5, cSource, -1);
+	gchar *cCachePath = g_strdup_printf ("%s/cairo-dock/thumbnails/%s-%dx%d.png", g_get_user_cache_dir (), cHash, CAIRO_DOCK_PREVIEW_WIDTH, CAIRO_DOCK_PREVIEW_HEIGHT);  // the size the previews are scaled down to is part of the key.
+	g_free (cHash);
+	return cCachePath;
+}
+
+static gint _compare_thumbnails_age (const CairoDockThumbnail *a, const CairoDockThumbnail *b)
+{
+	return (a->iMTime < b->iMTime ? -1 : a->iMTime > b->iMTime ? 1 : 0);
+}
+
+// done once per session, when the first preview is cached.
+static void _prune_preview_cache (const gchar *cCacheDir)
+{
+	if (s_bPreviewCachePruned)
+		return;
+	s_bPreviewCachePruned = TRUE;
+	GDir *dir = g_dir_open (cCacheDir, 0, NULL);
+	if (dir == NULL)
+		return;
+	
+	//\_______________ remove the old thumbnails, and list the others.
+	GList *pThumbnails = NULL;
+	CairoDockThumbnail *pThumbnail;
+	goffset iTotalSize = 0;
+	time_t iNow = time (NULL);
+	const gchar *cFileName;
+	gchar *cPath;
+	GStatBuf st;
+	while ((cFileName = g_dir_read_name (dir)) != NULL)
+	{
+		cPath = g_strdup_printf ("%s/%s", cCacheDir, cFileName);
+		if (g_stat (cPath, &st) != 0 || ! S_ISREG (st.st_mode))
+		{
+			g_free (cPath);
+		}
+		else if (iNow - st.st_mtime > CAIRO_DOCK_PREVIEW_CACHE_PRUNE_AGE)
+		{
+			g_remove (cPath);
+			g_free (cPath);
+		}
+		else
+		{
+			pThumbnail = g_new (CairoDockThumbnail, 1);
+			pThumbnail->cPath = cPath;
+			pThumbnail->iMTime = st.st_mtime;
+			pThumbnail->iSize = st.st_size;
+			pThumbnails = g_list_prepend (pThumbnails, pThumbnail);
+			iTotalSize += st.st_size;
+		}
+	}
+	g_dir_close (dir);
+	
+	//\_______________ if they still take too much space, remove the oldest ones.
+	pThumbnails = g_list_sort (pThumbnails, (GCompareFunc) _compare_thumbnails_age);
+	GList *t;
+	for (t = pThumbnails; t != NULL; t = t->next)
+	{
+		pThumbnail = t->data;
+		if (iTotalSize > CAIRO_DOCK_PREVIEW_CACHE_MAX_SIZE)
+		{
+			g_remove (pThumbnail->cPath);
+			iTotalSize -= pThumbnail->iSize;
+		}
+		g_free (pThumbnail->cPath);
+		g_free (pThumbnail);
+	}
+	g_list_free (pThumbnails);
+}
+
+static GdkPixbuf *_get_cached_preview (const gchar *cSource, gint64 iMTime)  // iMTime is 0 for a remote preview.
+{
+	GdkPixbuf *pixbuf = NULL;
+	gchar *cCachePath = _get_preview_cache_path (cSource);
+	GStatBuf st;
+	if (g_stat (cCachePath, &st) == 0
+	&& (iMTime != 0 || time (NULL) - st.st_mtime < CAIRO_DOCK_PREVIEW_CACHE_MAX_AGE))
+	{
+		pixbuf = gdk_pixbuf_new_from_file (cCachePath, NULL);
+		const gchar *cMTime = (pixbuf != NULL ? gdk_pixbuf_get_option (pixbuf, "tEXt::Thumb::MTime") : NULL);
+		if (pixbuf != NULL && (cMTime == NULL || g_ascii_strtoll (cMTime, NULL, 10) != iMTime))  // the preview has changed since.
+		{
+			g_object_unref (pixbuf);
+			pixbuf = NULL;
+		}
+	}
+	g_free (cCachePath);
+	return pixbuf;
+}
+
+static void _cache_preview (GdkPixbuf *pixbuf, const gchar *cSource, gint64 iMTime)
+{
+	gchar *cCachePath = _get_preview_cache_path (cSource);
+	gchar *cCacheDir = g_path_get_dirname (cCachePath);
+	if (g_mkdir_with_parents (cCacheDir, 7*8*8+7*8+5) == 0)
+	{
+		_prune_preview_cache (cCacheDir);
+		
+		gchar *cMTime = g_strdup_printf ("%"G_GINT64_FORMAT, iMTime);
+		gchar *cTmpPath = g_strconcat (cCachePath, ".tmp", NULL);  // so that a half-written thumbnail is never loaded.
+		if (gdk_pixbuf_save (pixbuf, cTmpPath, "png", NULL, "tEXt::Thumb::MTime", cMTime, NULL))
+			g_rename (cTmpPath, cCachePath);
+		else
+			g_remove (cTmpPath);
+		g_free (cTmpPath);
+		g_free (cMTime);
+	}
+	g_free (cCacheDir);
+	g_free (cCachePath);
+}
+
+static GdkPixbuf *_load_preview (const gchar *cPreviewFilePath, GtkImage *pPreviewImage)
 {
 	int iPreviewWidth, iPreviewHeight;
 	GtkRequisition requisition;
@@ -336,6 +461,11 @@ static inline void _set_preview_image (const gchar *cPreviewFilePath, GtkImage *
 		cd_debug ("preview : %dx%d => %dx%d", requisition.width, requisition.height, iPreviewWidth, iPreviewHeight);
 		pPreviewPixbuf = gdk_pixbuf_new_from_file_at_size (cPreviewFilePath, iPreviewWidth, iPreviewHeight, NULL);
 	}
+	return pPreviewPixbuf;
+}
+
+static void _show_preview (GdkPixbuf *pPreviewPixbuf, GtkImage *pPreviewImage, GtkWidget *pPreviewImageFrame)
+{
 	if (pPreviewPixbuf == NULL)
 	{
 		pPreviewPixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB,
@@ -348,7 +478,24 @@ static inline void _set_preview_image (const gchar *cPreviewFilePath, GtkImage *
 		gtk_frame_set_shadow_type (GTK_FRAME (pPreviewImageFrame), GTK_SHADOW_ETCHED_IN);
 
 	gtk_image_set_from_pixbuf (pPreviewImage, pPreviewPixbuf);
-	g_object_unref (pPreviewPixbuf);
+	g_object_unref (pPreviewPixbuf);  // takes the reference.
+}
+
+static inline void _set_preview_image (const gchar *cPreviewFilePath, GtkImage *pPreviewImage, GtkWidget *pPreviewImageFrame)
+{
+	GdkPixbuf *pPreviewPixbuf = NULL;
+	GStatBuf st;
+	if (g_stat (cPreviewFilePath, &st) == 0)
+	{
+		pPreviewPixbuf = _get_cached_preview (cPreviewFilePath, st.st_mtime);
+		if (pPreviewPixbuf == NULL)
+		{
+			pPreviewPixbuf = _load_preview (cPreviewFilePath, pPreviewImage);
+			if (pPreviewPixbuf != NULL)
+				_cache_preview (pPreviewPixbuf, cPreviewFilePath, st.st_mtime);
+		}
+	}
+	_show_preview (pPreviewPixbuf, pPreviewImage, pPreviewImageFrame);
 }
 
 static void _on_got_readme (const gchar *cDescription, GtkWidget *pDescriptionLabel)
@@ -374,7 +521,11 @@ static void _on_got_preview_file (const gchar *cPreviewFilePath, gpointer *data)
 	
 	if (cPreviewFilePath != NULL)
 	{
-		_set_preview_image (cPreviewFilePath, GTK_IMAGE (pPreviewImage), pImageFrame);
+		GdkPixbuf *pPreviewPixbuf = _load_preview (cPreviewFilePath, GTK_IMAGE (pPreviewImage));
+		const gchar *cPreviewURL = g_object_get_data (G_OBJECT (pPreviewImage), "cd-preview-url");
+		if (pPreviewPixbuf != NULL && cPreviewURL != NULL)
+			_cache_preview (pPreviewPixbuf, cPreviewURL, 0);
+		_show_preview (pPreviewPixbuf, GTK_IMAGE (pPreviewImage), pImageFrame);
 		g_remove (cPreviewFilePath);
 	}
 	GldiTask *pTask = g_object_get_data (G_OBJECT (pPreviewImage), "cd-task");
@@ -527,10 +678,19 @@ static void _cairo_dock_selection_changed (GtkTreeModel *model, GtkTreeIter iter
 		if (strncmp (cPreviewFilePath, "http://", 7) == 0)  // fichier distant.
 		{
 			cd_debug ("fichier preview distant (%s)", cPreviewFilePath);
-			gtk_image_set_from_pixbuf (pPreviewImage, NULL);  // set blank image while downloading.
-			
-			pTask = cairo_dock_download_file_async (cPreviewFilePath, NULL, (GFunc) _on_got_preview_file, data);  // NULL <=> as a temporary file
-			g_object_set_data (G_OBJECT (pPreviewImage), "cd-task", pTask);
+			GdkPixbuf *pPreviewPixbuf = _get_cached_preview (cPreviewFilePath, 0);
+			if (pPreviewPixbuf != NULL)  // downloaded recently, no need to do it again.
+			{
+				_show_preview (pPreviewPixbuf, pPreviewImage, pImageFrame);
+			}
+			else
+			{
+				gtk_image_set_from_pixbuf (pPreviewImage, NULL);  // set blank image while downloading.
+				
+				g_object_set_data_full (G_OBJECT (pPreviewImage), "cd-preview-url", g_strdup (cPreviewFilePath), g_free);  // to cache the preview once downloaded.
+				pTask = cairo_dock_download_file_async (cPreviewFilePath, NULL, (GFunc) _on_got_preview_file, data);  // NULL <=> as a temporary file
+				g_object_set_data (G_OBJECT (pPreviewImage), "cd-task", pTask);
+			}
 		}
 		else  // fichier local ou rien.
 			_set_preview_image (cPreviewFilePath, pPreviewImage, pImageFrame);
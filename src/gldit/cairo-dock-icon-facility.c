@@ -45,6 +45,7 @@
 #include "cairo-dock-draw-opengl.h"
 #include "cairo-dock-draw.h"
 #include "cairo-dock-animations.h"  // CairoDockHidingEffect
+#include "cairo-dock-overlay.h"  // cairo_dock_icon_image_changed
 #include "cairo-dock-icon-facility.h"
 
 extern gchar *g_cCurrentLaunchersPath;
@@ -650,6 +651,7 @@ cairo_t *cairo_dock_begin_draw_icon_cairo (Icon *pIcon, gint iRenderingMode, cai
 void cairo_dock_end_draw_icon_cairo (Icon *pIcon)
 {
 	cairo_dock_end_draw_image_buffer_cairo (&pIcon->image);
+	cairo_dock_icon_image_changed (pIcon);
 }
 
 gboolean cairo_dock_begin_draw_icon (Icon *pIcon, gint iRenderingMode)
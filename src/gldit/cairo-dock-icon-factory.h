@@ -175,7 +175,8 @@ struct _Icon {
 	gint iThumbnailWidth, iThumbnailHeight;
 	
 	gboolean bIsLaunching;  // a mere recopy of gldi_class_is_starting()
-	gpointer reserved[4];
+	struct _CairoIconOverlaysCache *pOverlaysCache;  // the image and the overlays drawn together at rest, in cairo (see cairo-dock-overlay.c).
+	gpointer reserved[3];
 };
 
 typedef void (*CairoIconContainerLoadFunc) (void);
@@ -42,6 +42,7 @@
 #include "cairo-dock-style-manager.h"
 #include "cairo-dock-applications-manager.h"  // myTaskbarParam.bShowAppli
 #include "cairo-dock-windows-manager.h"
+#include "cairo-dock-separator-manager.h"  // GLDI_OBJECT_IS_SEPARATOR_ICON
 #define _MANAGER_DEF_
 #include "cairo-dock-indicator-manager.h"
 
@@ -56,6 +57,23 @@ extern CairoDock *g_pMainDock;
 static CairoDockImageBuffer s_indicatorBuffer;
 static CairoDockImageBuffer s_activeIndicatorBuffer;
 static CairoDockImageBuffer s_classIndicatorBuffer;
+static GList *s_pActiveSubDocks = NULL;  // sub-docks containing the active window
+static GldiWindowActor *s_pActiveSubDocksAppli = NULL;  // window for which they were listed
+static gboolean s_bActiveSubDocksValid = FALSE;
+
+// The indicators are drawn in batches, with one draw per kind of indicator rather than one per icon: one array of quads on a single texture with OpenGL, one source pattern painted at each place with cairo.
+typedef struct {
+	GArray *pVertices;  // opengl: 4 corners (x,y,z) per indicator
+	GArray *pCoords;  // opengl: texture coordinates of these corners
+	GArray *pMatrices;  // cairo: transformation from the surface of the indicator to the device, per indicator
+	} CairoIndicatorBatch;
+static CairoIndicatorBatch s_appliBatch;
+static CairoIndicatorBatch s_activeBatch;
+static CairoIndicatorBatch s_classBatch;
+static CairoDock *s_pRenderedDock = NULL;  // dock being drawn by its view, NULL outside of it
+static gboolean s_bFirstIconDrawn = FALSE;  // whether the view has drawn an icon of this dock yet
+static gboolean s_bBelowBatched = FALSE;  // whether the indicators below the icons have been drawn all at once
+static gint s_iNbAboveLeft = 0;  // number of icons with an indicator above them that haven't been drawn yet
 
 static gboolean cairo_dock_pre_render_indicator_notification (gpointer pUserData, Icon *icon, CairoDock *pDock, cairo_t *pCairoContext);
 static gboolean cairo_dock_render_indicator_notification (gpointer pUserData, Icon *icon, CairoDock *pDock, gboolean *bHasBeenRendered, cairo_t *pCairoContext);
@@ -75,7 +93,8 @@ static inline double _compute_delta_y (Icon *icon, double py, gboolean bOnIcon,
 	return dy;
 }
 
-static void _cairo_dock_draw_appli_indicator_opengl (Icon *icon, CairoDock *pDock)
+// The following functions place an indicator on its icon. They apply on a matrix the transformations that were applied on the context; with OpenGL, the indicator is then a quad of size 1 centered on the origin, and with cairo, its surface is drawn at the origin.
+static void _set_appli_indicator_matrix_opengl (Icon *icon, CairoDock *pDock, cairo_matrix_t *m)
 {
 	gboolean bIsHorizontal = pDock->container.bIsHorizontal;
 	gboolean bDirectionUp = pDock->container.bDirectionUp;
@@ -92,67 +111,69 @@ static void _cairo_dock_draw_appli_indicator_opengl (Icon *icon, CairoDock *pDoc
 	fY += - icon->fHeight * icon->fScale/2 + h*z/2;  // a 0, le bas de l'indicateur correspond au bas de l'icone.
 	
 	//\__________________ On place l'indicateur.
-	glPushMatrix ();
 	if (bIsHorizontal)
 	{
 		if (! bDirectionUp)
 			fY = - fY;
-		glTranslatef (0., fY, 0.);
+		cairo_matrix_translate (m, 0., fY);
 	}
 	else
 	{
 		if (bDirectionUp)
 			fY = - fY;
-		glTranslatef (fY, 0., 0.);
-		glRotatef (90, 0., 0., 1.);
+		cairo_matrix_translate (m, fY, 0.);
+		cairo_matrix_rotate (m, G_PI/2);
 	}
-	glScalef (w * z, (bDirectionUp ? 1:-1) * h * z, 1.);
-	
-	//\__________________ On dessine l'indicateur.
-	cairo_dock_draw_texture_with_alpha (s_indicatorBuffer.iTexture, 1., 1., 1.);
-	glPopMatrix ();
+	cairo_matrix_scale (m, w * z, (bDirectionUp ? 1:-1) * h * z);
 }
-static void _cairo_dock_draw_active_window_indicator_opengl (Icon *icon, CairoDock *pDock, G_GNUC_UNUSED double fRatio)
+static void _set_active_window_indicator_matrix_opengl (Icon *icon, CairoDock *pDock, cairo_matrix_t *m)
 {
-	if (s_activeIndicatorBuffer.iTexture == 0)
-		return ;
-	glPushMatrix ();
-	cairo_dock_set_icon_scale (icon, CAIRO_CONTAINER (pDock), 1.);
-	
-	_cairo_dock_enable_texture ();
-	
-	_cairo_dock_set_blend_pbuffer ();  // rend mieux que les 2 autres.
-	
-	_cairo_dock_apply_texture_at_size_with_alpha (s_activeIndicatorBuffer.iTexture, 1., 1., 1.);
-	
-	_cairo_dock_disable_texture ();
-	glPopMatrix ();
-	
+	double fSizeX, fSizeY;
+	cairo_dock_get_current_icon_size (icon, CAIRO_CONTAINER (pDock), &fSizeX, &fSizeY);
+	cairo_matrix_scale (m, fSizeX, fSizeY);
 }
-static void _cairo_dock_draw_class_indicator_opengl (Icon *icon, gboolean bIsHorizontal, double fRatio, gboolean bDirectionUp)
+static void _set_class_indicator_matrix_opengl (Icon *icon, CairoDock *pDock, cairo_matrix_t *m)
 {
-	glPushMatrix ();
+	double fRatio = pDock->container.fRatio;
 	if (myIndicatorsParam.bZoomClassIndicator)
 		fRatio *= icon->fScale;
 	double w = icon->fWidth/3 * fRatio;
 	double h = icon->fHeight/3 * fRatio;
 	
-	if (! bIsHorizontal)
-		glRotatef (90., 0., 0., 1.);
-	if (! bDirectionUp)
-		glScalef (1., -1., 1.);
-	glTranslatef (icon->fWidth * icon->fScale/2 - w/2,  // top-right corner, 1/3 of the icon
-		icon->fHeight * icon->fScale/2 - h/2,
-		0.);
-	
-	cairo_dock_draw_texture_with_alpha (s_classIndicatorBuffer.iTexture,
-		w,
-		h,
-		1.);
-	glPopMatrix ();
+	if (! pDock->container.bIsHorizontal)
+		cairo_matrix_rotate (m, G_PI/2);
+	if (! pDock->container.bDirectionUp)
+		cairo_matrix_scale (m, 1., -1.);
+	cairo_matrix_translate (m, icon->fWidth * icon->fScale/2 - w/2,  // top-right corner, 1/3 of the icon
+		icon->fHeight * icon->fScale/2 - h/2);
+	cairo_matrix_scale (m, w, h);
 }
 
-static void _cairo_dock_draw_appli_indicator (Icon *icon, CairoDock *pDock, cairo_t *pCairoContext)
+static void _set_surface_orientation (cairo_matrix_t *m, int iWidth, int iHeight, gboolean bDirectionUp, gboolean bHorizontal)  // same as cairo_dock_draw_surface().
+{
+	if (bDirectionUp)
+	{
+		if (! bHorizontal)
+		{
+			cairo_matrix_rotate (m, - G_PI/2);
+			cairo_matrix_translate (m, - iWidth, 0.);
+		}
+	}
+	else
+	{
+		if (bHorizontal)
+		{
+			cairo_matrix_scale (m, 1., -1.);
+			cairo_matrix_translate (m, 0., - iHeight);
+		}
+		else
+		{
+			cairo_matrix_rotate (m, G_PI/2);
+			cairo_matrix_translate (m, 0., - iHeight);
+		}
+	}
+}
+static void _set_appli_indicator_matrix (Icon *icon, CairoDock *pDock, cairo_matrix_t *m)
 {
 	gboolean bIsHorizontal = pDock->container.bIsHorizontal;
 	gboolean bDirectionUp = pDock->container.bDirectionUp;
@@ -168,46 +189,36 @@ static void _cairo_dock_draw_appli_indicator (Icon *icon, CairoDock *pDock, cair
 	double fY = - _compute_delta_y (icon, myIndicatorsParam.fIndicatorDeltaY, myIndicatorsParam.bIndicatorOnIcon, pDock->container.bUseReflect);  // a 0, le bas de l'indicateur correspond au bas de l'icone.
 	
 	//\__________________ On place l'indicateur.
-	cairo_save (pCairoContext);
 	if (bIsHorizontal)
 	{
-		cairo_translate (pCairoContext,
+		cairo_matrix_translate (m,
 			icon->fWidth * icon->fScale / 2 - w * z/2,
 			(bDirectionUp ?
 				icon->fHeight * icon->fHeightFactor * icon->fScale - h * z + fY :
 				- fY));
-		cairo_scale (pCairoContext,
-			z,
-			z);
 	}
 	else
 	{
-		cairo_translate (pCairoContext,
+		cairo_matrix_translate (m,
 			(bDirectionUp ?
 				icon->fHeight * icon->fHeightFactor * icon->fScale - h * z + fY :
 				- fY),
 			icon->fWidth * icon->fScale / 2 - (w * z/2));
-		cairo_scale (pCairoContext,
-			z,
-			z);
 	}
-	
-	cairo_dock_draw_surface (pCairoContext, s_indicatorBuffer.pSurface, w, h, bDirectionUp, bIsHorizontal, 1.);
-	cairo_restore (pCairoContext);
+	cairo_matrix_scale (m, z, z);
+	_set_surface_orientation (m, w, h, bDirectionUp, bIsHorizontal);
 }
-static void _cairo_dock_draw_active_window_indicator (cairo_t *pCairoContext, Icon *icon)
+static void _set_active_window_indicator_matrix (Icon *icon, G_GNUC_UNUSED CairoDock *pDock, cairo_matrix_t *m)
 {
-	cairo_save (pCairoContext);
-	cairo_scale (pCairoContext,
+	cairo_matrix_scale (m,
 		icon->fWidth * icon->fWidthFactor / s_activeIndicatorBuffer.iWidth * icon->fScale,
 		icon->fHeight * icon->fHeightFactor / s_activeIndicatorBuffer.iHeight * icon->fScale);
-	cairo_set_source_surface (pCairoContext, s_activeIndicatorBuffer.pSurface, 0., 0.);
-	cairo_paint (pCairoContext);
-	cairo_restore (pCairoContext);
 }
-static void _cairo_dock_draw_class_indicator (cairo_t *pCairoContext, Icon *icon, gboolean bIsHorizontal, double fRatio, gboolean bDirectionUp)
+static void _set_class_indicator_matrix (Icon *icon, CairoDock *pDock, cairo_matrix_t *m)
 {
-	cairo_save (pCairoContext);
+	gboolean bIsHorizontal = pDock->container.bIsHorizontal;
+	gboolean bDirectionUp = pDock->container.bDirectionUp;
+	double fRatio = pDock->container.fRatio;
 	if (myIndicatorsParam.bZoomClassIndicator)
 		fRatio *= icon->fScale;
 	double w = s_classIndicatorBuffer.iWidth;
@@ -215,127 +226,474 @@ static void _cairo_dock_draw_class_indicator (cairo_t *pCairoContext, Icon *icon
 	if (bIsHorizontal)  // draw it in the top-right corner, at 1/3 of the icon.
 	{
 		if (bDirectionUp)
-			cairo_translate (pCairoContext,
+			cairo_matrix_translate (m,
 				icon->fWidth * (icon->fScale - fRatio/3),
 				0.);
 		else
-			cairo_translate (pCairoContext,
+			cairo_matrix_translate (m,
 				icon->fWidth * (icon->fScale - fRatio/3),
 				icon->fHeight * (icon->fScale - fRatio/3));
 	}
 	else
 	{
 		if (bDirectionUp)
-			cairo_translate (pCairoContext,
+			cairo_matrix_translate (m,
 				0.,
 				icon->fWidth * (icon->fScale - fRatio/3));
 		else
-			cairo_translate (pCairoContext,
+			cairo_matrix_translate (m,
 				icon->fHeight * (icon->fScale - fRatio/3),
 				icon->fWidth * (icon->fScale - fRatio/3));
 	}
-	cairo_scale (pCairoContext, icon->fWidth/3 * fRatio / w, icon->fHeight/3 * fRatio / h);
-	cairo_dock_draw_surface (pCairoContext, s_classIndicatorBuffer.pSurface, w, h, bDirectionUp, bIsHorizontal, 1.);
+	cairo_matrix_scale (m, icon->fWidth/3 * fRatio / w, icon->fHeight/3 * fRatio / h);
+	_set_surface_orientation (m, w, h, bDirectionUp, bIsHorizontal);
+}
+
+// Place of an icon in its dock, as set by the view with cairo_dock_render_one_icon() or cairo_dock_render_one_icon_opengl(), for an icon that doesn't glide nor turn in 3D (see _icon_is_flat).
+static void _get_icon_matrix (Icon *icon, CairoDock *pDock, cairo_matrix_t *m)
+{
+	if (pDock->container.bIsHorizontal)
+		cairo_matrix_init_translate (m, icon->fDrawX, icon->fDrawY);
+	else
+		cairo_matrix_init_translate (m, icon->fDrawY, icon->fDrawX);
+	if (icon->fOrientation != 0)
+		cairo_matrix_rotate (m, icon->fOrientation);
+}
+static void _get_icon_matrix_opengl (Icon *icon, CairoDock *pDock, cairo_matrix_t *m, double *z)
+{
+	double w = icon->fWidth * icon->fScale;
+	double h = icon->fHeight * icon->fScale;
+	if (pDock->container.bIsHorizontal)
+		cairo_matrix_init_translate (m, icon->fDrawX + w/2, pDock->container.iHeight - icon->fDrawY - h/2);
+	else
+		cairo_matrix_init_translate (m, icon->fDrawY + h/2, pDock->container.iWidth - (icon->fDrawX + w/2));
+	if (icon->fOrientation != 0)
+	{
+		cairo_matrix_translate (m, -w/2, h/2);
+		cairo_matrix_rotate (m, -icon->fOrientation);
+		cairo_matrix_translate (m, w/2, -h/2);
+	}
+	*z = - h;
+}
+static inline gboolean _icon_is_flat (Icon *icon)
+{
+	return (icon->fGlideOffset == 0 && icon->iRotationX == 0 && icon->iRotationY == 0 && ! GLDI_OBJECT_IS_SEPARATOR_ICON (icon));
+}
+
+static void _init_batch (CairoIndicatorBatch *pBatch)
+{
+	pBatch->pVertices = g_array_new (FALSE, FALSE, sizeof (GLfloat));
+	pBatch->pCoords = g_array_new (FALSE, FALSE, sizeof (GLfloat));
+	pBatch->pMatrices = g_array_new (FALSE, FALSE, sizeof (cairo_matrix_t));
+}
+static void _clear_batch (CairoIndicatorBatch *pBatch)
+{
+	g_array_set_size (pBatch->pVertices, 0);
+	g_array_set_size (pBatch->pCoords, 0);
+	g_array_set_size (pBatch->pMatrices, 0);
+}
+static void _batch_add_quad (CairoIndicatorBatch *pBatch, const cairo_matrix_t *m, double z, const GLfloat *pModelview)  // if a modelview is given, the corners are converted into eye coordinates.
+{
+	static const GLfloat corners[8] = {-.5, .5,  .5, .5,  .5, -.5,  -.5, -.5};  // same as _cairo_dock_apply_current_texture_at_size.
+	static const GLfloat coords[8] = {0., 0.,  1., 0.,  1., 1.,  0., 1.};
+	GLfloat v[3];
+	double x, y;
+	int i;
+	for (i = 0; i < 4; i ++)
+	{
+		x = corners[2*i];
+		y = corners[2*i+1];
+		cairo_matrix_transform_point (m, &x, &y);
+		if (pModelview != NULL)
+		{
+			v[0] = pModelview[0] * x + pModelview[4] * y + pModelview[8] * z + pModelview[12];
+			v[1] = pModelview[1] * x + pModelview[5] * y + pModelview[9] * z + pModelview[13];
+			v[2] = pModelview[2] * x + pModelview[6] * y + pModelview[10] * z + pModelview[14];
+		}
+		else
+		{
+			v[0] = x;
+			v[1] = y;
+			v[2] = z;
+		}
+		g_array_append_vals (pBatch->pVertices, v, 3);
+	}
+	g_array_append_vals (pBatch->pCoords, coords, 8);
+}
+static void _batch_add_matrix (CairoIndicatorBatch *pBatch, const cairo_matrix_t *m)
+{
+	g_array_append_vals (pBatch->pMatrices, m, 1);
+}
+
+static void _flush_batch_opengl (CairoIndicatorBatch *pBatch, GLuint iTexture, gboolean bBlendPbuffer)
+{
+	guint iNbVertices = pBatch->pVertices->len / 3;
+	if (iNbVertices == 0)
+		return;
+	_cairo_dock_enable_texture ();
+	if (bBlendPbuffer)
+		_cairo_dock_set_blend_pbuffer ();  // rend mieux que les 2 autres.
+	else
+		_cairo_dock_set_blend_over ();  // same as cairo_dock_draw_texture_with_alpha.
+	_cairo_dock_set_alpha (1.);
+	glBindTexture (GL_TEXTURE_2D, iTexture);
+	
+	glEnableClientState (GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState (GL_VERTEX_ARRAY);
+	glTexCoordPointer (2, GL_FLOAT, 2 * sizeof (GLfloat), pBatch->pCoords->data);
+	glVertexPointer (3, GL_FLOAT, 3 * sizeof (GLfloat), pBatch->pVertices->data);
+	glDrawArrays (GL_QUADS, 0, iNbVertices);
+	glDisableClientState (GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState (GL_VERTEX_ARRAY);
+	
+	_cairo_dock_disable_texture ();
+	_clear_batch (pBatch);
+}
+static void _flush_batch (CairoIndicatorBatch *pBatch, cairo_surface_t *pSurface, cairo_t *pCairoContext)
+{
+	if (pBatch->pMatrices->len == 0)
+		return;
+	cairo_pattern_t *pPattern = cairo_pattern_create_for_surface (pSurface);
+	cairo_save (pCairoContext);
+	guint i;
+	for (i = 0; i < pBatch->pMatrices->len; i ++)
+	{
+		cairo_set_matrix (pCairoContext, &g_array_index (pBatch->pMatrices, cairo_matrix_t, i));
+		cairo_set_source (pCairoContext, pPattern);
+		cairo_paint (pCairoContext);
+	}
 	cairo_restore (pCairoContext);
+	cairo_pattern_destroy (pPattern);
+	_clear_batch (pBatch);
 }
 
-static inline gboolean _active_indicator_is_visible (Icon *icon)
+// The icons pointing on a sub-dock get the active indicator if the active window is inside it. Rather than looking into their sub-dock for each icon on each frame, the sub-docks containing the active window are listed once, and only listed again when the active window changes or when an icon is inserted in or removed from a dock.
+static void _find_active_subdocks (G_GNUC_UNUSED const gchar *cName, CairoDock *pDock, GldiWindowActor *pAppli)
 {
-	gboolean bIsActive = FALSE;
-	if (icon->pAppli)
+	if (pDock->iRefCount == 0)  // only sub-docks can be pointed by an icon.
+		return;
+	Icon *icon;
+	GList *ic;
+	for (ic = pDock->icons; ic != NULL; ic = ic->next)
 	{
-		GldiWindowActor *pAppli = gldi_windows_get_active ();
-		if (pAppli != NULL)
+		icon = ic->data;
+		if (icon->pAppli == pAppli)
 		{
-			bIsActive = (icon->pAppli == pAppli);
-			if (!bIsActive && icon->pSubDock != NULL)
-			{
-				Icon *subicon;
-				GList *ic;
-				for (ic = icon->pSubDock->icons; ic != NULL; ic = ic->next)
-				{
-					subicon = ic->data;
-					if (subicon->pAppli == pAppli)
-					{
-						bIsActive = TRUE;
-						break;
-					}
-				}
-			}
+			s_pActiveSubDocks = g_list_prepend (s_pActiveSubDocks, pDock);
+			break;
 		}
 	}
-	return bIsActive;
+}
+static void _update_active_subdocks (GldiWindowActor *pAppli)
+{
+	g_list_free (s_pActiveSubDocks);
+	s_pActiveSubDocks = NULL;
+	gldi_docks_foreach ((GHFunc)_find_active_subdocks, pAppli);
+	s_pActiveSubDocksAppli = pAppli;
+	s_bActiveSubDocksValid = TRUE;
+}
+static inline void _invalidate_active_subdocks (void)
+{
+	s_bActiveSubDocksValid = FALSE;
+}
+static gboolean _on_active_window_changed (G_GNUC_UNUSED gpointer data, G_GNUC_UNUSED GldiWindowActor *pActiveAppli)
+{
+	_invalidate_active_subdocks ();
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+static gboolean _on_insert_remove_icon (G_GNUC_UNUSED gpointer data, G_GNUC_UNUSED Icon *pIcon, G_GNUC_UNUSED CairoDock *pDock)
+{
+	_invalidate_active_subdocks ();
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+static gboolean _on_dock_destroyed (G_GNUC_UNUSED gpointer data, CairoDock *pDock)
+{
+	_invalidate_active_subdocks ();  // it may be in the list.
+	if (pDock == s_pRenderedDock)
+		s_pRenderedDock = NULL;
+	return GLDI_NOTIFICATION_LET_PASS;
 }
 
-static gboolean cairo_dock_pre_render_indicator_notification (G_GNUC_UNUSED gpointer pUserData, Icon *icon, CairoDock *pDock, cairo_t *pCairoContext)
+static inline gboolean _active_indicator_is_visible (Icon *icon)
 {
-	gboolean bIsActive = (myIndicatorsParam.bActiveIndicatorAbove ? FALSE : _active_indicator_is_visible (icon));
+	if (icon->pAppli == NULL)
+		return FALSE;
+	GldiWindowActor *pAppli = gldi_windows_get_active ();
+	if (pAppli == NULL)
+		return FALSE;
+	if (icon->pAppli == pAppli)
+		return TRUE;
+	if (icon->pSubDock == NULL)
+		return FALSE;
 	
-	if (pCairoContext != NULL)
+	if (! s_bActiveSubDocksValid || s_pActiveSubDocksAppli != pAppli)
+		_update_active_subdocks (pAppli);
+	return (g_list_find (s_pActiveSubDocks, icon->pSubDock) != NULL);
+}
+
+#define _indicator_is_loaded(buffer, bOpenGL) ((bOpenGL) ? (buffer).iTexture != 0 : (buffer).pSurface != NULL)
+
+static inline gboolean _has_appli_indicator_below (Icon *icon, gboolean bOpenGL)
+{
+	return (icon->bHasIndicator && ! myIndicatorsParam.bIndicatorAbove && _indicator_is_loaded (s_indicatorBuffer, bOpenGL));
+}
+static inline gboolean _has_active_indicator_below (Icon *icon, gboolean bOpenGL)
+{
+	return (! myIndicatorsParam.bActiveIndicatorAbove && _indicator_is_loaded (s_activeIndicatorBuffer, bOpenGL) && _active_indicator_is_visible (icon));
+}
+static inline gboolean _has_appli_indicator_above (Icon *icon, gboolean bOpenGL)
+{
+	return (icon->bHasIndicator && myIndicatorsParam.bIndicatorAbove && _indicator_is_loaded (s_indicatorBuffer, bOpenGL));
+}
+static inline gboolean _has_active_indicator_above (Icon *icon, gboolean bOpenGL)
+{
+	return (myIndicatorsParam.bActiveIndicatorAbove && _indicator_is_loaded (s_activeIndicatorBuffer, bOpenGL) && _active_indicator_is_visible (icon));
+}
+static inline gboolean _has_class_indicator (Icon *icon, gboolean bOpenGL)
+{
+	return (icon->pSubDock != NULL && icon->cClass != NULL && icon->pAppli == NULL && _indicator_is_loaded (s_classIndicatorBuffer, bOpenGL));  // le dernier test est de la paranoia.
+}
+
+// pIconMatrix is the place of the icon: a matrix of the context with cairo, a matrix relative to the current modelview with OpenGL (z being its depth).
+static void _add_indicators_below (Icon *icon, CairoDock *pDock, const cairo_matrix_t *pIconMatrix, double z, cairo_t *pCairoContext)
+{
+	gboolean bOpenGL = (pCairoContext == NULL);
+	cairo_matrix_t m;
+	if (_has_appli_indicator_below (icon, bOpenGL))
 	{
-		if (icon->bHasIndicator && ! myIndicatorsParam.bIndicatorAbove && s_indicatorBuffer.pSurface != NULL)
+		m = *pIconMatrix;
+		if (bOpenGL)
 		{
-			_cairo_dock_draw_appli_indicator (icon, pDock, pCairoContext);
+			_set_appli_indicator_matrix_opengl (icon, pDock, &m);
+			_batch_add_quad (&s_appliBatch, &m, z, NULL);
 		}
-		
-		if (bIsActive && s_activeIndicatorBuffer.pSurface != NULL)
+		else
 		{
-			_cairo_dock_draw_active_window_indicator (pCairoContext, icon);
+			_set_appli_indicator_matrix (icon, pDock, &m);
+			_batch_add_matrix (&s_appliBatch, &m);
 		}
 	}
-	else
+	if (_has_active_indicator_below (icon, bOpenGL))
 	{
-		if (icon->bHasIndicator && ! myIndicatorsParam.bIndicatorAbove)
+		m = *pIconMatrix;
+		if (bOpenGL)
 		{
-			_cairo_dock_draw_appli_indicator_opengl (icon, pDock);
+			_set_active_window_indicator_matrix_opengl (icon, pDock, &m);
+			_batch_add_quad (&s_activeBatch, &m, z, NULL);
 		}
-		
-		if (bIsActive)
+		else
 		{
-			_cairo_dock_draw_active_window_indicator_opengl (icon, pDock, pDock->container.fRatio);
+			_set_active_window_indicator_matrix (icon, pDock, &m);
+			_batch_add_matrix (&s_activeBatch, &m);
 		}
 	}
-	return GLDI_NOTIFICATION_LET_PASS;
+}
+static void _draw_indicators_below (cairo_t *pCairoContext)
+{
+	if (pCairoContext != NULL)
+	{
+		_flush_batch (&s_appliBatch, s_indicatorBuffer.pSurface, pCairoContext);
+		_flush_batch (&s_activeBatch, s_activeIndicatorBuffer.pSurface, pCairoContext);
+	}
+	else
+	{
+		_flush_batch_opengl (&s_appliBatch, s_indicatorBuffer.iTexture, FALSE);
+		_flush_batch_opengl (&s_activeBatch, s_activeIndicatorBuffer.iTexture, TRUE);
+	}
 }
 
-static gboolean cairo_dock_render_indicator_notification (G_GNUC_UNUSED gpointer pUserData, Icon *icon, CairoDock *pDock, G_GNUC_UNUSED gboolean *bHasBeenRendered, cairo_t *pCairoContext)
+// the indicators above the icon are taken at the current place of the icon (the matrix of the context with cairo, eye coordinates with OpenGL), so they can be drawn later from anywhere.
+static void _add_indicators_above (Icon *icon, CairoDock *pDock, cairo_t *pCairoContext)
 {
-	gboolean bIsActive = (myIndicatorsParam.bActiveIndicatorAbove ? _active_indicator_is_visible (icon) : FALSE);
-	
+	cairo_matrix_t m;
 	if (pCairoContext != NULL)
 	{
-		if (bIsActive)
+		cairo_matrix_t mi;
+		cairo_get_matrix (pCairoContext, &mi);
+		if (_has_active_indicator_above (icon, FALSE))
 		{
-			_cairo_dock_draw_active_window_indicator (pCairoContext, icon);
+			m = mi;
+			_set_active_window_indicator_matrix (icon, pDock, &m);
+			_batch_add_matrix (&s_activeBatch, &m);
 		}
-		if (icon->bHasIndicator && myIndicatorsParam.bIndicatorAbove && s_indicatorBuffer.pSurface != NULL)
+		if (_has_appli_indicator_above (icon, FALSE))
 		{
-			_cairo_dock_draw_appli_indicator (icon, pDock, pCairoContext);
+			m = mi;
+			_set_appli_indicator_matrix (icon, pDock, &m);
+			_batch_add_matrix (&s_appliBatch, &m);
 		}
-		if (icon->pSubDock != NULL && icon->cClass != NULL && s_classIndicatorBuffer.pSurface != NULL && icon->pAppli == NULL)  // le dernier test est de la paranoia.
+		if (_has_class_indicator (icon, FALSE))
 		{
-			_cairo_dock_draw_class_indicator (pCairoContext, icon, pDock->container.bIsHorizontal, pDock->container.fRatio, pDock->container.bDirectionUp);
+			m = mi;
+			_set_class_indicator_matrix (icon, pDock, &m);
+			_batch_add_matrix (&s_classBatch, &m);
 		}
 	}
 	else
 	{
-		if (icon->bHasIndicator && myIndicatorsParam.bIndicatorAbove)
+		GLfloat pModelview[16];
+		glGetFloatv (GL_MODELVIEW_MATRIX, pModelview);
+		if (_has_appli_indicator_above (icon, TRUE))
 		{
+			GLfloat pIconModelview[16];  // the appli indicator is placed on the icon without its orientation.
 			glPushMatrix ();
-			glLoadIdentity();
+			glLoadIdentity ();
 			cairo_dock_translate_on_icon_opengl (icon, CAIRO_CONTAINER (pDock), 1.);
-			_cairo_dock_draw_appli_indicator_opengl (icon, pDock);
+			glGetFloatv (GL_MODELVIEW_MATRIX, pIconModelview);
 			glPopMatrix ();
+			cairo_matrix_init_identity (&m);
+			_set_appli_indicator_matrix_opengl (icon, pDock, &m);
+			_batch_add_quad (&s_appliBatch, &m, 0., pIconModelview);
 		}
-		if (bIsActive)
+		if (_has_active_indicator_above (icon, TRUE))
 		{
-			_cairo_dock_draw_active_window_indicator_opengl (icon, pDock, pDock->container.fRatio);
+			cairo_matrix_init_identity (&m);
+			_set_active_window_indicator_matrix_opengl (icon, pDock, &m);
+			_batch_add_quad (&s_activeBatch, &m, 0., pModelview);
 		}
-		if (icon->pSubDock != NULL && icon->cClass != NULL && s_classIndicatorBuffer.iTexture != 0 && icon->pAppli == NULL)  // le dernier test est de la paranoia.
+		if (_has_class_indicator (icon, TRUE))
 		{
-			_cairo_dock_draw_class_indicator_opengl (icon, pDock->container.bIsHorizontal, pDock->container.fRatio, pDock->container.bDirectionUp);
+			cairo_matrix_init_identity (&m);
+			_set_class_indicator_matrix_opengl (icon, pDock, &m);
+			_batch_add_quad (&s_classBatch, &m, 0., pModelview);
 		}
 	}
+}
+static void _draw_indicators_above (cairo_t *pCairoContext)
+{
+	if (pCairoContext != NULL)
+	{
+		_flush_batch (&s_activeBatch, s_activeIndicatorBuffer.pSurface, pCairoContext);
+		_flush_batch (&s_appliBatch, s_indicatorBuffer.pSurface, pCairoContext);
+		_flush_batch (&s_classBatch, s_classIndicatorBuffer.pSurface, pCairoContext);
+	}
+	else
+	{
+		glPushMatrix ();
+		glLoadIdentity ();  // the quads are in eye coordinates.
+		_flush_batch_opengl (&s_appliBatch, s_indicatorBuffer.iTexture, FALSE);
+		_flush_batch_opengl (&s_activeBatch, s_activeIndicatorBuffer.iTexture, TRUE);
+		_flush_batch_opengl (&s_classBatch, s_classIndicatorBuffer.iTexture, FALSE);
+		glPopMatrix ();
+	}
+}
+
+// When the view draws the first icon of a dock, the indicators below all the icons are drawn at once, at the place where each icon will be drawn; this place is deduced from the current one, since all icons are placed the same way, from their coordinates. Icons whose place can't be deduced (gliding, turning in 3D) get their indicators when they are drawn.
+static void _draw_all_indicators_below (Icon *pFirstIcon, CairoDock *pDock, cairo_t *pCairoContext)
+{
+	gboolean bOpenGL = (pCairoContext == NULL);
+	cairo_matrix_t base, m;
+	double z0 = 0., z = 0.;
+	cairo_matrix_init_identity (&base);
+	s_bBelowBatched = _icon_is_flat (pFirstIcon);
+	if (s_bBelowBatched)
+	{
+		if (bOpenGL)  // relatively to the first icon, which is the current modelview.
+		{
+			_get_icon_matrix_opengl (pFirstIcon, pDock, &base, &z0);
+			cairo_matrix_invert (&base);
+		}
+		else  // matrix of the context under the icons.
+		{
+			cairo_matrix_t ctm;
+			cairo_get_matrix (pCairoContext, &ctm);
+			_get_icon_matrix (pFirstIcon, pDock, &base);
+			cairo_matrix_invert (&base);
+			cairo_matrix_multiply (&base, &base, &ctm);
+		}
+	}
+	
+	s_iNbAboveLeft = 0;
+	Icon *icon;
+	GList *ic;
+	for (ic = pDock->icons; ic != NULL; ic = ic->next)
+	{
+		icon = ic->data;
+		if (_has_appli_indicator_above (icon, bOpenGL) || _has_active_indicator_above (icon, bOpenGL) || _has_class_indicator (icon, bOpenGL))
+			s_iNbAboveLeft ++;
+		if (! s_bBelowBatched || ! _icon_is_flat (icon))
+			continue;
+		if (bOpenGL)
+		{
+			icon->fGlideScale = 1;  // as the view will set it, the icon doesn't glide.
+			_get_icon_matrix_opengl (icon, pDock, &m, &z);
+			z -= z0;
+		}
+		else
+			_get_icon_matrix (icon, pDock, &m);
+		cairo_matrix_multiply (&m, &m, &base);
+		_add_indicators_below (icon, pDock, &m, z, pCairoContext);
+	}
+	_draw_indicators_below (pCairoContext);
+}
+
+static gboolean _on_render_dock_start (G_GNUC_UNUSED gpointer data, CairoDock *pDock, G_GNUC_UNUSED cairo_t *pCairoContext)
+{
+	s_pRenderedDock = pDock;
+	s_bFirstIconDrawn = FALSE;
+	s_bBelowBatched = FALSE;
+	s_iNbAboveLeft = 0;
+	_clear_batch (&s_appliBatch);
+	_clear_batch (&s_activeBatch);
+	_clear_batch (&s_classBatch);
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+static gboolean _on_render_dock_end (G_GNUC_UNUSED gpointer data, CairoDock *pDock, cairo_t *pCairoContext)
+{
+	if (pDock == s_pRenderedDock)
+	{
+		_draw_indicators_above (pCairoContext);  // if the view didn't draw all the icons.
+		s_pRenderedDock = NULL;
+	}
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+static gboolean _on_new_dock (G_GNUC_UNUSED gpointer data, CairoDock *pDock)
+{
+	gldi_object_register_notification (pDock,
+		NOTIFICATION_RENDER,
+		(GldiNotificationFunc) _on_render_dock_start,
+		GLDI_RUN_FIRST, NULL);  // the dock manager has connected the view before, so we pass before it.
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+
+static gboolean cairo_dock_pre_render_indicator_notification (G_GNUC_UNUSED gpointer pUserData, Icon *icon, CairoDock *pDock, cairo_t *pCairoContext)
+{
+	if (pDock == s_pRenderedDock)
+	{
+		if (! s_bFirstIconDrawn)
+		{
+			s_bFirstIconDrawn = TRUE;
+			_draw_all_indicators_below (icon, pDock, pCairoContext);
+		}
+		if (s_bBelowBatched && _icon_is_flat (icon))  // already drawn.
+			return GLDI_NOTIFICATION_LET_PASS;
+	}
+	
+	cairo_matrix_t m;
+	if (pCairoContext != NULL)
+		cairo_get_matrix (pCairoContext, &m);
+	else
+		cairo_matrix_init_identity (&m);
+	_add_indicators_below (icon, pDock, &m, 0., pCairoContext);
+	_draw_indicators_below (pCairoContext);
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+
+static gboolean cairo_dock_render_indicator_notification (G_GNUC_UNUSED gpointer pUserData, Icon *icon, CairoDock *pDock, G_GNUC_UNUSED gboolean *bHasBeenRendered, cairo_t *pCairoContext)
+{
+	gboolean bOpenGL = (pCairoContext == NULL);
+	if (! _has_appli_indicator_above (icon, bOpenGL) && ! _has_active_indicator_above (icon, bOpenGL) && ! _has_class_indicator (icon, bOpenGL))
+		return GLDI_NOTIFICATION_LET_PASS;
+	
+	_add_indicators_above (icon, pDock, pCairoContext);
+	if (pDock == s_pRenderedDock && s_bFirstIconDrawn)  // draw them all after the last of their icons.
+	{
+		s_iNbAboveLeft --;
+		if (s_iNbAboveLeft <= 0)
+			_draw_indicators_above (pCairoContext);
+	}
+	else
+		_draw_indicators_above (pCairoContext);
 	return GLDI_NOTIFICATION_LET_PASS;
 }
 
@@ -732,6 +1090,9 @@ static void unload (void)
 	cairo_dock_unload_image_buffer (&s_indicatorBuffer);
 	cairo_dock_unload_image_buffer (&s_activeIndicatorBuffer);
 	cairo_dock_unload_image_buffer (&s_classIndicatorBuffer);
+	g_list_free (s_pActiveSubDocks);
+	s_pActiveSubDocks = NULL;
+	s_bActiveSubDocksValid = FALSE;
 }
 
 
@@ -770,6 +1131,34 @@ static void init (void)
 		NOTIFICATION_STYLE_CHANGED,
 		(GldiNotificationFunc) on_style_changed,
 		GLDI_RUN_AFTER, NULL);
+	gldi_object_register_notification (&myWindowObjectMgr,
+		NOTIFICATION_WINDOW_ACTIVATED,
+		(GldiNotificationFunc) _on_active_window_changed,
+		GLDI_RUN_FIRST, NULL);
+	gldi_object_register_notification (&myDockObjectMgr,
+		NOTIFICATION_INSERT_ICON,
+		(GldiNotificationFunc) _on_insert_remove_icon,
+		GLDI_RUN_FIRST, NULL);
+	gldi_object_register_notification (&myDockObjectMgr,
+		NOTIFICATION_REMOVE_ICON,
+		(GldiNotificationFunc) _on_insert_remove_icon,
+		GLDI_RUN_FIRST, NULL);
+	gldi_object_register_notification (&myDockObjectMgr,
+		NOTIFICATION_DESTROY,
+		(GldiNotificationFunc) _on_dock_destroyed,
+		GLDI_RUN_FIRST, NULL);
+	gldi_object_register_notification (&myDockObjectMgr,
+		NOTIFICATION_NEW,
+		(GldiNotificationFunc) _on_new_dock,
+		GLDI_RUN_AFTER, NULL);
+	gldi_object_register_notification (&myDockObjectMgr,
+		NOTIFICATION_RENDER,
+		(GldiNotificationFunc) _on_render_dock_end,
+		GLDI_RUN_FIRST, NULL);  // the manager is notified after the dock itself, so after the view.
+
+	_init_batch (&s_appliBatch);
+	_init_batch (&s_activeBatch);
+	_init_batch (&s_classBatch);
 }
 
 
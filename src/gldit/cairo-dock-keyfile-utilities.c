@@ -17,16 +17,731 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#define _GNU_SOURCE  // st_mtim, st_ctim
 #include <string.h>
 #include <stdlib.h>
+#include <fcntl.h>  // open
+#include <unistd.h>  // write
+#include <sys/stat.h>  // stat
+#include <glib/gstdio.h>  // g_remove
 
 #include "cairo-dock-log.h"
 #include "cairo-dock-keyfile-utilities.h"
 
+// Conf files updated with cairo_dock_update_keyfile are kept in memory and written once a little later, since the updates often come in bursts (a desklet being moved, icons being reordered, etc). Any other access to a conf file through this API writes it first.
+#define CAIRO_DOCK_CONF_FILE_WRITE_DELAY 2  // s
+typedef struct {
+	GKeyFile *pKeyFile;
+	gboolean bExisted;  // whether the file existed when it was loaded; if it doesn't any more, it has been deleted in the meantime.
+	gboolean bJournaled;  // whether some of its updates are in the journal.
+	} CairoDockPendingConfFile;
+static GHashTable *s_hPendingConfFiles = NULL;  // path -> CairoDockPendingConfFile
+static guint s_iSidWriteConfFiles = 0;
+static gint s_iNbUpdates = 0;  // since the last report
+static gint s_iNbWrites = 0;
+static gint64 s_iLastReportTime = 0;
 
-GKeyFile *cairo_dock_open_key_file (const gchar *cConfFilePath)
+#ifndef GLIB_VERSION_2_32
+static GStaticMutex s_mPendingConfFiles = G_STATIC_MUTEX_INIT;
+#define _lock_pending_conf_files() g_static_mutex_lock (&s_mPendingConfFiles)
+#define _unlock_pending_conf_files() g_static_mutex_unlock (&s_mPendingConfFiles)
+#else
+static GMutex s_mPendingConfFiles;  // conf files can be opened from a thread (see gldi_module_instance_prepare_conf_file).
+#define _lock_pending_conf_files() g_mutex_lock (&s_mPendingConfFiles)
+#define _unlock_pending_conf_files() g_mutex_unlock (&s_mPendingConfFiles)
+#endif
+
+// The updates of the order and the parent dock of the icons are also appended to a journal, all the updates of a burst in a single write, so that they're not lost if the dock is stopped before the conf files are written (a reordering updates many files at once).
+// The entries of a file are removed from the journal once it is written, and the journal is replayed at the next startup.
+static const gchar *s_cJournaledKeys[][2] = {
+	{"Desktop Entry", "Order"},  // launchers
+	{"Desktop Entry", "Container"},
+	{"Icon", "order"},  // applets
+	{"Icon", "dock name"},
+	{NULL, NULL}};
+static gchar *s_cJournalPath = NULL;  // NULL until the journal is enabled.
+static GString *s_sJournal = NULL;  // entries since the journal was emptied.
+static gsize s_iJournalLength = 0;  // length of the entries that are on the disk already.
+static guint s_iSidWriteJournal = 0;
+
+static void _write_keys_to_file (GKeyFile *pKeyFile, const gchar *cConfFilePath);
+
+static gboolean _is_journaled_key (const gchar *cGroupName, const gchar *cKeyName)
+{
+	int i;
+	for (i = 0; s_cJournaledKeys[i][0] != NULL; i ++)
+	{
+		if (strcmp (cKeyName, s_cJournaledKeys[i][1]) == 0 && strcmp (cGroupName, s_cJournaledKeys[i][0]) == 0)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static gboolean _write_private_file (const gchar *cPath, int iFlags, const gchar *cData, gsize iLength)
+{
+	int fd = open (cPath, O_WRONLY | O_CREAT | iFlags, 0600);
+	if (fd < 0)
+		return FALSE;
+	gsize n = 0;
+	gssize r;
+	while (n < iLength)
+	{
+		r = write (fd, cData + n, iLength - n);
+		if (r < 0)
+			break;
+		n += r;
+	}
+	close (fd);
+	return (n == iLength);
+}
+
+static void _append_journal_entries (void)
+{
+	if (s_sJournal == NULL || s_iJournalLength >= s_sJournal->len || s_cJournalPath == NULL)
+		return;
+	if (! _write_private_file (s_cJournalPath, O_APPEND, s_sJournal->str + s_iJournalLength, s_sJournal->len - s_iJournalLength))
+		cd_warning ("couldn't write the journal of the conf files (%s)", s_cJournalPath);
+	s_iJournalLength = s_sJournal->len;
+}
+
+static gboolean _write_journal_idle (G_GNUC_UNUSED gpointer data)
+{
+	_lock_pending_conf_files ();
+	s_iSidWriteJournal = 0;
+	_append_journal_entries ();
+	_unlock_pending_conf_files ();
+	return FALSE;
+}
+
+static void _add_journal_entry (const gchar *cConfFilePath, gboolean bExisted, const gchar *cGroupName, const gchar *cKeyName, const gchar *cRawValue)
+{
+	if (s_sJournal == NULL)
+		s_sJournal = g_string_new ("");
+	const gchar *cFields[5] = {cConfFilePath, bExisted ? "1" : "0", cGroupName, cKeyName, cRawValue};  // escaped, so that they don't contain any tab or new line.
+	gchar *cField;
+	int i;
+	for (i = 0; i < 5; i ++)
+	{
+		cField = g_strescape (cFields[i] != NULL ? cFields[i] : "", NULL);
+		g_string_append (s_sJournal, cField);
+		g_string_append_c (s_sJournal, i < 4 ? '\t' : '\n');
+		g_free (cField);
+	}
+	if (s_iSidWriteJournal == 0)
+		s_iSidWriteJournal = g_idle_add (_write_journal_idle, NULL);  // once the burst is over.
+}
+
+static void _clear_journal (void)
+{
+	if (s_iSidWriteJournal != 0)
+	{
+		g_source_remove (s_iSidWriteJournal);
+		s_iSidWriteJournal = 0;
+	}
+	if (s_sJournal != NULL)
+		g_string_truncate (s_sJournal, 0);
+	s_iJournalLength = 0;
+	if (s_cJournalPath != NULL)
+		g_remove (s_cJournalPath);
+}
+
+// remove the entries of a file that has just been written (or replaced), so that they are not replayed on it; the other files keep theirs.
+static void _remove_journal_entries (const gchar *cConfFilePath)
+{
+	if (s_sJournal == NULL)
+		return;
+	gchar *cEscapedPath = g_strescape (cConfFilePath, NULL);
+	gsize iPathLength = strlen (cEscapedPath);
+	GString *sJournal = g_string_sized_new (s_sJournal->len);
+	const gchar *cLine = s_sJournal->str, *cEndOfLine;
+	while ((cEndOfLine = strchr (cLine, '\n')) != NULL)
+	{
+		if (strncmp (cLine, cEscapedPath, iPathLength) != 0 || cLine[iPathLength] != '\t')
+			g_string_append_len (sJournal, cLine, cEndOfLine + 1 - cLine);
+		cLine = cEndOfLine + 1;
+	}
+	g_free (cEscapedPath);
+	g_string_free (s_sJournal, TRUE);
+	s_sJournal = sJournal;
+	
+	if (s_sJournal->len == 0)
+		_clear_journal ();
+	else if (s_iJournalLength != 0 && s_cJournalPath != NULL)  // some of the entries are on the disk: replace the journal.
+	{
+		gchar *cTmpPath = g_strdup_printf ("%s.tmp", s_cJournalPath);
+		if (_write_private_file (cTmpPath, O_TRUNC, s_sJournal->str, s_sJournal->len) && g_rename (cTmpPath, s_cJournalPath) == 0)
+			s_iJournalLength = s_sJournal->len;
+		else  // keep the current one (its entries will just be replayed on an up-to-date file), and append all the remaining entries to it.
+		{
+			cd_warning ("couldn't write the journal of the conf files (%s)", s_cJournalPath);
+			g_remove (cTmpPath);
+			s_iJournalLength = 0;
+		}
+		g_free (cTmpPath);
+	}
+}
+
+static void _free_pending_conf_file (CairoDockPendingConfFile *pPendingFile)
+{
+	g_key_file_free (pPendingFile->pKeyFile);
+	g_free (pPendingFile);
+}
+
+static void _write_pending_conf_file (const gchar *cConfFilePath, CairoDockPendingConfFile *pPendingFile)
+{
+	if (pPendingFile->bExisted && ! g_file_test (cConfFilePath, G_FILE_TEST_EXISTS))  // deleted in the meantime, don't bring it back.
+		return;
+	_write_keys_to_file (pPendingFile->pKeyFile, cConfFilePath);
+	s_iNbWrites ++;
+}
+
+static void _report_conf_files_writes (void)
+{
+	gint64 t = g_get_monotonic_time ();
+	if (t - s_iLastReportTime < 60 * G_USEC_PER_SEC)
+		return;
+	if (s_iNbUpdates != 0)
+		cd_message ("conf files: %d updates -> %d writes (%d saved) in the last %.0f s", s_iNbUpdates, s_iNbWrites, s_iNbUpdates - s_iNbWrites, (double)(t - s_iLastReportTime) / G_USEC_PER_SEC);
+	s_iNbUpdates = s_iNbWrites = 0;
+	s_iLastReportTime = t;
+}
+
+static void _write_all_pending_conf_files (void)
+{
+	if (s_iSidWriteConfFiles != 0)
+	{
+		g_source_remove (s_iSidWriteConfFiles);
+		s_iSidWriteConfFiles = 0;
+	}
+	if (s_hPendingConfFiles != NULL)
+	{
+		g_hash_table_foreach (s_hPendingConfFiles, (GHFunc) _write_pending_conf_file, NULL);
+		g_hash_table_remove_all (s_hPendingConfFiles);
+	}
+	_clear_journal ();  // everything is on the disk now.
+}
+
+void cairo_dock_flush_conf_files (void)
+{
+	_lock_pending_conf_files ();
+	_write_all_pending_conf_files ();
+	_report_conf_files_writes ();
+	_unlock_pending_conf_files ();
+}
+
+static gboolean _write_conf_files_idle (G_GNUC_UNUSED gpointer data)
+{
+	_lock_pending_conf_files ();
+	s_iSidWriteConfFiles = 0;
+	_unlock_pending_conf_files ();
+	cairo_dock_flush_conf_files ();
+	return FALSE;
+}
+
+static void _forget_pending_conf_file (const gchar *cConfFilePath, CairoDockPendingConfFile *pPendingFile)
+{
+	if (pPendingFile->bJournaled)
+		_remove_journal_entries (cConfFilePath);
+	g_hash_table_remove (s_hPendingConfFiles, cConfFilePath);  // the other files keep waiting.
+}
+
+void cairo_dock_flush_conf_file (const gchar *cConfFilePath)
+{
+	_lock_pending_conf_files ();
+	CairoDockPendingConfFile *pPendingFile = (s_hPendingConfFiles != NULL ? g_hash_table_lookup (s_hPendingConfFiles, cConfFilePath) : NULL);
+	if (pPendingFile != NULL)
+	{
+		_write_pending_conf_file (cConfFilePath, pPendingFile);
+		_forget_pending_conf_file (cConfFilePath, pPendingFile);
+	}
+	_unlock_pending_conf_files ();
+}
+
+void cairo_dock_discard_conf_file (const gchar *cConfFilePath)
+{
+	_lock_pending_conf_files ();
+	CairoDockPendingConfFile *pPendingFile = (s_hPendingConfFiles != NULL ? g_hash_table_lookup (s_hPendingConfFiles, cConfFilePath) : NULL);
+	if (pPendingFile != NULL)
+		_forget_pending_conf_file (cConfFilePath, pPendingFile);  // so that its entries in the journal are not replayed on the new file.
+	_unlock_pending_conf_files ();
+}
+
+static void _free_replayed_conf_file (GKeyFile *pKeyFile)
+{
+	if (pKeyFile != NULL)
+		g_key_file_free (pKeyFile);
+}
+
+static void _write_replayed_conf_file (const gchar *cConfFilePath, GKeyFile *pKeyFile)
+{
+	if (pKeyFile != NULL)
+		_write_keys_to_file (pKeyFile, cConfFilePath);
+}
+
+static void _replay_journal (const gchar *cJournalPath)
+{
+	gchar *cContent = NULL;
+	if (! g_file_get_contents (cJournalPath, &cContent, NULL, NULL))
+		return;  // no journal, the conf files are up to date.
+	
+	//\_____________ apply the entries in order on the conf files, each one being loaded once.
+	GHashTable *hConfFiles = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) _free_replayed_conf_file);
+	int iNbEntries = 0;
+	GKeyFile *pKeyFile;
+	gpointer key, value;
+	gchar **cFields, *cConfFilePath, *cGroupName, *cKeyName, *cRawValue;
+	gboolean bExisted;
+	gchar *cLine = cContent, *cEndOfLine;
+	while ((cEndOfLine = strchr (cLine, '\n')) != NULL)  // a last line without end was being written when the dock stopped; its update was not applied yet, ignore it.
+	{
+		*cEndOfLine = '\0';
+		cFields = g_strsplit (cLine, "\t", 6);
+		if (g_strv_length (cFields) == 5)
+		{
+			cConfFilePath = g_strcompress (cFields[0]);
+			bExisted = (strcmp (cFields[1], "0") != 0);
+			if (g_hash_table_lookup_extended (hConfFiles, cConfFilePath, &key, &value))
+			{
+				pKeyFile = value;
+			}
+			else
+			{
+				pKeyFile = g_key_file_new ();
+				if (! g_key_file_load_from_file (pKeyFile, cConfFilePath, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, NULL)
+				&& bExisted)  // deleted since then; a file that didn't exist yet is created with the updates, as it would have been.
+				{
+					g_key_file_free (pKeyFile);
+					pKeyFile = NULL;
+				}
+				g_hash_table_insert (hConfFiles, g_strdup (cConfFilePath), pKeyFile);
+			}
+			if (pKeyFile != NULL)
+			{
+				cGroupName = g_strcompress (cFields[2]);
+				cKeyName = g_strcompress (cFields[3]);
+				cRawValue = g_strcompress (cFields[4]);
+				g_key_file_set_value (pKeyFile, cGroupName, cKeyName, cRawValue);
+				g_free (cGroupName);
+				g_free (cKeyName);
+				g_free (cRawValue);
+				iNbEntries ++;
+			}
+			g_free (cConfFilePath);
+		}
+		g_strfreev (cFields);
+		cLine = cEndOfLine + 1;
+	}
+	
+	//\_____________ write them and forget the journal.
+	g_hash_table_foreach (hConfFiles, (GHFunc) _write_replayed_conf_file, NULL);
+	if (iNbEntries != 0)
+		cd_message ("conf files: %d updates recovered from the journal", iNbEntries);
+	g_hash_table_destroy (hConfFiles);
+	g_free (cContent);
+	g_remove (cJournalPath);
+}
+
+void cairo_dock_set_conf_files_journal (const gchar *cJournalPath)
+{
+	_lock_pending_conf_files ();
+	_write_all_pending_conf_files ();  // if the journal is already enabled, it only holds these updates; otherwise they were not journaled.
+	if (s_cJournalPath == NULL)  // a journal left by the previous session.
+		_replay_journal (cJournalPath);
+	g_free (s_cJournalPath);
+	s_cJournalPath = g_strdup (cJournalPath);
+	_unlock_pending_conf_files ();
+}
+
+
+  ////////////////
+ /// SNAPSHOT ///
+////////////////
+
+// While the current theme is loading, its conf files are taken from a snapshot of the previous load when they haven't changed since then, instead of being read and parsed.
+// The snapshot holds the resolved content of each file: its values once it has been upgraded, and its version, but not the comments that describe the widgets of the config panel (most of a conf file). It is a single file, mapped in memory.
+// A file is taken from it only if it still has the same inode, size, and modification and change times to the nanosecond. The files that hold a password are not put in it.
+#define CAIRO_DOCK_CONF_SNAPSHOT "conf-snapshot"
+#define CAIRO_DOCK_CONF_SNAPSHOT_MAGIC 0x53434443  // "CDCS"
+#define CAIRO_DOCK_CONF_SNAPSHOT_VERSION 1
+typedef struct {
+	guint32 iMagic;
+	guint32 iVersion;
+	guint32 iNbEntries;
+	guint32 iReserved;
+	} CairoDockConfSnapshotHeader;
+typedef struct {
+	guint64 iDevice;
+	guint64 iInode;
+	gint64 iSize;
+	gint64 iMTime;  // ns
+	gint64 iCTime;  // ns; unlike the modification time, it can't be set back.
+	} CairoDockFileStamp;
+typedef struct {
+	CairoDockFileStamp stamp;
+	guint32 iPathOffset;  // offsets from the start of the snapshot; the path is NUL-terminated.
+	guint32 iDataOffset;  // 0 if the content of the file is not in the snapshot (it holds a password).
+	guint32 iDataLength;
+	guint32 iReserved;
+	} CairoDockConfSnapshotEntry;
+static gchar *s_cSnapshotDir = NULL;  // only the conf files in this folder are taken from the snapshot; NULL if we're not loading a theme.
+static GMappedFile *s_pSnapshot = NULL;  // snapshot of the previous load
+static GHashTable *s_hSnapshotEntries = NULL;  // path -> CairoDockConfSnapshotEntry, in s_pSnapshot
+static GHashTable *s_hSnapshotFiles = NULL;  // paths of the conf files opened during the current load.
+static GHashTable *s_hSnapshotKeyFiles = NULL;  // key-files made from the snapshot, which have no comments; a reference is kept, so that their address is not reused.
+static gint s_iNbSnapshotHits = 0;
+
+#ifndef GLIB_VERSION_2_32
+static GStaticMutex s_mSnapshot = G_STATIC_MUTEX_INIT;
+#define _lock_snapshot() g_static_mutex_lock (&s_mSnapshot)
+#define _unlock_snapshot() g_static_mutex_unlock (&s_mSnapshot)
+#else
+static GMutex s_mSnapshot;  // conf files can be opened from a thread.
+#define _lock_snapshot() g_mutex_lock (&s_mSnapshot)
+#define _unlock_snapshot() g_mutex_unlock (&s_mSnapshot)
+#endif
+
+static gboolean _get_file_stamp (const gchar *cFilePath, CairoDockFileStamp *pStamp)
+{
+	struct stat st;
+	if (stat (cFilePath, &st) != 0)
+		return FALSE;
+	memset (pStamp, 0, sizeof (CairoDockFileStamp));
+	pStamp->iDevice = st.st_dev;
+	pStamp->iInode = st.st_ino;
+	pStamp->iSize = st.st_size;
+	pStamp->iMTime = (gint64)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+	pStamp->iCTime = (gint64)st.st_ctim.tv_sec * 1000000000 + st.st_ctim.tv_nsec;
+	return TRUE;
+}
+#define _same_stamp(pStamp1, pStamp2) (memcmp (pStamp1, pStamp2, sizeof (CairoDockFileStamp)) == 0)
+
+static gchar *_get_snapshot_path (void)
+{
+	return g_strdup_printf ("%s/cairo-dock/%s", g_get_user_cache_dir (), CAIRO_DOCK_CONF_SNAPSHOT);
+}
+
+static void _map_snapshot (void)
+{
+	gchar *cSnapshotPath = _get_snapshot_path ();
+	s_pSnapshot = g_mapped_file_new (cSnapshotPath, FALSE, NULL);
+	g_free (cSnapshotPath);
+	if (s_pSnapshot == NULL)  // no snapshot yet.
+		return;
+	
+	//\______________ check that the snapshot is sane, it is trusted afterwards.
+	const gchar *pData = g_mapped_file_get_contents (s_pSnapshot);
+	gsize iLength = g_mapped_file_get_length (s_pSnapshot);
+	const CairoDockConfSnapshotHeader *pHeader = (const CairoDockConfSnapshotHeader *)pData;
+	if (iLength < sizeof (CairoDockConfSnapshotHeader)
+	|| pHeader->iMagic != CAIRO_DOCK_CONF_SNAPSHOT_MAGIC
+	|| pHeader->iVersion != CAIRO_DOCK_CONF_SNAPSHOT_VERSION
+	|| (iLength - sizeof (CairoDockConfSnapshotHeader)) / sizeof (CairoDockConfSnapshotEntry) < pHeader->iNbEntries)
+	{
+		cd_debug ("the snapshot of the conf files is not valid, it will be rebuilt");
+		g_mapped_file_unref (s_pSnapshot);
+		s_pSnapshot = NULL;
+		return;
+	}
+	s_hSnapshotEntries = g_hash_table_new (g_str_hash, g_str_equal);
+	const CairoDockConfSnapshotEntry *pEntries = (const CairoDockConfSnapshotEntry *)(pHeader + 1);
+	const CairoDockConfSnapshotEntry *pEntry;
+	guint i;
+	for (i = 0; i < pHeader->iNbEntries; i ++)
+	{
+		pEntry = &pEntries[i];
+		if (pEntry->iPathOffset >= iLength
+		|| memchr (pData + pEntry->iPathOffset, '\0', iLength - pEntry->iPathOffset) == NULL
+		|| pEntry->iDataOffset > iLength || pEntry->iDataLength > iLength - pEntry->iDataOffset)
+		{
+			cd_debug ("the snapshot of the conf files is truncated, it will be rebuilt");
+			g_hash_table_remove_all (s_hSnapshotEntries);
+			break;
+		}
+		g_hash_table_insert (s_hSnapshotEntries, (gpointer)(pData + pEntry->iPathOffset), (gpointer)pEntry);
+	}
+}
+
+void cairo_dock_begin_conf_files_snapshot (const gchar *cThemeDir)
+{
+	_lock_snapshot ();
+	if (s_cSnapshotDir == NULL)
+	{
+		s_cSnapshotDir = g_strdup (cThemeDir);
+		_map_snapshot ();
+		s_hSnapshotFiles = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		s_hSnapshotKeyFiles = g_hash_table_new_full (g_direct_hash, g_direct_equal, (GDestroyNotify) g_key_file_unref, NULL);
+		s_iNbSnapshotHits = 0;
+	}
+	_unlock_snapshot ();
+}
+
+// return a key-file made from the snapshot if the file hasn't changed since it was taken, or NULL to read the file.
+static GKeyFile *_open_key_file_from_snapshot (const gchar *cConfFilePath)
+{
+	const gchar *cData = NULL;
+	gsize iLength = 0;
+	CairoDockFileStamp stamp;
+	const CairoDockConfSnapshotEntry *pEntry;
+	_lock_snapshot ();
+	if (s_cSnapshotDir != NULL
+	&& g_str_has_prefix (cConfFilePath, s_cSnapshotDir) && cConfFilePath[strlen (s_cSnapshotDir)] == '/'
+	&& _get_file_stamp (cConfFilePath, &stamp))  // a missing file is not recorded, it will just be opened again next time.
+	{
+		g_hash_table_replace (s_hSnapshotFiles, g_strdup (cConfFilePath), NULL);  // it will be in the next snapshot.
+		pEntry = (s_hSnapshotEntries != NULL ? g_hash_table_lookup (s_hSnapshotEntries, cConfFilePath) : NULL);
+		if (pEntry != NULL && pEntry->iDataOffset != 0 && _same_stamp (&stamp, &pEntry->stamp))
+		{
+			cData = g_mapped_file_get_contents (s_pSnapshot) + pEntry->iDataOffset;
+			iLength = pEntry->iDataLength;
+		}
+	}
+	_unlock_snapshot ();
+	if (cData == NULL)
+		return NULL;
+	
+	GKeyFile *pKeyFile = g_key_file_new ();  // the snapshot stays mapped until the end of the load, so it can be parsed without the lock.
+	if (! g_key_file_load_from_data (pKeyFile, cData, iLength, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, NULL))
+	{
+		g_key_file_free (pKeyFile);
+		return NULL;
+	}
+	_lock_snapshot ();
+	if (s_hSnapshotKeyFiles != NULL)
+		g_hash_table_insert (s_hSnapshotKeyFiles, g_key_file_ref (pKeyFile), pKeyFile);
+	s_iNbSnapshotHits ++;
+	_unlock_snapshot ();
+	return pKeyFile;
+}
+
+// a key-file made from the snapshot has no comments, which are needed to write or upgrade it. Return the key-file of the disk with its values, or NULL if it's a complete key-file already.
+static GKeyFile *_restore_comments (GKeyFile *pKeyFile, const gchar *cConfFilePath)
+{
+	_lock_snapshot ();
+	gboolean bFromSnapshot = (s_hSnapshotKeyFiles != NULL && g_hash_table_lookup (s_hSnapshotKeyFiles, pKeyFile) != NULL);
+	_unlock_snapshot ();
+	if (! bFromSnapshot)
+		return NULL;
+	
+	GKeyFile *pFullKeyFile = g_key_file_new ();
+	g_key_file_load_from_file (pFullKeyFile, cConfFilePath, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, NULL);  // if it's gone, the values are written as they are.
+	gchar **pGroupList, **pKeyList, *cValue, *cComment;
+	int i, j;
+	
+	//\______________ remove what has been removed from the key-file.
+	pGroupList = g_key_file_get_groups (pFullKeyFile, NULL);
+	for (i = 0; pGroupList[i] != NULL; i ++)
+	{
+		if (! g_key_file_has_group (pKeyFile, pGroupList[i]))
+		{
+			g_key_file_remove_group (pFullKeyFile, pGroupList[i], NULL);
+			continue;
+		}
+		pKeyList = g_key_file_get_keys (pFullKeyFile, pGroupList[i], NULL, NULL);
+		for (j = 0; pKeyList != NULL && pKeyList[j] != NULL; j ++)
+		{
+			if (! g_key_file_has_key (pKeyFile, pGroupList[i], pKeyList[j], NULL))
+				g_key_file_remove_key (pFullKeyFile, pGroupList[i], pKeyList[j], NULL);
+		}
+		g_strfreev (pKeyList);
+	}
+	g_strfreev (pGroupList);
+	
+	//\______________ set its values, with the comments of the keys that have been added.
+	pGroupList = g_key_file_get_groups (pKeyFile, NULL);
+	for (i = 0; pGroupList[i] != NULL; i ++)
+	{
+		pKeyList = g_key_file_get_keys (pKeyFile, pGroupList[i], NULL, NULL);
+		for (j = 0; pKeyList != NULL && pKeyList[j] != NULL; j ++)
+		{
+			cComment = (g_key_file_has_key (pFullKeyFile, pGroupList[i], pKeyList[j], NULL) ? NULL : g_key_file_get_comment (pKeyFile, pGroupList[i], pKeyList[j], NULL));
+			cValue = g_key_file_get_value (pKeyFile, pGroupList[i], pKeyList[j], NULL);
+			g_key_file_set_value (pFullKeyFile, pGroupList[i], pKeyList[j], cValue != NULL ? cValue : "");
+			if (cComment != NULL)
+				g_key_file_set_comment (pFullKeyFile, pGroupList[i], pKeyList[j], cComment, NULL);
+			g_free (cValue);
+			g_free (cComment);
+		}
+		g_strfreev (pKeyList);
+	}
+	g_strfreev (pGroupList);
+	cComment = g_key_file_get_comment (pKeyFile, NULL, NULL, NULL);  // the version.
+	if (cComment != NULL)
+		g_key_file_set_comment (pFullKeyFile, NULL, NULL, cComment, NULL);
+	g_free (cComment);
+	return pFullKeyFile;
+}
+
+// the values of a conf file and the comment on top that holds its version, as a key-file; NULL if it can't be read, or if it holds a password.
+static gchar *_get_resolved_content (const gchar *cConfFilePath, gsize *iLength)
 {
 	GKeyFile *pKeyFile = g_key_file_new ();
+	if (! g_key_file_load_from_file (pKeyFile, cConfFilePath, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, NULL))
+	{
+		g_key_file_free (pKeyFile);
+		return NULL;
+	}
+	GKeyFile *pValuesKeyFile = g_key_file_new ();
+	gchar *cComment = g_key_file_get_comment (pKeyFile, NULL, NULL, NULL);
+	if (cComment != NULL)
+		g_key_file_set_comment (pValuesKeyFile, NULL, NULL, cComment, NULL);
+	g_free (cComment);
+	
+	gboolean bHasPassword = FALSE;
+	gchar **pGroupList = g_key_file_get_groups (pKeyFile, NULL), **pKeyList;
+	gchar *cValue, *cType;
+	int i, j;
+	for (i = 0; pGroupList[i] != NULL && ! bHasPassword; i ++)
+	{
+		pKeyList = g_key_file_get_keys (pKeyFile, pGroupList[i], NULL, NULL);
+		if (pKeyList == NULL || pKeyList[0] == NULL)  // keep the empty groups, someone may check that they're here.
+		{
+			g_key_file_set_value (pValuesKeyFile, pGroupList[i], "_", "");
+			g_key_file_remove_key (pValuesKeyFile, pGroupList[i], "_", NULL);
+		}
+		for (j = 0; pKeyList != NULL && pKeyList[j] != NULL && ! bHasPassword; j ++)
+		{
+			cComment = g_key_file_get_comment (pKeyFile, pGroupList[i], pKeyList[j], NULL);
+			for (cType = cComment; cType != NULL && (*cType == '#' || *cType == ' ' || *cType == '\n'); cType ++);  // the type of widget, as the config panel gets it.
+			bHasPassword = (cType != NULL && *cType == CAIRO_DOCK_WIDGET_PASSWORD_ENTRY);
+			g_free (cComment);
+			
+			cValue = g_key_file_get_value (pKeyFile, pGroupList[i], pKeyList[j], NULL);
+			g_key_file_set_value (pValuesKeyFile, pGroupList[i], pKeyList[j], cValue != NULL ? cValue : "");
+			g_free (cValue);
+		}
+		g_strfreev (pKeyList);
+	}
+	g_strfreev (pGroupList);
+	
+	gchar *cContent = (bHasPassword ? NULL : g_key_file_to_data (pValuesKeyFile, iLength, NULL));
+	g_key_file_free (pValuesKeyFile);
+	g_key_file_free (pKeyFile);
+	return cContent;
+}
+
+// add a conf file opened during the load to the new snapshot; return TRUE if its entry differs from the previous one.
+static gboolean _add_file_to_snapshot (const gchar *cConfFilePath, GByteArray *pSnapshot)
+{
+	CairoDockConfSnapshotEntry entry;
+	memset (&entry, 0, sizeof (CairoDockConfSnapshotEntry));
+	if (! _get_file_stamp (cConfFilePath, &entry.stamp))  // deleted in the meantime.
+		return TRUE;
+	
+	//\______________ take the content of the previous snapshot if the file hasn't changed since then, otherwise (new, or modified, for instance upgraded during the load) its current content.
+	const CairoDockConfSnapshotEntry *pEntry = (s_hSnapshotEntries != NULL ? g_hash_table_lookup (s_hSnapshotEntries, cConfFilePath) : NULL);
+	const gchar *cData = NULL;
+	gchar *cContent = NULL;
+	gsize iLength = 0;
+	gboolean bChanged = FALSE;
+	if (pEntry != NULL && _same_stamp (&entry.stamp, &pEntry->stamp))
+	{
+		if (pEntry->iDataOffset != 0)
+		{
+			cData = g_mapped_file_get_contents (s_pSnapshot) + pEntry->iDataOffset;
+			iLength = pEntry->iDataLength;
+		}
+	}
+	else
+	{
+		cData = cContent = _get_resolved_content (cConfFilePath, &iLength);  // if it's modified in the meantime, its stamp won't match at the next load anyway.
+		bChanged = TRUE;
+	}
+	
+	//\______________ append the path and the content, and fill the entry in the table reserved at the beginning.
+	entry.iPathOffset = pSnapshot->len;
+	g_byte_array_append (pSnapshot, (const guint8 *)cConfFilePath, strlen (cConfFilePath) + 1);
+	if (cData != NULL)
+	{
+		entry.iDataOffset = pSnapshot->len;
+		entry.iDataLength = iLength;
+		g_byte_array_append (pSnapshot, (const guint8 *)cData, iLength);
+	}
+	g_free (cContent);
+	
+	CairoDockConfSnapshotHeader *pHeader = (CairoDockConfSnapshotHeader *)pSnapshot->data;  // the array may have been reallocated.
+	CairoDockConfSnapshotEntry *pEntries = (CairoDockConfSnapshotEntry *)(pHeader + 1);
+	pEntries[pHeader->iNbEntries] = entry;
+	pHeader->iNbEntries ++;
+	return bChanged;
+}
+
+static void _save_snapshot (GByteArray *pSnapshot)
+{
+	gchar *cSnapshotPath = _get_snapshot_path ();
+	gchar *cSnapshotDir = g_path_get_dirname (cSnapshotPath);
+	gchar *cTmpPath = g_strdup_printf ("%s.tmp", cSnapshotPath);
+	if (g_mkdir_with_parents (cSnapshotDir, 7*8*8) != 0)
+		cd_warning ("couldn't create the folder '%s', the snapshot of the conf files will not be saved", cSnapshotDir);
+	else if (! _write_private_file (cTmpPath, O_TRUNC, (const gchar *)pSnapshot->data, pSnapshot->len)
+	|| g_rename (cTmpPath, cSnapshotPath) != 0)  // replace it atomically, so that the current mapping stays valid.
+	{
+		cd_warning ("couldn't save the snapshot of the conf files (%s)", cSnapshotPath);
+		g_remove (cTmpPath);
+	}
+	g_free (cTmpPath);
+	g_free (cSnapshotDir);
+	g_free (cSnapshotPath);
+}
+
+void cairo_dock_end_conf_files_snapshot (void)
+{
+	_lock_snapshot ();
+	if (s_cSnapshotDir == NULL)
+	{
+		_unlock_snapshot ();
+		return;
+	}
+	guint iNbFiles = g_hash_table_size (s_hSnapshotFiles);
+	cd_message ("conf files: %d/%d taken from the snapshot", s_iNbSnapshotHits, iNbFiles);
+	
+	//\______________ make the new snapshot, and save it if any file has changed.
+	gboolean bChanged = (s_hSnapshotEntries == NULL || iNbFiles != g_hash_table_size (s_hSnapshotEntries));
+	GByteArray *pSnapshot = g_byte_array_sized_new (sizeof (CairoDockConfSnapshotHeader) + iNbFiles * sizeof (CairoDockConfSnapshotEntry) + 64 * 1024);
+	CairoDockConfSnapshotHeader header = {CAIRO_DOCK_CONF_SNAPSHOT_MAGIC, CAIRO_DOCK_CONF_SNAPSHOT_VERSION, 0, 0};
+	g_byte_array_append (pSnapshot, (const guint8 *)&header, sizeof (CairoDockConfSnapshotHeader));
+	g_byte_array_set_size (pSnapshot, sizeof (CairoDockConfSnapshotHeader) + iNbFiles * sizeof (CairoDockConfSnapshotEntry));
+	GHashTableIter iter;
+	gpointer cConfFilePath;
+	g_hash_table_iter_init (&iter, s_hSnapshotFiles);
+	while (g_hash_table_iter_next (&iter, &cConfFilePath, NULL))
+	{
+		if (_add_file_to_snapshot (cConfFilePath, pSnapshot))
+			bChanged = TRUE;
+	}
+	if (bChanged)
+		_save_snapshot (pSnapshot);
+	g_byte_array_free (pSnapshot, TRUE);
+	
+	//\______________ and forget the current one.
+	g_hash_table_destroy (s_hSnapshotFiles);
+	s_hSnapshotFiles = NULL;
+	g_hash_table_destroy (s_hSnapshotKeyFiles);  // the key-files still in use are complete again when written.
+	s_hSnapshotKeyFiles = NULL;
+	if (s_hSnapshotEntries != NULL)
+	{
+		g_hash_table_destroy (s_hSnapshotEntries);
+		s_hSnapshotEntries = NULL;
+	}
+	if (s_pSnapshot != NULL)
+	{
+		g_mapped_file_unref (s_pSnapshot);
+		s_pSnapshot = NULL;
+	}
+	g_free (s_cSnapshotDir);
+	s_cSnapshotDir = NULL;
+	_unlock_snapshot ();
+}
+
+
+GKeyFile *cairo_dock_open_key_file (const gchar *cConfFilePath)
+{
+	cairo_dock_flush_conf_file (cConfFilePath);  // get the latest values.
+	
+	GKeyFile *pKeyFile = _open_key_file_from_snapshot (cConfFilePath);
+	if (pKeyFile != NULL)
+		return pKeyFile;
+	
+	pKeyFile = g_key_file_new ();
 	GError *erreur = NULL;
 	g_key_file_load_from_file (pKeyFile, cConfFilePath, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, &erreur);
 	if (erreur != NULL)
@@ -40,8 +755,21 @@ GKeyFile *cairo_dock_open_key_file (const gchar *cConfFilePath)
 }
 
 void cairo_dock_write_keys_to_file (GKeyFile *pKeyFile, const gchar *cConfFilePath)
+{
+	cairo_dock_discard_conf_file (cConfFilePath);  // the pending updates would be overwritten anyway.
+	_write_keys_to_file (pKeyFile, cConfFilePath);
+}
+
+static void _write_keys_to_file (GKeyFile *pKeyFile, const gchar *cConfFilePath)
 {
 	cd_debug ("%s (%s)", __func__, cConfFilePath);
+	GKeyFile *pFullKeyFile = _restore_comments (pKeyFile, cConfFilePath);
+	if (pFullKeyFile != NULL)
+	{
+		_write_keys_to_file (pFullKeyFile, cConfFilePath);
+		g_key_file_free (pFullKeyFile);
+		return;
+	}
 	GError *erreur = NULL;
 
 	gchar *cDirectory = g_path_get_dirname (cConfFilePath);
@@ -171,6 +899,12 @@ void cairo_dock_merge_conf_files (const gchar *cConfFilePath, gchar *cReplacemen
 {
 	GKeyFile *pOriginalKeyFile = cairo_dock_open_key_file (cConfFilePath);
 	g_return_if_fail (pOriginalKeyFile != NULL);
+	GKeyFile *pFullKeyFile = _restore_comments (pOriginalKeyFile, cConfFilePath);  // its comments tell which keys to merge.
+	if (pFullKeyFile != NULL)
+	{
+		g_key_file_free (pOriginalKeyFile);
+		pOriginalKeyFile = pFullKeyFile;
+	}
 	GKeyFile *pReplacementKeyFile = cairo_dock_open_key_file (cReplacementConfFilePath);
 	g_return_if_fail (pReplacementKeyFile != NULL);
 	
@@ -255,11 +989,14 @@ void cairo_dock_upgrade_conf_file_full (const gchar *cConfFilePath, GKeyFile *pK
 	GKeyFile *pUptodateKeyFile = cairo_dock_open_key_file (cDefaultConfFilePath);
 	g_return_if_fail (pUptodateKeyFile != NULL);
 	
-	_cairo_dock_replace_key_values (pKeyFile, pUptodateKeyFile, bUpdateKeys);
+	GKeyFile *pFullKeyFile = _restore_comments (pKeyFile, cConfFilePath);  // the comments of the old keys tell which ones to keep.
+	_cairo_dock_replace_key_values (pFullKeyFile != NULL ? pFullKeyFile : pKeyFile, pUptodateKeyFile, bUpdateKeys);
 	
 	cairo_dock_write_keys_to_file (pUptodateKeyFile, cConfFilePath);
 	
 	g_key_file_free (pUptodateKeyFile);
+	if (pFullKeyFile != NULL)
+		g_key_file_free (pFullKeyFile);
 }
 
 
@@ -403,9 +1140,21 @@ void cairo_dock_update_keyfile_va_args (const gchar *cConfFilePath, GType iFirst
 {
 	cd_message ("%s (%s)", __func__, cConfFilePath);
 	
-	GKeyFile *pKeyFile = g_key_file_new ();  // if the key-file doesn't exist, it will be created.
-	g_key_file_load_from_file (pKeyFile, cConfFilePath, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, NULL);
+	//\_____________ get the file in memory, or load it.
+	_lock_pending_conf_files ();
+	if (s_hPendingConfFiles == NULL)
+		s_hPendingConfFiles = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) _free_pending_conf_file);
+	CairoDockPendingConfFile *pPendingFile = g_hash_table_lookup (s_hPendingConfFiles, cConfFilePath);
+	if (pPendingFile == NULL)
+	{
+		pPendingFile = g_new0 (CairoDockPendingConfFile, 1);
+		pPendingFile->pKeyFile = g_key_file_new ();  // if the key-file doesn't exist, it will be created.
+		pPendingFile->bExisted = g_key_file_load_from_file (pPendingFile->pKeyFile, cConfFilePath, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, NULL);
+		g_hash_table_insert (s_hPendingConfFiles, g_strdup (cConfFilePath), pPendingFile);
+	}
+	GKeyFile *pKeyFile = pPendingFile->pKeyFile;
 	
+	//\_____________ set the values.
 	GType iType = iFirstDataType;
 	gboolean bValue;
 	gint iValue;
@@ -439,11 +1188,22 @@ void cairo_dock_update_keyfile_va_args (const gchar *cConfFilePath, GType iFirst
 			break ;
 		}
 
+		if (s_cJournalPath != NULL && _is_journaled_key (cGroupName, cGroupKey))
+		{
+			cValue = g_key_file_get_value (pKeyFile, cGroupName, cGroupKey, NULL);  // as written in the file.
+			_add_journal_entry (cConfFilePath, pPendingFile->bExisted, cGroupName, cGroupKey, cValue);
+			g_free (cValue);
+			pPendingFile->bJournaled = TRUE;
+		}
+		
 		iType = va_arg (args, GType);
 	}
-
-	cairo_dock_write_keys_to_file (pKeyFile, cConfFilePath);
-	g_key_file_free (pKeyFile);
+	
+	//\_____________ and write it a bit later.
+	s_iNbUpdates ++;
+	if (s_iSidWriteConfFiles == 0)
+		s_iSidWriteConfFiles = g_timeout_add_seconds (CAIRO_DOCK_CONF_FILE_WRITE_DELAY, _write_conf_files_idle, NULL);
+	_unlock_pending_conf_files ();
 }
 
 void cairo_dock_update_keyfile (const gchar *cConfFilePath, GType iFirstDataType, ...)  // type, groupe, cle, valeur, etc. finir par G_TYPE_INVALID.
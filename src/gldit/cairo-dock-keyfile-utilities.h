@@ -88,10 +88,39 @@ gchar * cairo_dock_get_locale_string_from_conf_file (GKeyFile *pKeyFile, const g
 void cairo_dock_update_keyfile_va_args (const gchar *cConfFilePath, GType iFirstDataType, va_list args);
 
 /** Update a conf file with a list of values of the form : {type, name of the groupe, name of the key, value}. Must end with G_TYPE_INVALID.
+*The file is updated in memory, and written on the disk a few seconds later, so that successive updates are written at once. Opening or writing it with the functions above gets the updated values.
 *@param cConfFilePath path to the conf file.
 *@param iFirstDataType type of the first value.
 */
 void cairo_dock_update_keyfile (const gchar *cConfFilePath, GType iFirstDataType, ...);
 
+/** Write the pending updates of a conf file on the disk now. Call it before accessing the file other than with the functions above (copy, etc).
+*@param cConfFilePath path to the conf file.
+*/
+void cairo_dock_flush_conf_file (const gchar *cConfFilePath);
+
+/** Write the pending updates of all the conf files on the disk now.
+*/
+void cairo_dock_flush_conf_files (void);
+
+/** Forget the pending updates of a conf file, because it is going to be deleted or overwritten.
+*@param cConfFilePath path to the conf file.
+*/
+void cairo_dock_discard_conf_file (const gchar *cConfFilePath);
+
+/** Start taking the conf files of a theme opened with cairo_dock_open_key_file from the snapshot of the previous load, when they haven't changed since then. Such key-files only have the values and the version of the file; they get their comments back when they're written or upgraded. Call it before loading the theme.
+*@param cThemeDir folder of the theme; only the conf files inside are taken from the snapshot.
+*/
+void cairo_dock_begin_conf_files_snapshot (const gchar *cThemeDir);
+
+/** Stop using the snapshot of the conf files, and replace it with the conf files opened since cairo_dock_begin_conf_files_snapshot if any of them has changed.
+*/
+void cairo_dock_end_conf_files_snapshot (void);
+
+/** Keep a journal of the pending updates of the order and the parent dock of the icons, so that they can be written at the next startup if the dock is stopped before. If a journal has been left by the previous session, its updates are written first. Call it before loading a theme.
+*@param cJournalPath path to the journal.
+*/
+void cairo_dock_set_conf_files_journal (const gchar *cJournalPath);
+
 G_END_DECLS
 #endif
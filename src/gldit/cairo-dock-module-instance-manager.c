@@ -51,7 +51,12 @@ static GldiModuleInstance *s_pUsedSlots[CAIRO_DOCK_NB_DATA_SLOT+1];
 
 GldiModuleInstance *gldi_module_instance_new (GldiModule *pModule, gchar *cConfFilePah)  // The module-instance takes ownership of the path
 {
-	GldiModuleInstanceAttr attr = {pModule, cConfFilePah};
+	return gldi_module_instance_new_full (pModule, cConfFilePah, NULL);
+}
+
+GldiModuleInstance *gldi_module_instance_new_full (GldiModule *pModule, gchar *cConfFilePah, GKeyFile *pKeyFile)
+{
+	GldiModuleInstanceAttr attr = {pModule, cConfFilePah, pKeyFile};
 	
 	GldiModuleInstance *pInstance = g_malloc0 (sizeof (GldiModuleInstance) + pModule->pVisitCard->iSizeOfConfig + pModule->pVisitCard->iSizeOfData);  // we allocate everything at once, since config and data will anyway live as long as the instance itself.
 	gldi_object_init (GLDI_OBJECT(pInstance), &myModuleInstanceObjectMgr, &attr);
@@ -84,15 +89,24 @@ static void _read_module_config (GKeyFile *pKeyFile, GldiModuleInstance *pInstan
 	}
 }
 
-GKeyFile *gldi_module_instance_open_conf_file (GldiModuleInstance *pInstance, CairoDockMinimalAppletConfig *pMinimalConfig)
+GKeyFile *gldi_module_instance_prepare_conf_file (G_GNUC_UNUSED GldiModule *pModule, const gchar *cConfFilePath)
+{
+	return cairo_dock_open_key_file (cConfFilePath);  // the upgrade, if any, is done once the module has read its config (it may pick up the values of renamed keys there).
+}
+
+static GKeyFile *_open_conf_file (GldiModuleInstance *pInstance, GKeyFile *pKeyFile, CairoDockMinimalAppletConfig *pMinimalConfig)
 {
-	g_return_val_if_fail (pInstance != NULL, NULL);
 	//\____________________ we open its config file.
 	if (pInstance->cConfFilePath == NULL)  // no config file (e.g. xxx-integration).
+	{
+		if (pKeyFile != NULL)
+			g_key_file_free (pKeyFile);
 		return NULL;
+	}
 	gchar *cInstanceConfFilePath = pInstance->cConfFilePath;
 	
-	GKeyFile *pKeyFile = cairo_dock_open_key_file (cInstanceConfFilePath);
+	if (pKeyFile == NULL)
+		pKeyFile = cairo_dock_open_key_file (cInstanceConfFilePath);
 	if (pKeyFile == NULL)  // unreadable file.
 		return NULL;
 	
@@ -234,6 +248,12 @@ GKeyFile *gldi_module_instance_open_conf_file (GldiModuleInstance *pInstance, Ca
 	return pKeyFile;
 }
 
+GKeyFile *gldi_module_instance_open_conf_file (GldiModuleInstance *pInstance, CairoDockMinimalAppletConfig *pMinimalConfig)
+{
+	g_return_val_if_fail (pInstance != NULL, NULL);
+	return _open_conf_file (pInstance, NULL, pMinimalConfig);
+}
+
 void gldi_module_instance_free_generic_config (CairoDockMinimalAppletConfig *pMinimalConfig)
 {
 	if (pMinimalConfig == NULL)
@@ -386,7 +406,7 @@ static void init_object (GldiObject *obj, gpointer attr)
 	
 	//\____________________ open the conf file.
 	CairoDockMinimalAppletConfig *pMinimalConfig = g_new0 (CairoDockMinimalAppletConfig, 1);
-	GKeyFile *pKeyFile = gldi_module_instance_open_conf_file (pInstance, pMinimalConfig);
+	GKeyFile *pKeyFile = _open_conf_file (pInstance, mattr->pKeyFile, pMinimalConfig);
 	if (pInstance->cConfFilePath != NULL && pKeyFile == NULL)  // we have a conf file, but it was unreadable -> cancel
 	{
 		cd_warning ("unreadable config file (%s) for applet %s", pInstance->cConfFilePath, pModule->pVisitCard->cModuleName);
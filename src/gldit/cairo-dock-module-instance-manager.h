@@ -79,6 +79,7 @@ struct _GldiModuleInstance {
 struct _GldiModuleInstanceAttr {
 	GldiModule *pModule;
 	gchar *cConfFilePath;
+	GKeyFile *pKeyFile;  // conf file already opened, or NULL
 };
 
 
@@ -91,6 +92,21 @@ struct _GldiModuleInstanceAttr {
 
 GldiModuleInstance *gldi_module_instance_new (GldiModule *pModule, gchar *cConfFilePah);
 
+/** Create a new instance of a module, from a conf file that has already been opened (see gldi_module_instance_prepare_conf_file).
+*@param pModule the module
+*@param cConfFilePah path to the conf file of the instance; the instance takes ownership of it
+*@param pKeyFile the conf file, or NULL to open it; it is freed by the function
+*@return the new instance
+*/
+GldiModuleInstance *gldi_module_instance_new_full (GldiModule *pModule, gchar *cConfFilePah, GKeyFile *pKeyFile);
+
+/** Open and parse the conf file of a future instance of a module. It doesn't touch anything else, so it can be called from a thread. The file is not upgraded here: it's done on the main thread once the instance has read its config.
+*@param pModule the module
+*@param cConfFilePath path to the conf file
+*@return the conf file, or NULL if it's unreadable
+*/
+GKeyFile *gldi_module_instance_prepare_conf_file (GldiModule *pModule, const gchar *cConfFilePath);
+
 GKeyFile *gldi_module_instance_open_conf_file (GldiModuleInstance *pInstance, CairoDockMinimalAppletConfig *pMinimalConfig);
 
 void gldi_module_instance_free_generic_config (CairoDockMinimalAppletConfig *pMinimalConfig);
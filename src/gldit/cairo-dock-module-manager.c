@@ -27,6 +27,7 @@
 #include "cairo-dock-dock-manager.h"
 #include "cairo-dock-themes-manager.h"  // cairo_dock_add_conf_file
 #include "cairo-dock-file-manager.h"  // cairo_dock_copy_file
+#include "cairo-dock-keyfile-utilities.h"  // cairo_dock_write_keys_to_file
 #include "cairo-dock-log.h"
 #include "cairo-dock-applet-manager.h"
 #include "cairo-dock-desktop-manager.h"  // gldi_desktop_get_width
@@ -54,6 +55,12 @@ extern gboolean g_bEasterEggs;
 static GHashTable *s_hModuleTable = NULL;
 static GList *s_AutoLoadedModules = NULL;
 static guint s_iSidWriteModules = 0;
+static GKeyFile *s_pManifest = NULL;  // cached visit cards of the modules
+static gboolean s_bManifestChanged = FALSE;
+static GStringChunk *s_pManifestStrings = NULL;  // strings of the visit cards read from the manifest
+
+#define CAIRO_DOCK_MODULES_MANIFEST "modules-manifest"
+#define CAIRO_DOCK_MODULES_MANIFEST_VERSION 1
 
 
   ///////////////
@@ -134,6 +141,190 @@ void gldi_modules_write_active (void)
 }
 
 
+  ////////////////
+ /// MANIFEST ///
+////////////////
+
+// The manifest caches the visit card of each module, so that the modules that are not active don't have to be loaded just to be listed.
+// Each module is a group named after the path of its .so file, and the entry is valid as long as the file keeps the same modification time and size.
+
+static gchar *_get_manifest_path (void)
+{
+	return g_strdup_printf ("%s/cairo-dock/%s", g_get_user_cache_dir (), CAIRO_DOCK_MODULES_MANIFEST);
+}
+
+static void _load_manifest (void)
+{
+	if (s_pManifest != NULL)
+		return;
+	s_pManifest = g_key_file_new ();
+	gchar *cManifestPath = _get_manifest_path ();
+	if (! g_key_file_load_from_file (s_pManifest, cManifestPath, G_KEY_FILE_NONE, NULL)
+	|| g_key_file_get_integer (s_pManifest, "Manifest", "version", NULL) != CAIRO_DOCK_MODULES_MANIFEST_VERSION)  // no manifest yet, or an old one -> start from scratch.
+	{
+		g_key_file_free (s_pManifest);
+		s_pManifest = g_key_file_new ();
+		g_key_file_set_integer (s_pManifest, "Manifest", "version", CAIRO_DOCK_MODULES_MANIFEST_VERSION);
+		s_bManifestChanged = TRUE;
+	}
+	g_free (cManifestPath);
+	if (s_pManifestStrings == NULL)
+		s_pManifestStrings = g_string_chunk_new (4096);
+}
+
+static void _save_manifest (const gchar *cModuleDirPath)
+{
+	g_return_if_fail (s_pManifest != NULL);
+	
+	//\______________ forget the modules of this folder that don't exist any more.
+	gchar **pGroups = g_key_file_get_groups (s_pManifest, NULL);
+	int i;
+	for (i = 0; pGroups[i] != NULL; i ++)
+	{
+		if (g_str_has_prefix (pGroups[i], cModuleDirPath) && ! g_file_test (pGroups[i], G_FILE_TEST_EXISTS))
+		{
+			g_key_file_remove_group (s_pManifest, pGroups[i], NULL);
+			s_bManifestChanged = TRUE;
+		}
+	}
+	g_strfreev (pGroups);
+	if (! s_bManifestChanged)
+		return;
+	
+	//\______________ write it down.
+	gchar *cManifestPath = _get_manifest_path ();
+	gchar *cManifestDir = g_path_get_dirname (cManifestPath);
+	if (g_mkdir_with_parents (cManifestDir, 7*8*8+7*8+5) == 0)
+		cairo_dock_write_keys_to_file (s_pManifest, cManifestPath);
+	else
+		cd_warning ("couldn't create the folder '%s', the modules manifest will not be saved", cManifestDir);
+	g_free (cManifestDir);
+	g_free (cManifestPath);
+	s_bManifestChanged = FALSE;
+}
+
+static inline void _set_manifest_string (const gchar *cGroup, const gchar *cKey, const gchar *cValue)
+{
+	if (cValue != NULL)
+		g_key_file_set_string (s_pManifest, cGroup, cKey, cValue);
+}
+static void _add_module_to_manifest (const gchar *cSoFilePath, GStatBuf *pStat, GldiVisitCard *pVisitCard)
+{
+	if (s_pManifest == NULL)  // not loading a folder of modules.
+		return;
+	g_key_file_remove_group (s_pManifest, cSoFilePath, NULL);  // remove the keys of the previous version.
+	
+	g_key_file_set_int64 (s_pManifest, cSoFilePath, "mtime", pStat->st_mtime);
+	g_key_file_set_int64 (s_pManifest, cSoFilePath, "size", pStat->st_size);
+	
+	_set_manifest_string (cSoFilePath, "name", pVisitCard->cModuleName);
+	gint iVersionNeeded[3] = {pVisitCard->iMajorVersionNeeded, pVisitCard->iMinorVersionNeeded, pVisitCard->iMicroVersionNeeded};
+	g_key_file_set_integer_list (s_pManifest, cSoFilePath, "version needed", iVersionNeeded, 3);
+	_set_manifest_string (cSoFilePath, "preview", pVisitCard->cPreviewFilePath);
+	_set_manifest_string (cSoFilePath, "gettext domain", pVisitCard->cGettextDomain);
+	_set_manifest_string (cSoFilePath, "dock version", pVisitCard->cDockVersionOnCompilation);
+	_set_manifest_string (cSoFilePath, "module version", pVisitCard->cModuleVersion);
+	_set_manifest_string (cSoFilePath, "user data dir", pVisitCard->cUserDataDir);
+	_set_manifest_string (cSoFilePath, "share data dir", pVisitCard->cShareDataDir);
+	_set_manifest_string (cSoFilePath, "conf file", pVisitCard->cConfFileName);
+	g_key_file_set_integer (s_pManifest, cSoFilePath, "category", pVisitCard->iCategory);
+	_set_manifest_string (cSoFilePath, "icon", pVisitCard->cIconFilePath);
+	g_key_file_set_integer (s_pManifest, cSoFilePath, "size of config", pVisitCard->iSizeOfConfig);
+	g_key_file_set_integer (s_pManifest, cSoFilePath, "size of data", pVisitCard->iSizeOfData);
+	g_key_file_set_boolean (s_pManifest, cSoFilePath, "multi-instance", pVisitCard->bMultiInstance);
+	_set_manifest_string (cSoFilePath, "description", pVisitCard->cDescription);
+	_set_manifest_string (cSoFilePath, "author", pVisitCard->cAuthor);
+	_set_manifest_string (cSoFilePath, "title", pVisitCard->cTitle);
+	g_key_file_set_integer (s_pManifest, cSoFilePath, "container type", pVisitCard->iContainerType);
+	g_key_file_set_boolean (s_pManifest, cSoFilePath, "static desklet size", pVisitCard->bStaticDeskletSize);
+	g_key_file_set_boolean (s_pManifest, cSoFilePath, "allow empty title", pVisitCard->bAllowEmptyTitle);
+	g_key_file_set_boolean (s_pManifest, cSoFilePath, "act as launcher", pVisitCard->bActAsLauncher);
+	s_bManifestChanged = TRUE;
+}
+
+static gboolean _check_visit_card (const gchar *cSoFilePath, GldiVisitCard *pVisitCard)
+{
+	if (! g_bEasterEggs &&
+		(pVisitCard->iMajorVersionNeeded > g_iMajorVersion
+		|| (pVisitCard->iMajorVersionNeeded == g_iMajorVersion && pVisitCard->iMinorVersionNeeded > g_iMinorVersion)
+		|| (pVisitCard->iMajorVersionNeeded == g_iMajorVersion && pVisitCard->iMinorVersionNeeded == g_iMinorVersion && pVisitCard->iMicroVersionNeeded > g_iMicroVersion)))
+	{
+		cd_warning ("this module ('%s') needs at least Cairo-Dock v%d.%d.%d, but Cairo-Dock is in v%d.%d.%d (%s)\n  It will be ignored", cSoFilePath, pVisitCard->iMajorVersionNeeded, pVisitCard->iMinorVersionNeeded, pVisitCard->iMicroVersionNeeded, g_iMajorVersion, g_iMinorVersion, g_iMicroVersion, GLDI_VERSION);
+		return FALSE;
+	}
+	if (! g_bEasterEggs
+	&& pVisitCard->cDockVersionOnCompilation != NULL && strcmp (pVisitCard->cDockVersionOnCompilation, GLDI_VERSION) != 0)  // separation des versions en easter egg.
+	{
+		cd_warning ("this module ('%s') was compiled with Cairo-Dock v%s, but Cairo-Dock is in v%s\n  It will be ignored", cSoFilePath, pVisitCard->cDockVersionOnCompilation, GLDI_VERSION);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static inline const gchar *_get_manifest_string (const gchar *cGroup, const gchar *cKey)
+{
+	gchar *cValue = g_key_file_get_string (s_pManifest, cGroup, cKey, NULL);
+	if (cValue == NULL)
+		return NULL;
+	const gchar *str = g_string_chunk_insert_const (s_pManifestStrings, cValue);  // the strings of a visit card are static.
+	g_free (cValue);
+	return str;
+}
+static GldiModule *_module_new_from_manifest (const gchar *cSoFilePath, GStatBuf *pStat)
+{
+	if (! g_key_file_has_group (s_pManifest, cSoFilePath))
+		return NULL;
+	if (g_key_file_get_int64 (s_pManifest, cSoFilePath, "mtime", NULL) != (gint64)pStat->st_mtime
+	|| g_key_file_get_int64 (s_pManifest, cSoFilePath, "size", NULL) != (gint64)pStat->st_size)  // the module has been updated.
+		return NULL;
+	
+	GldiVisitCard *pVisitCard = g_new0 (GldiVisitCard, 1);
+	pVisitCard->cModuleName = _get_manifest_string (cSoFilePath, "name");
+	gsize length = 0;
+	gint *iVersionNeeded = g_key_file_get_integer_list (s_pManifest, cSoFilePath, "version needed", &length, NULL);
+	if (pVisitCard->cModuleName == NULL || iVersionNeeded == NULL || length != 3)  // invalid entry, load the module.
+	{
+		g_free (iVersionNeeded);
+		cairo_dock_free_visit_card (pVisitCard);
+		return NULL;
+	}
+	pVisitCard->iMajorVersionNeeded = iVersionNeeded[0];
+	pVisitCard->iMinorVersionNeeded = iVersionNeeded[1];
+	pVisitCard->iMicroVersionNeeded = iVersionNeeded[2];
+	g_free (iVersionNeeded);
+	pVisitCard->cPreviewFilePath = _get_manifest_string (cSoFilePath, "preview");
+	pVisitCard->cGettextDomain = _get_manifest_string (cSoFilePath, "gettext domain");
+	pVisitCard->cDockVersionOnCompilation = _get_manifest_string (cSoFilePath, "dock version");
+	pVisitCard->cModuleVersion = _get_manifest_string (cSoFilePath, "module version");
+	pVisitCard->cUserDataDir = _get_manifest_string (cSoFilePath, "user data dir");
+	pVisitCard->cShareDataDir = _get_manifest_string (cSoFilePath, "share data dir");
+	pVisitCard->cConfFileName = _get_manifest_string (cSoFilePath, "conf file");
+	pVisitCard->iCategory = g_key_file_get_integer (s_pManifest, cSoFilePath, "category", NULL);
+	pVisitCard->cIconFilePath = _get_manifest_string (cSoFilePath, "icon");
+	pVisitCard->iSizeOfConfig = g_key_file_get_integer (s_pManifest, cSoFilePath, "size of config", NULL);
+	pVisitCard->iSizeOfData = g_key_file_get_integer (s_pManifest, cSoFilePath, "size of data", NULL);
+	pVisitCard->bMultiInstance = g_key_file_get_boolean (s_pManifest, cSoFilePath, "multi-instance", NULL);
+	pVisitCard->cDescription = _get_manifest_string (cSoFilePath, "description");
+	pVisitCard->cAuthor = _get_manifest_string (cSoFilePath, "author");
+	pVisitCard->cTitle = _get_manifest_string (cSoFilePath, "title");
+	pVisitCard->iContainerType = g_key_file_get_integer (s_pManifest, cSoFilePath, "container type", NULL);
+	pVisitCard->bStaticDeskletSize = g_key_file_get_boolean (s_pManifest, cSoFilePath, "static desklet size", NULL);
+	pVisitCard->bAllowEmptyTitle = g_key_file_get_boolean (s_pManifest, cSoFilePath, "allow empty title", NULL);
+	pVisitCard->bActAsLauncher = g_key_file_get_boolean (s_pManifest, cSoFilePath, "act as launcher", NULL);
+	
+	// check module compatibility (the dock may have been updated since then).
+	if (! _check_visit_card (cSoFilePath, pVisitCard))
+	{
+		cairo_dock_free_visit_card (pVisitCard);
+		return NULL;
+	}
+	
+	// register the module without loading it; its interface will be set when it's loaded.
+	GldiModuleAttr attr = {pVisitCard, g_new0 (GldiModuleInterface, 1), cSoFilePath, NULL};
+	return (GldiModule*)gldi_object_new (&myModuleObjectMgr, &attr);
+}
+
+
   /////////////////////
  /// MODULE LOADER ///
 /////////////////////
@@ -142,16 +333,12 @@ GldiModule *gldi_module_new (GldiVisitCard *pVisitCard, GldiModuleInterface *pIn
 {
 	g_return_val_if_fail (pVisitCard != NULL && pVisitCard->cModuleName != NULL, NULL);
 	
-	GldiModuleAttr attr = {pVisitCard, pInterface};
+	GldiModuleAttr attr = {pVisitCard, pInterface, NULL, NULL};
 	return (GldiModule*)gldi_object_new (&myModuleObjectMgr, &attr);
 }
 
-GldiModule *gldi_module_new_from_so_file (const gchar *cSoFilePath)
+static gpointer _open_so_file (const gchar *cSoFilePath, GldiVisitCard *pVisitCard, GldiModuleInterface *pInterface)
 {
-	g_return_val_if_fail (cSoFilePath != NULL, NULL);
-	GldiVisitCard *pVisitCard = NULL;
-	GldiModuleInterface *pInterface = NULL;
-	
 	// open the .so file
 	///GModule *module = g_module_open (pGldiModule->cSoFilePath, G_MODULE_BIND_LAZY | G_MODULE_BIND_LOCAL);
 	gpointer handle = dlopen (cSoFilePath, RTLD_LAZY | RTLD_LOCAL);
@@ -173,8 +360,6 @@ GldiModule *gldi_module_new_from_so_file (const gchar *cSoFilePath)
 	}
 	
 	// run the pre-init entry point to get the necessary info about the module
-	pVisitCard = g_new0 (GldiVisitCard, 1);
-	pInterface = g_new0 (GldiModuleInterface, 1);
 	gboolean bModuleLoaded = function_pre_init (pVisitCard, pInterface);
 	if (! bModuleLoaded)
 	{
@@ -183,33 +368,75 @@ GldiModule *gldi_module_new_from_so_file (const gchar *cSoFilePath)
 	}
 	
 	// check module compatibility
-	if (! g_bEasterEggs &&
-		(pVisitCard->iMajorVersionNeeded > g_iMajorVersion
-		|| (pVisitCard->iMajorVersionNeeded == g_iMajorVersion && pVisitCard->iMinorVersionNeeded > g_iMinorVersion)
-		|| (pVisitCard->iMajorVersionNeeded == g_iMajorVersion && pVisitCard->iMinorVersionNeeded == g_iMinorVersion && pVisitCard->iMicroVersionNeeded > g_iMicroVersion)))
-	{
-		cd_warning ("this module ('%s') needs at least Cairo-Dock v%d.%d.%d, but Cairo-Dock is in v%d.%d.%d (%s)\n  It will be ignored", cSoFilePath, pVisitCard->iMajorVersionNeeded, pVisitCard->iMinorVersionNeeded, pVisitCard->iMicroVersionNeeded, g_iMajorVersion, g_iMinorVersion, g_iMicroVersion, GLDI_VERSION);
+	if (! _check_visit_card (cSoFilePath, pVisitCard))
 		goto discard;
-	}
-	if (! g_bEasterEggs
-	&& pVisitCard->cDockVersionOnCompilation != NULL && strcmp (pVisitCard->cDockVersionOnCompilation, GLDI_VERSION) != 0)  // separation des versions en easter egg.
+	
+	return handle;
+	
+discard:
+	///g_module_close (pModule);
+	dlclose (handle);
+	return NULL;
+}
+
+static GldiModule *_module_new_from_so_file (const gchar *cSoFilePath, GStatBuf *pStat)
+{
+	GldiVisitCard *pVisitCard = g_new0 (GldiVisitCard, 1);
+	GldiModuleInterface *pInterface = g_new0 (GldiModuleInterface, 1);
+	gpointer handle = _open_so_file (cSoFilePath, pVisitCard, pInterface);
+	if (handle == NULL)
 	{
-		cd_warning ("this module ('%s') was compiled with Cairo-Dock v%s, but Cairo-Dock is in v%s\n  It will be ignored", cSoFilePath, pVisitCard->cDockVersionOnCompilation, GLDI_VERSION);
-		goto discard;
+		cairo_dock_free_visit_card (pVisitCard);
+		g_free (pInterface);
+		return NULL;
 	}
 	
 	// create a new module with these info
-	GldiModule *pModule = gldi_module_new (pVisitCard, pInterface);  // takes ownership of pVisitCard and pInterface
-	if (pModule)
-		pModule->handle = handle;
+	GldiModuleAttr attr = {pVisitCard, pInterface, cSoFilePath, handle};
+	GldiModule *pModule = (GldiModule*)gldi_object_new (&myModuleObjectMgr, &attr);  // takes ownership of pVisitCard and pInterface
+	
+	// remember its visit card for the next time, unless it will be loaded anyway.
+	if (pModule && pModule->pVisitCard && pStat && ! gldi_module_is_auto_loaded (pModule))
+		_add_module_to_manifest (cSoFilePath, pStat, pModule->pVisitCard);
 	return pModule;
+}
+
+GldiModule *gldi_module_new_from_so_file (const gchar *cSoFilePath)
+{
+	g_return_val_if_fail (cSoFilePath != NULL, NULL);
+	return _module_new_from_so_file (cSoFilePath, NULL);
+}
+
+gboolean gldi_module_load (GldiModule *pModule)
+{
+	g_return_val_if_fail (pModule != NULL, FALSE);
+	if (gldi_module_is_loaded (pModule))
+		return TRUE;
+	cd_debug ("%s (%s)", __func__, pModule->cSoFilePath);
 	
-discard:
-	///g_module_close (pModule);
-	dlclose (handle);
+	GldiVisitCard *pVisitCard = g_new0 (GldiVisitCard, 1);
+	GldiModuleInterface *pInterface = g_new0 (GldiModuleInterface, 1);
+	gpointer handle = _open_so_file (pModule->cSoFilePath, pVisitCard, pInterface);
+	if (handle != NULL && g_strcmp0 (pVisitCard->cModuleName, pModule->pVisitCard->cModuleName) != 0)  // the manifest was wrong, which shouldn't happen since the file hasn't changed.
+	{
+		cd_warning ("the module '%s' is now '%s', it will be ignored until the next start", pModule->pVisitCard->cModuleName, pVisitCard->cModuleName);
+		dlclose (handle);
+		handle = NULL;
+	}
+	if (handle == NULL)
+	{
+		cairo_dock_free_visit_card (pVisitCard);
+		g_free (pInterface);
+		return FALSE;
+	}
+	
+	// replace the cached visit card by the real one (the module name, which is the key in the table of modules, stays valid since the cached strings are never freed), and set the interface.
+	*pModule->pVisitCard = *pVisitCard;
 	cairo_dock_free_visit_card (pVisitCard);
+	*pModule->pInterface = *pInterface;
 	g_free (pInterface);
-	return NULL;
+	pModule->handle = handle;
+	return TRUE;
 }
 
 void gldi_modules_new_from_directory (const gchar *cModuleDirPath, GError **erreur)
@@ -225,9 +452,12 @@ void gldi_modules_new_from_directory (const gchar *cModuleDirPath, GError **erre
 		g_propagate_error (erreur, tmp_erreur);
 		return ;
 	}
-
+	
+	_load_manifest ();
+	
 	const gchar *cFileName;
 	GString *sFilePath = g_string_new ("");
+	GStatBuf st;
 	do
 	{
 		cFileName = g_dir_read_name (dir);
@@ -237,12 +467,17 @@ void gldi_modules_new_from_directory (const gchar *cModuleDirPath, GError **erre
 		if (g_str_has_suffix (cFileName, ".so"))
 		{
 			g_string_printf (sFilePath, "%s/%s", cModuleDirPath, cFileName);
-			(void)gldi_module_new_from_so_file (sFilePath->str);
+			if (g_stat (sFilePath->str, &st) != 0)
+				continue;
+			if (_module_new_from_manifest (sFilePath->str, &st) == NULL)  // not in the manifest, or it has changed -> load it to get its visit card.
+				(void)_module_new_from_so_file (sFilePath->str, &st);
 		}
 	}
 	while (1);
 	g_string_free (sFilePath, TRUE);
 	g_dir_close (dir);
+	
+	_save_manifest (cModuleDirPath);
 }
 
 gchar *gldi_module_get_config_dir (GldiModule *pModule)
@@ -283,97 +518,110 @@ void cairo_dock_free_visit_card (GldiVisitCard *pVisitCard)
  /// MODULES HIGH LEVEL///
 /////////////////////////
 
-void gldi_module_activate (GldiModule *module)
+static gboolean _get_instances_conf_files (GldiModule *module, GPtrArray *pConfFiles)
 {
-	g_return_if_fail (module != NULL && module->pVisitCard != NULL);
-	cd_debug ("%s (%s)", __func__, module->pVisitCard->cModuleName);
+	if (module->pVisitCard->cConfFileName == NULL)  // the module has no conf file, just instanciate it once.
+	{
+		g_ptr_array_add (pConfFiles, NULL);
+		return TRUE;
+	}
 	
-	if (module->pInstancesList != NULL)
+	// check that the module's config dir exists or create it.
+	gchar *cUserDataDirPath = gldi_module_get_config_dir (module);
+	if (cUserDataDirPath == NULL)
 	{
-		cd_warning ("Module %s already active", module->pVisitCard->cModuleName);
-		return ;
+		cd_warning ("Unable to open the config folder of module %s\nCheck permissions", module->pVisitCard->cModuleName);
+		return FALSE;
 	}
 	
-	if (module->pVisitCard->cConfFileName != NULL)  // the module has a conf file -> create an instance for each of them.
+	// look for conf files inside this folder, there will be an instance for each of them.
+	int n = 0;
+	if (module->pVisitCard->bMultiInstance)  // possibly several conf files.
 	{
-		// check that the module's config dir exists or create it.
-		gchar *cUserDataDirPath = gldi_module_get_config_dir (module);
-		if (cUserDataDirPath == NULL)
+		// open it
+		GError *tmp_erreur = NULL;
+		GDir *dir = g_dir_open (cUserDataDirPath, 0, &tmp_erreur);
+		if (tmp_erreur != NULL)
 		{
-			cd_warning ("Unable to open the config folder of module %s\nCheck permissions", module->pVisitCard->cModuleName);
-			return;
+			cd_warning ("couldn't open folder %s (%s)", cUserDataDirPath, tmp_erreur->message);
+			g_error_free (tmp_erreur);
+			g_free (cUserDataDirPath);
+			return FALSE;
 		}
 		
-		// look for conf files inside this folder, and create an instance for each of them.
-		int n = 0;
-		if (module->pVisitCard->bMultiInstance)  // possibly several conf files.
+		// for each conf file inside, the module will be instanciated with it.
+		const gchar *cFileName;
+		while ((cFileName = g_dir_read_name (dir)) != NULL)
 		{
-			// open it
-			GError *tmp_erreur = NULL;
-			GDir *dir = g_dir_open (cUserDataDirPath, 0, &tmp_erreur);
-			if (tmp_erreur != NULL)
-			{
-				cd_warning ("couldn't open folder %s (%s)", cUserDataDirPath, tmp_erreur->message);
-				g_error_free (tmp_erreur);
-				g_free (cUserDataDirPath);
-				return ;
-			}
-			
-			// for each conf file inside, instanciate the module with it.
-			const gchar *cFileName;
-			gchar *cInstanceFilePath;
-			
-			while ((cFileName = g_dir_read_name (dir)) != NULL)
-			{
-				gchar *str = strstr (cFileName, ".conf");
-				if (!str)
-					continue;
-				if (*(str+5) != '-' && *(str+5) != '\0')  // xxx.conf or xxx.conf-i
-					continue;
-				cInstanceFilePath = g_strdup_printf ("%s/%s", cUserDataDirPath, cFileName);
-				gldi_module_instance_new (module, cInstanceFilePath);  // takes ownership of 'cInstanceFilePath'.
-				n ++;
-			}
-			g_dir_close (dir);
+			gchar *str = strstr (cFileName, ".conf");
+			if (!str)
+				continue;
+			if (*(str+5) != '-' && *(str+5) != '\0')  // xxx.conf or xxx.conf-i
+				continue;
+			g_ptr_array_add (pConfFiles, g_strdup_printf ("%s/%s", cUserDataDirPath, cFileName));
+			n ++;
 		}
-		else  // only 1 conf file possible.
+		g_dir_close (dir);
+	}
+	else  // only 1 conf file possible.
+	{
+		gchar *cConfFilePath = g_strdup_printf ("%s/%s", cUserDataDirPath, module->pVisitCard->cConfFileName);
+		if (g_file_test (cConfFilePath, G_FILE_TEST_EXISTS))
 		{
-			gchar *cConfFilePath = g_strdup_printf ("%s/%s", cUserDataDirPath, module->pVisitCard->cConfFileName);
-			if (g_file_test (cConfFilePath, G_FILE_TEST_EXISTS))
-			{
-				gldi_module_instance_new (module, cConfFilePath);
-				n = 1;
-			}
-			else
-			{
-				g_free (cConfFilePath);
-			}
+			g_ptr_array_add (pConfFiles, cConfFilePath);
+			n = 1;
 		}
-		
-		// if no conf file was present, copy the default one and instanciate the module with it.
-		if (n == 0)  // no conf file was present.
+		else
 		{
-			gchar *cConfFilePath = g_strdup_printf ("%s/%s", cUserDataDirPath, module->pVisitCard->cConfFileName);
-			gboolean r = cairo_dock_copy_file (module->cConfFilePath, cConfFilePath);
-			if (! r)  // the copy failed.
-			{
-				cd_warning ("couldn't copy %s into %s; check permissions and file's existence", module->cConfFilePath, cUserDataDirPath);
-				g_free (cConfFilePath);
-				g_free (cUserDataDirPath);
-				return;
-			}
-			else
-			{
-				gldi_module_instance_new (module, cConfFilePath);
-			}
+			g_free (cConfFilePath);
 		}
-		
-		g_free (cUserDataDirPath);
 	}
-	else  // the module has no conf file, just instanciate it once.
+	
+	// if no conf file was present, copy the default one and instanciate the module with it.
+	if (n == 0)  // no conf file was present.
+	{
+		gchar *cConfFilePath = g_strdup_printf ("%s/%s", cUserDataDirPath, module->pVisitCard->cConfFileName);
+		gboolean r = cairo_dock_copy_file (module->cConfFilePath, cConfFilePath);
+		if (! r)  // the copy failed.
+		{
+			cd_warning ("couldn't copy %s into %s; check permissions and file's existence", module->cConfFilePath, cUserDataDirPath);
+			g_free (cConfFilePath);
+			g_free (cUserDataDirPath);
+			return FALSE;
+		}
+		g_ptr_array_add (pConfFiles, cConfFilePath);
+	}
+	
+	g_free (cUserDataDirPath);
+	return TRUE;
+}
+
+void gldi_module_activate (GldiModule *module)
+{
+	g_return_if_fail (module != NULL && module->pVisitCard != NULL);
+	cd_debug ("%s (%s)", __func__, module->pVisitCard->cModuleName);
+	
+	if (module->pInstancesList != NULL)
+	{
+		cd_warning ("Module %s already active", module->pVisitCard->cModuleName);
+		return ;
+	}
+	
+	if (! gldi_module_load (module))
 	{
-		gldi_module_instance_new (module, NULL);
+		cd_warning ("Unable to load the module %s", module->pVisitCard->cModuleName);
+		return;
 	}
+	
+	// create an instance for each conf file of the module.
+	GPtrArray *pConfFiles = g_ptr_array_new ();
+	if (_get_instances_conf_files (module, pConfFiles))
+	{
+		guint i;
+		for (i = 0; i < pConfFiles->len; i ++)
+			gldi_module_instance_new (module, g_ptr_array_index (pConfFiles, i));  // takes ownership of the path.
+	}
+	g_ptr_array_free (pConfFiles, TRUE);
 }
 
 void gldi_module_deactivate (GldiModule *module)  // stop all instances of a module
@@ -389,8 +637,84 @@ void gldi_module_deactivate (GldiModule *module)  // stop all instances of a mod
 }
 
 
+// At startup, the conf files of all the instances are opened and parsed on a pool of threads, while the instances are created one after the other on the main thread, in the order of activation; an instance only waits for its own conf file.
+typedef struct {
+	GldiModule *pModule;
+	gchar *cConfFilePath;  // NULL if the module has no conf file
+	GKeyFile *pKeyFile;  // prepared by a thread
+	gint64 iPrepareStart, iPrepareEnd;  // set by the thread
+	gint64 iInitStart, iInitEnd;  // set by the main thread
+	gboolean bPrepared;  // only used by the main thread
+	} GldiModuleInstanceStartup;
+
+static void _prepare_instance (GldiModuleInstanceStartup *pStartup, GAsyncQueue *pQueue)
+{
+	pStartup->iPrepareStart = g_get_monotonic_time ();
+	if (pStartup->cConfFilePath != NULL)
+		pStartup->pKeyFile = gldi_module_instance_prepare_conf_file (pStartup->pModule, pStartup->cConfFilePath);
+	pStartup->iPrepareEnd = g_get_monotonic_time ();
+	g_async_queue_push (pQueue, pStartup);
+}
+
+static void _schedule_module (GldiModule *pModule, GPtrArray *pStartups, GHashTable *pScheduledModules)
+{
+	if (pModule->pInstancesList != NULL  // already active
+	|| g_hash_table_lookup (pScheduledModules, pModule) != NULL)  // or already in the list
+		return;
+	g_hash_table_insert (pScheduledModules, pModule, pModule);
+	
+	if (! gldi_module_load (pModule))
+	{
+		cd_warning ("Unable to load the module %s", pModule->pVisitCard->cModuleName);
+		return;
+	}
+	GPtrArray *pConfFiles = g_ptr_array_new ();
+	if (_get_instances_conf_files (pModule, pConfFiles))
+	{
+		GldiModuleInstanceStartup *pStartup;
+		guint i;
+		for (i = 0; i < pConfFiles->len; i ++)
+		{
+			pStartup = g_new0 (GldiModuleInstanceStartup, 1);
+			pStartup->pModule = pModule;
+			pStartup->cConfFilePath = g_ptr_array_index (pConfFiles, i);
+			g_ptr_array_add (pStartups, pStartup);
+		}
+	}
+	g_ptr_array_free (pConfFiles, TRUE);
+}
+
+#define _ms(t) ((t) / 1000.)
+static void _show_startup_timeline (GPtrArray *pStartups, gint64 iStart, gint64 iEnd, int iNbThreads)
+{
+	cd_debug ("startup timeline of the modules (in ms):");
+	GldiModuleInstanceStartup *pStartup;
+	gint64 iInitTime = 0, iWaitTime = 0, iPrevious = iStart;
+	guint i;
+	for (i = 0; i < pStartups->len; i ++)
+	{
+		pStartup = g_ptr_array_index (pStartups, i);
+		cd_debug ("  %s (%s): prepared %.1f -> %.1f, initialized %.1f -> %.1f, waited %.1f",
+			pStartup->pModule->pVisitCard->cModuleName,
+			pStartup->cConfFilePath ? pStartup->cConfFilePath : "no conf file",
+			_ms (pStartup->iPrepareStart - iStart), _ms (pStartup->iPrepareEnd - iStart),
+			_ms (pStartup->iInitStart - iStart), _ms (pStartup->iInitEnd - iStart),
+			_ms (pStartup->iInitStart - iPrevious));
+		iWaitTime += pStartup->iInitStart - iPrevious;
+		iInitTime += pStartup->iInitEnd - pStartup->iInitStart;
+		iPrevious = pStartup->iInitEnd;
+	}
+	// the critical path is the main thread: it creates the instances one after the other, and only waits for the conf files that are not ready yet.
+	cd_debug ("  %d instances started in %.1fms on the main thread: %.1fms initializing, %.1fms listing or waiting for the conf files (prepared on %d threads)",
+		pStartups->len, _ms (iEnd - iStart), _ms (iInitTime), _ms (iWaitTime), iNbThreads);
+}
+
 void gldi_modules_activate_from_list (gchar **cActiveModuleList)
 {
+	gint64 iStart = g_get_monotonic_time ();
+	GPtrArray *pStartups = g_ptr_array_new ();
+	GHashTable *pScheduledModules = g_hash_table_new (g_direct_hash, g_direct_equal);
+	
 	//\_______________ On active les modules auto-charges en premier.
 	gchar *cModuleName;
 	GldiModule *pModule;
@@ -398,18 +722,12 @@ void gldi_modules_activate_from_list (gchar **cActiveModuleList)
 	for (m = s_AutoLoadedModules; m != NULL; m = m->next)
 	{
 		pModule = m->data;
-		if (pModule->pInstancesList == NULL)  // not yet active
-		{
-			gldi_module_activate (pModule);
-		}
+		_schedule_module (pModule, pStartups, pScheduledModules);
 	}
 	
-	if (cActiveModuleList == NULL)
-		return ;
-	
 	//\_______________ On active tous les autres.
 	int i;
-	for (i = 0; cActiveModuleList[i] != NULL; i ++)
+	for (i = 0; cActiveModuleList != NULL && cActiveModuleList[i] != NULL; i ++)
 	{
 		cModuleName = cActiveModuleList[i];
 		pModule = g_hash_table_lookup (s_hModuleTable, cModuleName);
@@ -418,12 +736,73 @@ void gldi_modules_activate_from_list (gchar **cActiveModuleList)
 			cd_debug ("No such module (%s)", cModuleName);
 			continue ;
 		}
-		
-		if (pModule->pInstancesList == NULL)  // not yet active
+		_schedule_module (pModule, pStartups, pScheduledModules);
+	}
+	g_hash_table_destroy (pScheduledModules);
+	
+	//\_______________ prepare the conf files on threads.
+	GAsyncQueue *pQueue = g_async_queue_new ();
+	#if GLIB_CHECK_VERSION (2, 36, 0)
+	int iNbThreads = MIN (g_get_num_processors (), (int)pStartups->len);
+	#else
+	int iNbThreads = MIN (4, (int)pStartups->len);
+	#endif
+	GThreadPool *pPool = NULL;
+	if (iNbThreads > 0)
+	{
+		GError *erreur = NULL;
+		pPool = g_thread_pool_new ((GFunc) _prepare_instance, pQueue, iNbThreads, FALSE, &erreur);
+		if (erreur != NULL)  // no thread, prepare them here.
 		{
-			gldi_module_activate (pModule);
+			cd_warning (erreur->message);
+			g_error_free (erreur);
+			iNbThreads = 0;
 		}
 	}
+	GldiModuleInstanceStartup *pStartup;
+	guint j;
+	for (j = 0; j < pStartups->len; j ++)
+	{
+		pStartup = g_ptr_array_index (pStartups, j);
+		if (pPool)
+			g_thread_pool_push (pPool, pStartup, NULL);
+		else
+			_prepare_instance (pStartup, pQueue);
+	}
+	
+	//\_______________ create the instances in order, as soon as their conf file is ready.
+	GldiModuleInstanceStartup *pPrepared;
+	gboolean bSkipModule = FALSE;
+	for (j = 0; j < pStartups->len; j ++)
+	{
+		pStartup = g_ptr_array_index (pStartups, j);
+		while (! pStartup->bPrepared)
+		{
+			pPrepared = g_async_queue_pop (pQueue);
+			pPrepared->bPrepared = TRUE;
+		}
+		pStartup->iInitStart = g_get_monotonic_time ();
+		if (j == 0 || ((GldiModuleInstanceStartup*)g_ptr_array_index (pStartups, j-1))->pModule != pStartup->pModule)  // first instance of this module
+			bSkipModule = (pStartup->pModule->pInstancesList != NULL);  // it has been activated in the meantime (by another module).
+		if (bSkipModule)
+		{
+			g_free (pStartup->cConfFilePath);
+			if (pStartup->pKeyFile != NULL)
+				g_key_file_free (pStartup->pKeyFile);
+		}
+		else
+			gldi_module_instance_new_full (pStartup->pModule, pStartup->cConfFilePath, pStartup->pKeyFile);  // takes ownership of the path and the key file.
+		pStartup->iInitEnd = g_get_monotonic_time ();
+	}
+	if (pPool)
+		g_thread_pool_free (pPool, FALSE, TRUE);
+	g_async_queue_unref (pQueue);
+	
+	if (pStartups->len != 0)
+		_show_startup_timeline (pStartups, iStart, g_get_monotonic_time (), iNbThreads);
+	for (j = 0; j < pStartups->len; j ++)
+		g_free (g_ptr_array_index (pStartups, j));
+	g_ptr_array_free (pStartups, TRUE);
 	
 	// don't write down
 	if (s_iSidWriteModules != 0)
@@ -600,6 +979,8 @@ static void init_object (GldiObject *obj, gpointer attr)
 	mattr->pVisitCard = NULL;
 	pModule->pInterface = mattr->pInterface;
 	mattr->pInterface = NULL;
+	pModule->cSoFilePath = g_strdup (mattr->cSoFilePath);
+	pModule->handle = mattr->handle;
 	if (pModule->cConfFilePath == NULL && pModule->pVisitCard->cConfFileName)
 		pModule->cConfFilePath = g_strdup_printf ("%s/%s", pModule->pVisitCard->cShareDataDir, pModule->pVisitCard->cConfFileName);
 	
@@ -631,6 +1012,7 @@ static void reset_object (GldiObject *obj)
 	// free data
 	if (pModule->handle)
 		dlclose (pModule->handle);
+	g_free (pModule->cSoFilePath);
 	g_free (pModule->pInterface);
 	cairo_dock_free_visit_card (pModule->pVisitCard);
 }
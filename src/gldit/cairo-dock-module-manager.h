@@ -47,9 +47,12 @@ extern GldiObjectManager myModuleObjectMgr;
 #endif
 
 
+// only filled by libgldi (see gldi_module_new).
 struct _GldiModuleAttr {
 	GldiVisitCard *pVisitCard;
 	GldiModuleInterface *pInterface;
+	const gchar *cSoFilePath;
+	gpointer handle;
 };
 
 // params
@@ -166,7 +169,9 @@ struct _GldiModule {
 	gpointer handle;
 	/// list of instances of the module.
 	GList *pInstancesList;
-	gpointer reserved[2];
+	/// path to this library, or NULL if the module is built-in. If the handle is NULL, the library has not been loaded yet (see gldi_module_load).
+	gchar *cSoFilePath;
+	gpointer reserved[1];
 };
 
 struct _CairoDockMinimalAppletConfig {
@@ -192,7 +197,12 @@ struct _CairoDockMinimalAppletConfig {
  // MODULE LOADER //
 ///////////////////
 
-#define gldi_module_is_auto_loaded(pModule) (pModule->pInterface->initModule == NULL || pModule->pInterface->stopModule == NULL || pModule->pVisitCard->cInternalModule != NULL)
+/** Say if the library of a module is loaded. A module that is not active may have been registered from the modules manifest only, in which case its interface is empty until it's loaded.
+*@param pModule the module
+*/
+#define gldi_module_is_loaded(pModule) (pModule->cSoFilePath == NULL || pModule->handle != NULL)
+
+#define gldi_module_is_auto_loaded(pModule) (gldi_module_is_loaded (pModule) && (pModule->pInterface->initModule == NULL || pModule->pInterface->stopModule == NULL || pModule->pVisitCard->cInternalModule != NULL))
 
 /** Create a new module. The module takes ownership of the 2 arguments, unless an error occured.
 * @param pVisitCard the visit card of the module
@@ -207,7 +217,14 @@ GldiModule *gldi_module_new (GldiVisitCard *pVisitCard, GldiModuleInterface *pIn
 */
 GldiModule *gldi_module_new_from_so_file (const gchar *cSoFilePath);
 
+/** Load the library of a module that has been registered from the modules manifest, so that its interface can be used. It is done automatically when the module is activated.
+* @param pModule the module
+* @return TRUE if the library is loaded.
+*/
+gboolean gldi_module_load (GldiModule *pModule);
+
 /** Create new modules from all the .so files contained in the given folder.
+* The visit cards of the modules are cached in a manifest; a module that is in the manifest and whose file hasn't changed is registered without loading its library.
 * @param cModuleDirPath path to the folder
 * @param erreur an error
 * @return the new module, or NULL if an error occured.
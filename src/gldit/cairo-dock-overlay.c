@@ -27,6 +27,8 @@
 #include "cairo-dock-draw.h"
 #include "cairo-dock-draw-opengl.h"
 #include "cairo-dock-image-buffer.h"
+#include "cairo-dock-surface-factory.h"  // cairo_dock_create_blank_surface
+#include "cairo-dock-container.h"
 #include "cairo-dock-log.h"
 #define _MANAGER_DEF_
 #include "cairo-dock-overlay.h"
@@ -51,6 +53,43 @@ CairoOverlay *gldi_overlay_new (CairoOverlayAttr *attr)
  /// ADD / REMOVE ///
 ////////////////////
 
+// In cairo, the image of an icon at rest and its overlays are drawn together on a surface, which is then painted at once on each frame; it's redrawn only when the image or an overlay is modified, or when the icon is resized. The surface is made of device pixels, so that it's not blurred when the context is scaled (desklets, HiDPI).
+// In OpenGL, each overlay is a single textured quad, which is as fast as drawing a composited texture, and compositing them would require to switch the framebuffer in the middle of a frame.
+typedef struct _CairoIconOverlaysCache {
+	cairo_surface_t *pSurface;  // the image and the overlays, or NULL if they have to be redrawn.
+	cairo_surface_t *pImageSurface;  // a reference on the image they were drawn with, so that a new image can't take its address.
+	gint iSurfaceWidth, iSurfaceHeight;
+	gdouble fScaleX, fScaleY;  // from the user space to device pixels, when they were drawn.
+	gdouble fWidth, fHeight;  // size of the icon when they were drawn.
+	gboolean bIsHorizontal;
+	gint w, h;  // extent of the icon, used to place the overlays.
+	gdouble z;  // and their zoom.
+	gboolean bDrawn;  // TRUE once the overlays have been drawn along with the image, until cairo_dock_draw_icon_overlays_cairo is called for this frame.
+	} CairoIconOverlaysCache;
+
+static void _invalidate_icon_overlays (Icon *pIcon)
+{
+	CairoIconOverlaysCache *pCache = pIcon->pOverlaysCache;
+	if (pCache != NULL && pCache->pSurface != NULL)
+	{
+		cairo_surface_destroy (pCache->pSurface);
+		pCache->pSurface = NULL;
+		cairo_surface_destroy (pCache->pImageSurface);
+		pCache->pImageSurface = NULL;
+	}
+}
+
+void cairo_dock_overlay_changed (CairoOverlay *pOverlay)
+{
+	if (pOverlay->pIcon != NULL)
+		_invalidate_icon_overlays (pOverlay->pIcon);
+}
+
+void cairo_dock_icon_image_changed (Icon *pIcon)
+{
+	_invalidate_icon_overlays (pIcon);
+}
+
 static inline void cairo_dock_add_overlay_to_icon (Icon *pIcon, CairoOverlay *pOverlay, CairoOverlayPosition iPosition, gpointer data)
 {
 	if (! pOverlay)
@@ -81,6 +120,7 @@ static inline void cairo_dock_add_overlay_to_icon (Icon *pIcon, CairoOverlay *pO
 	
 	// add the new overlay to the icon
 	pIcon->pOverlays = g_list_prepend (pIcon->pOverlays, pOverlay);
+	_invalidate_icon_overlays (pIcon);
 }
 
 CairoOverlay *cairo_dock_add_overlay_from_image (Icon *pIcon, const gchar *cImageFile, CairoOverlayPosition iPosition, gpointer data)
@@ -150,6 +190,9 @@ void cairo_dock_destroy_icon_overlays (Icon *pIcon)
 	pIcon->pOverlays = NULL;  // nullify the list to avoid unnecessary roundtrips.
 	g_list_foreach (pOverlays, (GFunc)gldi_object_unref, NULL);
 	g_list_free (pOverlays);
+	_invalidate_icon_overlays (pIcon);
+	g_free (pIcon->pOverlaysCache);
+	pIcon->pOverlaysCache = NULL;
 }
 
 
@@ -206,16 +249,8 @@ static void _get_overlay_position_and_size (CairoOverlay *pOverlay, int w, int h
 		break;
 	}
 }
-void cairo_dock_draw_icon_overlays_cairo (Icon *pIcon, double fRatio, cairo_t *pCairoContext)
+static void _draw_icon_overlays_cairo (Icon *pIcon, int w, int h, double z, cairo_t *pCairoContext, double fAlpha)
 {
-	if (pIcon->pOverlays == NULL)
-		return;
-	
-	int w, h;
-	cairo_dock_get_icon_extent (pIcon, &w, &h);
-	double fMaxScale = cairo_dock_get_icon_max_scale (pIcon);
-	double z = fRatio * pIcon->fScale / fMaxScale;
-	
 	GList* ov;
 	CairoOverlay *p;
 	int wo, ho;  // actual size at which the overlay will rendered.
@@ -249,12 +284,109 @@ void cairo_dock_draw_icon_overlays_cairo (Icon *pIcon, double fRatio, cairo_t *p
 		cairo_scale (pCairoContext,
 			(double) wo / p->image.iWidth,
 			(double) ho / p->image.iHeight);
-		cairo_dock_apply_image_buffer_surface_with_offset (&p->image, pCairoContext, 0., 0., pIcon->fAlpha);
+		cairo_dock_apply_image_buffer_surface_with_offset (&p->image, pCairoContext, 0., 0., fAlpha);
 		
 		cairo_restore (pCairoContext);
 	}
 }
 
+void cairo_dock_draw_icon_overlays_cairo (Icon *pIcon, double fRatio, cairo_t *pCairoContext)
+{
+	if (pIcon->pOverlays == NULL)
+		return;
+	
+	if (pIcon->pOverlaysCache != NULL && pIcon->pOverlaysCache->bDrawn)  // already drawn with the image of the icon.
+	{
+		pIcon->pOverlaysCache->bDrawn = FALSE;
+		return;
+	}
+	
+	int w, h;
+	cairo_dock_get_icon_extent (pIcon, &w, &h);
+	double fMaxScale = cairo_dock_get_icon_max_scale (pIcon);
+	double z = fRatio * pIcon->fScale / fMaxScale;
+	
+	_draw_icon_overlays_cairo (pIcon, w, h, z, pCairoContext, pIcon->fAlpha);
+}
+
+gboolean cairo_dock_draw_icon_and_overlays_cairo (Icon *pIcon, GldiContainer *pContainer, cairo_t *pCairoContext)
+{
+	if (pIcon->pOverlays == NULL || pIcon->image.pSurface == NULL)
+		return FALSE;
+	
+	//\______________ only an icon at rest can be cached, on a context that is not rotated nor flipped.
+	if (pIcon->fScale != 1 || pIcon->fGlideScale != 1 || pIcon->fWidthFactor != 1 || pIcon->fHeightFactor != 1 || pIcon->fOrientation != 0
+	|| cairo_dock_image_buffer_is_animated (&pIcon->image))
+		return FALSE;
+	double fScaleX = 1., dy = 0., dx = 0., fScaleY = 1.;
+	cairo_user_to_device_distance (pCairoContext, &fScaleX, &dy);
+	cairo_user_to_device_distance (pCairoContext, &dx, &fScaleY);
+	if (dx != 0 || dy != 0 || fScaleX <= 0 || fScaleY <= 0)
+		return FALSE;
+	#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE (1, 14, 0)
+	double fDeviceScaleX, fDeviceScaleY;  // scale of the target surface (HiDPI), not part of the matrix of the context.
+	cairo_surface_get_device_scale (cairo_get_target (pCairoContext), &fDeviceScaleX, &fDeviceScaleY);
+	fScaleX *= fDeviceScaleX;
+	fScaleY *= fDeviceScaleY;
+	#endif
+	
+	int w, h;
+	cairo_dock_get_icon_extent (pIcon, &w, &h);
+	double z = pContainer->fRatio / cairo_dock_get_icon_max_scale (pIcon);
+	gboolean bIsHorizontal = pContainer->bIsHorizontal;
+	double fWidth = (bIsHorizontal ? pIcon->fWidth : MAX (pIcon->fWidth, pIcon->fHeight));  // in a vertical container, the image is turned but not the overlays.
+	double fHeight = (bIsHorizontal ? pIcon->fHeight : fWidth);
+	int iWidth = ceil (fWidth * fScaleX), iHeight = ceil (fHeight * fScaleY);
+	
+	//\______________ draw them together if something has changed.
+	if (pIcon->pOverlaysCache == NULL)
+		pIcon->pOverlaysCache = g_new0 (CairoIconOverlaysCache, 1);
+	CairoIconOverlaysCache *pCache = pIcon->pOverlaysCache;
+	if (pCache->pSurface != NULL
+	&& (pCache->pImageSurface != pIcon->image.pSurface  // a new image has been loaded.
+		|| pCache->iSurfaceWidth != iWidth || pCache->iSurfaceHeight != iHeight || pCache->fScaleX != fScaleX || pCache->fScaleY != fScaleY
+		|| pCache->fWidth != pIcon->fWidth || pCache->fHeight != pIcon->fHeight || pCache->bIsHorizontal != bIsHorizontal
+		|| pCache->w != w || pCache->h != h || pCache->z != z))  // the icon or the context has been resized.
+		_invalidate_icon_overlays (pIcon);
+	if (pCache->pSurface == NULL)
+	{
+		pCache->pSurface = cairo_dock_create_blank_surface (iWidth, iHeight);
+		pCache->pImageSurface = cairo_surface_reference (pIcon->image.pSurface);
+		pCache->iSurfaceWidth = iWidth;
+		pCache->iSurfaceHeight = iHeight;
+		pCache->fScaleX = fScaleX;
+		pCache->fScaleY = fScaleY;
+		pCache->fWidth = pIcon->fWidth;
+		pCache->fHeight = pIcon->fHeight;
+		pCache->bIsHorizontal = bIsHorizontal;
+		pCache->w = w;
+		pCache->h = h;
+		pCache->z = z;
+		
+		cairo_t *ctx = cairo_create (pCache->pSurface);
+		cairo_scale (ctx, fScaleX, fScaleY);
+		cairo_save (ctx);
+		cairo_dock_set_icon_scale_on_context (ctx, pIcon, bIsHorizontal, 1., pContainer->bDirectionUp);  // as cairo_dock_draw_icon_cairo
+		cairo_set_source_surface (ctx, pIcon->image.pSurface, 0., 0.);
+		cairo_paint (ctx);
+		cairo_restore (ctx);
+		_draw_icon_overlays_cairo (pIcon, w, h, z, ctx, 1.);
+		cairo_destroy (ctx);
+	}
+	
+	//\______________ and paint them at once, pixel to pixel.
+	cairo_save (pCairoContext);
+	cairo_scale (pCairoContext, 1. / fScaleX, 1. / fScaleY);
+	cairo_set_source_surface (pCairoContext, pCache->pSurface, 0., 0.);
+	if (pIcon->fAlpha == 1)
+		cairo_paint (pCairoContext);
+	else
+		cairo_paint_with_alpha (pCairoContext, pIcon->fAlpha);
+	cairo_restore (pCairoContext);
+	pCache->bDrawn = TRUE;
+	return TRUE;
+}
+
 void cairo_dock_draw_icon_overlays_opengl (Icon *pIcon, double fRatio)
 {
 	if (pIcon->pOverlays == NULL)
@@ -364,6 +496,7 @@ static void cairo_dock_print_overlay_on_icon (Icon *pIcon, CairoOverlay *pOverla
 		cairo_paint (pCairoContext);
 		
 		cairo_destroy (pCairoContext);
+		cairo_dock_icon_image_changed (pIcon);
 	}
 }
 
@@ -444,6 +577,7 @@ static void reset_object (GldiObject *obj)
 	if (pIcon)
 	{
 		pIcon->pOverlays = g_list_remove (pIcon->pOverlays, pOverlay);
+		_invalidate_icon_overlays (pIcon);
 	}
 	
 	// free data
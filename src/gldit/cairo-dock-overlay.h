@@ -132,12 +132,17 @@ CairoOverlay *cairo_dock_add_overlay_from_texture (Icon *pIcon, GLuint iTexture,
  *@param pOverlay the overlay
  *@param _fScale the scale
  */
-#define cairo_dock_set_overlay_scale(pOverlay, _fScale) (pOverlay)->fScale = _fScale
+#define cairo_dock_set_overlay_scale(pOverlay, _fScale) (cairo_dock_overlay_changed (pOverlay), (pOverlay)->fScale = _fScale)
 
-/** Get the image buffer of an overlay (only useful if you need to redraw the overlay).
+/** Get the image buffer of an overlay (only useful if you need to redraw the overlay). The overlay will be redrawn on its icon at the next frame.
  *@param pOverlay the overlay
  */
-#define cairo_dock_get_overlay_image_buffer(pOverlay) (&(pOverlay)->image)
+#define cairo_dock_get_overlay_image_buffer(pOverlay) (cairo_dock_overlay_changed (pOverlay), &(pOverlay)->image)
+
+/** Tell that an overlay has been modified, so that it's redrawn on its icon.
+ *@param pOverlay the overlay
+ */
+void cairo_dock_overlay_changed (CairoOverlay *pOverlay);
 
 
 /** Remove an overlay from an icon, given its position and data.
@@ -156,6 +161,19 @@ void cairo_dock_destroy_icon_overlays (Icon *pIcon);
 
 void cairo_dock_draw_icon_overlays_cairo (Icon *pIcon, double fRatio, cairo_t *pCairoContext);
 
+/** Draw the image of an icon at rest and its overlays at once, from a surface where they are drawn together, which is redrawn only when one of them changes. The overlays are then not drawn again by \ref cairo_dock_draw_icon_overlays_cairo in this frame.
+ *@param pIcon the icon
+ *@param pContainer its container
+ *@param pCairoContext a context placed on the icon
+ *@return TRUE if the icon has been drawn; FALSE if it can't be drawn this way (it's not at rest, or the context is rotated), in which case nothing is drawn.
+ */
+gboolean cairo_dock_draw_icon_and_overlays_cairo (Icon *pIcon, GldiContainer *pContainer, cairo_t *pCairoContext);
+
+/** Tell that the image of an icon has been modified, so that it's redrawn along with its overlays. It's done by \ref cairo_dock_end_draw_icon_cairo and \ref cairo_dock_redraw_icon.
+ *@param pIcon the icon
+ */
+void cairo_dock_icon_image_changed (Icon *pIcon);
+
 void cairo_dock_draw_icon_overlays_opengl (Icon *pIcon, double fRatio);
 
 
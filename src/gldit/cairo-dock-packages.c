@@ -18,6 +18,7 @@
 */
 
 #include <string.h>
+#include <stdio.h>  // fopen
 #include <unistd.h>
 #define __USE_XOPEN_EXTENDED
 #include <stdlib.h>
@@ -29,7 +30,12 @@
 #include <curl/curl.h>
 
 #include "gldi-config.h"
+#ifdef HAVE_LIBARCHIVE
+#include <archive.h>
+#include <archive_entry.h>
+#endif
 #include "cairo-dock-keyfile-utilities.h"
+#include "cairo-dock-file-manager.h"  // cairo_dock_remove_directory
 #include "cairo-dock-task.h"
 #include "cairo-dock-config.h"
 #include "cairo-dock-log.h"
@@ -45,11 +51,96 @@ GldiManager myConnectionMgr;
 // private
 #define CAIRO_DOCK_DEFAULT_PACKAGES_LIST_FILE "list.conf"
 static gchar *s_cPackageServerAdress = NULL;
+static CURLSH *s_pCurlShare = NULL;  // DNS cache, TLS sessions and connections shared by all the transfers, so that successive downloads from the server don't reconnect each time.
 
+// curl may hold a lock on a kind of shared data while locking another one (e.g. the connections and the DNS cache), so each kind has its own mutex.
+#ifndef GLIB_VERSION_2_32
+static GStaticMutex s_mCurlShare[CURL_LOCK_DATA_LAST];  // initialized in init()
+#define _lock_curl_share(data) g_static_mutex_lock (&s_mCurlShare[data])
+#define _unlock_curl_share(data) g_static_mutex_unlock (&s_mCurlShare[data])
+#else
+static GMutex s_mCurlShare[CURL_LOCK_DATA_LAST];  // transfers are done in the threads of the tasks.
+#define _lock_curl_share(data) g_mutex_lock (&s_mCurlShare[data])
+#define _unlock_curl_share(data) g_mutex_unlock (&s_mCurlShare[data])
+#endif
 
-  ////////////////////
- /// DOWNLOAD API ///
-////////////////////
+
+  ///////////////
+ /// ARCHIVE ///
+///////////////
+
+#ifdef HAVE_LIBARCHIVE
+// Packages are tarballs compressed with gzip or bzip2; they are extracted here rather than by spawning 'tar'.
+static gboolean _extract_archive (const gchar *cArchivePath, const gchar *cExtractTo)
+{
+	struct archive *pArchive = archive_read_new ();
+	archive_read_support_filter_all (pArchive);  // the compression is detected from the data, since a downloaded archive is in a temporary file without extension.
+	archive_read_support_format_tar (pArchive);  // ustar, pax and GNU
+	if (archive_read_open_filename (pArchive, cArchivePath, 10240) != ARCHIVE_OK)
+	{
+		cd_warning ("couldn't open the archive %s (%s)", cArchivePath, archive_error_string (pArchive));
+		archive_read_free (pArchive);
+		return FALSE;
+	}
+	struct archive *pDisk = archive_write_disk_new ();
+	archive_write_disk_set_options (pDisk, ARCHIVE_EXTRACT_TIME | ARCHIVE_EXTRACT_SECURE_NODOTDOT | ARCHIVE_EXTRACT_SECURE_SYMLINKS);  // like 'tar', but don't let an archive write outside of the folder.
+	
+	struct archive_entry *pEntry;
+	gboolean bSuccess = FALSE;
+	int r;
+	while (1)
+	{
+		r = archive_read_next_header (pArchive, &pEntry);
+		if (r == ARCHIVE_EOF)
+		{
+			bSuccess = TRUE;
+			break;
+		}
+		if (r < ARCHIVE_WARN)
+		{
+			cd_warning ("invalid archive %s (%s)", cArchivePath, archive_error_string (pArchive));
+			break;
+		}
+		
+		//\_______________ only take the files and folders that stay inside the folder.
+		const gchar *cName = archive_entry_pathname (pEntry);
+		if (cName == NULL || *cName == '/')
+		{
+			cd_warning ("the file '%s' of the archive is outside of it, it will be ignored", cName);
+			continue;
+		}
+		mode_t iType = archive_entry_filetype (pEntry);
+		if ((iType != AE_IFREG && iType != AE_IFDIR) || archive_entry_hardlink (pEntry) != NULL)  // links, devices, etc: packages don't need them, and a link could make the next entries write anywhere.
+		{
+			cd_debug ("the entry '%s' is ignored", cName);
+			continue;
+		}
+		gchar *cPath = g_strdup_printf ("%s/%s", cExtractTo, cName);
+		archive_entry_set_pathname (pEntry, cPath);
+		
+		//\_______________ extract it.
+		r = archive_read_extract2 (pArchive, pEntry, pDisk);
+		if (r != ARCHIVE_OK)
+			cd_warning ("couldn't extract %s (%s)", cPath, archive_error_string (pDisk));
+		g_free (cPath);
+		if (r == ARCHIVE_FATAL)
+			break;
+	}
+	
+	archive_write_free (pDisk);  // also sets the time of the folders.
+	archive_read_free (pArchive);
+	return bSuccess;
+}
+#else
+static gboolean _extract_archive (const gchar *cArchivePath, const gchar *cExtractTo)
+{
+	gchar *cCommand = g_strdup_printf ("tar xf%c \"%s\" -C \"%s\"", (g_str_has_suffix (cArchivePath, "bz2") ? 'j' : 'z'), cArchivePath, cExtractTo);
+	cd_debug ("tar : %s", cCommand);
+	int r = system (cCommand);
+	g_free (cCommand);
+	return (r == 0);
+}
+#endif
 
 gchar *cairo_dock_uncompress_file (const gchar *cArchivePath, const gchar *cExtractTo, const gchar *cRealArchiveName)
 {
@@ -93,16 +184,15 @@ gchar *cairo_dock_uncompress_file (const gchar *cArchivePath, const gchar *cExtr
 	}
 	
 	//\_______________ on decompresse l'archive.
-	gchar *cCommand = g_strdup_printf ("tar xf%c \"%s\" -C \"%s\"", (g_str_has_suffix (cArchivePath, "bz2") ? 'j' : 'z'), cArchivePath, cExtractTo);
-	cd_debug ("tar : %s", cCommand);
-	int r = system (cCommand);
+	gboolean bExtracted = _extract_archive (cArchivePath, cExtractTo);
 	
 	//\_______________ on verifie le resultat, en remettant l'original en cas d'echec.
-	if (r != 0 || !g_file_test (cResultPath, G_FILE_TEST_EXISTS))
+	if (! bExtracted || !g_file_test (cResultPath, G_FILE_TEST_EXISTS))
 	{
-		cd_warning ("Invalid archive file (%s)", cCommand);
+		cd_warning ("Invalid archive file (%s)", cArchivePath);
 		if (cTempBackup != NULL)
 		{
+			cairo_dock_remove_directory (cResultPath);  // what may have been extracted before the error.
 			g_rename (cTempBackup, cResultPath);
 		}
 		g_free (cResultPath);
@@ -110,18 +200,18 @@ gchar *cairo_dock_uncompress_file (const gchar *cArchivePath, const gchar *cExtr
 	}
 	else if (cTempBackup != NULL)
 	{
-		gchar *cCommand = g_strdup_printf ("rm -rf \"%s\"", cTempBackup);
-		int r = system (cCommand);
-		if (r < 0)
-			cd_warning ("Couldn't remove temporary folder (%s)", cCommand);
-		g_free (cCommand);
+		if (! cairo_dock_remove_directory (cTempBackup))
+			cd_warning ("Couldn't remove temporary folder (%s)", cTempBackup);
 	}
 	
-	g_free (cCommand);
 	g_free (cTempBackup);
 	return cResultPath;
 }
 
+  ////////////////////
+ /// DOWNLOAD API ///
+////////////////////
+
 static inline CURL *_init_curl_connection (const gchar *cURL)
 {
 	CURL *handle = curl_easy_init ();
@@ -150,34 +240,190 @@ static inline CURL *_init_curl_connection (const gchar *cURL)
 	curl_easy_setopt (handle, CURLOPT_NOSIGNAL, 1);  // With CURLOPT_NOSIGNAL set non-zero, curl will not use any signals; sinon curl se vautre apres le timeout, meme si le download s'est bien passe !
 	curl_easy_setopt (handle, CURLOPT_FOLLOWLOCATION , 1);  // follow redirection
 	curl_easy_setopt (handle, CURLOPT_USERAGENT , "a/5.0 (X11; Linux x86_64; rv:2.0b11) Gecko/20100101 Firefox/4.0b11");
+	if (myConnectionParam.iConnectionMaxSpeed > 0)
+		curl_easy_setopt (handle, CURLOPT_MAX_RECV_SPEED_LARGE, (curl_off_t)myConnectionParam.iConnectionMaxSpeed * 1024);
+	CURLSH *pCurlShare = g_atomic_pointer_get (&s_pCurlShare);
+	if (pCurlShare != NULL)
+		curl_easy_setopt (handle, CURLOPT_SHARE, pCurlShare);
 	return handle;
 }
 
-static size_t _write_data_to_file (gpointer buffer, size_t size, size_t nmemb, FILE *fd)
+static void _lock_curl_share_data (G_GNUC_UNUSED CURL *handle, curl_lock_data data, G_GNUC_UNUSED curl_lock_access access, G_GNUC_UNUSED void *userptr)
 {
-	return fwrite (buffer, size, nmemb, fd);
+	_lock_curl_share (data);
 }
-gboolean cairo_dock_download_file (const gchar *cURL, const gchar *cLocalPath)
+static void _unlock_curl_share_data (G_GNUC_UNUSED CURL *handle, curl_lock_data data, G_GNUC_UNUSED void *userptr)
 {
-	g_return_val_if_fail (cLocalPath != NULL && cURL != NULL, FALSE);
+	_unlock_curl_share (data);
+}
+
+// files downloaded from the server are kept in the cache folder, to be revalidated (lists) or resumed (archives) the next time.
+static gchar *_get_net_cache_path (const gchar *cURL, const gchar *cSuffix)
+{
+	gchar *cKey = g_compute_checksum_for_string (G_CHECKSUM_MD5, cURL, -1);
+	gchar *cPath = g_strdup_printf ("%s/cairo-dock/net/%s%s", g_get_user_cache_dir (), cKey, cSuffix);
+	g_free (cKey);
+	return cPath;
+}
+
+typedef struct {
+	gchar *cETag;
+	gchar *cLastModified;
+	} CairoDockHttpValidators;
+static size_t _get_validators (gchar *buffer, size_t size, size_t nitems, CairoDockHttpValidators *pValidators)
+{
+	size_t n = size * nitems;
+	if (n > 5 && strncmp (buffer, "HTTP/", 5) == 0)  // new response (after a redirection), forget the headers of the previous one.
+	{
+		g_free (pValidators->cETag);
+		g_free (pValidators->cLastModified);
+		pValidators->cETag = pValidators->cLastModified = NULL;
+	}
+	else if (n > 5 && g_ascii_strncasecmp (buffer, "ETag:", 5) == 0)
+	{
+		g_free (pValidators->cETag);
+		pValidators->cETag = g_strstrip (g_strndup (buffer + 5, n - 5));
+	}
+	else if (n > 14 && g_ascii_strncasecmp (buffer, "Last-Modified:", 14) == 0)
+	{
+		g_free (pValidators->cLastModified);
+		pValidators->cLastModified = g_strstrip (g_strndup (buffer + 14, n - 14));
+	}
+	return n;
+}
+typedef struct {
+	const gchar *cLocalPath;
+	FILE *f;
+	CURL *handle;
+	gboolean bFirstData;
+	gboolean bResuming;  // we asked the server for the end of the file only.
+	CairoDockHttpValidators validators;  // of the response
+	gchar *cInfoPath;  // where the validators are kept to resume the download later, or NULL
+	} CairoDockDownload;
+static void _save_download_validators (CairoDockDownload *pDownload)
+{
+	GKeyFile *pInfo = g_key_file_new ();
+	g_key_file_set_string (pInfo, "Download", "etag", pDownload->validators.cETag ? pDownload->validators.cETag : "");
+	g_key_file_set_string (pInfo, "Download", "last-modified", pDownload->validators.cLastModified ? pDownload->validators.cLastModified : "");
+	cairo_dock_write_keys_to_file (pInfo, pDownload->cInfoPath);
+	g_key_file_free (pInfo);
+}
+static gchar *_get_download_validator (const gchar *cInfoPath)
+{
+	gchar *cValidator = NULL;
+	GKeyFile *pInfo = g_key_file_new ();
+	if (g_key_file_load_from_file (pInfo, cInfoPath, G_KEY_FILE_NONE, NULL))
+	{
+		cValidator = g_key_file_get_string (pInfo, "Download", "etag", NULL);
+		if (cValidator == NULL || *cValidator == '\0' || strncmp (cValidator, "W/", 2) == 0)  // If-Range only accepts a strong ETag.
+		{
+			g_free (cValidator);
+			cValidator = g_key_file_get_string (pInfo, "Download", "last-modified", NULL);
+			if (cValidator != NULL && *cValidator == '\0')
+			{
+				g_free (cValidator);
+				cValidator = NULL;
+			}
+		}
+	}
+	g_key_file_free (pInfo);
+	return cValidator;
+}
+static size_t _write_data_to_file (gpointer buffer, size_t size, size_t nmemb, CairoDockDownload *pDownload)
+{
+	if (pDownload->bFirstData)
+	{
+		pDownload->bFirstData = FALSE;
+		long iCode = 0;
+		curl_easy_getinfo (pDownload->handle, CURLINFO_RESPONSE_CODE, &iCode);
+		if (iCode != 206)  // the server sends the whole file (it can't resume it, or the file has changed since the partial download).
+		{
+			if (pDownload->bResuming)  // start again from scratch.
+			{
+				cd_debug ("the server can't resume the download of %s", pDownload->cLocalPath);
+				pDownload->f = freopen (pDownload->cLocalPath, "wb", pDownload->f);
+				if (pDownload->f == NULL)
+					return 0;  // abort the transfer.
+			}
+			if (pDownload->cInfoPath != NULL)  // remember which version of the file we're getting, to be able to resume it.
+				_save_download_validators (pDownload);
+		}
+	}
+	return fwrite (buffer, size, nmemb, pDownload->f);
+}
+static gboolean _download_file (const gchar *cURL, const gchar *cLocalPath, gboolean bResume)
+{
+	CairoDockDownload download;
+	memset (&download, 0, sizeof (CairoDockDownload));
+	download.cLocalPath = cLocalPath;
+	download.bFirstData = TRUE;
+	if (bResume)
+		download.cInfoPath = g_strconcat (cLocalPath, ".info", NULL);
 	
-	// download the file
-	FILE *f = fopen (cLocalPath, "wb");
-	g_return_val_if_fail (f, FALSE);
+	// continue a previous download if there is one, provided the server still has the same file.
+	struct curl_slist *pHeaders = NULL;
+	GStatBuf st;
+	if (bResume && g_stat (cLocalPath, &st) == 0 && st.st_size > 0)
+	{
+		gchar *cValidator = _get_download_validator (download.cInfoPath);
+		if (cValidator != NULL)
+		{
+			cd_debug ("resuming the download of '%s' from %ld bytes", cURL, (long)st.st_size);
+			gchar *cHeader = g_strdup_printf ("If-Range: %s", cValidator);  // if the file has changed, the server sends it whole.
+			pHeaders = curl_slist_append (pHeaders, cHeader);
+			g_free (cHeader);
+			g_free (cValidator);
+			download.bResuming = TRUE;
+		}
+		else
+			cd_debug ("the partial download of '%s' can't be checked, starting again", cURL);
+	}
+	download.f = fopen (cLocalPath, download.bResuming ? "ab" : "wb");
+	if (download.f == NULL)
+	{
+		cd_warning ("couldn't write into '%s'", cLocalPath);
+		curl_slist_free_all (pHeaders);
+		g_free (download.cInfoPath);
+		return FALSE;
+	}
 	
+	// download the file
 	CURL *handle = _init_curl_connection (cURL);
-	curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, _write_data_to_file);
-	curl_easy_setopt(handle, CURLOPT_WRITEDATA, f);
+	download.handle = handle;
+	curl_easy_setopt (handle, CURLOPT_FAILONERROR, 1);  // don't save an error page as the file.
+	if (download.bResuming)
+	{
+		curl_easy_setopt (handle, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)st.st_size);
+		curl_easy_setopt (handle, CURLOPT_HTTPHEADER, pHeaders);
+	}
+	curl_easy_setopt (handle, CURLOPT_HEADERFUNCTION, (curl_write_callback)_get_validators);
+	curl_easy_setopt (handle, CURLOPT_HEADERDATA, &download.validators);
+	curl_easy_setopt (handle, CURLOPT_WRITEFUNCTION, (curl_write_callback)_write_data_to_file);
+	curl_easy_setopt (handle, CURLOPT_WRITEDATA, &download);
 	
+	gboolean bResumed = download.bResuming;
 	CURLcode r = curl_easy_perform (handle);
-	fclose (f);
+	if (download.f != NULL)
+		fclose (download.f);
+	curl_easy_cleanup (handle);
+	curl_slist_free_all (pHeaders);
+	g_free (download.validators.cETag);
+	g_free (download.validators.cLastModified);
 	
 	// check the result
 	gboolean bOk;
 	if (r != CURLE_OK)  // an error occured
 	{
 		cd_warning ("Couldn't download file '%s' (%s)", cURL, curl_easy_strerror (r));
-		g_remove (cLocalPath);
+		if (bResumed && (r == CURLE_HTTP_RETURNED_ERROR || r == CURLE_RANGE_ERROR || r == CURLE_BAD_DOWNLOAD_RESUME))  // the server refused the range (the partial file may be complete or outdated), retry from scratch.
+		{
+			g_remove (cLocalPath);
+			g_remove (download.cInfoPath);
+			g_free (download.cInfoPath);
+			return _download_file (cURL, cLocalPath, bResume);
+		}
+		if (! bResume)  // otherwise keep what we've got, to resume it the next time.
+			g_remove (cLocalPath);
 		bOk = FALSE;
 	}
 	else  // download ok, check the file is not empty.
@@ -194,11 +440,17 @@ gboolean cairo_dock_download_file (const gchar *cURL, const gchar *cLocalPath)
 			g_remove (cLocalPath);
 			bOk = FALSE;
 		}
+		if (download.cInfoPath != NULL)  // nothing to resume any more.
+			g_remove (download.cInfoPath);
 	}
-	
-	curl_easy_cleanup (handle);
+	g_free (download.cInfoPath);
 	return bOk;
 }
+gboolean cairo_dock_download_file (const gchar *cURL, const gchar *cLocalPath)
+{
+	g_return_val_if_fail (cLocalPath != NULL && cURL != NULL, FALSE);
+	return _download_file (cURL, cLocalPath, FALSE);
+}
 
 gchar *cairo_dock_download_file_in_tmp (const gchar *cURL)
 {
@@ -229,7 +481,21 @@ gchar *cairo_dock_download_archive (const gchar *cURL, const gchar *cExtractTo)
 	g_return_val_if_fail (cURL != NULL, NULL);
 	
 	// download the archive
-	gchar *cArchivePath = cairo_dock_download_file_in_tmp (cURL);
+	gchar *cArchivePath;
+	if (cExtractTo != NULL)  // into the cache, so that an interrupted download can be resumed.
+	{
+		cArchivePath = _get_net_cache_path (cURL, ".part");
+		gchar *cCacheDir = g_path_get_dirname (cArchivePath);
+		g_mkdir_with_parents (cCacheDir, 7*8*8+7*8+5);
+		g_free (cCacheDir);
+		if (! _download_file (cURL, cArchivePath, TRUE))
+		{
+			g_free (cArchivePath);
+			cArchivePath = NULL;
+		}
+	}
+	else
+		cArchivePath = cairo_dock_download_file_in_tmp (cURL);
 	
 	// if success, uncompress it.
 	gchar *cPath = NULL;
@@ -365,6 +631,103 @@ gchar *cairo_dock_get_url_data_with_post (const gchar *cURL, gboolean bGetOutput
 }
 
 
+// Get the content of a URL, from the cache if the server says it hasn't changed since we got it (or if the server can't be reached).
+static gchar *_get_url_data_with_cache (const gchar *cURL, GError **erreur)
+{
+	gchar *cCachePath = _get_net_cache_path (cURL, "");
+	gchar *cInfoPath = _get_net_cache_path (cURL, ".info");
+	gchar *cCachedContent = NULL;
+	GKeyFile *pInfo = g_key_file_new ();
+	if (g_key_file_load_from_file (pInfo, cInfoPath, G_KEY_FILE_NONE, NULL))
+		g_file_get_contents (cCachePath, &cCachedContent, NULL, NULL);
+	
+	//\_______________ ask the server to send the data only if they have changed.
+	CURL *handle = _init_curl_connection (cURL);
+	struct curl_slist *pHeaders = NULL;
+	if (cCachedContent != NULL)
+	{
+		gchar *cETag = g_key_file_get_string (pInfo, "Cache", "etag", NULL);
+		gchar *cLastModified = g_key_file_get_string (pInfo, "Cache", "last-modified", NULL);
+		gchar *cHeader;
+		if (cETag != NULL && *cETag != '\0')
+		{
+			cHeader = g_strdup_printf ("If-None-Match: %s", cETag);
+			pHeaders = curl_slist_append (pHeaders, cHeader);
+			g_free (cHeader);
+		}
+		if (cLastModified != NULL && *cLastModified != '\0')
+		{
+			cHeader = g_strdup_printf ("If-Modified-Since: %s", cLastModified);
+			pHeaders = curl_slist_append (pHeaders, cHeader);
+			g_free (cHeader);
+		}
+		g_free (cETag);
+		g_free (cLastModified);
+		curl_easy_setopt (handle, CURLOPT_HTTPHEADER, pHeaders);
+	}
+	CairoDockHttpValidators validators = {NULL, NULL};
+	curl_easy_setopt (handle, CURLOPT_HEADERFUNCTION, (curl_write_callback)_get_validators);
+	curl_easy_setopt (handle, CURLOPT_HEADERDATA, &validators);
+	GString *buffer = g_string_sized_new (1024);
+	curl_easy_setopt (handle, CURLOPT_WRITEFUNCTION, (curl_write_callback)_write_data_to_buffer);
+	curl_easy_setopt (handle, CURLOPT_WRITEDATA, buffer);
+	
+	CURLcode r = curl_easy_perform (handle);
+	long iCode = 0;
+	curl_easy_getinfo (handle, CURLINFO_RESPONSE_CODE, &iCode);
+	curl_easy_cleanup (handle);
+	curl_slist_free_all (pHeaders);
+	
+	//\_______________ take the data, and keep them for the next time.
+	gchar *cContent = NULL;
+	if (r != CURLE_OK)
+	{
+		if (cCachedContent != NULL)
+		{
+			cd_warning ("Couldn't download file '%s' (%s), the previous copy will be used", cURL, curl_easy_strerror (r));
+			cContent = cCachedContent;
+			cCachedContent = NULL;
+		}
+		else
+			g_set_error (erreur, 1, 1, "Couldn't download file '%s' (%s)", cURL, curl_easy_strerror (r));
+	}
+	else if (iCode == 304 && cCachedContent != NULL)  // not modified.
+	{
+		cd_debug ("'%s' has not changed", cURL);
+		cContent = cCachedContent;
+		cCachedContent = NULL;
+	}
+	else
+	{
+		cContent = g_string_free (buffer, FALSE);
+		buffer = NULL;
+		if (iCode == 200)
+		{
+			gchar *cCacheDir = g_path_get_dirname (cCachePath);
+			g_mkdir_with_parents (cCacheDir, 7*8*8+7*8+5);
+			g_free (cCacheDir);
+			g_key_file_free (pInfo);
+			pInfo = g_key_file_new ();
+			g_key_file_set_string (pInfo, "Cache", "url", cURL);
+			g_key_file_set_string (pInfo, "Cache", "etag", validators.cETag ? validators.cETag : "");
+			g_key_file_set_string (pInfo, "Cache", "last-modified", validators.cLastModified ? validators.cLastModified : "");
+			if (g_file_set_contents (cCachePath, cContent, -1, NULL))
+				cairo_dock_write_keys_to_file (pInfo, cInfoPath);
+		}
+	}
+	
+	if (buffer != NULL)
+		g_string_free (buffer, TRUE);
+	g_free (validators.cETag);
+	g_free (validators.cLastModified);
+	g_free (cCachedContent);
+	g_key_file_free (pInfo);
+	g_free (cInfoPath);
+	g_free (cCachePath);
+	return cContent;
+}
+
+
 static void _dl_file_content (gpointer *pSharedMemory)
 {
 	GError *erreur = NULL;
@@ -432,48 +795,166 @@ static inline int _get_rating (const gchar *cPackagesDir, const gchar *cPackageN
 	g_free (cRatingFile);
 	return iRating;	
 }
+
+// The index keeps the packages of each local folder with their rating, so that the folders don't have to be walked and each rating file read every time the packages are listed (each time the themes page is opened).
+// A folder is rescanned when its modification time has changed (a package has been added or removed), and the ratings are read again when the one of its '.rating' folder has changed (ratings are written with a rename).
+#define CAIRO_DOCK_PACKAGES_INDEX "packages-index"
+#define CAIRO_DOCK_PACKAGES_INDEX_VERSION 1
+static GKeyFile *s_pPackagesIndex = NULL;
+
+#ifndef GLIB_VERSION_2_32
+static GStaticMutex s_mPackagesIndex = G_STATIC_MUTEX_INIT;
+#define _lock_packages_index() g_static_mutex_lock (&s_mPackagesIndex)
+#define _unlock_packages_index() g_static_mutex_unlock (&s_mPackagesIndex)
+#else
+static GMutex s_mPackagesIndex;  // packages can be listed from a task.
+#define _lock_packages_index() g_mutex_lock (&s_mPackagesIndex)
+#define _unlock_packages_index() g_mutex_unlock (&s_mPackagesIndex)
+#endif
+
+static gchar *_get_packages_index_path (void)
+{
+	return g_strdup_printf ("%s/cairo-dock/%s", g_get_user_cache_dir (), CAIRO_DOCK_PACKAGES_INDEX);
+}
+
+static void _load_packages_index (void)
+{
+	if (s_pPackagesIndex != NULL)
+		return;
+	s_pPackagesIndex = g_key_file_new ();
+	gchar *cIndexPath = _get_packages_index_path ();
+	if (! g_key_file_load_from_file (s_pPackagesIndex, cIndexPath, G_KEY_FILE_NONE, NULL)
+	|| g_key_file_get_integer (s_pPackagesIndex, "Index", "version", NULL) != CAIRO_DOCK_PACKAGES_INDEX_VERSION)  // no index yet, or an old one.
+	{
+		g_key_file_free (s_pPackagesIndex);
+		s_pPackagesIndex = g_key_file_new ();
+		g_key_file_set_integer (s_pPackagesIndex, "Index", "version", CAIRO_DOCK_PACKAGES_INDEX_VERSION);
+	}
+	g_free (cIndexPath);
+}
+
+static void _save_packages_index (void)
+{
+	gchar *cIndexPath = _get_packages_index_path ();
+	gchar *cIndexDir = g_path_get_dirname (cIndexPath);
+	if (g_mkdir_with_parents (cIndexDir, 7*8*8+7*8+5) == 0)
+		cairo_dock_write_keys_to_file (s_pPackagesIndex, cIndexPath);
+	g_free (cIndexDir);
+	g_free (cIndexPath);
+}
+
+static inline gint64 _get_dir_mtime (const gchar *cDirPath)
+{
+	GStatBuf st;
+	return (g_stat (cDirPath, &st) == 0 ? (gint64)st.st_mtime : 0);
+}
+
 GHashTable *cairo_dock_list_local_packages (const gchar *cPackagesDir, GHashTable *hProvidedTable, G_GNUC_UNUSED gboolean bUpdatePackageValidity, GError **erreur)
 {
 	cd_debug ("%s (%s)", __func__, cPackagesDir);
-	GError *tmp_erreur = NULL;
-	GDir *dir = g_dir_open (cPackagesDir, 0, &tmp_erreur);
-	if (tmp_erreur != NULL)
+	_lock_packages_index ();
+	_load_packages_index ();
+	
+	//\_______________ take the packages from the index if the folder hasn't changed.
+	gint64 iDirMTime = _get_dir_mtime (cPackagesDir);
+	gchar *cRatingDir = g_strdup_printf ("%s/.rating", cPackagesDir);
+	gint64 iRatingMTime = _get_dir_mtime (cRatingDir);
+	g_free (cRatingDir);
+	gchar **pIndexedNames = NULL;
+	gint *pIndexedRatings = NULL;
+	gsize iNbIndexedNames = 0, iNbIndexedRatings = 0;
+	if (iDirMTime != 0 && g_key_file_get_int64 (s_pPackagesIndex, cPackagesDir, "mtime", NULL) == iDirMTime)
 	{
-		g_propagate_error (erreur, tmp_erreur);
-		return hProvidedTable;
+		pIndexedNames = g_key_file_get_string_list (s_pPackagesIndex, cPackagesDir, "packages", &iNbIndexedNames, NULL);
+		if (g_key_file_get_int64 (s_pPackagesIndex, cPackagesDir, "rating mtime", NULL) == iRatingMTime)
+			pIndexedRatings = g_key_file_get_integer_list (s_pPackagesIndex, cPackagesDir, "ratings", &iNbIndexedRatings, NULL);
+		if (pIndexedRatings != NULL && iNbIndexedRatings != iNbIndexedNames)  // shouldn't happen.
+		{
+			g_free (pIndexedRatings);
+			pIndexedRatings = NULL;
+		}
 	}
-
+	
+	//\_______________ otherwise walk the folder.
+	gboolean bIndexed = (pIndexedNames != NULL && (pIndexedRatings != NULL || iNbIndexedNames == 0));
+	GPtrArray *pNames = g_ptr_array_new_with_free_func (g_free);
+	if (pIndexedNames != NULL)
+	{
+		gsize i;
+		for (i = 0; i < iNbIndexedNames; i ++)
+			g_ptr_array_add (pNames, g_strdup (pIndexedNames[i]));
+		g_strfreev (pIndexedNames);
+	}
+	else
+	{
+		GError *tmp_erreur = NULL;
+		GDir *dir = g_dir_open (cPackagesDir, 0, &tmp_erreur);
+		if (tmp_erreur != NULL)
+		{
+			g_propagate_error (erreur, tmp_erreur);
+			g_ptr_array_free (pNames, TRUE);
+			_unlock_packages_index ();
+			return hProvidedTable;
+		}
+		gchar *cPackagePath;
+		const gchar *cPackageName;
+		while ((cPackageName = g_dir_read_name (dir)) != NULL)
+		{
+			// on ecarte les fichiers caches.
+			if (*cPackageName == '.')
+				continue;
+			
+			// on ecarte les non repertoires.
+			cPackagePath = g_strdup_printf ("%s/%s", cPackagesDir, cPackageName);
+			if (g_file_test (cPackagePath, G_FILE_TEST_IS_DIR))
+				g_ptr_array_add (pNames, g_strdup (cPackageName));
+			g_free (cPackagePath);
+		}
+		g_dir_close (dir);
+	}
+	gint *pRatings = pIndexedRatings;
+	if (pRatings == NULL)
+	{
+		pRatings = g_new0 (gint, MAX (pNames->len, 1));
+		guint i;
+		for (i = 0; i < pNames->len; i ++)
+			pRatings[i] = _get_rating (cPackagesDir, g_ptr_array_index (pNames, i));
+	}
+	
+	//\_______________ update the index; a folder modified during the current second could be modified again without changing its time, so it's not indexed yet.
+	if (! bIndexed && iDirMTime != 0 && MAX (iDirMTime, iRatingMTime) < (gint64)time (NULL))
+	{
+		g_key_file_set_int64 (s_pPackagesIndex, cPackagesDir, "mtime", iDirMTime);
+		g_key_file_set_int64 (s_pPackagesIndex, cPackagesDir, "rating mtime", iRatingMTime);
+		g_key_file_set_string_list (s_pPackagesIndex, cPackagesDir, "packages", (const gchar * const *)pNames->pdata, pNames->len);
+		g_key_file_set_integer_list (s_pPackagesIndex, cPackagesDir, "ratings", pRatings, pNames->len);
+		_save_packages_index ();
+	}
+	_unlock_packages_index ();
+	
+	//\_______________ fill the table.
 	GHashTable *pPackageTable = (hProvidedTable != NULL ? hProvidedTable : g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) cairo_dock_free_package));
 	
 	CairoDockPackageType iType = (strncmp (cPackagesDir, "/usr", 4) == 0 ?
 		CAIRO_DOCK_LOCAL_PACKAGE :
 		CAIRO_DOCK_USER_PACKAGE);
-	gchar *cPackagePath;
 	CairoDockPackage *pPackage;
 	const gchar *cPackageName;
-	while ((cPackageName = g_dir_read_name (dir)) != NULL)
+	guint i;
+	for (i = 0; i < pNames->len; i ++)
 	{
-		// on ecarte les fichiers caches.
-		if (*cPackageName == '.')
-			continue;
-		
-		// on ecarte les non repertoires.
-		cPackagePath = g_strdup_printf ("%s/%s", cPackagesDir, cPackageName);
-		if (! g_file_test (cPackagePath, G_FILE_TEST_IS_DIR))
-		{
-			g_free (cPackagePath);
-			continue;
-		}
+		cPackageName = g_ptr_array_index (pNames, i);
 		
 		// on insere le package dans la table.
 		pPackage = g_new0 (CairoDockPackage, 1);
-		pPackage->cPackagePath = cPackagePath;
+		pPackage->cPackagePath = g_strdup_printf ("%s/%s", cPackagesDir, cPackageName);
 		pPackage->cDisplayedName = g_strdup (cPackageName);
 		pPackage->iType = iType;
-		pPackage->iRating = _get_rating (cPackagesDir, cPackageName);
+		pPackage->iRating = pRatings[i];
 		g_hash_table_insert (pPackageTable, g_strdup (cPackageName), pPackage);  // donc ecrase un package installe ayant le meme nom.
 	}
-	g_dir_close (dir);
+	g_free (pRatings);
+	g_ptr_array_free (pNames, TRUE);
 	return pPackageTable;
 }
 
@@ -633,7 +1114,7 @@ GHashTable *cairo_dock_list_net_packages (const gchar *cServerAdress, const gcha
 	// On recupere la liste des packages distants.
 	GError *tmp_erreur = NULL;
 	gchar *cURL = g_strdup_printf ("%s/%s/%s", cServerAdress, cDirectory, cListFileName);
-	gchar *cContent = cairo_dock_get_url_data (cURL, &tmp_erreur);
+	gchar *cContent = _get_url_data_with_cache (cURL, &tmp_erreur);
 	g_free (cURL);
 	if (tmp_erreur != NULL)
 	{
@@ -834,6 +1315,16 @@ CairoDockPackageType cairo_dock_extract_package_type_from_name (const gchar *cPa
 }
 
 
+void cairo_dock_cleanup_connections (void)
+{
+	CURLSH *pCurlShare = s_pCurlShare;
+	if (pCurlShare == NULL)
+		return;
+	g_atomic_pointer_set (&s_pCurlShare, NULL);  // new transfers won't use it any more.
+	if (curl_share_cleanup (pCurlShare) == CURLSHE_IN_USE)  // a transfer is still running in a task; the process is ending anyway, so just leave it.
+		cd_debug ("the shared connections are still in use");
+}
+
 void cairo_dock_set_packages_server (gchar *cPackageServerAdress)
 {
 	s_cPackageServerAdress = cPackageServerAdress;
@@ -859,6 +1350,7 @@ static gboolean get_config (GKeyFile *pKeyFile, CairoConnectionParam *pSystem)
 		cairo_dock_decrypt_string (cPasswd, &pSystem->cConnectionPasswd);
 		pSystem->bForceIPv4 = cairo_dock_get_boolean_key_value (pKeyFile, "System", "force ipv4", &bFlushConfFileNeeded, TRUE, NULL, NULL);
 	}
+	pSystem->iConnectionMaxSpeed = cairo_dock_get_integer_key_value (pKeyFile, "System", "conn max speed", &bFlushConfFileNeeded, 0, NULL, NULL);
 	
 	return bFlushConfFileNeeded;
 }
@@ -882,6 +1374,20 @@ static void reset_config (CairoConnectionParam *pSystem)
 static void init (void)
 {
 	curl_global_init (CURL_GLOBAL_DEFAULT);
+	
+	#ifndef GLIB_VERSION_2_32
+	int i;
+	for (i = 0; i < CURL_LOCK_DATA_LAST; i ++)
+		g_static_mutex_init (&s_mCurlShare[i]);
+	#endif
+	s_pCurlShare = curl_share_init ();
+	curl_share_setopt (s_pCurlShare, CURLSHOPT_LOCKFUNC, _lock_curl_share_data);
+	curl_share_setopt (s_pCurlShare, CURLSHOPT_UNLOCKFUNC, _unlock_curl_share_data);
+	curl_share_setopt (s_pCurlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt (s_pCurlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	#if LIBCURL_VERSION_NUM >= 0x073900  // 7.57
+	curl_share_setopt (s_pCurlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+	#endif
 }
 
 
@@ -54,6 +54,7 @@ struct _CairoConnectionParam {
 	gchar *cConnectionUser;
 	gchar *cConnectionPasswd;
 	gboolean bForceIPv4;
+	gint iConnectionMaxSpeed;  // kB/s, 0 = no limit
 	};
 
 // signals
@@ -213,6 +214,10 @@ CairoDockPackageType cairo_dock_extract_package_type_from_name (const gchar *cPa
 
 void cairo_dock_set_packages_server (gchar *cPackageServerAdress);
 
+/** Release the DNS cache, TLS sessions and connections shared by the transfers. Call it when quitting, once no more transfer will be started.
+*/
+void cairo_dock_cleanup_connections (void);
+
 
 void gldi_register_connection_manager (void);
 
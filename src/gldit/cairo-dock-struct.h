@@ -418,6 +418,7 @@ typedef struct _CairoDataRendererEmblemParam CairoDataRendererEmblemParam;
 typedef struct _CairoDataRendererEmblem CairoDataRendererEmblem;
 typedef struct _CairoDataRendererTextParam CairoDataRendererTextParam;
 typedef struct _CairoDataRendererText CairoDataRendererText;
+typedef struct _CairoDataRendererAngleTable CairoDataRendererAngleTable;
 typedef struct _CairoDockDataRendererRecord CairoDockDataRendererRecord;
 
 typedef struct _CairoDockAnimationRecord CairoDockAnimationRecord;
@@ -462,6 +463,10 @@ typedef struct _GldiWindowManagerBackend GldiWindowManagerBackend;
 
 typedef struct _GldiWindowActor GldiWindowActor;
 
+typedef struct _GldiWindowInfo GldiWindowInfo;
+
+typedef struct _GldiWindowsSnapshot GldiWindowsSnapshot;
+
 typedef struct _GldiContainerManagerBackend GldiContainerManagerBackend;
 
 typedef struct _GldiGLManagerBackend GldiGLManagerBackend;
@@ -261,56 +261,28 @@ static inline void _apply_orientation_and_scale (cairo_t *pCairoContext, CairoDo
 }
 
 
-cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuffer, int iBufferNbElements, int iWidth, int iHeight)
+void cairo_dock_premultiply_xicon_pixels (const gulong * restrict pXPixels, guint32 * restrict pPixels, int n)
 {
-	//\____________________ On recupere la plus grosse des icones presentes dans le tampon (meilleur rendu).
-	int iIndex = 0, iBestIndex = 0;
-	while (iIndex + 2 < iBufferNbElements)
-	{
-		if (pXIconBuffer[iIndex] == 0 || pXIconBuffer[iIndex+1] == 0)  // precaution au cas ou un buffer foirreux nous serait retourne, on risque de boucler sans fin.
-		{
-			cd_warning ("This icon is broken !\nThis means that one of the current applications has sent a buggy icon to X.");
-			if (iIndex == 0)  // tout le buffer est a jeter.
-				return NULL;
-			break;
-		}
-		if (pXIconBuffer[iIndex] > pXIconBuffer[iBestIndex])
-			iBestIndex = iIndex;
-		iIndex += 2 + pXIconBuffer[iIndex] * pXIconBuffer[iIndex+1];
-	}
-
-	//\____________________ On pre-multiplie chaque composante par le alpha (necessaire pour libcairo).
-	int w = pXIconBuffer[iBestIndex];
-	int h = pXIconBuffer[iBestIndex+1];
-	iBestIndex += 2;
-	//g_print ("%s (%dx%d)\n", __func__, w, h);
-	
-	int i, n = w * h;
-	if (iBestIndex + n > iBufferNbElements)  // precaution au cas ou le nombre d'elements dans le buffer serait incorrect.
-	{
-		cd_warning ("This icon is broken !\nThis means that one of the current applications has sent a buggy icon to X.");
-		return NULL;
-	}
-	gint pixel, alpha, red, green, blue;
-	float fAlphaFactor;
-	gint *pPixelBuffer = (gint *) &pXIconBuffer[iBestIndex];  // on va ecrire le resultat du filtre directement dans le tableau fourni en entree. C'est ok car sizeof(gulong) >= sizeof(gint), donc le tableau de pixels est plus petit que le buffer fourni en entree. merci a Hannemann pour ses tests et ses screenshots ! :-)
+	// integer only and without any branch, so that the compiler can vectorize it (the division by 255 is done with the usual (x + (x >> 8)) >> 8 trick, which is exact with rounding).
+	guint32 pixel, alpha, rb, g;
+	int i;
 	for (i = 0; i < n; i ++)
 	{
-		pixel = (gint) pXIconBuffer[iBestIndex+i];
-		alpha = (pixel & 0xFF000000) >> 24;
-		red   = (pixel & 0x00FF0000) >> 16;
-		green = (pixel & 0x0000FF00) >> 8;
-		blue  = (pixel & 0x000000FF);
-		fAlphaFactor = (float) alpha / 255;
-		red *= fAlphaFactor;
-		green *= fAlphaFactor;
-		blue *= fAlphaFactor;
-		pPixelBuffer[i] = (pixel & 0xFF000000) + (red << 16) + (green << 8) + blue;
+		pixel = (guint32) pXPixels[i];
+		alpha = pixel >> 24;
+		rb = (pixel & 0x00FF00FF) * alpha + 0x00800080;  // red and blue are computed together, each on 16 bits.
+		rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+		g = ((pixel >> 8) & 0xFF) * alpha + 0x80;
+		g = (g + (g >> 8)) >> 8;
+		pPixels[i] = (pixel & 0xFF000000) | rb | (g << 8);
 	}
+}
 
+cairo_surface_t *cairo_dock_create_surface_from_argb_pixels (guint32 *pPixels, int w, int h, int iWidth, int iHeight)
+{
 	//\____________________ On cree la surface a partir du tampon.
-	int iStride = w * sizeof (gint);  // nbre d'octets entre le debut de 2 lignes.
-	cairo_surface_t *surface_ini = cairo_image_surface_create_for_data ((guchar *)pPixelBuffer,
+	int iStride = w * sizeof (guint32);  // nbre d'octets entre le debut de 2 lignes.
+	cairo_surface_t *surface_ini = cairo_image_surface_create_for_data ((guchar *)pPixels,
 		CAIRO_FORMAT_ARGB32,
 		w,
 		h,
@@ -347,6 +319,45 @@ cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuff
 	return pNewSurface;
 }
 
+cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuffer, int iBufferNbElements, int iWidth, int iHeight)
+{
+	//\____________________ On recupere la plus petite des icones au moins aussi grande que la taille demandee (sinon la plus grosse).
+	int iSize = MAX (iWidth, iHeight);
+	int iIndex = 0, iBestIndex = 0;
+	while (iIndex + 2 < iBufferNbElements)
+	{
+		if (pXIconBuffer[iIndex] == 0 || pXIconBuffer[iIndex+1] == 0)  // precaution au cas ou un buffer foirreux nous serait retourne, on risque de boucler sans fin.
+		{
+			cd_warning ("This icon is broken !\nThis means that one of the current applications has sent a buggy icon to X.");
+			if (iIndex == 0)  // tout le buffer est a jeter.
+				return NULL;
+			break;
+		}
+		if (cairo_dock_xicon_size_is_better ((int)pXIconBuffer[iIndex], (int)pXIconBuffer[iBestIndex], iSize))
+			iBestIndex = iIndex;
+		iIndex += 2 + pXIconBuffer[iIndex] * pXIconBuffer[iIndex+1];
+	}
+
+	//\____________________ On pre-multiplie chaque composante par le alpha (necessaire pour libcairo).
+	int w = pXIconBuffer[iBestIndex];
+	int h = pXIconBuffer[iBestIndex+1];
+	iBestIndex += 2;
+	//g_print ("%s (%dx%d)\n", __func__, w, h);
+	
+	int n = w * h;
+	if (iBestIndex + n > iBufferNbElements)  // precaution au cas ou le nombre d'elements dans le buffer serait incorrect.
+	{
+		cd_warning ("This icon is broken !\nThis means that one of the current applications has sent a buggy icon to X.");
+		return NULL;
+	}
+	guint32 *pPixels = g_new (guint32, n);
+	cairo_dock_premultiply_xicon_pixels (&pXIconBuffer[iBestIndex], pPixels, n);
+	
+	cairo_surface_t *pNewSurface = cairo_dock_create_surface_from_argb_pixels (pPixels, w, h, iWidth, iHeight);
+	g_free (pPixels);
+	return pNewSurface;
+}
+
 
 cairo_surface_t *cairo_dock_create_surface_from_pixbuf (GdkPixbuf *pixbuf, double fMaxScale, int iWidthConstraint, int iHeightConstraint, CairoDockLoadImageModifier iLoadingModifier, double *fImageWidth, double *fImageHeight, double *fZoomX, double *fZoomY)
 {
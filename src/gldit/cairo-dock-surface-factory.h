@@ -70,7 +70,7 @@ typedef enum {
 #define CAIRO_DOCK_ORIENTATION_MASK (7<<3)
 
 
-/** Create a surface from raw data of an X icon. The biggest icon possible is taken. The ratio is kept, and the surface will fill the space with transparency if necessary.
+/** Create a surface from raw data of an X icon. The smallest icon that is at least as big as the requested size is taken (or the biggest one if they are all smaller). The ratio is kept, and the surface will fill the space with transparency if necessary.
 *@param pXIconBuffer raw data of the icon.
 *@param iBufferNbElements number of elements in the buffer.
 *@param iWidth will be filled with the resulting width of the surface.
@@ -79,6 +79,31 @@ typedef enum {
 */
 cairo_surface_t *cairo_dock_create_surface_from_xicon_buffer (gulong *pXIconBuffer, int iBufferNbElements, int iWidth, int iHeight);
 
+/** Tell if an icon of width w is a better choice than the current best one of width iBestWidth, to be displayed at a given size. Icons at least as big as the size are preferred, and among them the smallest one (it's the less expensive to decode and the nicest once scaled down).
+*@param w width of the candidate icon
+*@param iBestWidth width of the best icon so far
+*@param iSize size the icon will be displayed at
+*@return TRUE if the candidate is better.
+*/
+#define cairo_dock_xicon_size_is_better(w, iBestWidth, iSize) ((iBestWidth) < (iSize) ? (w) > (iBestWidth) : ((w) >= (iSize) && (w) < (iBestWidth)))
+
+/** Convert the pixels of an X icon (one pixel per long, non-premultiplied ARGB) into premultiplied ARGB32 pixels, as needed by libcairo.
+*@param pXPixels the X pixels
+*@param pPixels the buffer to fill, of at least n elements; it must not overlap pXPixels.
+*@param n number of pixels
+*/
+void cairo_dock_premultiply_xicon_pixels (const gulong *pXPixels, guint32 *pPixels, int n);
+
+/** Create a surface of a given size from a buffer of premultiplied ARGB32 pixels. The ratio is kept, and the surface will fill the space with transparency if necessary. The buffer is not modified and can be freed right after.
+*@param pPixels the pixels
+*@param w width of the buffer
+*@param h height of the buffer
+*@param iWidth width of the surface
+*@param iHeight height of the surface
+*@return the newly allocated surface.
+*/
+cairo_surface_t *cairo_dock_create_surface_from_argb_pixels (guint32 *pPixels, int w, int h, int iWidth, int iHeight);
+
 /** Create a surface from a GdkPixbuf.
 *@param pixbuf the pixbuf.
 *@param fMaxScale maximum zoom of the icon.
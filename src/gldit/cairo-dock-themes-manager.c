@@ -136,12 +136,14 @@ gboolean cairo_dock_current_theme_need_save (void)
 
 void cairo_dock_delete_conf_file (const gchar *cConfFilePath)
 {
+	cairo_dock_discard_conf_file (cConfFilePath);
 	g_remove (cConfFilePath);
 	cairo_dock_mark_current_theme_as_modified (TRUE);
 }
 
 gboolean cairo_dock_add_conf_file (const gchar *cOriginalConfFilePath, const gchar *cConfFilePath)
 {
+	cairo_dock_flush_conf_file (cOriginalConfFilePath);  // it can be the conf file of another instance.
 	gboolean r = cairo_dock_copy_file (cOriginalConfFilePath, cConfFilePath);
 	if (r)
 		cairo_dock_mark_current_theme_as_modified (TRUE);
@@ -166,6 +168,70 @@ void cairo_dock_write_keys_to_conf_file (GKeyFile *pKeyFile, const gchar *cConfF
 }
 
 
+// The files of the themes are copied/removed directly rather than with 'cp', 'rm' and 'find' commands, to not spawn dozens of processes when a theme is loaded or saved.
+typedef gboolean (*CairoDockThemeFileFilter) (const gchar *cFileName, gconstpointer data);
+
+static gboolean _has_suffix (const gchar *cFileName, gconstpointer cSuffix)
+{
+	return g_str_has_suffix (cFileName, cSuffix);
+}
+static gboolean _has_not_suffix (const gchar *cFileName, gconstpointer cSuffix)
+{
+	return ! g_str_has_suffix (cFileName, cSuffix);
+}
+static gboolean _is_theme_data (const gchar *cFileName, G_GNUC_UNUSED gconstpointer data)  // neither a conf file nor the launchers.
+{
+	return ! g_str_has_suffix (cFileName, ".conf") && strcmp (cFileName, CAIRO_DOCK_LAUNCHERS_DIR) != 0;
+}
+static gboolean _is_not_main_conf_nor_launchers (const gchar *cFileName, G_GNUC_UNUSED gconstpointer data)
+{
+	return strcmp (cFileName, CAIRO_DOCK_CONF_FILE) != 0 && strcmp (cFileName, CAIRO_DOCK_LAUNCHERS_DIR) != 0;
+}
+
+// same as 'cp -r <dir>/* <dest>', or 'cp <dir>/* <dest>' if bFilesOnly (folders are then ignored); hidden files are copied too if bHidden (like with 'find <dir> -mindepth 1 -maxdepth 1'), else ignored like with '*'.
+static void _copy_entries (const gchar *cDirPath, const gchar *cDestDirPath, gboolean bFilesOnly, gboolean bHidden, CairoDockThemeFileFilter pFilter, gconstpointer data)
+{
+	GDir *dir = g_dir_open (cDirPath, 0, NULL);
+	if (dir == NULL)
+		return;
+	const gchar *cFileName;
+	gchar *cFilePath, *cDestFilePath;
+	while ((cFileName = g_dir_read_name (dir)) != NULL)
+	{
+		if ((*cFileName == '.' && ! bHidden) || (pFilter != NULL && ! pFilter (cFileName, data)))
+			continue;
+		cFilePath = g_strdup_printf ("%s/%s", cDirPath, cFileName);
+		cDestFilePath = g_strdup_printf ("%s/%s", cDestDirPath, cFileName);
+		if (! g_file_test (cFilePath, G_FILE_TEST_IS_DIR))
+			cairo_dock_copy_file (cFilePath, cDestFilePath);
+		else if (! bFilesOnly)
+			cairo_dock_copy_directory (cFilePath, cDestFilePath);
+		g_free (cDestFilePath);
+		g_free (cFilePath);
+	}
+	g_dir_close (dir);
+}
+
+// same as 'rm -f <dir>/*' (and '<dir>/.*' if bHidden): folders are kept.
+static void _remove_files (const gchar *cDirPath, gboolean bHidden, CairoDockThemeFileFilter pFilter, gconstpointer data)
+{
+	GDir *dir = g_dir_open (cDirPath, 0, NULL);
+	if (dir == NULL)
+		return;
+	const gchar *cFileName;
+	gchar *cFilePath;
+	while ((cFileName = g_dir_read_name (dir)) != NULL)
+	{
+		if ((*cFileName == '.' && ! bHidden) || (pFilter != NULL && ! pFilter (cFileName, data)))
+			continue;
+		cFilePath = g_strdup_printf ("%s/%s", cDirPath, cFileName);
+		if (! g_file_test (cFilePath, G_FILE_TEST_IS_DIR))
+			g_remove (cFilePath);
+		g_free (cFilePath);
+	}
+	g_dir_close (dir);
+}
+
 gboolean cairo_dock_export_current_theme (const gchar *cNewThemeName, gboolean bSaveBehavior, gboolean bSaveLaunchers)
 {
 	g_return_val_if_fail (cNewThemeName != NULL, FALSE);
@@ -174,14 +240,10 @@ gboolean cairo_dock_export_current_theme (const gchar *cNewThemeName, gboolean b
 	
 	cairo_dock_extract_package_type_from_name (cNewThemeNameWithoutSlashes);
 
-	gchar *cNewThemeNameEscaped = g_strescape (cNewThemeNameWithoutSlashes, NULL);
-
 	cd_message ("we save in %s", cNewThemeNameWithoutSlashes);
-	GString *sCommand = g_string_new ("");
+	cairo_dock_flush_conf_files ();  // the conf files are copied as they are on the disk.
 	gboolean bThemeSaved = FALSE;
-	int r;
 	gchar *cNewThemePath = g_strdup_printf ("%s/%s", g_cThemesDirPath, cNewThemeNameWithoutSlashes);
-	gchar *cNewThemePathEscaped = g_strdup_printf ("%s/%s", g_cThemesDirPath, cNewThemeNameEscaped);
 	if (g_file_test (cNewThemePath, G_FILE_TEST_EXISTS))  // on ecrase un theme existant.
 	{
 		cd_debug ("  This theme will be updated");
@@ -211,26 +273,15 @@ gboolean cairo_dock_export_current_theme (const gchar *cNewThemeName, gboolean b
 			//\___________________ On traite les lanceurs.
 			if (bSaveLaunchers)
 			{
-				g_string_printf (sCommand, "rm -f \"%s/%s\"/*", cNewThemePathEscaped, CAIRO_DOCK_LAUNCHERS_DIR);
-				cd_message ("%s", sCommand->str);
-				r = system (sCommand->str);
-				if (r < 0)
-					cd_warning ("Not able to launch this command: %s", sCommand->str);
-				
-				g_string_printf (sCommand, "cp \"%s\"/* \"%s/%s\"", g_cCurrentLaunchersPath, cNewThemePathEscaped, CAIRO_DOCK_LAUNCHERS_DIR);
-				cd_message ("%s", sCommand->str);
-				r = system (sCommand->str);
-				if (r < 0)
-					cd_warning ("Not able to launch this command: %s", sCommand->str);
+				gchar *cNewLaunchersPath = g_strdup_printf ("%s/%s", cNewThemePath, CAIRO_DOCK_LAUNCHERS_DIR);
+				_remove_files (cNewLaunchersPath, FALSE, NULL, NULL);
+				_copy_entries (g_cCurrentLaunchersPath, cNewLaunchersPath, TRUE, FALSE, NULL, NULL);
+				g_free (cNewLaunchersPath);
 			}
 			
 			//\___________________ On traite tous le reste.
 			/// TODO : traiter les .conf des applets comme celui du dock...
-			g_string_printf (sCommand, "find \"%s\" -mindepth 1 -maxdepth 1  ! -name '%s' ! -name \"%s\" -exec cp -r '{}' \"%s\" \\;", g_cCurrentThemePath, CAIRO_DOCK_CONF_FILE, CAIRO_DOCK_LAUNCHERS_DIR, cNewThemePathEscaped);
-			cd_message ("%s", sCommand->str);
-			r = system (sCommand->str);
-			if (r < 0)
-				cd_warning ("Not able to launch this command: %s", sCommand->str);
+			_copy_entries (g_cCurrentThemePath, cNewThemePath, FALSE, TRUE, _is_not_main_conf_nor_launchers, NULL);
 
 			bThemeSaved = TRUE;
 		}
@@ -241,11 +292,7 @@ gboolean cairo_dock_export_current_theme (const gchar *cNewThemeName, gboolean b
 
 		if (g_mkdir (cNewThemePath, 7*8*8+7*8+5) == 0)
 		{
-			g_string_printf (sCommand, "cp -r \"%s\"/* \"%s\"", g_cCurrentThemePath, cNewThemePathEscaped);
-			cd_message ("%s", sCommand->str);
-			r = system (sCommand->str);
-			if (r < 0)
-				cd_warning ("Not able to launch this command: %s", sCommand->str);
+			_copy_entries (g_cCurrentThemePath, cNewThemePath, FALSE, FALSE, NULL, NULL);
 
 			bThemeSaved = TRUE;
 		}
@@ -253,7 +300,6 @@ gboolean cairo_dock_export_current_theme (const gchar *cNewThemeName, gboolean b
 			cd_warning ("couldn't create %s", cNewThemePath);
 	}
 
-	g_free (cNewThemeNameEscaped);
 	g_free (cNewThemeNameWithoutSlashes);
 
 	//\___________________ On conserve la date de derniere modif.
@@ -271,8 +317,9 @@ gboolean cairo_dock_export_current_theme (const gchar *cNewThemeName, gboolean b
 	g_free (cReadmeFile);
 	g_free (cMessage);
 	
-	g_string_printf (sCommand, "rm -f \"%s/last-modif\"", cNewThemePathEscaped);
-	r = system (sCommand->str);
+	gchar *cLastModifFile = g_strdup_printf ("%s/last-modif", cNewThemePath);
+	g_remove (cLastModifFile);
+	g_free (cLastModifFile);
 	
 	//\___________________ make a preview of the current main dock.
 	gchar *cPreviewPath = g_strdup_printf ("%s/preview", cNewThemePath);
@@ -281,14 +328,11 @@ gboolean cairo_dock_export_current_theme (const gchar *cNewThemeName, gboolean b
 	
 	//\___________________ Le theme n'est plus en etat 'modifie'.
 	g_free (cNewThemePath);
-	g_free (cNewThemePathEscaped);
 	if (bThemeSaved)
 	{
 		cairo_dock_mark_current_theme_as_modified (FALSE);
 	}
 	
-	g_string_free (sCommand, TRUE);
-	
 	return bThemeSaved;
 }
 
@@ -296,6 +340,7 @@ gboolean cairo_dock_package_current_theme (const gchar *cThemeName, const gchar
 {
 	g_return_val_if_fail (cThemeName != NULL, FALSE);
 	gboolean bSuccess = FALSE;
+	cairo_dock_flush_conf_files ();  // the conf files are packaged as they are on the disk.
 
 	gchar *cNewThemeName = _escape_string_for_filename (cThemeName);
 	if (cDirPath == NULL || *cDirPath == '\0'
@@ -384,8 +429,8 @@ gboolean cairo_dock_delete_themes (gchar **cThemesList)
 		GLDI_SHARE_DATA_DIR"/"CAIRO_DOCK_ICON, NULL);
 	if (iClickedButton == 0 || iClickedButton == -1)  // ok button or Enter.
 	{
-		gchar *cThemeName;
-		int i, r;
+		gchar *cThemeName, *cThemePath;
+		int i;
 		for (i = 0; cThemesList[i] != NULL; i ++)
 		{
 			cThemeName = _escape_string_for_filename (cThemesList[i]);
@@ -397,10 +442,9 @@ gboolean cairo_dock_delete_themes (gchar **cThemesList)
 			cairo_dock_extract_package_type_from_name (cThemeName);
 			
 			bThemeDeleted = TRUE;
-			g_string_printf (sCommand, "rm -rf \"%s/%s\"", g_cThemesDirPath, cThemeName);
-			r = system (sCommand->str);  // g_rmdir only delete an empty dir...
-			if (r < 0)
-				cd_warning ("Not able to launch this command: %s", sCommand->str);
+			cThemePath = g_strdup_printf ("%s/%s", g_cThemesDirPath, cThemeName);
+			cairo_dock_remove_directory (cThemePath);
+			g_free (cThemePath);
 			g_free (cThemeName);
 		}
 	}
@@ -442,12 +486,94 @@ static gchar *_cairo_dock_get_theme_path (const gchar *cThemeName)  // a theme n
 	return cNewThemePath;
 }
 
-static void _launch_cmd (const gchar *cCommand)
+// same as 'for f in <dir>/*; do rm -f <dest>/`basename ${f%.*}`*; done'
+static void _remove_icons_replaced_by (const gchar *cNewIconsPath, const gchar *cIconsPath)
+{
+	GDir *dir = g_dir_open (cNewIconsPath, 0, NULL);
+	if (dir == NULL)
+		return;
+	GPtrArray *pNames = g_ptr_array_new_with_free_func (g_free);
+	const gchar *cFileName;
+	while ((cFileName = g_dir_read_name (dir)) != NULL)
+	{
+		if (*cFileName == '.')
+			continue;
+		const gchar *ext = strrchr (cFileName, '.');
+		g_ptr_array_add (pNames, ext ? g_strndup (cFileName, ext - cFileName) : g_strdup (cFileName));
+	}
+	g_dir_close (dir);
+	
+	dir = g_dir_open (cIconsPath, 0, NULL);
+	if (dir != NULL)
+	{
+		guint i;
+		gchar *cFilePath;
+		while ((cFileName = g_dir_read_name (dir)) != NULL)
+		{
+			for (i = 0; i < pNames->len; i ++)
+			{
+				if (g_str_has_prefix (cFileName, g_ptr_array_index (pNames, i)))
+				{
+					cFilePath = g_strdup_printf ("%s/%s", cIconsPath, cFileName);
+					g_remove (cFilePath);
+					g_free (cFilePath);
+					break;
+				}
+			}
+		}
+		g_dir_close (dir);
+	}
+	g_ptr_array_free (pNames, TRUE);
+}
+
+// same as 'find <dir> -mindepth 1 ! -name '*.conf' ! -path '<excluded>*' ! -type d -exec cp -p {} <dest> \;': the files of the tree are all copied into the same folder.
+static void _copy_files_flat (const gchar *cDirPath, const gchar *cDestDirPath, const gchar *cExcludedPath)
 {
-	cd_debug ("%s", cCommand);
-	int r = system (cCommand);
-	if (r < 0)
-		cd_warning ("Not able to launch this command: %s", cCommand);
+	GDir *dir = g_dir_open (cDirPath, 0, NULL);
+	if (dir == NULL)
+		return;
+	const gchar *cFileName;
+	gchar *cFilePath, *cDestFilePath;
+	while ((cFileName = g_dir_read_name (dir)) != NULL)
+	{
+		cFilePath = g_strdup_printf ("%s/%s", cDirPath, cFileName);
+		if (! g_str_has_prefix (cFilePath, cExcludedPath))
+		{
+			if (g_file_test (cFilePath, G_FILE_TEST_IS_DIR))
+				_copy_files_flat (cFilePath, cDestDirPath, cExcludedPath);
+			else if (! g_str_has_suffix (cFileName, ".conf"))
+			{
+				cDestFilePath = g_strdup_printf ("%s/%s", cDestDirPath, cFileName);
+				cairo_dock_copy_file (cFilePath, cDestFilePath);
+				g_free (cDestFilePath);
+			}
+		}
+		g_free (cFilePath);
+	}
+	g_dir_close (dir);
+}
+
+// same as 'chmod -R 775 <path>'
+static void _set_permissions (const gchar *cPath)
+{
+	g_chmod (cPath, 7*8*8+7*8+5);
+	GDir *dir = g_dir_open (cPath, 0, NULL);
+	if (dir == NULL)  // not a folder.
+		return;
+	const gchar *cFileName;
+	gchar *cFilePath;
+	while ((cFileName = g_dir_read_name (dir)) != NULL)
+	{
+		cFilePath = g_strdup_printf ("%s/%s", cPath, cFileName);
+		if (g_file_test (cFilePath, G_FILE_TEST_IS_SYMLINK))  // 'chmod -R' doesn't follow the links either.
+		{
+			g_free (cFilePath);
+			continue;
+		}
+		_set_permissions (cFilePath);
+		g_free (cFilePath);
+	}
+	g_dir_close (dir);
 }
 
 static gboolean _cairo_dock_import_local_theme (const gchar *cNewThemePath, gboolean bLoadBehavior, gboolean bLoadLaunchers)
@@ -455,15 +581,13 @@ static gboolean _cairo_dock_import_local_theme (const gchar *cNewThemePath, gboo
 	g_return_val_if_fail (cNewThemePath != NULL && g_file_test (cNewThemePath, G_FILE_TEST_EXISTS), FALSE);
 	
 	//\___________________ We load global behaviour parameters for each dock.
-	GString *sCommand = g_string_new ("");
+	cairo_dock_flush_conf_files ();  // write the pending updates now, rather than on top of the new conf files.
+	gchar *cPath;
 	cd_message ("Applying changes ...");
 	if (g_pMainDock == NULL || bLoadBehavior)
 	{
-		g_string_printf (sCommand, "rm -f \"%s\"/*.conf", g_cCurrentThemePath);
-		_launch_cmd (sCommand->str);
-
-		g_string_printf (sCommand, "cp \"%s\"/*.conf \"%s\"", cNewThemePath, g_cCurrentThemePath);
-		_launch_cmd (sCommand->str);
+		_remove_files (g_cCurrentThemePath, FALSE, _has_suffix, ".conf");
+		_copy_entries (cNewThemePath, g_cCurrentThemePath, TRUE, FALSE, _has_suffix, ".conf");
 	}
 	else
 	{
@@ -494,68 +618,58 @@ static gboolean _cairo_dock_import_local_theme (const gchar *cNewThemePath, gboo
 	//\___________________ We load icons
 	if (bLoadLaunchers)
 	{
-		g_string_printf (sCommand, "rm -f \"%s\"/*", g_cCurrentIconsPath);
-		_launch_cmd (sCommand->str);
-		g_string_printf (sCommand, "rm -f \"%s\"/.*", g_cCurrentIconsPath);
-		_launch_cmd (sCommand->str);
-		
-		g_string_printf (sCommand, "rm -f \"%s\"/*", g_cCurrentImagesPath);
-		_launch_cmd (sCommand->str);
-		g_string_printf (sCommand, "rm -f \"%s\"/.*", g_cCurrentImagesPath);
-		_launch_cmd (sCommand->str);
+		_remove_files (g_cCurrentIconsPath, TRUE, NULL, NULL);
+		_remove_files (g_cCurrentImagesPath, TRUE, NULL, NULL);
 	}
 	gchar *cNewLocalIconsPath = g_strdup_printf ("%s/%s", cNewThemePath, CAIRO_DOCK_LOCAL_ICONS_DIR);
 	if (! g_file_test (cNewLocalIconsPath, G_FILE_TEST_IS_DIR))  // it's an old theme: move icons to a new dir 'icons'.
 	{
-		g_string_printf (sCommand, "find \"%s/%s\" -mindepth 1 ! -name '*.desktop' -exec cp '{}' '%s' \\;", cNewThemePath, CAIRO_DOCK_LAUNCHERS_DIR, g_cCurrentIconsPath);
+		cPath = g_strdup_printf ("%s/%s", cNewThemePath, CAIRO_DOCK_LAUNCHERS_DIR);
+		_copy_entries (cPath, g_cCurrentIconsPath, TRUE, TRUE, _has_not_suffix, ".desktop");
+		g_free (cPath);
 	}
 	else
 	{
-		g_string_printf (sCommand, "for f in \"%s\"/* ; do rm -f \"%s/`basename \"${f%%.*}\"`\"*; done;", cNewLocalIconsPath, g_cCurrentIconsPath);  // we erase double items because we could have x.png and x.svg and the dock will not know which it has to use.
-		_launch_cmd (sCommand->str);
-		
-		g_string_printf (sCommand, "cp \"%s\"/* \"%s\"", cNewLocalIconsPath, g_cCurrentIconsPath);
+		_remove_icons_replaced_by (cNewLocalIconsPath, g_cCurrentIconsPath);  // we erase double items because we could have x.png and x.svg and the dock will not know which it has to use.
+		_copy_entries (cNewLocalIconsPath, g_cCurrentIconsPath, TRUE, FALSE, NULL, NULL);
 	}
-	_launch_cmd (sCommand->str);
 	g_free (cNewLocalIconsPath);
 	
 	//\___________________ We load extras.
-	g_string_printf (sCommand, "%s/%s", cNewThemePath, CAIRO_DOCK_LOCAL_EXTRAS_DIR);
-	if (g_file_test (sCommand->str, G_FILE_TEST_IS_DIR))
+	cPath = g_strdup_printf ("%s/%s", cNewThemePath, CAIRO_DOCK_LOCAL_EXTRAS_DIR);
+	if (g_file_test (cPath, G_FILE_TEST_IS_DIR))
 	{
-		g_string_printf (sCommand, "cp -r \"%s/%s\"/* \"%s\"", cNewThemePath, CAIRO_DOCK_LOCAL_EXTRAS_DIR, g_cExtrasDirPath);
-		_launch_cmd (sCommand->str);
+		_copy_entries (cPath, g_cExtrasDirPath, FALSE, FALSE, NULL, NULL);
 	}
+	g_free (cPath);
 	
 	//\___________________ We load launcher if needed after having removed old ones.
 	if (! g_file_test (g_cCurrentLaunchersPath, G_FILE_TEST_EXISTS))
 	{
-		g_string_printf (sCommand, "mkdir -p \"%s\"", g_cCurrentLaunchersPath);
-		_launch_cmd (sCommand->str);
+		g_mkdir_with_parents (g_cCurrentLaunchersPath, 7*8*8+7*8+5);
 	}
 	if (g_pMainDock == NULL || bLoadLaunchers)
 	{
-		g_string_printf (sCommand, "rm -f \"%s\"/*.desktop", g_cCurrentLaunchersPath);
-		_launch_cmd (sCommand->str);
-
-		g_string_printf (sCommand, "cp \"%s/%s\"/*.desktop \"%s\"", cNewThemePath, CAIRO_DOCK_LAUNCHERS_DIR, g_cCurrentLaunchersPath);
-		_launch_cmd (sCommand->str);
+		_remove_files (g_cCurrentLaunchersPath, FALSE, _has_suffix, ".desktop");
+		
+		cPath = g_strdup_printf ("%s/%s", cNewThemePath, CAIRO_DOCK_LAUNCHERS_DIR);
+		_copy_entries (cPath, g_cCurrentLaunchersPath, TRUE, FALSE, _has_suffix, ".desktop");
+		g_free (cPath);
 	}
 	
 	//\___________________ We replace all files by the new ones.
-	g_string_printf (sCommand, "find \"%s\" -mindepth 1 -maxdepth 1  ! -name '*.conf' -type f -exec rm -f '{}' \\;", g_cCurrentThemePath);  // remove all ficher of the theme except launchers and plugins.
-	_launch_cmd (sCommand->str);
-
+	_remove_files (g_cCurrentThemePath, TRUE, _has_not_suffix, ".conf");  // remove all ficher of the theme except launchers and plugins.
+	
 	if (g_pMainDock == NULL || bLoadBehavior)
 	{
-		g_string_printf (sCommand, "find \"%s\"/* -prune ! -name '*.conf' ! -name %s -exec cp -r '{}' \"%s\" \\;", cNewThemePath, CAIRO_DOCK_LAUNCHERS_DIR, g_cCurrentThemePath);  // Copy all files of the new theme except launchers and .conf files in the dir of the current theme. Overwrite files with same names
-		_launch_cmd (sCommand->str);
+		_copy_entries (cNewThemePath, g_cCurrentThemePath, FALSE, FALSE, _is_theme_data, NULL);  // Copy all files of the new theme except launchers and .conf files in the dir of the current theme. Overwrite files with same names
 	}
 	else
 	{
 		// We copy all files of the new theme except launchers and .conf files (dock and plug-ins).
-		g_string_printf (sCommand, "find \"%s\" -mindepth 1 ! -name '*.conf' ! -path '%s/%s*' ! -type d -exec cp -p {} \"%s\" \\;", cNewThemePath, cNewThemePath, CAIRO_DOCK_LAUNCHERS_DIR, g_cCurrentThemePath);
-		_launch_cmd (sCommand->str);
+		cPath = g_strdup_printf ("%s/%s", cNewThemePath, CAIRO_DOCK_LAUNCHERS_DIR);
+		_copy_files_flat (cNewThemePath, g_cCurrentThemePath, cPath);
+		g_free (cPath);
 		
 		// iterate all .conf files of all plug-ins, then update them and merge them with the current theme.
 		gchar *cNewPlugInsDir = g_strdup_printf ("%s/%s", cNewThemePath, CAIRO_DOCK_PLUG_INS_DIR);  // dir of plug-ins of the new theme.
@@ -575,8 +689,7 @@ static gboolean _cairo_dock_import_local_theme (const gchar *cNewThemePath, gboo
 			{
 				cd_debug ("    directory %s doesn't exist, it will be created.", cUserDataDirPath);
 				
-				g_string_printf (sCommand, "mkdir -p \"%s\"", cUserDataDirPath);
-				_launch_cmd (sCommand->str);
+				g_mkdir_with_parents (cUserDataDirPath, 7*8*8+7*8+5);
 			}
 			
 			// we find the name and path of the .conf file of the plugin in the new theme.
@@ -617,16 +730,15 @@ static gboolean _cairo_dock_import_local_theme (const gchar *cNewThemePath, gboo
 		g_free (cNewPlugInsDir);
 	}
 	
-	g_string_printf (sCommand, "rm -f \"%s/last-modif\"", g_cCurrentThemePath);
-	_launch_cmd (sCommand->str);
+	cPath = g_strdup_printf ("%s/last-modif", g_cCurrentThemePath);
+	g_remove (cPath);
+	g_free (cPath);
 	
 	// precaution maybe useless.
-	g_string_printf (sCommand, "chmod -R 775 \"%s\"", g_cCurrentThemePath);
-	_launch_cmd (sCommand->str);
+	_set_permissions (g_cCurrentThemePath);
 	
 	cairo_dock_mark_current_theme_as_modified (FALSE);
 	
-	g_string_free (sCommand, TRUE);
 	return TRUE;
 }
 
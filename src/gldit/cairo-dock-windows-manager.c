@@ -32,6 +32,11 @@ GList *s_pWindowsList = NULL;  // list of all window actors
 static gboolean s_bSortedByZ = FALSE;  // whether the list is currently sorted by z-order
 static gboolean s_bSortedByAge = FALSE;  // whether the list is currently sorted by age
 static GldiWindowManagerBackend s_backend;
+static GldiWindowsSnapshot *s_pSnapshot = NULL;  // current snapshot, published with an atomic exchange
+static gint s_iNbSnapshotReaders = 0;  // number of threads currently between the load of s_pSnapshot and the ref on it
+static GSList *s_pRetiredSnapshots = NULL;  // snapshots replaced while a reader might still be taking them (main thread only)
+static guint s_iSidPublishSnapshot = 0;
+static guint s_iSidReleaseRetired = 0;
 
 
 static gboolean on_zorder_changed (G_GNUC_UNUSED gpointer data)
@@ -91,6 +96,109 @@ GldiWindowActor *gldi_windows_find (gboolean (*callback) (GldiWindowActor*, gpoi
 }
 
 
+  ////////////////
+ /// SNAPSHOT ///
+////////////////
+
+static void _free_snapshot (GldiWindowsSnapshot *pSnapshot)
+{
+	g_free (pSnapshot->pWindows);
+	g_string_chunk_free (pSnapshot->pStrings);
+	g_free (pSnapshot);
+}
+
+GldiWindowsSnapshot *gldi_windows_snapshot_acquire (void)
+{
+	// announce ourselves, so that the main thread doesn't release the snapshot between the moment we get it and the moment we take a ref on it.
+	g_atomic_int_inc (&s_iNbSnapshotReaders);
+	GldiWindowsSnapshot *pSnapshot = g_atomic_pointer_get (&s_pSnapshot);
+	g_atomic_int_inc (&pSnapshot->iRefCount);
+	g_atomic_int_add (&s_iNbSnapshotReaders, -1);
+	return pSnapshot;
+}
+
+void gldi_windows_snapshot_release (GldiWindowsSnapshot *pSnapshot)
+{
+	if (pSnapshot == NULL)
+		return;
+	if (g_atomic_int_dec_and_test (&pSnapshot->iRefCount))
+		_free_snapshot (pSnapshot);
+}
+
+static gboolean _release_retired_snapshots (G_GNUC_UNUSED gpointer data)
+{
+	if (g_atomic_int_get (&s_iNbSnapshotReaders) != 0)  // a reader may still be taking one of them, retry a bit later (readers only stay there for a few instructions).
+		return TRUE;
+	g_slist_free_full (s_pRetiredSnapshots, (GDestroyNotify)gldi_windows_snapshot_release);
+	s_pRetiredSnapshots = NULL;
+	s_iSidReleaseRetired = 0;
+	return FALSE;
+}
+
+static void _fill_window_info (GldiWindowActor *actor, GldiWindowsSnapshot *pSnapshot)
+{
+	GldiWindowInfo *info = &pSnapshot->pWindows[pSnapshot->iNbWindows ++];
+	info->actor = actor;
+	info->iId = gldi_window_get_id (actor);
+	info->bDisplayed = actor->bDisplayed;
+	info->bIsHidden = actor->bIsHidden;
+	info->bIsFullScreen = actor->bIsFullScreen;
+	info->bIsMaximized = actor->bIsMaximized;
+	info->bDemandsAttention = actor->bDemandsAttention;
+	info->bIsTransientFor = actor->bIsTransientFor;
+	info->windowGeometry = actor->windowGeometry;
+	info->iNumDesktop = actor->iNumDesktop;
+	info->iViewPortX = actor->iViewPortX;
+	info->iViewPortY = actor->iViewPortY;
+	info->iStackOrder = actor->iStackOrder;
+	info->iAge = actor->iAge;
+	info->cClass = (actor->cClass ? g_string_chunk_insert_const (pSnapshot->pStrings, actor->cClass) : NULL);  // classes are shared by several windows
+	info->cWmClass = (actor->cWmClass ? g_string_chunk_insert_const (pSnapshot->pStrings, actor->cWmClass) : NULL);
+	info->cName = (actor->cName ? g_string_chunk_insert (pSnapshot->pStrings, actor->cName) : NULL);
+}
+
+static gboolean _publish_snapshot (G_GNUC_UNUSED gpointer data)
+{
+	//\_____________ build a new snapshot of the current windows
+	GldiWindowsSnapshot *pSnapshot = g_new0 (GldiWindowsSnapshot, 1);
+	pSnapshot->iRefCount = 1;  // owned by s_pSnapshot
+	pSnapshot->iSerial = (s_pSnapshot ? s_pSnapshot->iSerial + 1 : 0);
+	pSnapshot->pWindows = g_new0 (GldiWindowInfo, MAX (1, g_list_length (s_pWindowsList)));
+	pSnapshot->pStrings = g_string_chunk_new (256);
+	gldi_windows_foreach (FALSE, (GFunc)_fill_window_info, pSnapshot);
+	GldiWindowActor *pActiveWindow = gldi_windows_get_active ();
+	guint i;
+	for (i = 0; i < pSnapshot->iNbWindows; i ++)
+		pSnapshot->pWindows[i].bIsActive = (pSnapshot->pWindows[i].actor == pActiveWindow);
+	
+	//\_____________ swap it with the current one
+	GldiWindowsSnapshot *pOldSnapshot = s_pSnapshot;
+	g_atomic_pointer_set (&s_pSnapshot, pSnapshot);
+	
+	//\_____________ drop our ref on the old one, once no reader can be taking it any more
+	if (pOldSnapshot != NULL)
+	{
+		s_pRetiredSnapshots = g_slist_prepend (s_pRetiredSnapshots, pOldSnapshot);
+		if (s_iSidReleaseRetired == 0 && _release_retired_snapshots (NULL))  // if a retry is already planned, it will release it too.
+			s_iSidReleaseRetired = g_timeout_add (10, _release_retired_snapshots, NULL);
+	}
+	s_iSidPublishSnapshot = 0;
+	return FALSE;
+}
+
+static void _schedule_snapshot (void)
+{
+	if (s_iSidPublishSnapshot == 0)  // all the changes until the next idle are published at once.
+		s_iSidPublishSnapshot = g_idle_add (_publish_snapshot, NULL);
+}
+
+static gboolean on_window_changed (G_GNUC_UNUSED gpointer data)
+{
+	_schedule_snapshot ();
+	return GLDI_NOTIFICATION_LET_PASS;
+}
+
+
   ///////////////
  /// BACKEND ///
 ///////////////
@@ -349,6 +457,7 @@ static void init_object (GldiObject *obj, G_GNUC_UNUSED gpointer attr)
 {
 	GldiWindowActor *actor = (GldiWindowActor*)obj;
 	s_pWindowsList = g_list_prepend (s_pWindowsList, actor);
+	_schedule_snapshot ();  // the backends don't notify the windows they find at startup; the actor is filled by the time the snapshot is built.
 }
 
 static void reset_object (GldiObject *obj)
@@ -359,6 +468,7 @@ static void reset_object (GldiObject *obj)
 	g_free (actor->cWmClass);
 	g_free (actor->cLastAttentionDemand);
 	s_pWindowsList = g_list_remove (s_pWindowsList, actor);
+	_schedule_snapshot ();
 }
 
 void gldi_register_windows_manager (void)
@@ -379,5 +489,16 @@ void gldi_register_windows_manager (void)
 		NOTIFICATION_WINDOW_Z_ORDER_CHANGED,
 		(GldiNotificationFunc) on_zorder_changed,
 		GLDI_RUN_FIRST, NULL);
+	int iNotification;
+	for (iNotification = NOTIFICATION_WINDOW_CREATED; iNotification < NB_NOTIFICATIONS_WINDOWS; iNotification ++)
+	{
+		if (iNotification == NOTIFICATION_WINDOW_ICON_CHANGED)  // not part of the snapshot
+			continue;
+		gldi_object_register_notification (&myWindowObjectMgr,
+			iNotification,
+			(GldiNotificationFunc) on_window_changed,
+			GLDI_RUN_AFTER, NULL);
+	}
+	_publish_snapshot (NULL);  // so that there is always a snapshot to acquire
 }
 
@@ -100,6 +100,40 @@ struct _GldiWindowActor {
 	gboolean bIsTransientFor;  // TRUE if the window is transient (for a parent window).
 	};
 
+/// Definition of the state of a window at a given time, as found in a snapshot.
+struct _GldiWindowInfo {
+	GldiWindowActor *actor;  /// only to compare or look it up on the main thread; never dereference it from another thread.
+	guint iId;
+	gboolean bDisplayed;
+	gboolean bIsHidden;
+	gboolean bIsFullScreen;
+	gboolean bIsMaximized;
+	gboolean bDemandsAttention;
+	gboolean bIsTransientFor;
+	gboolean bIsActive;
+	GtkAllocation windowGeometry;
+	gint iNumDesktop;
+	gint iViewPortX, iViewPortY;
+	gint iStackOrder;
+	gint iAge;
+	const gchar *cClass;
+	const gchar *cWmClass;
+	const gchar *cName;
+	};
+
+/// Definition of an immutable snapshot of all the windows. It can be read from any thread, as long as it is held.
+struct _GldiWindowsSnapshot {
+	gint iRefCount;
+	/// incremented each time a new snapshot is published
+	guint iSerial;
+	/// number of windows
+	guint iNbWindows;
+	/// the windows, sorted by age
+	GldiWindowInfo *pWindows;
+	/// where the strings live
+	GStringChunk *pStrings;
+	};
+
 
 /** Register a Window Manager backend. NULL functions are simply ignored.
 *@param pBackend a Window Manager backend
@@ -120,6 +154,16 @@ void gldi_windows_foreach (gboolean bOrderedByZ, GFunc callback, gpointer data);
 */
 GldiWindowActor *gldi_windows_find (gboolean (*callback) (GldiWindowActor*, gpointer), gpointer data);
 
+/** Get the current snapshot of the windows. This can be called from any thread (typically from the 'get_data' of a GldiTask), and never blocks nor waits for the main loop. The snapshot is immutable; a new one is published after each batch of changes on the windows.
+*@return the current snapshot, to be released with \ref gldi_windows_snapshot_release once you're done with it.
+*/
+GldiWindowsSnapshot *gldi_windows_snapshot_acquire (void);
+
+/** Release a snapshot got with \ref gldi_windows_snapshot_acquire. Can be called from any thread.
+*@param pSnapshot the snapshot
+*/
+void gldi_windows_snapshot_release (GldiWindowsSnapshot *pSnapshot);
+
 /** Get the current active window actor.
 *@return the actor, or NULL if no window is currently active
 */
@@ -85,7 +85,6 @@ static Atom s_aWmHints;
 static Atom s_aNetStartupInfoBegin;
 static Atom s_aNetStartupInfo;
 static GHashTable *s_hXWindowTable = NULL;  // table of (Xid,actor)
-static GHashTable *s_hXClientMessageTable = NULL;  // table of (Xid,client-message)
 static int s_iTime = 1;  // on peut aller jusqu'a 2^31, soit 17 ans a 4Hz.
 static int s_iNumWindow = 1;  // used to order appli icons by age (=creation date).
 static Window s_iCurrentActiveWindow = 0;
@@ -97,6 +96,22 @@ typedef enum {
 	X_URGENCY_HINT = (1 << 2)
 } XAttentionFlag;
 
+// startup-notification messages (_NET_STARTUP_INFO_BEGIN + _NET_STARTUP_INFO), sent by pieces of 20 bytes
+#define CAIRO_DOCK_STARTUP_MSG_MAX_LENGTH 1024  // a message is a few key/value pairs; longer ones are dropped
+#define CAIRO_DOCK_STARTUP_MSG_NB_SLOTS 8  // number of messages that can be reassembled at the same time (one per sender)
+#define CAIRO_DOCK_STARTUP_MSG_MAX_NB_KEYS 16
+typedef struct {
+	Window Xid;  // window that sends the message, None if the slot is free
+	gint iLength;
+	gchar buffer[CAIRO_DOCK_STARTUP_MSG_MAX_LENGTH];
+	} CairoDockStartupMessage;
+typedef struct {
+	gchar *cKey;
+	gchar *cValue;
+	} CairoDockStartupKeyValue;
+static CairoDockStartupMessage s_pStartupMessages[CAIRO_DOCK_STARTUP_MSG_NB_SLOTS];  // no allocation at all, each slot is reused
+static int s_iNextStartupSlot = 0;  // slot to recycle if they are all used
+
 // signals
 typedef enum {
 	NB_NOTIFICATIONS_X_MANAGER = NB_NOTIFICATIONS_WINDOWS
@@ -355,6 +370,148 @@ static void lookup_ignorable_modifiers (void)
 	scroll_lock_mask = XkbKeysymToModifiers (s_XDisplay, GDK_KEY_Scroll_Lock);
 }
 
+static int _parse_startup_message (gchar *cMessage, gchar **cType, CairoDockStartupKeyValue *pKeyValues, int iMaxNbKeys)
+{
+	// the message looks like: 'type: KEY=VALUE KEY="VALUE WITH SPACES" KEY=VALUE\ WITH\ ESCAPED\ SPACES'; it's parsed in-place.
+	gchar *str = strchr (cMessage, ':');
+	if (str == NULL)
+		return -1;
+	*str = '\0';
+	*cType = cMessage;
+	str ++;
+	
+	int n = 0;
+	gchar *key, *value, *out;
+	gboolean bQuoted, bEnd;
+	while (n < iMaxNbKeys)
+	{
+		while (*str == ' ')
+			str ++;
+		if (*str == '\0')
+			break;
+		// key
+		key = str;
+		while (*str != '=' && *str != ' ' && *str != '\0')
+			str ++;
+		if (*str != '=')  // malformed message, keep what we got so far
+			break;
+		*str = '\0';
+		str ++;
+		// value: remove the quotes and the escaping characters
+		value = out = str;
+		bQuoted = FALSE;
+		while (*str != '\0' && (bQuoted || *str != ' '))
+		{
+			if (*str == '"')
+			{
+				bQuoted = ! bQuoted;
+				str ++;
+			}
+			else if (*str == '\\' && str[1] != '\0')
+			{
+				*out++ = str[1];
+				str += 2;
+			}
+			else
+				*out++ = *str++;
+		}
+		bEnd = (*str == '\0');
+		*out = '\0';
+		pKeyValues[n].cKey = key;
+		pKeyValues[n].cValue = value;
+		n ++;
+		if (bEnd)
+			break;
+		str ++;
+	}
+	return n;
+}
+
+static void _on_startup_message_complete (CairoDockStartupMessage *pMsg)
+{
+	cd_debug (" => message: %s", pMsg->buffer);
+	gchar *cType = NULL;
+	CairoDockStartupKeyValue pKeyValues[CAIRO_DOCK_STARTUP_MSG_MAX_NB_KEYS];
+	int i, n = _parse_startup_message (pMsg->buffer, &cType, pKeyValues, CAIRO_DOCK_STARTUP_MSG_MAX_NB_KEYS);
+	for (i = 0; i < n; i ++)
+	{
+		if (strcmp (pKeyValues[i].cKey, "ID") != 0)
+			continue;
+		gchar *str = pKeyValues[i].cValue;
+		cd_debug (" => ID: %s", str);
+		// extract the class if it's one of our ID
+		if (strncmp (str, "gldi-", 5) == 0)  // we built this ID => it has the class inside
+		{
+			str += 5;
+			gchar *id_end = strrchr (str, '-');
+			if (id_end)
+				*id_end = '\0';
+			cd_debug (" => class: %s", str);
+			// notify the class about the end of the launching
+			gldi_class_startup_notify_end (str);
+		}
+		break;
+	}
+}
+
+static CairoDockStartupMessage *_get_startup_message (Window Xid)
+{
+	int i;
+	for (i = 0; i < CAIRO_DOCK_STARTUP_MSG_NB_SLOTS; i ++)
+	{
+		if (s_pStartupMessages[i].Xid == Xid)
+			return &s_pStartupMessages[i];
+	}
+	return NULL;
+}
+
+static void _on_startup_message (Window Xid, gboolean bBegin, const char *data)
+{
+	//\_____________ get the message being reassembled for this sender, or start a new one.
+	CairoDockStartupMessage *pMsg = _get_startup_message (Xid);  // a sender has at most 1 slot, since its messages can't be interleaved.
+	if (bBegin)
+	{
+		if (strncmp (data, "remove:", 7) != 0)  // ignore 'new:' and 'change:' messages (the next pieces will be ignored too, since they have no slot)
+		{
+			if (pMsg != NULL)  // the sender never finished its previous message, drop it so that the next pieces are not appended to it.
+				pMsg->Xid = None;
+			return;
+		}
+		if (pMsg == NULL)  // take a free slot
+			pMsg = _get_startup_message (None);
+		if (pMsg == NULL)  // all slots are used by incomplete messages, recycle one.
+		{
+			pMsg = &s_pStartupMessages[s_iNextStartupSlot];
+			s_iNextStartupSlot = (s_iNextStartupSlot + 1) % CAIRO_DOCK_STARTUP_MSG_NB_SLOTS;
+		}
+		pMsg->Xid = Xid;
+		pMsg->iLength = 0;
+	}
+	else if (pMsg == NULL)  // not a message we're interested in
+		return;
+	
+	//\_____________ append the new piece; the message ends with the first '\0'.
+	int iPieceLength = 0;
+	while (iPieceLength < 20 && data[iPieceLength] != '\0')
+		iPieceLength ++;
+	if (pMsg->iLength + iPieceLength >= CAIRO_DOCK_STARTUP_MSG_MAX_LENGTH)  // too long, drop it
+	{
+		cd_warning ("startup-notification message too long, ignored");
+		pMsg->Xid = None;
+		return;
+	}
+	memcpy (pMsg->buffer + pMsg->iLength, data, iPieceLength);
+	pMsg->iLength += iPieceLength;
+	
+	//\_____________ if it's complete, handle it and free the slot.
+	if (iPieceLength < 20)
+	{
+		pMsg->buffer[pMsg->iLength] = '\0';
+		_on_startup_message_complete (pMsg);
+		pMsg->Xid = None;
+	}
+}
+
 static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 {
 	static XEvent event;
@@ -381,109 +538,10 @@ static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 		{
 			cd_debug ("+ message: %s (%ld/%ld)", XGetAtomName (s_XDisplay, event.xclient.message_type), Xid, root);
 			
-			// make a new message or get the existing one from previous startup events on this window
-			GString *pMsg = NULL;
 			if (event.xclient.message_type == s_aNetStartupInfoBegin)
-			{
-				if (strncmp (&event.xclient.data.b[0], "remove:", 7) == 0)  // ignore 'new:' and 'change:' messages
-				{
-					pMsg = g_string_sized_new (128);
-					
-					Window *pXid = g_new (Window, 1);
-					*pXid = Xid;
-					g_hash_table_insert (s_hXClientMessageTable, pXid, pMsg);
-				}
-			}
+				_on_startup_message (Xid, TRUE, event.xclient.data.b);
 			else if (event.xclient.message_type == s_aNetStartupInfo)
-			{
-				pMsg = g_hash_table_lookup (s_hXClientMessageTable, &Xid);
-			}
-			
-			// if a startup message is available, take it into account
-			if (pMsg)
-			{
-				// append the new data to the message
-				g_string_append_len (pMsg, &event.xclient.data.b[0], 20);
-				
-				// check if the messge is complete
-				int i = 0;
-				while (i < 20 && event.xclient.data.b[i] != '\0')
-					i ++;
-				
-				// if it is, parse it
-				if (i < 20)  // this event is the end of the message => it's complete; we should have something like: 'remove ID="id-value"'
-				{
-					cd_debug (" => message: %s", pMsg->str);
-					// look for the ID key
-					gchar *str = NULL;
-					do  // look for "ID *="
-					{
-						str = strstr (pMsg->str, "ID");
-						if (str)
-						{
-							str += 2;
-							while (*str == ' ') str++;
-							if (*str == '=')
-							{
-								str ++;
-								break;
-							}
-						}
-						str = NULL;
-					}
-					while(1);
-					
-					if (str)
-					{
-						// extract the ID value
-						while (*str == ' ') str++;
-						gboolean quoted = (*str == '"');
-						if (quoted)
-							str ++;
-						gchar *id_end = str+1;
-						// We can have: ID="gldi-atom\ shell-2", with a whitespace... yes
-						if (quoted)
-						{
-							// we need to remove '\' and '"'
-							gchar *withoutChar = id_end;
-							while (*id_end != '\0' && *id_end != '"')
-							{
-								*withoutChar = *id_end;
-								if (*withoutChar != '\\')
-									withoutChar ++;
-								id_end ++;
-							}
-							/* id_end should be at the '"' char but because we
-							 * have moved all char if we found '\', the new end
-							 * is at the position of withoutChar
-							 */
-							*withoutChar = '\0';
-						}
-						else
-						{
-							while (*id_end != '\0' && *id_end != ' ')
-								id_end ++;
-							*id_end = '\0';
-						}
-						cd_debug (" => ID: %s", str);
-
-						// extract the class if it's one of our ID
-						if (strncmp (str, "gldi-", 5) == 0)  // we built this ID => it has the class inside
-						{
-							str += 5;
-							id_end = strrchr (str, '-');
-							if (id_end)
-								*id_end = '\0';
-							cd_debug (" => class: %s", str);
-							// notify the class about the end of the launching
-							gldi_class_startup_notify_end (str);
-						}
-					}
-					
-					// destroy this message
-					g_hash_table_remove (s_hXClientMessageTable, &Xid);
-				}
-			}
+				_on_startup_message (Xid, FALSE, event.xclient.data.b);
 		}
 		else if (event.type == MappingNotify)  // keymap changed (this event is always sent to all clients)
 		{
@@ -491,6 +549,10 @@ static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 			lookup_ignorable_modifiers ();
 			gldi_object_notify (&myDesktopMgr, NOTIFICATION_KEYMAP_CHANGED, TRUE);
 		}
+		else if (cairo_dock_is_screen_change_event (&event))  // a screen has been plugged/unplugged/resized/rotated
+		{
+			_on_change_desktop_geometry ();  // -> NOTIFICATION_DESKTOP_GEOMETRY_CHANGED
+		}
 		else if (Xid == root)  // event on the desktop
 		{
 			if (event.type == PropertyNotify)
@@ -659,6 +721,7 @@ static gboolean _cairo_dock_unstack_Xevents (G_GNUC_UNUSED gpointer data)
 				{
 					if (xactor->bIgnored)  // skip taskbar
 						continue;
+					cairo_dock_forget_xwindow_icon (Xid);  // the cached icon is now outdated
 					// notify everybody
 					gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_ICON_CHANGED, actor);
 				}
@@ -1127,10 +1190,6 @@ static void _present (GldiContainer *pContainer)
  /// INIT ///
 ////////////
 
-static void _string_free (GString *pString)
-{
-	g_string_free (pString, TRUE);
-}
 
 static gboolean _prepare (G_GNUC_UNUSED GSource *source, gint *timeout)
 {
@@ -1179,11 +1238,6 @@ static void init (void)
 		g_free,  // Xid
 		NULL);  // actor
 	
-	s_hXClientMessageTable = g_hash_table_new_full (g_int_hash,
-		g_int_equal,
-		g_free,  // Xid
-		(GDestroyNotify)_string_free);  // GString
-	
 	//\__________________ get the list of windows
 	gulong i, iNbWindows = 0;
 	Window *pXWindowsList = cairo_dock_get_windows_list (&iNbWindows, FALSE);  // ordered by creation date; this allows us to set the correct age to the icon, which is constant. On the next updates, the z-order (which is dynamic) will be set.
@@ -1210,6 +1264,7 @@ static void init (void)
 	//\__________________ listen for X events
 	Window root = DefaultRootWindow (s_XDisplay);
 	cairo_dock_set_xwindow_mask (root, PropertyChangeMask | KeyPressMask);
+	cairo_dock_listen_for_screen_changes ();  // from now on, the screens geometry is only re-read when the server tells us it has changed
 	
 	static GSourceFuncs source_funcs;
 	memset (&source_funcs,0, sizeof (GSourceFuncs));
@@ -1342,6 +1397,8 @@ static void reset_object (GldiObject *obj)
 	
 	cairo_dock_set_xicon_geometry (actor->Xid, 0, 0, 0, 0);
 	
+	cairo_dock_forget_xwindow_icon (actor->Xid);
+	
 	// remove from table
 	if (actor->iLastCheckTime != -1)  // if not already removed
 		g_hash_table_remove (s_hXWindowTable, &actor->Xid);
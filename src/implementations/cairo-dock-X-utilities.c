@@ -34,7 +34,7 @@
 
 #include "cairo-dock-log.h"
 #include "cairo-dock-utils.h"  // cairo_dock_remove_version_from_string, cairo_dock_check_xrandr
-#include "cairo-dock-surface-factory.h"  // cairo_dock_create_surface_from_xicon_buffer
+#include "cairo-dock-surface-factory.h"  // cairo_dock_create_surface_from_argb_pixels
 #include "cairo-dock-desktop-manager.h"
 #include "cairo-dock-opengl.h"  // for texture_from_pixmap
 #include "cairo-dock-X-utilities.h"
@@ -47,6 +47,7 @@ extern CairoDockGLConfig g_openglConfig;
 static gboolean s_bUseXComposite = TRUE;
 static gboolean s_bUseXinerama = TRUE;
 static gboolean s_bUseXrandr = TRUE;
+static int s_iXrandrEventBase = -1;  // -1 means we don't receive the RRScreenChangeNotify events
 //extern int g_iDamageEvent;
 
 static Display *s_XDisplay = NULL;
@@ -88,8 +89,24 @@ static Atom s_aWmName;
 static Atom s_aUtf8String;
 static Atom s_aString;
 static unsigned char error_code = Success;
+// cache of the _NET_WM_ICON
+typedef struct {
+	guint64 iHash;  // hash of the pixels and the size, used as key
+	gint iWidth, iHeight;
+	guint32 *pPixels;  // premultiplied ARGB32
+	gint iRefCount;
+	} CairoDockXIcon;
+typedef struct {
+	CairoDockXIcon *pIcon;  // may be NULL if the window has no _NET_WM_ICON
+	gint iSize;  // size the icon has been chosen for
+	} CairoDockXWindowIcon;
+static GHashTable *s_hXIconTable = NULL;  // table of (hash,icon); windows with identical icons (typically of the same class) share the same buffer.
+static GHashTable *s_hXWindowIconTable = NULL;  // table of (Xid,window-icon)
+#define CAIRO_DOCK_XICON_MAX_NB_SIZES 32  // to stop on broken buffers
+#define CAIRO_DOCK_XICON_MAX_SIZE 4096
 
 static GtkAllocation *_get_screens_geometry (int *pNbScreens);
+static void _free_xwindow_icon (CairoDockXWindowIcon *pWindowIcon);
 
 static gboolean cairo_dock_support_X_extension (void);
 
@@ -166,6 +183,12 @@ Display *cairo_dock_initialize_X_desktop_support (void)
 	
 	g_desktopGeometry.pScreens = _get_screens_geometry (&g_desktopGeometry.iNbScreens);
 	
+	s_hXIconTable = g_hash_table_new (g_int64_hash, g_int64_equal);  // the key belongs to the icon
+	s_hXWindowIconTable = g_hash_table_new_full (g_int_hash,
+		g_int_equal,
+		g_free,
+		(GDestroyNotify)_free_xwindow_icon);
+	
 	return s_XDisplay;
 }
 
@@ -208,7 +231,7 @@ static GtkAllocation *_get_screens_geometry (int *pNbScreens)
 	if (s_bUseXrandr)  // we place Xrandr first to get more tests :) (and also because it will deprecate Xinerama).
 	{
 		cd_debug ("Using Xrandr to determine the screen's position and size ...");
-		XRRScreenResources *res = XRRGetScreenResources (s_XDisplay, DefaultRootWindow (s_XDisplay));  // Xrandr >= 1.3
+		XRRScreenResources *res = XRRGetScreenResourcesCurrent (s_XDisplay, DefaultRootWindow (s_XDisplay));  // Xrandr >= 1.3; unlike XRRGetScreenResources(), it doesn't make the server poll the outputs, which can block it for a noticeable time; it's up-to-date anyway, since we're called when the server has told us the configuration has changed.
 		if (res != NULL)
 		{
 			int n = res->ncrtc;
@@ -444,30 +467,21 @@ int cairo_dock_get_current_desktop (void)
 void cairo_dock_get_current_viewport (int *iCurrentViewPortX, int *iCurrentViewPortY)
 {
 	Window root = DefaultRootWindow (s_XDisplay);
-	
-	Window root_return;
-	int x_return=1, y_return=1;
-	unsigned int width_return, height_return, border_width_return, depth_return;
-	XGetGeometry (s_XDisplay, root,
-		&root_return,
-		&x_return, &y_return,
-		&width_return, &height_return,
-		&border_width_return, &depth_return);
-	*iCurrentViewPortX = x_return;
-	*iCurrentViewPortY = y_return;
+	*iCurrentViewPortX = 0;  // the root window is always at (0;0), no need to ask the server.
+	*iCurrentViewPortY = 0;
 	
 	Atom aReturnedType = 0;
 	int aReturnedFormat = 0;
 	unsigned long iLeftBytes, iBufferNbElements = 0;
 	gulong *pViewportsXY = NULL;
-	XGetWindowProperty (s_XDisplay, root, s_aNetDesktopViewport, 0, G_MAXULONG, False, XA_CARDINAL, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pViewportsXY);
-	if (iBufferNbElements > 0)
+	XGetWindowProperty (s_XDisplay, root, s_aNetDesktopViewport, 0, 2, False, XA_CARDINAL, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pViewportsXY);  // the property holds the viewport of each desktop, but only the first one is meaningful for us
+	if (iBufferNbElements > 1)
 	{
 		*iCurrentViewPortX = pViewportsXY[0];
 		*iCurrentViewPortY = pViewportsXY[1];
-		XFree (pViewportsXY);
 	}
-	
+	if (pViewportsXY != NULL)
+		XFree (pViewportsXY);
 }
 
 int cairo_dock_get_nb_desktops (void)
@@ -485,6 +499,7 @@ int cairo_dock_get_nb_desktops (void)
 	else
 		iNumberOfDesktops = 0;
 	
+	XFree (pXDesktopNumberBuffer);
 	return iNumberOfDesktops;
 }
 
@@ -759,6 +774,8 @@ static gboolean cairo_dock_support_X_extension (void)
 	
 	// check for Xrandr >= 1.3
 	s_bUseXrandr = cairo_dock_check_xrandr (1, 3);
+	if (s_bUseXrandr && ! XRRQueryExtension (s_XDisplay, &s_iXrandrEventBase, &error_base))
+		s_iXrandrEventBase = -1;
 	
 	return TRUE;
 #else
@@ -775,6 +792,26 @@ gboolean cairo_dock_xcomposite_is_available (void)
 	return s_bUseXComposite;
 }
 
+void cairo_dock_listen_for_screen_changes (void)
+{
+	#ifdef HAVE_XEXTEND
+	if (s_iXrandrEventBase >= 0)
+		XRRSelectInput (s_XDisplay, DefaultRootWindow (s_XDisplay), RRScreenChangeNotifyMask);
+	#endif
+}
+
+gboolean cairo_dock_is_screen_change_event (XEvent *pEvent)
+{
+	#ifdef HAVE_XEXTEND
+	if (s_iXrandrEventBase >= 0 && pEvent->type == s_iXrandrEventBase + RRScreenChangeNotify)
+	{
+		XRRUpdateConfiguration (pEvent);  // let Xlib update its own copy of the screen's size
+		return TRUE;
+	}
+	#endif
+	return FALSE;
+}
+
 
 void cairo_dock_set_xwindow_timestamp (Window Xid, gulong iTimeStamp)
 {
@@ -1473,22 +1510,136 @@ Window cairo_dock_get_active_xwindow (void)
 
 
 
-cairo_surface_t *cairo_dock_create_surface_from_xwindow (Window Xid, int iWidth, int iHeight)
+static void _unref_xicon (CairoDockXIcon *pIcon)
+{
+	pIcon->iRefCount --;
+	if (pIcon->iRefCount == 0)
+	{
+		if (g_hash_table_lookup (s_hXIconTable, &pIcon->iHash) == pIcon)  // an icon whose hash collided with another one is not in the table.
+			g_hash_table_remove (s_hXIconTable, &pIcon->iHash);
+		g_free (pIcon->pPixels);
+		g_free (pIcon);
+	}
+}
+
+static void _free_xwindow_icon (CairoDockXWindowIcon *pWindowIcon)
+{
+	if (pWindowIcon->pIcon != NULL)
+		_unref_xicon (pWindowIcon->pIcon);
+	g_free (pWindowIcon);
+}
+
+static CairoDockXIcon *_get_xicon (Window Xid, int iSize)
 {
 	Atom aReturnedType = 0;
 	int aReturnedFormat = 0;
-	unsigned long iLeftBytes, iBufferNbElements = 0;
-	gulong *pXIconBuffer = NULL;
-	XGetWindowProperty (s_XDisplay, Xid, s_aNetWmIcon, 0, G_MAXULONG, False, XA_CARDINAL, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pXIconBuffer);
+	unsigned long iLeftBytes = 0, iBufferNbElements = 0;
+	gulong *pXBuffer = NULL;
+	
+	//\__________________ get the whole property in one round trip; it holds the icons one after the other, each one preceded by its width and height.
+	XGetWindowProperty (s_XDisplay, Xid, s_aNetWmIcon, 0, G_MAXLONG, False, XA_CARDINAL, &aReturnedType, &aReturnedFormat, &iBufferNbElements, &iLeftBytes, (guchar **)&pXBuffer);
+	if (pXBuffer == NULL)  // no icon
+		return NULL;
+	
+	//\__________________ walk through the headers of the icons to choose the size.
+	gulong iOffset = 0, iBestOffset = G_MAXULONG;
+	gulong w, h;
+	int iBestWidth = 0, iBestHeight = 0;
+	int i;
+	for (i = 0; i < CAIRO_DOCK_XICON_MAX_NB_SIZES && iOffset + 2 <= iBufferNbElements; i ++)
+	{
+		w = pXBuffer[iOffset];
+		h = pXBuffer[iOffset+1];
+		if (w == 0 || h == 0 || w > CAIRO_DOCK_XICON_MAX_SIZE || h > CAIRO_DOCK_XICON_MAX_SIZE || iBufferNbElements - iOffset - 2 < w * h)
+		{
+			cd_warning ("This icon is broken !\nThis means that one of the current applications has sent a buggy icon to X.");
+			break;
+		}
+		if (iBestOffset == G_MAXULONG || cairo_dock_xicon_size_is_better ((int)w, iBestWidth, iSize))
+		{
+			iBestOffset = iOffset;
+			iBestWidth = w;
+			iBestHeight = h;
+		}
+		iOffset += 2 + w * h;
+	}
+	if (iBestOffset == G_MAXULONG)
+	{
+		XFree (pXBuffer);
+		return NULL;
+	}
+	
+	//\__________________ decode the pixels of the chosen size.
+	int n = iBestWidth * iBestHeight;
+	guint32 *pPixels = g_new (guint32, n);
+	cairo_dock_premultiply_xicon_pixels (pXBuffer + iBestOffset + 2, pPixels, n);
+	XFree (pXBuffer);
+	
+	//\__________________ look for an identical icon (FNV-1a hash, then comparison of the pixels).
+	guint64 iHash = 14695981039346656037ULL;
+	iHash = (iHash ^ (guint64)iBestWidth) * 1099511628211ULL;
+	iHash = (iHash ^ (guint64)iBestHeight) * 1099511628211ULL;
+	for (i = 0; i < n; i ++)
+		iHash = (iHash ^ pPixels[i]) * 1099511628211ULL;
+	
+	CairoDockXIcon *pIcon = g_hash_table_lookup (s_hXIconTable, &iHash);
+	if (pIcon != NULL && pIcon->iWidth == iBestWidth && pIcon->iHeight == iBestHeight
+	&& memcmp (pIcon->pPixels, pPixels, n * sizeof (guint32)) == 0)
+	{
+		pIcon->iRefCount ++;
+		g_free (pPixels);
+		return pIcon;
+	}
+	
+	gboolean bCollision = (pIcon != NULL);  // same hash but another icon: it's not shared.
+	pIcon = g_new0 (CairoDockXIcon, 1);
+	pIcon->iHash = iHash;
+	pIcon->iWidth = iBestWidth;
+	pIcon->iHeight = iBestHeight;
+	pIcon->pPixels = pPixels;
+	pIcon->iRefCount = 1;
+	if (! bCollision)
+		g_hash_table_insert (s_hXIconTable, &pIcon->iHash, pIcon);
+	return pIcon;
+}
+
+void cairo_dock_forget_xwindow_icon (Window Xid)
+{
+	if (s_hXWindowIconTable != NULL)
+		g_hash_table_remove (s_hXWindowIconTable, &Xid);
+}
 
-	if (iBufferNbElements > 2)
+cairo_surface_t *cairo_dock_create_surface_from_xwindow (Window Xid, int iWidth, int iHeight)
+{
+	//\__________________ get the icon from the cache, or update it if it's not there yet or if the size has changed.
+	int iSize = MAX (iWidth, iHeight);
+	CairoDockXWindowIcon *pWindowIcon = g_hash_table_lookup (s_hXWindowIconTable, &Xid);
+	if (pWindowIcon == NULL)
+	{
+		pWindowIcon = g_new0 (CairoDockXWindowIcon, 1);
+		Window *pXid = g_new (Window, 1);
+		*pXid = Xid;
+		g_hash_table_insert (s_hXWindowIconTable, pXid, pWindowIcon);
+		pWindowIcon->pIcon = _get_xicon (Xid, iSize);
+		pWindowIcon->iSize = iSize;
+	}
+	else if (pWindowIcon->iSize != iSize)
+	{
+		CairoDockXIcon *pIcon = _get_xicon (Xid, iSize);  // get the new one before releasing the old one, in case they are the same.
+		if (pWindowIcon->pIcon != NULL)
+			_unref_xicon (pWindowIcon->pIcon);
+		pWindowIcon->pIcon = pIcon;
+		pWindowIcon->iSize = iSize;
+	}
+	
+	if (pWindowIcon->pIcon != NULL)
 	{
-		cairo_surface_t *pNewSurface = cairo_dock_create_surface_from_xicon_buffer (pXIconBuffer,
-			iBufferNbElements,
+		CairoDockXIcon *pIcon = pWindowIcon->pIcon;
+		return cairo_dock_create_surface_from_argb_pixels (pIcon->pPixels,
+			pIcon->iWidth,
+			pIcon->iHeight,
 			iWidth,
 			iHeight);
-		XFree (pXIconBuffer);
-		return pNewSurface;
 	}
 	else  // sinon on tente avec l'icone eventuellement presente dans les WMHints.
 	{
@@ -47,6 +47,9 @@ unsigned char cairo_dock_get_X_error_code (void);
 
 gboolean cairo_dock_update_screen_geometry (void);
 
+void cairo_dock_listen_for_screen_changes (void);  // select RRScreenChangeNotify on the root window, if Xrandr is available
+gboolean cairo_dock_is_screen_change_event (XEvent *pEvent);  // TRUE if it's a RRScreenChangeNotify; Xlib is updated accordingly
+
 gchar **cairo_dock_get_desktops_names (void);
 
 void cairo_dock_set_desktops_names (gchar **cNames);
@@ -115,6 +118,9 @@ Window cairo_dock_get_active_xwindow (void);
 
 
 cairo_surface_t *cairo_dock_create_surface_from_xwindow (Window Xid, int iWidth, int iHeight);
+/* Forget the cached icon of a window; must be called when its _NET_WM_ICON changes or when it's destroyed.
+ */
+void cairo_dock_forget_xwindow_icon (Window Xid);
 
 cairo_surface_t *cairo_dock_create_surface_from_xpixmap (Pixmap Xid, int iWidth, int iHeight);
 
@@ -19,10 +19,15 @@
 
 /** See the "data/gauges" folder for some exemples */
 
+#define _GNU_SOURCE  // st_mtim
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#include <sys/stat.h>  // stat
+#include <glib/gstdio.h>  // g_stat, g_remove
 #include <libxml/tree.h>
 #include <libxml/parser.h>
+#include <libxml/xmlreader.h>
 
 #include "gldi-config.h"
 #include "cairo-dock-log.h"
@@ -69,7 +74,9 @@ typedef struct {
 	gdouble iNeedleOffsetX, iNeedleOffsetY;
 	gdouble fNeedleScale;
 	gint iNeedleWidth, iNeedleHeight;
+	gint iNeedleSvgWidth, iNeedleSvgHeight;  // size of the needle in its SVG file.
 	GaugeImage *pImageNeedle;
+	CairoDataRendererAngleTable angles;  // rotation of the needle for the range of values, in the cairo frame.
 	// images list
 	GaugeIndicatorEffect iEffect;
 	gint iNbImages;
@@ -91,17 +98,35 @@ typedef enum {
 	CD_GAUGE_NB_MULTI_DISPLAY
 	} GaugeMultiDisplay;
 
+// A gauge theme, either as described in its theme.xml (the images are not loaded), or compiled at a given size (the images are loaded). Both are shared by all the gauges using the same theme (at the same size).
+typedef struct _GaugeTheme GaugeTheme;
+struct _GaugeTheme {
+	gchar *cThemePath;
+	gint iWidth, iHeight;  // 0 for a description.
+	gint iRefCount;
+	GaugeTheme *pDescription;  // the description a compiled theme has been made from.
+	gint iRank;
+	GaugeMultiDisplay iMultiDisplay;
+	GaugeImage *pImageBackground;
+	GaugeImage *pImageForeground;
+	GList *pIndicatorList;
+};
+
 typedef struct {
 	CairoDataRenderer dataRenderer;
-	GaugeImage *pImageBackground;
+	GaugeImage *pImageBackground;  // the images and indicators belong to the theme.
 	GaugeImage *pImageForeground;
 	GList *pIndicatorList;
 	GaugeMultiDisplay iMultiDisplay;
+	GaugeTheme *pTheme;
 } Gauge;
 
 
 extern gboolean g_bUseOpenGL;
 
+static GHashTable *s_hGaugeDescriptions = NULL;  // table of (theme path, description).
+static GHashTable *s_hGaugeThemes = NULL;  // table of (theme path + size, compiled theme).
+
   ////////////////////////////////////////////
  /////////////// LOAD GAUGE /////////////////
 ////////////////////////////////////////////
@@ -114,42 +139,18 @@ static double _str2double (xmlChar *s)
 	return g_ascii_strtod ((char *) s, NULL);
 }
 
-static void _load_gauge_image (GaugeImage *pGaugeImage, const gchar *cThemePath, const xmlChar *cImageName, int iWidth, int iHeight)
-{
-	pGaugeImage->cImagePath = g_strdup_printf ("%s/%s", cThemePath, (gchar *) cImageName);
-	cairo_dock_load_image_buffer (&pGaugeImage->image, pGaugeImage->cImagePath, iWidth, iHeight, 0);
-}
-
-static GaugeImage *_new_gauge_image (const gchar *cThemePath, const xmlChar *cImageName, int iWidth, int iHeight)
+static GaugeImage *_new_gauge_image (const gchar *cThemePath, const xmlChar *cImageName)
 {
 	GaugeImage *pGaugeImage = g_new0 (GaugeImage, 1);
-	_load_gauge_image (pGaugeImage, cThemePath, cImageName, iWidth, iHeight);
+	pGaugeImage->cImagePath = g_strdup_printf ("%s/%s", cThemePath, (gchar *) cImageName);  // the image is loaded when the theme is compiled.
 	return pGaugeImage;
 }
 
-static void _reload_gauge_image (GaugeImage *pGaugeImage, int iWidth, int iHeight)
-{
-	cairo_dock_unload_image_buffer (&pGaugeImage->image);
-	
-	if (pGaugeImage->cImagePath)
-	{
-		cairo_dock_load_image_buffer (&pGaugeImage->image, pGaugeImage->cImagePath, iWidth, iHeight, 0);
-	}
-}
-
-static void __load_needle (GaugeIndicator *pGaugeIndicator, int iWidth, int iHeight)
+// set the size of the needle from the size of its SVG, and compute its rotations.
+static void _set_needle_size (GaugeIndicator *pGaugeIndicator, int sizeX, int sizeY, int iWidth, int iHeight)
 {
-	GaugeImage *pGaugeImage = pGaugeIndicator->pImageNeedle;
-	
-	// load the SVG file.
-	RsvgHandle *pSvgHandle = rsvg_handle_new_from_file (pGaugeImage->cImagePath, NULL);
-	g_return_if_fail (pSvgHandle != NULL);
-	
-	// get the SVG dimensions.
-	RsvgDimensionData SizeInfo;
-	rsvg_handle_get_dimensions (pSvgHandle, &SizeInfo);
-	int sizeX = SizeInfo.width;
-	int sizeY = SizeInfo.height;
+	pGaugeIndicator->iNeedleSvgWidth = sizeX;
+	pGaugeIndicator->iNeedleSvgHeight = sizeY;
 	
 	// guess the needle size and offset if not specified.
 	if (pGaugeIndicator->iNeedleRealHeight == 0)
@@ -168,6 +169,29 @@ static void __load_needle (GaugeIndicator *pGaugeIndicator, int iWidth, int iHei
 	pGaugeIndicator->iNeedleWidth = (double) pGaugeIndicator->iNeedleRealWidth * pGaugeIndicator->fNeedleScale;
 	pGaugeIndicator->iNeedleHeight = (double) pGaugeIndicator->iNeedleRealHeight * pGaugeIndicator->fNeedleScale;
 	
+	// compute the rotations of the needle: enough angles for its tip to move by less than half a pixel between 2 of them.
+	double fSign = (pGaugeIndicator->direction < 0 ? -1. : 1.);
+	double fAngleStart = fSign * pGaugeIndicator->posStart * G_PI / 180. - G_PI/2;
+	double fAngleStop = fSign * pGaugeIndicator->posStop * G_PI / 180. - G_PI/2;
+	cairo_data_renderer_compute_angle_table (&pGaugeIndicator->angles,
+		2 * ceil (fabs (fAngleStop - fAngleStart) * pGaugeIndicator->iNeedleWidth) + 1,
+		fAngleStart,
+		fAngleStop);
+}
+
+static void __load_needle (GaugeIndicator *pGaugeIndicator, int iWidth, int iHeight)
+{
+	GaugeImage *pGaugeImage = pGaugeIndicator->pImageNeedle;
+	
+	// load the SVG file.
+	RsvgHandle *pSvgHandle = rsvg_handle_new_from_file (pGaugeImage->cImagePath, NULL);
+	g_return_if_fail (pSvgHandle != NULL);
+	
+	// get the SVG dimensions.
+	RsvgDimensionData SizeInfo;
+	rsvg_handle_get_dimensions (pSvgHandle, &SizeInfo);
+	_set_needle_size (pGaugeIndicator, SizeInfo.width, SizeInfo.height, iWidth, iHeight);
+	
 	// make a cairo surface.
 	cairo_surface_t *pNeedleSurface = cairo_dock_create_blank_surface (pGaugeIndicator->iNeedleWidth, pGaugeIndicator->iNeedleHeight);
 	g_return_if_fail (cairo_surface_status (pNeedleSurface) == CAIRO_STATUS_SUCCESS);
@@ -186,347 +210,891 @@ static void __load_needle (GaugeIndicator *pGaugeIndicator, int iWidth, int iHei
 	cairo_dock_load_image_buffer_from_surface (&pGaugeImage->image, pNeedleSurface, iWidth, iHeight);
 }
 
-static void _reload_gauge_needle (GaugeIndicator *pGaugeIndicator, int iWidth, int iHeight)
+static void _free_theme (GaugeTheme *pTheme);
+static void _cairo_dock_free_gauge_image (GaugeImage *pGaugeImage, gboolean bFree);
+static void _cairo_dock_free_gauge_indicator (GaugeIndicator *pGaugeIndicator);
+
+// The theme.xml is read in one pass with a xmlTextReader, without building its tree: the text of an element is gathered in a single buffer, and used when the element ends.
+// What used to be counted ahead in the tree (the number of indicators and of images) is set once their parent has been read.
+typedef enum {
+	GAUGE_FILE_NO_ATTRIBUTE = 0,
+	GAUGE_FILE_OTHER,
+	GAUGE_FILE_BACKGROUND,
+	GAUGE_FILE_FOREGROUND,
+	GAUGE_FILE_NEEDLE,
+	GAUGE_FILE_UNDEF_VALUE
+	} GaugeFileAttribute;
+
+typedef enum {
+	GAUGE_ZONE_NONE = 0,
+	GAUGE_ZONE_TEXT,
+	GAUGE_ZONE_LABEL,
+	GAUGE_ZONE_LOGO
+	} GaugeZone;
+
+typedef struct {
+	const gchar *cThemePath;
+	GaugeTheme *pTheme;
+	double ratio_xy;
+	double ratio_text;
+	gboolean bCountIndicators;  // no rank given before the first indicator: it's the number of indicators.
+	gint iNbIndicators;
+	GaugeIndicator *pIndicator;  // indicator being read.
+	GaugeType iType;  // its type.
+	gchar *cNeedleImage;
+	GPtrArray *pImages;  // paths of its images.
+	GaugeZone iZone;  // zone being read in the indicator.
+	GaugeFileAttribute iFileType, iFileKey;  // attributes of the current 'file' element.
+	GString *sContent;  // text of the current element.
+} GaugeThemeParser;
+
+static GaugeFileAttribute _get_file_attribute (const xmlChar *cValue)
+{
+	if (xmlStrEqual (cValue, BAD_CAST "background"))
+		return GAUGE_FILE_BACKGROUND;
+	if (xmlStrEqual (cValue, BAD_CAST "foreground"))
+		return GAUGE_FILE_FOREGROUND;
+	if (xmlStrEqual (cValue, BAD_CAST "needle"))
+		return GAUGE_FILE_NEEDLE;
+	if (xmlStrEqual (cValue, BAD_CAST "undef-value"))
+		return GAUGE_FILE_UNDEF_VALUE;
+	return GAUGE_FILE_OTHER;
+}
+
+static void _read_file_attributes (GaugeThemeParser *pParser, xmlTextReaderPtr reader)
 {
-	GaugeImage *pGaugeImage = pGaugeIndicator->pImageNeedle;
-	
-	if (pGaugeImage != NULL)
+	pParser->iFileType = pParser->iFileKey = GAUGE_FILE_NO_ATTRIBUTE;
+	while (xmlTextReaderMoveToNextAttribute (reader) == 1)
 	{
-		cairo_dock_unload_image_buffer (&pGaugeImage->image);
-		if (pGaugeImage->cImagePath)
-		{
-			__load_needle (pGaugeIndicator, iWidth, iHeight);
-		}
+		const xmlChar *cName = xmlTextReaderConstName (reader);
+		if (xmlStrEqual (cName, BAD_CAST "type"))
+			pParser->iFileType = _get_file_attribute (xmlTextReaderConstValue (reader));
+		else if (xmlStrEqual (cName, BAD_CAST "key"))
+			pParser->iFileKey = _get_file_attribute (xmlTextReaderConstValue (reader));
 	}
+	xmlTextReaderMoveToElement (reader);
 }
 
-static void _load_gauge_needle (GaugeIndicator *pGaugeIndicator, const gchar *cThemePath, const gchar *cImageName, int iWidth, int iHeight)
+static gboolean _start_indicator (GaugeThemeParser *pParser, xmlTextReaderPtr reader)
 {
-	if (!cImageName)
-		return;
+	if (pParser->iNbIndicators == 0 && pParser->pTheme->iRank == 0)  // first indicator.
+		pParser->bCountIndicators = TRUE;
 	
-	GaugeImage *pGaugeImage = g_new0 (GaugeImage, 1);
-	pGaugeImage->cImagePath = g_strdup_printf ("%s/%s", cThemePath, cImageName);
-	pGaugeIndicator->pImageNeedle = pGaugeImage;
+	// get the type if the indicator.
+	GaugeType iType = CD_GAUGE_TYPE_UNKNOWN;  // until we know the indicator type, it can be any one.
+	if (xmlTextReaderMoveToAttribute (reader, BAD_CAST "type") == 1)  // the value is read in place, unlike with xmlTextReaderGetAttribute.
+	{
+		const xmlChar *cAttribute = xmlTextReaderConstValue (reader);
+		if (xmlStrEqual (cAttribute, BAD_CAST "needle"))
+			iType = CD_GAUGE_TYPE_NEEDLE;
+		else if (xmlStrEqual (cAttribute, BAD_CAST "images"))
+			iType = CD_GAUGE_TYPE_IMAGES;
+		else
+			iType = CD_NB_GAUGE_TYPES;
+		xmlTextReaderMoveToElement (reader);
+		if (iType == CD_NB_GAUGE_TYPES)  // wrong attribute, skip this indicator.
+			return FALSE;
+	}
 	
-	__load_needle (pGaugeIndicator, iWidth, iHeight);
+	cd_debug ("gauge : On charge un indicateur");
+	pParser->pIndicator = g_new0 (GaugeIndicator, 1);
+	pParser->pIndicator->direction = 1;
+	pParser->iType = iType;
+	pParser->iZone = GAUGE_ZONE_NONE;
+	return TRUE;
 }
 
-static gboolean _load_theme (Gauge *pGauge, const gchar *cThemePath)
+static void _end_indicator (GaugeThemeParser *pParser)
 {
-	cd_message ("%s (%s)", __func__, cThemePath);
-	int iWidth = pGauge->dataRenderer.iWidth, iHeight = pGauge->dataRenderer.iHeight;
-	if (iWidth == 0 || iHeight == 0)
-		return FALSE;
-	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGauge);
+	GaugeIndicator *pGaugeIndicator = pParser->pIndicator;
 	
-	g_return_val_if_fail (cThemePath != NULL, FALSE);
+	// take the images; their number can be given by the theme, otherwise it's the number of 'file' elements.
+	guint iNbImages = pParser->pImages->len;
+	if (iNbImages != 0)
+	{
+		if (pGaugeIndicator->iNbImages == 0)
+			pGaugeIndicator->iNbImages = iNbImages;
+		pGaugeIndicator->pImageList = g_new0 (GaugeImage, pGaugeIndicator->iNbImages);
+		guint i;
+		for (i = 0; i < iNbImages && i < (guint)pGaugeIndicator->iNbImages; i ++)
+		{
+			pGaugeIndicator->pImageList[i].cImagePath = g_ptr_array_index (pParser->pImages, i);
+			g_ptr_array_index (pParser->pImages, i) = NULL;
+		}
+		pGaugeIndicator->iNbImageLoaded = i;
+		g_ptr_array_set_size (pParser->pImages, 0);  // frees the extra ones.
+	}
+	else
+		pGaugeIndicator->iNbImages = 0;  // nothing to show.
 	
-	xmlInitParser ();
-	xmlDocPtr pGaugeTheme;
-	xmlNodePtr pGaugeMainNode;
-	gchar *cXmlFile = g_strdup_printf ("%s/theme.xml", cThemePath);
-	pGaugeTheme = cairo_dock_open_xml_file (cXmlFile, "gauge", &pGaugeMainNode, NULL);
-	g_free (cXmlFile);
-	g_return_val_if_fail (pGaugeTheme != NULL && pGaugeMainNode != NULL, FALSE);
+	// in the case of a needle, remember it now, since we need to know the dimensions to load it.
+	if (pParser->cNeedleImage != NULL)
+	{
+		pGaugeIndicator->pImageNeedle = _new_gauge_image (pParser->cThemePath, BAD_CAST pParser->cNeedleImage);
+		g_free (pParser->cNeedleImage);
+		pParser->cNeedleImage = NULL;
+	}
+	pParser->pTheme->pIndicatorList = g_list_append (pParser->pTheme->pIndicatorList, pGaugeIndicator);
+	pParser->pIndicator = NULL;
+	pParser->iNbIndicators ++;
+}
+
+static void _read_indicator_file (GaugeThemeParser *pParser, xmlChar *cNodeContent)
+{
+	// if the type is still unknown, try to get it here (version <= 2)
+	if (pParser->iType == CD_GAUGE_TYPE_UNKNOWN)
+		pParser->iType = (pParser->iFileKey == GAUGE_FILE_NEEDLE ? CD_GAUGE_TYPE_NEEDLE : CD_GAUGE_TYPE_IMAGES);
 	
-	xmlChar *cAttribute, *cNodeContent, *cTextNodeContent, *cTypeAttr;
-	GString *sImagePath = g_string_new ("");
-	gchar *cNeedleImage;
-	GaugeType iType;  // type of the current indicator.
-	gboolean next;
-	GaugeIndicator *pGaugeIndicator = NULL;
-	xmlNodePtr pGaugeNode;
-	double ratio_xy = 1.;
-	double ratio_text = 2.;
-	int i;
-	for (pGaugeNode = pGaugeMainNode->children, i = 0; pGaugeNode != NULL; pGaugeNode = pGaugeNode->next, i ++)
+	// get the image(s).
+	if (pParser->iType == CD_GAUGE_TYPE_NEEDLE)
+	{
+		g_free (pParser->cNeedleImage);
+		pParser->cNeedleImage = g_strdup ((gchar *) cNodeContent);  // just remember the image name, we'll load it in the end.
+	}
+	else if (pParser->iFileType == GAUGE_FILE_UNDEF_VALUE)
 	{
-		if (xmlStrcmp (pGaugeNode->name, BAD_CAST "rank") == 0)
+		_cairo_dock_free_gauge_image (pParser->pIndicator->pImageUndef, TRUE);
+		pParser->pIndicator->pImageUndef = _new_gauge_image (pParser->cThemePath, cNodeContent);
+	}
+	else  // remember the image.
+	{
+		g_ptr_array_add (pParser->pImages, g_strdup_printf ("%s/%s", pParser->cThemePath, (gchar *) cNodeContent));
+	}
+}
+
+static void _read_indicator_param (GaugeThemeParser *pParser, const xmlChar *cName, xmlChar *cNodeContent)
+{
+	GaugeIndicator *pGaugeIndicator = pParser->pIndicator;
+	gboolean next = FALSE;
+	if (pParser->iType != CD_GAUGE_TYPE_IMAGES)  // needle or unknown
+	{
+		if(xmlStrcmp (cName, BAD_CAST "posX") == 0)
+			pGaugeIndicator->posX = _str2double (cNodeContent) * pParser->ratio_xy;
+		else if(xmlStrcmp (cName, BAD_CAST "posY") == 0)
+			pGaugeIndicator->posY = _str2double (cNodeContent) * pParser->ratio_xy;
+		else if(xmlStrcmp (cName, BAD_CAST "direction") == 0)
+			pGaugeIndicator->direction = _str2double (cNodeContent);
+		else if(xmlStrcmp (cName, BAD_CAST "posStart") == 0)
+			pGaugeIndicator->posStart = _str2double (cNodeContent);
+		else if(xmlStrcmp (cName, BAD_CAST "posStop") == 0)
+			pGaugeIndicator->posStop = _str2double (cNodeContent);
+		else if(xmlStrcmp (cName, BAD_CAST "nb images") == 0)
+			pGaugeIndicator->iNbImages = atoi ((char *) cNodeContent);
+		else if(xmlStrcmp (cName, BAD_CAST "offset_x") == 0)
+		{
+			pGaugeIndicator->iNeedleOffsetX = atoi ((char *) cNodeContent);
+		}
+		else if(xmlStrcmp (cName, BAD_CAST "width") == 0)
 		{
-			cNodeContent = xmlNodeGetContent (pGaugeNode);
-			pRenderer->iRank = atoi ((char *) cNodeContent);
-			xmlFree (cNodeContent);
+			pGaugeIndicator->iNeedleRealWidth = atoi ((char *) cNodeContent);
 		}
-		else if (xmlStrcmp (pGaugeNode->name, BAD_CAST "version") == 0)
+		else if(xmlStrcmp (cName, BAD_CAST "height") == 0)
+		{
+			pGaugeIndicator->iNeedleRealHeight = atoi ((char *) cNodeContent);
+			pGaugeIndicator->iNeedleOffsetY = .5 * pGaugeIndicator->iNeedleRealHeight;
+		}
+		else
+			next = TRUE;
+	}
+	if (pParser->iType != CD_GAUGE_TYPE_NEEDLE)  // image or unknown
+	{
+		if(xmlStrcmp (cName, BAD_CAST "effect") == 0)
+		{
+			pGaugeIndicator->iEffect = atoi ((char *) cNodeContent);
+		}
+		else
+			next = TRUE;
+	}
+	if (next && xmlStrcmp (cName, BAD_CAST "file") == 0)  // other parameters
+		_read_indicator_file (pParser, cNodeContent);
+}
+
+static void _read_zone_param (GaugeThemeParser *pParser, const xmlChar *cName, xmlChar *cNodeContent)
+{
+	GaugeIndicator *pGaugeIndicator = pParser->pIndicator;
+	if (pParser->iZone == GAUGE_ZONE_LOGO)
+	{
+		if(xmlStrcmp (cName, BAD_CAST "x_center") == 0)
+			pGaugeIndicator->emblem.fX = _str2double (cNodeContent);
+		else if(xmlStrcmp (cName, BAD_CAST "y_center") == 0)
+			pGaugeIndicator->emblem.fY = _str2double (cNodeContent);
+		else if(xmlStrcmp (cName, BAD_CAST "width") == 0)
+			pGaugeIndicator->emblem.fWidth = _str2double (cNodeContent);
+		else if(xmlStrcmp (cName, BAD_CAST "height") == 0)
+			pGaugeIndicator->emblem.fHeight = _str2double (cNodeContent);
+		else if(xmlStrcmp (cName, BAD_CAST "alpha") == 0)
+			pGaugeIndicator->emblem.fAlpha = _str2double (cNodeContent);
+		return;
+	}
+	
+	CairoDataRendererTextParam *pZone = (pParser->iZone == GAUGE_ZONE_TEXT ? &pGaugeIndicator->textZone : &pGaugeIndicator->labelZone);
+	double ratio = (pParser->iZone == GAUGE_ZONE_TEXT ? pParser->ratio_text : 1.);  // only the position of the value is scaled.
+	if(xmlStrcmp (cName, BAD_CAST "x_center") == 0)
+		pZone->fX = _str2double (cNodeContent)/ratio;
+	else if(xmlStrcmp (cName, BAD_CAST "y_center") == 0)
+		pZone->fY = _str2double (cNodeContent)/ratio;
+	else if(xmlStrcmp (cName, BAD_CAST "width") == 0)
+		pZone->fWidth = _str2double (cNodeContent);
+	else if(xmlStrcmp (cName, BAD_CAST "height") == 0)
+		pZone->fHeight = _str2double (cNodeContent);
+	else if(xmlStrcmp (cName, BAD_CAST "red") == 0)
+		pZone->pColor[0] = _str2double (cNodeContent);
+	else if(xmlStrcmp (cName, BAD_CAST "green") == 0)
+		pZone->pColor[1] = _str2double (cNodeContent);
+	else if(xmlStrcmp (cName, BAD_CAST "blue") == 0)
+		pZone->pColor[2] = _str2double (cNodeContent);
+	else if(xmlStrcmp (cName, BAD_CAST "alpha") == 0)
+		pZone->pColor[3] = _str2double (cNodeContent);
+}
+
+// returns FALSE to skip the element and its children.
+static gboolean _start_element (GaugeThemeParser *pParser, xmlTextReaderPtr reader, const xmlChar *cName, int iDepth)
+{
+	g_string_truncate (pParser->sContent, 0);
+	if (iDepth == 1)
+	{
+		if (xmlStrcmp (cName, BAD_CAST "indicator") == 0)
+			return _start_indicator (pParser, reader);
+		if (xmlStrcmp (cName, BAD_CAST "file") == 0)
+			_read_file_attributes (pParser, reader);
+	}
+	else if (iDepth == 2 && pParser->pIndicator != NULL)
+	{
+		if (xmlStrcmp (cName, BAD_CAST "file") == 0)
+			_read_file_attributes (pParser, reader);
+		else if (xmlStrcmp (cName, BAD_CAST "text_zone") == 0)
+		{
+			pParser->iZone = GAUGE_ZONE_TEXT;
+			pParser->pIndicator->textZone.pColor[3] = 1.;
+		}
+		else if (xmlStrcmp (cName, BAD_CAST "label_zone") == 0)
+		{
+			pParser->iZone = GAUGE_ZONE_LABEL;
+			pParser->pIndicator->labelZone.pColor[3] = 1.;
+		}
+		else if (xmlStrcmp (cName, BAD_CAST "logo_zone") == 0)
+		{
+			pParser->iZone = GAUGE_ZONE_LOGO;
+			pParser->pIndicator->emblem.fAlpha = 1.;
+		}
+	}
+	return TRUE;
+}
+
+static void _end_element (GaugeThemeParser *pParser, const xmlChar *cName, int iDepth)
+{
+	xmlChar *cNodeContent = BAD_CAST pParser->sContent->str;
+	GaugeTheme *pTheme = pParser->pTheme;
+	if (iDepth == 1)
+	{
+		if (xmlStrcmp (cName, BAD_CAST "rank") == 0)
+		{
+			pTheme->iRank = atoi ((char *) cNodeContent);
+			pParser->bCountIndicators = FALSE;
+		}
+		else if (xmlStrcmp (cName, BAD_CAST "version") == 0)
 		{
-			cNodeContent = xmlNodeGetContent (pGaugeNode);
 			int iVersion = atoi ((char *) cNodeContent);
 			if (iVersion >= 2)
 			{
-				ratio_text = 1.;
-				ratio_xy = 2.;
+				pParser->ratio_text = 1.;
+				pParser->ratio_xy = 2.;
 			}
-			xmlFree (cNodeContent);
 		}
-		else if (xmlStrcmp (pGaugeNode->name, BAD_CAST "file") == 0)
+		else if (xmlStrcmp (cName, BAD_CAST "file") == 0)
 		{
-			cNodeContent = xmlNodeGetContent (pGaugeNode);
-			cAttribute = xmlGetProp (pGaugeNode, BAD_CAST "type");
-			if (!cAttribute)
-				cAttribute = xmlGetProp (pGaugeNode, BAD_CAST "key");
-			if (cAttribute != NULL)
+			GaugeFileAttribute iAttribute = (pParser->iFileType != GAUGE_FILE_NO_ATTRIBUTE ? pParser->iFileType : pParser->iFileKey);
+			if (iAttribute == GAUGE_FILE_BACKGROUND)
 			{
-				if (xmlStrcmp (cAttribute, BAD_CAST "background") == 0)
-				{
-					pGauge->pImageBackground = _new_gauge_image (cThemePath, cNodeContent, iWidth, iHeight);
-				}
-				else if (xmlStrcmp (cAttribute, BAD_CAST "foreground") == 0)
-				{
-					pGauge->pImageForeground = _new_gauge_image (cThemePath, cNodeContent, iWidth, iHeight);
-				}
-				xmlFree (cAttribute);
+				_cairo_dock_free_gauge_image (pTheme->pImageBackground, TRUE);
+				pTheme->pImageBackground = _new_gauge_image (pParser->cThemePath, cNodeContent);
+			}
+			else if (iAttribute == GAUGE_FILE_FOREGROUND)
+			{
+				_cairo_dock_free_gauge_image (pTheme->pImageForeground, TRUE);
+				pTheme->pImageForeground = _new_gauge_image (pParser->cThemePath, cNodeContent);
 			}
-			xmlFree (cNodeContent);
 		}
-		else if(xmlStrcmp (pGaugeNode->name, BAD_CAST "multi_display") == 0)
+		else if (xmlStrcmp (cName, BAD_CAST "multi_display") == 0)
 		{
-			cNodeContent = xmlNodeGetContent (pGaugeNode);
-			pGauge->iMultiDisplay = atoi ((char *) cNodeContent);
+			pTheme->iMultiDisplay = atoi ((char *) cNodeContent);
 		}
-		else if (xmlStrcmp (pGaugeNode->name, BAD_CAST "indicator") == 0)
+		else if (xmlStrcmp (cName, BAD_CAST "indicator") == 0 && pParser->pIndicator != NULL)
 		{
-			// count the number of indicators.
-			if (pRenderer->iRank == 0)  // first indicator.
-			{
-				pRenderer->iRank = 1;
-				xmlNodePtr node;
-				for (node = pGaugeNode->next; node != NULL; node = node->next)
-				{
-					if (xmlStrcmp (node->name, BAD_CAST "indicator") == 0)
-						pRenderer->iRank ++;
-				}
-			}
-			
-			// get the type if the indicator.
-			iType = CD_GAUGE_TYPE_UNKNOWN;  // until we know the indicator type, it can be any one.
-			cAttribute = xmlGetProp (pGaugeNode, BAD_CAST "type");
-			if (cAttribute != NULL)
-			{
-				if (strcmp ((char *) cAttribute, "needle") == 0)
-				{
-					iType = CD_GAUGE_TYPE_NEEDLE;
-				}
-				else if (strcmp ((char *) cAttribute, "images") == 0)
-				{
-					iType = CD_GAUGE_TYPE_IMAGES;
-				}
-				else  // wrong attribute, skip this indicator.
-				{
-					pRenderer->iRank --;
-					continue;
-				}
-				xmlFree (cAttribute);
-			}
-			
-			// load the indicators.
-			pGaugeIndicator = g_new0 (GaugeIndicator, 1);
-			pGaugeIndicator->direction = 1;
-			
-			cd_debug ("gauge : On charge un indicateur");
-			cNeedleImage = NULL;
-			xmlNodePtr pIndicatorNode;
-			for (pIndicatorNode = pGaugeNode->children; pIndicatorNode != NULL; pIndicatorNode = pIndicatorNode->next)
-			{
-				if (xmlStrcmp (pIndicatorNode->name, BAD_CAST "text") == 0)  // xml noise.
-					continue;
-				cNodeContent = xmlNodeGetContent (pIndicatorNode);
-				
-				next = FALSE;
-				if (iType != CD_GAUGE_TYPE_IMAGES)  // needle or unknown
-				{
-					if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "posX") == 0)
-						pGaugeIndicator->posX = _str2double (cNodeContent) * ratio_xy;
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "posY") == 0)
-						pGaugeIndicator->posY = _str2double (cNodeContent) * ratio_xy;
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "direction") == 0)
-						pGaugeIndicator->direction = _str2double (cNodeContent);
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "posStart") == 0)
-						pGaugeIndicator->posStart = _str2double (cNodeContent);
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "posStop") == 0)
-						pGaugeIndicator->posStop = _str2double (cNodeContent);
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "nb images") == 0)
-						pGaugeIndicator->iNbImages = atoi ((char *) cNodeContent);
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "offset_x") == 0)
-					{
-						pGaugeIndicator->iNeedleOffsetX = atoi ((char *) cNodeContent);
-					}
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "width") == 0)
-					{
-						pGaugeIndicator->iNeedleRealWidth = atoi ((char *) cNodeContent);
-					}
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "height") == 0)
-					{
-						pGaugeIndicator->iNeedleRealHeight = atoi ((char *) cNodeContent);
-						pGaugeIndicator->iNeedleOffsetY = .5 * pGaugeIndicator->iNeedleRealHeight;
-					}
-					else
-						next = TRUE;
-				}
-				if (iType != CD_GAUGE_TYPE_NEEDLE)  // image or unknown
-				{
-					if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "effect") == 0)
-					{
-						pGaugeIndicator->iEffect = atoi ((char *) cNodeContent);
-					}
-					else
-						next = TRUE;
-				}
-				if (next)  // other parameters
+			_end_indicator (pParser);
+		}
+	}
+	else if (iDepth == 2 && pParser->pIndicator != NULL)
+	{
+		if (pParser->iZone != GAUGE_ZONE_NONE)  // end of a zone.
+			pParser->iZone = GAUGE_ZONE_NONE;
+		else
+			_read_indicator_param (pParser, cName, cNodeContent);
+	}
+	else if (iDepth == 3 && pParser->iZone != GAUGE_ZONE_NONE)
+	{
+		_read_zone_param (pParser, cName, cNodeContent);
+	}
+}
+
+static GaugeTheme *_parse_theme (const gchar *cThemePath)
+{
+	cd_message ("%s (%s)", __func__, cThemePath);
+	g_return_val_if_fail (cThemePath != NULL, NULL);
+	
+	xmlInitParser ();
+	gchar *cXmlFile = g_strdup_printf ("%s/theme.xml", cThemePath);
+	xmlTextReaderPtr reader = xmlReaderForFile (cXmlFile, NULL, XML_PARSE_NONET | XML_PARSE_NOBLANKS);
+	g_free (cXmlFile);
+	g_return_val_if_fail (reader != NULL, NULL);
+	
+	GaugeThemeParser parser;
+	memset (&parser, 0, sizeof (GaugeThemeParser));
+	parser.cThemePath = cThemePath;
+	parser.pTheme = g_new0 (GaugeTheme, 1);
+	parser.pTheme->cThemePath = g_strdup (cThemePath);
+	parser.ratio_xy = 1.;
+	parser.ratio_text = 2.;
+	parser.pImages = g_ptr_array_new_with_free_func (g_free);
+	parser.sContent = g_string_sized_new (64);
+	
+	//\_______________ read the nodes in order; the element names are interned by the reader, and the text is appended to the buffer without copy.
+	const xmlChar *cName;
+	gboolean bValid = TRUE, bEnter;
+	int iDepth;
+	int r = xmlTextReaderRead (reader);
+	while (r == 1)
+	{
+		iDepth = xmlTextReaderDepth (reader);
+		bEnter = TRUE;
+		switch (xmlTextReaderNodeType (reader))
+		{
+			case XML_READER_TYPE_ELEMENT:
+				cName = xmlTextReaderConstName (reader);
+				if (iDepth == 0 && xmlStrcmp (cName, BAD_CAST "gauge") != 0)  // not a gauge theme.
 				{
-					if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "file") == 0)
-					{
-						// if the type is still unknown, try to get it here (version <= 2)
-						if (iType == CD_GAUGE_TYPE_UNKNOWN)
-						{
-							cAttribute = xmlGetProp (pIndicatorNode, BAD_CAST "key");
-							if (cAttribute && strcmp ((char *) cAttribute, "needle") == 0)
-								iType = CD_GAUGE_TYPE_NEEDLE;
-							else
-								iType = CD_GAUGE_TYPE_IMAGES;
-							xmlFree (cAttribute);
-						}
-						// get/load the image(s).
-						if (iType == CD_GAUGE_TYPE_NEEDLE)
-						{
-							cNeedleImage = (gchar *) cNodeContent;  // just remember the image name, we'll load it in the end.
-							cNodeContent = NULL;
-						}
-						else  // load the images.
-						{
-							cAttribute = xmlGetProp (pIndicatorNode, BAD_CAST "type");
-							if (cAttribute && strcmp ((char *) cAttribute, "undef-value") == 0)
-							{
-								pGaugeIndicator->pImageUndef = _new_gauge_image (cThemePath, cNodeContent, iWidth, iHeight);
-							}
-							else
-							{
-								// count the number of images
-								if (pGaugeIndicator->iNbImages == 0)
-								{
-									pGaugeIndicator->iNbImages = 1;
-									xmlNodePtr node;
-									for (node = pIndicatorNode->next; node != NULL; node = node->next)
-									{
-										if (xmlStrcmp (node->name, BAD_CAST "file") == 0)
-										{
-											cTypeAttr = xmlGetProp (node, BAD_CAST "type");
-											if (!cTypeAttr || strcmp ((char *) cTypeAttr, "undef-value") != 0)
-												pGaugeIndicator->iNbImages ++;
-											xmlFree (cTypeAttr);
-										}
-									}
-								}
-								if (pGaugeIndicator->pImageList == NULL)
-									pGaugeIndicator->pImageList = g_new0 (GaugeImage, pGaugeIndicator->iNbImages);
-								
-								// load the image.
-								if (pGaugeIndicator->iNbImageLoaded < pGaugeIndicator->iNbImages)
-								{
-									_load_gauge_image (&pGaugeIndicator->pImageList[pGaugeIndicator->iNbImageLoaded],
-										cThemePath, cNodeContent,
-										iWidth, iHeight);
-									pGaugeIndicator->iNbImageLoaded ++;
-								}
-							}
-							xmlFree (cAttribute);
-						}
-					}
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "text_zone") == 0)
-					{
-						pGaugeIndicator->textZone.pColor[3] = 1.;
-						xmlNodePtr pTextSubNode;
-						for (pTextSubNode = pIndicatorNode->children; pTextSubNode != NULL; pTextSubNode = pTextSubNode->next)
-						{
-							cTextNodeContent = xmlNodeGetContent (pTextSubNode);
-							if(xmlStrcmp (pTextSubNode->name, BAD_CAST "x_center") == 0)
-								pGaugeIndicator->textZone.fX = _str2double (cTextNodeContent)/ratio_text;
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "y_center") == 0)
-								pGaugeIndicator->textZone.fY = _str2double (cTextNodeContent)/ratio_text;
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "width") == 0)
-								pGaugeIndicator->textZone.fWidth = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "height") == 0)
-								pGaugeIndicator->textZone.fHeight = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "red") == 0)
-								pGaugeIndicator->textZone.pColor[0] = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "green") == 0)
-								pGaugeIndicator->textZone.pColor[1] = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "blue") == 0)
-								pGaugeIndicator->textZone.pColor[2] = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "alpha") == 0)
-								pGaugeIndicator->textZone.pColor[3] = _str2double (cTextNodeContent);
-						}
-					}
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "label_zone") == 0)
-					{
-						xmlNodePtr pTextSubNode;
-						pGaugeIndicator->labelZone.pColor[3] = 1.;
-						for (pTextSubNode = pIndicatorNode->children; pTextSubNode != NULL; pTextSubNode = pTextSubNode->next)
-						{
-							cTextNodeContent = xmlNodeGetContent (pTextSubNode);
-							if(xmlStrcmp (pTextSubNode->name, BAD_CAST "x_center") == 0)
-								pGaugeIndicator->labelZone.fX = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "y_center") == 0)
-								pGaugeIndicator->labelZone.fY = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "width") == 0)
-								pGaugeIndicator->labelZone.fWidth = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "height") == 0)
-								pGaugeIndicator->labelZone.fHeight = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "red") == 0)
-								pGaugeIndicator->labelZone.pColor[0] = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "green") == 0)
-								pGaugeIndicator->labelZone.pColor[1] = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "blue") == 0)
-								pGaugeIndicator->labelZone.pColor[2] = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pTextSubNode->name, BAD_CAST "alpha") == 0)
-								pGaugeIndicator->labelZone.pColor[3] = _str2double (cTextNodeContent);
-						}
-					}
-					else if(xmlStrcmp (pIndicatorNode->name, BAD_CAST "logo_zone") == 0)
-					{
-						pGaugeIndicator->emblem.fAlpha = 1.;
-						xmlNodePtr pLogoSubNode;
-						for (pLogoSubNode = pIndicatorNode->children; pLogoSubNode != NULL; pLogoSubNode = pLogoSubNode->next)
-						{
-							cTextNodeContent = xmlNodeGetContent (pLogoSubNode);
-							if(xmlStrcmp (pLogoSubNode->name, BAD_CAST "x_center") == 0)
-								pGaugeIndicator->emblem.fX = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pLogoSubNode->name, BAD_CAST "y_center") == 0)
-								pGaugeIndicator->emblem.fY = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pLogoSubNode->name, BAD_CAST "width") == 0)
-								pGaugeIndicator->emblem.fWidth = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pLogoSubNode->name, BAD_CAST "height") == 0)
-								pGaugeIndicator->emblem.fHeight = _str2double (cTextNodeContent);
-							else if(xmlStrcmp (pLogoSubNode->name, BAD_CAST "alpha") == 0)
-								pGaugeIndicator->emblem.fAlpha = _str2double (cTextNodeContent);
-						}
-					}
+					bValid = FALSE;
+					break;
 				}
-				xmlFree (cNodeContent);
-			}
-			
-			// in the case of a needle, load it now, since we need to know the dimensions beforehand.
-			if (cNeedleImage != NULL)
+				bEnter = _start_element (&parser, reader, cName, iDepth);
+				if (bEnter && xmlTextReaderIsEmptyElement (reader))  // no end for <foo/>
+					_end_element (&parser, cName, iDepth);
+			break;
+			case XML_READER_TYPE_END_ELEMENT:
+				_end_element (&parser, xmlTextReaderConstName (reader), iDepth);
+			break;
+			case XML_READER_TYPE_TEXT:
+			case XML_READER_TYPE_CDATA:
+				g_string_append (parser.sContent, (const gchar *) xmlTextReaderConstValue (reader));
+			break;
+			default:
+			break;
+		}
+		if (! bValid)
+			break;
+		r = (bEnter ? xmlTextReaderRead (reader) : xmlTextReaderNext (reader));
+	}
+	if (r < 0)  // not well-formed.
+		bValid = FALSE;
+	xmlFreeTextReader (reader);  // ne pas utiliser xmlCleanupParser(), cela peut affecter les autres threads utilisant libxml !
+	
+	GaugeTheme *pTheme = parser.pTheme;
+	if (parser.pIndicator != NULL)  // unfinished indicator.
+		_cairo_dock_free_gauge_indicator (parser.pIndicator);
+	g_free (parser.cNeedleImage);
+	g_ptr_array_free (parser.pImages, TRUE);
+	g_string_free (parser.sContent, TRUE);
+	if (parser.bCountIndicators || pTheme->iRank <= 0)
+		pTheme->iRank = parser.iNbIndicators;
+	else if (pTheme->iRank > parser.iNbIndicators)  // the rank given by the theme can't exceed the number of indicators we could load (some may have been skipped), or some values would never be drawn.
+	{
+		cd_warning ("the gauge theme %s has a rank of %d but only %d valid indicators", cThemePath, pTheme->iRank, parser.iNbIndicators);
+		pTheme->iRank = parser.iNbIndicators;
+	}
+	
+	if (! bValid || pTheme->iRank == 0 || parser.iNbIndicators == 0)
+	{
+		cd_warning ("invalid gauge theme (%s)", cThemePath);
+		_free_theme (pTheme);
+		return NULL;
+	}
+	return pTheme;
+}
+
+  ///////////////////////////////////////////////
+ /////////////// COMPILE THEME /////////////////
+///////////////////////////////////////////////
+
+static GaugeImage *_compile_gauge_image (const GaugeImage *pImageDesc)
+{
+	if (pImageDesc == NULL)
+		return NULL;
+	GaugeImage *pGaugeImage = g_new0 (GaugeImage, 1);
+	pGaugeImage->cImagePath = g_strdup (pImageDesc->cImagePath);
+	return pGaugeImage;
+}
+
+static GaugeIndicator *_compile_gauge_indicator (const GaugeIndicator *pIndicatorDesc)
+{
+	GaugeIndicator *pGaugeIndicator = g_new (GaugeIndicator, 1);
+	memcpy (pGaugeIndicator, pIndicatorDesc, sizeof (GaugeIndicator));  // all the parameters
+	memset (&pGaugeIndicator->angles, 0, sizeof (CairoDataRendererAngleTable));
+	
+	if (pIndicatorDesc->pImageList != NULL)
+	{
+		pGaugeIndicator->pImageList = g_new0 (GaugeImage, pIndicatorDesc->iNbImages);
+		int i;
+		for (i = 0; i < pIndicatorDesc->iNbImages; i ++)
+			pGaugeIndicator->pImageList[i].cImagePath = g_strdup (pIndicatorDesc->pImageList[i].cImagePath);
+	}
+	pGaugeIndicator->pImageUndef = _compile_gauge_image (pIndicatorDesc->pImageUndef);
+	pGaugeIndicator->pImageNeedle = _compile_gauge_image (pIndicatorDesc->pImageNeedle);  // needs the size of the gauge to be loaded.
+	return pGaugeIndicator;
+}
+
+// pGaugeIndicator is only given for a needle.
+typedef gboolean (*GaugeImageFunc) (GaugeTheme *pTheme, GaugeImage *pGaugeImage, GaugeIndicator *pGaugeIndicator, gpointer data);
+
+// go through the images of a theme that have a file, always in the same order; stops as soon as the function returns FALSE.
+static gboolean _foreach_theme_image (GaugeTheme *pTheme, GaugeImageFunc func, gpointer data)
+{
+	if (pTheme->pImageBackground && pTheme->pImageBackground->cImagePath && ! func (pTheme, pTheme->pImageBackground, NULL, data))
+		return FALSE;
+	if (pTheme->pImageForeground && pTheme->pImageForeground->cImagePath && ! func (pTheme, pTheme->pImageForeground, NULL, data))
+		return FALSE;
+	GaugeIndicator *pGaugeIndicator;
+	GList *il;
+	int i;
+	for (il = pTheme->pIndicatorList; il != NULL; il = il->next)
+	{
+		pGaugeIndicator = il->data;
+		for (i = 0; pGaugeIndicator->pImageList != NULL && i < pGaugeIndicator->iNbImages; i ++)
+		{
+			if (pGaugeIndicator->pImageList[i].cImagePath && ! func (pTheme, &pGaugeIndicator->pImageList[i], NULL, data))
+				return FALSE;
+		}
+		if (pGaugeIndicator->pImageUndef && pGaugeIndicator->pImageUndef->cImagePath && ! func (pTheme, pGaugeIndicator->pImageUndef, NULL, data))
+			return FALSE;
+		if (pGaugeIndicator->pImageNeedle && pGaugeIndicator->pImageNeedle->cImagePath && ! func (pTheme, pGaugeIndicator->pImageNeedle, pGaugeIndicator, data))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean _load_theme_image (GaugeTheme *pTheme, GaugeImage *pGaugeImage, GaugeIndicator *pGaugeIndicator, G_GNUC_UNUSED gpointer data)
+{
+	if (pGaugeIndicator != NULL)
+		__load_needle (pGaugeIndicator, pTheme->iWidth, pTheme->iHeight);
+	else
+		cairo_dock_load_image_buffer (&pGaugeImage->image, pGaugeImage->cImagePath, pTheme->iWidth, pTheme->iHeight, 0);
+	return TRUE;
+}
+
+  /////////////////////////////////////////////
+ /////////////// THEME CACHE /////////////////
+/////////////////////////////////////////////
+
+// Compiled themes are also kept on disk, so that their SVG are not rendered again at each startup: the pixels of each image are stored, along with the date and size of its file and of the theme.xml; if any of them has changed, the theme is compiled again.
+// The description is still parsed from the theme.xml, which is cheap compared to the rendering of the images.
+#define GAUGE_CACHE_MAGIC 0x47434431  // "GCD1"
+#define GAUGE_CACHE_VERSION 1
+#define GAUGE_CACHE_PRUNE_AGE (30 * 24 * 3600)  // compiled themes not written for 1 month are removed.
+
+typedef struct {
+	gint64 iMTime;  // in ns.
+	gint64 iSize;
+	} GaugeFileStamp;
+
+typedef struct {
+	guint32 iMagic;
+	guint32 iVersion;
+	gint32 iWidth, iHeight;
+	guint32 iNbImages;
+	GaugeFileStamp theme;  // stamp of the theme.xml
+	} GaugeCacheHeader;
+
+// followed by iSurfaceWidth x iSurfaceHeight ARGB32 pixels; the records are not aligned, they're read with memcpy.
+typedef struct {
+	GaugeFileStamp file;
+	gint32 iWidth, iHeight;  // size of the image buffer.
+	gint32 iSurfaceWidth, iSurfaceHeight;  // size of its pixels (the needles are smaller than the gauge).
+	gdouble fZoomX, fZoomY;
+	gint32 iNeedleSvgWidth, iNeedleSvgHeight;  // 0 if not a needle.
+	} GaugeCacheImage;
+
+typedef struct {
+	const gchar *cContent;
+	gsize iLength;
+	gsize iOffset;
+	guint iNbImages;
+	} GaugeCacheReader;
+
+static gboolean s_bGaugeCachePruned = FALSE;
+
+static gchar *_get_theme_cache_path (const gchar *cThemePath, int iWidth, int iHeight)
+{
+	gchar *cHash = g_compute_checksum_for_string (G_CHECKSUM_MD5, cThemePath, -1);
+	gchar *cCachePath = g_strdup_printf ("%s/cairo-dock/gauges/%s-%dx%d", g_get_user_cache_dir (), cHash, iWidth, iHeight);
+	g_free (cHash);
+	return cCachePath;
+}
+
+static gboolean _get_file_stamp (const gchar *cFilePath, GaugeFileStamp *pStamp)
+{
+	struct stat st;
+	memset (pStamp, 0, sizeof (GaugeFileStamp));
+	if (stat (cFilePath, &st) != 0)
+		return FALSE;
+	pStamp->iMTime = (gint64)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+	pStamp->iSize = st.st_size;
+	return TRUE;
+}
+
+static gboolean _get_theme_stamp (GaugeTheme *pTheme, GaugeFileStamp *pStamp)
+{
+	gchar *cXmlFile = g_strdup_printf ("%s/theme.xml", pTheme->cThemePath);
+	gboolean bOk = _get_file_stamp (cXmlFile, pStamp);
+	g_free (cXmlFile);
+	return bOk;
+}
+
+static gboolean _count_theme_image (G_GNUC_UNUSED GaugeTheme *pTheme, G_GNUC_UNUSED GaugeImage *pGaugeImage, G_GNUC_UNUSED GaugeIndicator *pGaugeIndicator, gpointer data)
+{
+	guint *iNbImages = data;
+	(*iNbImages) ++;
+	return TRUE;
+}
+
+static gboolean _check_cached_image (GaugeTheme *pTheme, GaugeImage *pGaugeImage, GaugeIndicator *pGaugeIndicator, gpointer data)
+{
+	GaugeCacheReader *pReader = data;
+	GaugeCacheImage record;
+	if (pReader->iLength - pReader->iOffset < sizeof (GaugeCacheImage))
+		return FALSE;
+	memcpy (&record, pReader->cContent + pReader->iOffset, sizeof (GaugeCacheImage));
+	pReader->iOffset += sizeof (GaugeCacheImage);
+	
+	GaugeFileStamp stamp;
+	if (! _get_file_stamp (pGaugeImage->cImagePath, &stamp) || memcmp (&stamp, &record.file, sizeof (GaugeFileStamp)) != 0)
+		return FALSE;
+	if (record.iWidth <= 0 || record.iHeight <= 0 || record.iSurfaceWidth <= 0 || record.iSurfaceHeight <= 0
+	|| record.iSurfaceWidth > 4 * pTheme->iWidth || record.iSurfaceHeight > 4 * pTheme->iHeight)  // the images are loaded at the size of the gauge, a needle is at most as large as its SVG scaled to it.
+		return FALSE;
+	if ((pGaugeIndicator != NULL) != (record.iNeedleSvgWidth > 0 && record.iNeedleSvgHeight > 0))
+		return FALSE;
+	gsize iPixelsSize = (gsize)record.iSurfaceWidth * record.iSurfaceHeight * 4;
+	if (pReader->iLength - pReader->iOffset < iPixelsSize)
+		return FALSE;
+	pReader->iOffset += iPixelsSize;
+	pReader->iNbImages ++;
+	return TRUE;
+}
+
+static cairo_surface_t *_create_surface_from_pixels (const gchar *pPixels, int iWidth, int iHeight)
+{
+	cairo_surface_t *pImageSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, iWidth, iHeight);
+	if (cairo_surface_status (pImageSurface) != CAIRO_STATUS_SUCCESS)
+	{
+		cairo_surface_destroy (pImageSurface);
+		return NULL;
+	}
+	cairo_surface_flush (pImageSurface);
+	unsigned char *pData = cairo_image_surface_get_data (pImageSurface);
+	int iStride = cairo_image_surface_get_stride (pImageSurface);
+	int y;
+	for (y = 0; y < iHeight; y ++)
+		memcpy (pData + y * iStride, pPixels + (gsize)y * iWidth * 4, iWidth * 4);
+	cairo_surface_mark_dirty (pImageSurface);
+	if (g_bUseOpenGL)  // the texture is made from it, like the surfaces of the images.
+		return pImageSurface;
+	
+	// in cairo mode, the images are drawn from a surface similar to the dock's one.
+	cairo_surface_t *pSurface = cairo_dock_create_blank_surface (iWidth, iHeight);
+	cairo_t *pCairoContext = cairo_create (pSurface);
+	cairo_set_operator (pCairoContext, CAIRO_OPERATOR_SOURCE);
+	cairo_set_source_surface (pCairoContext, pImageSurface, 0, 0);
+	cairo_paint (pCairoContext);
+	cairo_destroy (pCairoContext);
+	cairo_surface_destroy (pImageSurface);
+	return pSurface;
+}
+
+static gboolean _load_cached_image (GaugeTheme *pTheme, GaugeImage *pGaugeImage, GaugeIndicator *pGaugeIndicator, gpointer data)
+{
+	GaugeCacheReader *pReader = data;
+	GaugeCacheImage record;
+	memcpy (&record, pReader->cContent + pReader->iOffset, sizeof (GaugeCacheImage));
+	pReader->iOffset += sizeof (GaugeCacheImage);
+	
+	if (pGaugeIndicator != NULL)  // the size of the needle and its rotations are computed as when its SVG is loaded.
+		_set_needle_size (pGaugeIndicator, record.iNeedleSvgWidth, record.iNeedleSvgHeight, pTheme->iWidth, pTheme->iHeight);
+	
+	cairo_surface_t *pSurface = _create_surface_from_pixels (pReader->cContent + pReader->iOffset, record.iSurfaceWidth, record.iSurfaceHeight);
+	pReader->iOffset += (gsize)record.iSurfaceWidth * record.iSurfaceHeight * 4;
+	cairo_dock_load_image_buffer_from_surface (&pGaugeImage->image, pSurface, record.iWidth, record.iHeight);
+	pGaugeImage->image.fZoomX = record.fZoomX;
+	pGaugeImage->image.fZoomY = record.fZoomY;
+	return TRUE;
+}
+
+static gboolean _load_theme_from_cache (GaugeTheme *pTheme, const gchar *cCachePath)
+{
+	gchar *cContent = NULL;
+	gsize iLength = 0;
+	if (! g_file_get_contents (cCachePath, &cContent, &iLength, NULL))
+		return FALSE;
+	
+	//\______________ check that the cache matches the theme, and that none of its files has changed.
+	gboolean bOk = FALSE;
+	GaugeCacheHeader header;
+	GaugeFileStamp stamp;
+	GaugeCacheReader reader = {cContent, iLength, sizeof (GaugeCacheHeader), 0};
+	if (iLength >= sizeof (GaugeCacheHeader))
+	{
+		memcpy (&header, cContent, sizeof (GaugeCacheHeader));
+		bOk = (header.iMagic == GAUGE_CACHE_MAGIC && header.iVersion == GAUGE_CACHE_VERSION
+			&& header.iWidth == pTheme->iWidth && header.iHeight == pTheme->iHeight
+			&& _get_theme_stamp (pTheme, &stamp) && memcmp (&stamp, &header.theme, sizeof (GaugeFileStamp)) == 0
+			&& _foreach_theme_image (pTheme, _check_cached_image, &reader)
+			&& reader.iNbImages == header.iNbImages && reader.iOffset == iLength);
+	}
+	
+	//\______________ load the images from their pixels.
+	if (bOk)
+	{
+		cd_debug ("gauge %s at %dx%d taken from the cache", pTheme->cThemePath, pTheme->iWidth, pTheme->iHeight);
+		reader.iOffset = sizeof (GaugeCacheHeader);
+		_foreach_theme_image (pTheme, _load_cached_image, &reader);
+	}
+	g_free (cContent);
+	return bOk;
+}
+
+static gboolean _write_cached_image (GaugeTheme *pTheme, GaugeImage *pGaugeImage, GaugeIndicator *pGaugeIndicator, gpointer data)
+{
+	GByteArray *pBuffer = data;
+	if (pGaugeImage->image.pSurface == NULL)  // not loaded, don't remember this failure.
+		return FALSE;
+	
+	GaugeCacheImage record;
+	memset (&record, 0, sizeof (GaugeCacheImage));
+	if (! _get_file_stamp (pGaugeImage->cImagePath, &record.file))
+		return FALSE;
+	record.iWidth = pGaugeImage->image.iWidth;
+	record.iHeight = pGaugeImage->image.iHeight;
+	record.fZoomX = pGaugeImage->image.fZoomX;
+	record.fZoomY = pGaugeImage->image.fZoomY;
+	if (pGaugeIndicator != NULL)
+	{
+		record.iSurfaceWidth = pGaugeIndicator->iNeedleWidth;
+		record.iSurfaceHeight = pGaugeIndicator->iNeedleHeight;
+		record.iNeedleSvgWidth = pGaugeIndicator->iNeedleSvgWidth;
+		record.iNeedleSvgHeight = pGaugeIndicator->iNeedleSvgHeight;
+	}
+	else
+	{
+		record.iSurfaceWidth = pGaugeImage->image.iWidth;
+		record.iSurfaceHeight = pGaugeImage->image.iHeight;
+	}
+	if (record.iSurfaceWidth <= 0 || record.iSurfaceHeight <= 0
+	|| record.iSurfaceWidth > 4 * pTheme->iWidth || record.iSurfaceHeight > 4 * pTheme->iHeight)  // same limits as when reading it.
+		return FALSE;
+	
+	// get the pixels, whatever the kind of surface.
+	cairo_surface_t *pImageSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, record.iSurfaceWidth, record.iSurfaceHeight);
+	cairo_t *pCairoContext = cairo_create (pImageSurface);
+	cairo_set_operator (pCairoContext, CAIRO_OPERATOR_SOURCE);
+	cairo_set_source_surface (pCairoContext, pGaugeImage->image.pSurface, 0, 0);
+	cairo_paint (pCairoContext);
+	cairo_destroy (pCairoContext);
+	cairo_surface_flush (pImageSurface);
+	gboolean bOk = (cairo_surface_status (pImageSurface) == CAIRO_STATUS_SUCCESS);
+	if (bOk)
+	{
+		g_byte_array_append (pBuffer, (guint8*)&record, sizeof (GaugeCacheImage));
+		const unsigned char *pData = cairo_image_surface_get_data (pImageSurface);
+		int iStride = cairo_image_surface_get_stride (pImageSurface);
+		int y;
+		for (y = 0; y < record.iSurfaceHeight; y ++)
+			g_byte_array_append (pBuffer, pData + y * iStride, record.iSurfaceWidth * 4);
+	}
+	cairo_surface_destroy (pImageSurface);
+	return bOk;
+}
+
+// done once per session, when the first theme is cached.
+static void _prune_theme_cache (const gchar *cCacheDir)
+{
+	if (s_bGaugeCachePruned)
+		return;
+	s_bGaugeCachePruned = TRUE;
+	GDir *dir = g_dir_open (cCacheDir, 0, NULL);
+	if (dir == NULL)
+		return;
+	time_t iNow = time (NULL);
+	const gchar *cFileName;
+	gchar *cPath;
+	GStatBuf st;
+	while ((cFileName = g_dir_read_name (dir)) != NULL)
+	{
+		cPath = g_strdup_printf ("%s/%s", cCacheDir, cFileName);
+		if (g_stat (cPath, &st) == 0 && S_ISREG (st.st_mode) && iNow - st.st_mtime > GAUGE_CACHE_PRUNE_AGE)
+			g_remove (cPath);
+		g_free (cPath);
+	}
+	g_dir_close (dir);
+}
+
+static void _save_theme_to_cache (GaugeTheme *pTheme, const gchar *cCachePath, guint iNbImages)
+{
+	GaugeCacheHeader header;
+	memset (&header, 0, sizeof (GaugeCacheHeader));
+	if (! _get_theme_stamp (pTheme, &header.theme))
+		return;
+	header.iMagic = GAUGE_CACHE_MAGIC;
+	header.iVersion = GAUGE_CACHE_VERSION;
+	header.iWidth = pTheme->iWidth;
+	header.iHeight = pTheme->iHeight;
+	header.iNbImages = iNbImages;
+	
+	GByteArray *pBuffer = g_byte_array_new ();
+	g_byte_array_append (pBuffer, (guint8*)&header, sizeof (GaugeCacheHeader));
+	if (_foreach_theme_image (pTheme, _write_cached_image, pBuffer))  // only if all the images could be loaded.
+	{
+		gchar *cCacheDir = g_path_get_dirname (cCachePath);
+		if (g_mkdir_with_parents (cCacheDir, 7*8*8+5*8+5) == 0)
+		{
+			_prune_theme_cache (cCacheDir);
+			GError *erreur = NULL;
+			g_file_set_contents (cCachePath, (gchar*)pBuffer->data, pBuffer->len, &erreur);  // written in a temporary file and renamed, so a gauge never reads a partial cache.
+			if (erreur != NULL)
 			{
-				_load_gauge_needle (pGaugeIndicator, cThemePath, cNeedleImage, iWidth, iHeight);
-				xmlFree (cNeedleImage);
+				cd_warning ("couldn't cache the gauge %s: %s", pTheme->cThemePath, erreur->message);
+				g_error_free (erreur);
 			}
-			pGauge->pIndicatorList = g_list_append (pGauge->pIndicatorList, pGaugeIndicator);
 		}
+		g_free (cCacheDir);
 	}
-	cairo_dock_close_xml_file (pGaugeTheme);
-	g_string_free (sImagePath, TRUE);
+	g_byte_array_free (pBuffer, TRUE);
+}
+
+static GaugeTheme *_compile_theme (GaugeTheme *pDescription, int iWidth, int iHeight)
+{
+	cd_debug ("compile the gauge %s at %dx%d", pDescription->cThemePath, iWidth, iHeight);
+	GaugeTheme *pTheme = g_new0 (GaugeTheme, 1);
+	pTheme->cThemePath = g_strdup (pDescription->cThemePath);
+	pTheme->iWidth = iWidth;
+	pTheme->iHeight = iHeight;
+	pTheme->pDescription = pDescription;
+	pDescription->iRefCount ++;
+	pTheme->iRank = pDescription->iRank;
+	pTheme->iMultiDisplay = pDescription->iMultiDisplay;
 	
-	g_return_val_if_fail (pRenderer->iRank != 0 && pGaugeIndicator != NULL, FALSE);
+	pTheme->pImageBackground = _compile_gauge_image (pDescription->pImageBackground);
+	pTheme->pImageForeground = _compile_gauge_image (pDescription->pImageForeground);
+	GList *il;
+	for (il = pDescription->pIndicatorList; il != NULL; il = il->next)
+	{
+		pTheme->pIndicatorList = g_list_prepend (pTheme->pIndicatorList, _compile_gauge_indicator (il->data));
+	}
+	pTheme->pIndicatorList = g_list_reverse (pTheme->pIndicatorList);
 	
-	return TRUE;
+	//\______________ load the images, from the cache if the theme has already been compiled at this size.
+	guint iNbImages = 0;
+	_foreach_theme_image (pTheme, _count_theme_image, &iNbImages);
+	if (iNbImages == 0)  // nothing to render, nothing to cache.
+		return pTheme;
+	gchar *cCachePath = _get_theme_cache_path (pTheme->cThemePath, iWidth, iHeight);
+	if (! _load_theme_from_cache (pTheme, cCachePath))
+	{
+		_foreach_theme_image (pTheme, _load_theme_image, NULL);
+		_save_theme_to_cache (pTheme, cCachePath, iNbImages);
+	}
+	g_free (cCachePath);
+	return pTheme;
 }
+
+static inline gchar *_get_theme_key (const gchar *cThemePath, int iWidth, int iHeight)
+{
+	return g_strdup_printf ("%s:%dx%d", cThemePath, iWidth, iHeight);
+}
+
+static GaugeTheme *_get_theme (const gchar *cThemePath, int iWidth, int iHeight)
+{
+	g_return_val_if_fail (cThemePath != NULL, NULL);
+	if (iWidth == 0 || iHeight == 0)
+		return NULL;
+	if (s_hGaugeThemes == NULL)
+	{
+		s_hGaugeDescriptions = g_hash_table_new (g_str_hash, g_str_equal);  // the key belongs to the theme.
+		s_hGaugeThemes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	}
+	
+	//\______________ look for the theme already compiled at this size.
+	gchar *cKey = _get_theme_key (cThemePath, iWidth, iHeight);
+	GaugeTheme *pTheme = g_hash_table_lookup (s_hGaugeThemes, cKey);
+	if (pTheme != NULL)
+	{
+		g_free (cKey);
+		pTheme->iRefCount ++;
+		return pTheme;
+	}
+	
+	//\______________ get its description, parsing the theme if needed.
+	GaugeTheme *pDescription = g_hash_table_lookup (s_hGaugeDescriptions, cThemePath);
+	if (pDescription == NULL)
+	{
+		pDescription = _parse_theme (cThemePath);
+		if (pDescription == NULL)
+		{
+			g_free (cKey);
+			return NULL;
+		}
+		g_hash_table_insert (s_hGaugeDescriptions, pDescription->cThemePath, pDescription);
+	}
+	
+	//\______________ compile it at this size.
+	pTheme = _compile_theme (pDescription, iWidth, iHeight);
+	pTheme->iRefCount = 1;
+	g_hash_table_insert (s_hGaugeThemes, cKey, pTheme);
+	return pTheme;
+}
+
+static void _release_theme (GaugeTheme *pTheme)
+{
+	if (pTheme == NULL || -- pTheme->iRefCount > 0)
+		return;
+	
+	GaugeTheme *pDescription = pTheme->pDescription;
+	gchar *cKey = _get_theme_key (pTheme->cThemePath, pTheme->iWidth, pTheme->iHeight);
+	g_hash_table_remove (s_hGaugeThemes, cKey);
+	g_free (cKey);
+	_free_theme (pTheme);
+	
+	if (-- pDescription->iRefCount == 0)  // no more gauge with this theme.
+	{
+		g_hash_table_remove (s_hGaugeDescriptions, pDescription->cThemePath);
+		_free_theme (pDescription);
+	}
+}
+
+static void _set_theme (Gauge *pGauge, GaugeTheme *pTheme)
+{
+	pGauge->pTheme = pTheme;
+	pGauge->pImageBackground = pTheme->pImageBackground;
+	pGauge->pImageForeground = pTheme->pImageForeground;
+	pGauge->pIndicatorList = pTheme->pIndicatorList;
+	pGauge->iMultiDisplay = pTheme->iMultiDisplay;
+	CAIRO_DATA_RENDERER (pGauge)->iRank = pTheme->iRank;
+}
+
 static void load (Gauge *pGauge, G_GNUC_UNUSED Icon *pIcon, CairoGaugeAttribute *pAttribute)
 {
-	// on charge le theme defini en attribut.
-	gboolean bThemeLoaded = _load_theme (pGauge, pAttribute->cThemePath);
-	if (!bThemeLoaded)
+	// on recupere le theme defini en attribut, compile a notre taille.
+	GaugeTheme *pTheme = _get_theme (pAttribute->cThemePath, pGauge->dataRenderer.iWidth, pGauge->dataRenderer.iHeight);
+	if (pTheme == NULL)
 		return;
+	_set_theme (pGauge, pTheme);
 	
 	// on complete le data-renderer.
 	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGauge);
@@ -568,19 +1136,19 @@ static void _draw_gauge_needle (cairo_t *pCairoContext, Gauge *pGauge, GaugeIndi
 		return;
 	
 	GaugeImage *pGaugeImage = pGaugeIndicator->pImageNeedle;
-	if (pGaugeImage != NULL)
+	if (pGaugeImage != NULL && pGaugeIndicator->angles.iNbAngles != 0)  // no angles if the needle couldn't be loaded
 	{
-		double fAngle = (pGaugeIndicator->posStart + fValue * (pGaugeIndicator->posStop - pGaugeIndicator->posStart)) * G_PI / 180.;
-		if (pGaugeIndicator->direction < 0)
-			fAngle = - fAngle;
+		int k = cairo_data_renderer_get_angle_index (&pGaugeIndicator->angles, fValue);
+		double c = pGaugeIndicator->angles.pCos[k], s = pGaugeIndicator->angles.pSin[k];
 		
 		double fHalfX = CAIRO_DATA_RENDERER (pGauge)->iWidth / 2.0f * (1 + pGaugeIndicator->posX);
 		double fHalfY = CAIRO_DATA_RENDERER (pGauge)->iHeight / 2.0f * (1 - pGaugeIndicator->posY);
 		
 		cairo_save (pCairoContext);
 		
-		cairo_translate (pCairoContext, fHalfX, fHalfY);
-		cairo_rotate (pCairoContext, -G_PI/2 + fAngle);
+		cairo_matrix_t m;
+		cairo_matrix_init (&m, c, s, -s, c, fHalfX, fHalfY);  // translation + rotation
+		cairo_transform (pCairoContext, &m);
 		
 		cairo_set_source_surface (pCairoContext, pGaugeImage->image.pSurface, -pGaugeIndicator->iNeedleOffsetX, -pGaugeIndicator->iNeedleOffsetY);
 		cairo_paint (pCairoContext);
@@ -759,16 +1327,19 @@ static void _draw_gauge_needle_opengl (Gauge *pGauge, GaugeIndicator *pGaugeIndi
 	int iWidth = pGauge->dataRenderer.iWidth, iHeight = pGauge->dataRenderer.iHeight;
 	if(pGaugeImage->image.iTexture != 0)
 	{
-		double fAngle = (pGaugeIndicator->posStart + fValue * (pGaugeIndicator->posStop - pGaugeIndicator->posStart));
-		if (pGaugeIndicator->direction < 0)
-			fAngle = - fAngle;
+		int k = cairo_data_renderer_get_angle_index (&pGaugeIndicator->angles, fValue);
+		double c = pGaugeIndicator->angles.pCos[k], s = - pGaugeIndicator->angles.pSin[k];  // the Y axis is upward in OpenGL, so the rotation is reversed.
 		double fHalfX = iWidth / 2.0f * (0 + pGaugeIndicator->posX);
 		double fHalfY = iHeight / 2.0f * (0 + pGaugeIndicator->posY);
+		GLdouble m[16] = {
+			c, s, 0., 0.,
+			-s, c, 0., 0.,
+			0., 0., 1., 0.,
+			fHalfX, fHalfY, 0., 1.};  // translation + rotation, column-major.
 		
 		glPushMatrix ();
 		
-		glTranslatef (fHalfX, fHalfY, 0.);
-		glRotatef (90. - fAngle, 0., 0., 1.);
+		glMultMatrixd (m);
 		glTranslatef (pGaugeIndicator->iNeedleWidth/2 - pGaugeIndicator->fNeedleScale * pGaugeIndicator->iNeedleOffsetX, 0., 0.);
 		_cairo_dock_apply_texture_at_size (pGaugeImage->image.iTexture, pGaugeIndicator->iNeedleWidth, pGaugeIndicator->iNeedleHeight);
 		
@@ -907,31 +1478,17 @@ static void reload (Gauge *pGauge)
 {
 	//g_print ("%s (%dx%d)\n", __func__, iWidth, iHeight);
 	g_return_if_fail (pGauge != NULL);
+	if (pGauge->pTheme == NULL)  // the theme couldn't be loaded.
+		return;
 	
 	int iWidth, iHeight;
 	cairo_data_renderer_get_size (CAIRO_DATA_RENDERER (pGauge), &iWidth, &iHeight);
 	
-	if (pGauge->pImageBackground)
-		_reload_gauge_image (pGauge->pImageBackground, iWidth, iHeight);
-	
-	if (pGauge->pImageForeground)
-		_reload_gauge_image (pGauge->pImageForeground, iWidth, iHeight);
-	
-	GaugeIndicator *pGaugeIndicator;
-	int i;
-	GList *pElement;
-	for (pElement = pGauge->pIndicatorList; pElement != NULL; pElement = pElement->next)
-	{
-		pGaugeIndicator = pElement->data;
-		for (i = 0; i < pGaugeIndicator->iNbImages; i ++)
-		{
-			_reload_gauge_image (&pGaugeIndicator->pImageList[i], iWidth, iHeight);
-		}
-		if (pGaugeIndicator->pImageNeedle)
-		{
-			_reload_gauge_needle (pGaugeIndicator, iWidth, iHeight);
-		}
-	}
+	GaugeTheme *pTheme = _get_theme (pGauge->pTheme->cThemePath, iWidth, iHeight);  // get the new one before releasing the old one, so that the description is kept.
+	if (pTheme == NULL)
+		return;
+	_release_theme (pGauge->pTheme);
+	_set_theme (pGauge, pTheme);
 }
 
   ////////////////////////////////////////////
@@ -963,18 +1520,26 @@ static void _cairo_dock_free_gauge_indicator(GaugeIndicator *pGaugeIndicator)
 	_cairo_dock_free_gauge_image (pGaugeIndicator->pImageUndef, TRUE);
 	
 	_cairo_dock_free_gauge_image (pGaugeIndicator->pImageNeedle, TRUE);
+	cairo_data_renderer_reset_angle_table (&pGaugeIndicator->angles);
 	
 	g_free (pGaugeIndicator);
 }
+static void _free_theme (GaugeTheme *pTheme)
+{
+	_cairo_dock_free_gauge_image (pTheme->pImageBackground, TRUE);
+	_cairo_dock_free_gauge_image (pTheme->pImageForeground, TRUE);
+	
+	g_list_foreach (pTheme->pIndicatorList, (GFunc)_cairo_dock_free_gauge_indicator, NULL);
+	g_list_free (pTheme->pIndicatorList);
+	g_free (pTheme->cThemePath);
+	g_free (pTheme);
+}
 static void unload (Gauge *pGauge)
 {
 	cd_debug("");
 	
-	_cairo_dock_free_gauge_image(pGauge->pImageBackground, TRUE);
-	_cairo_dock_free_gauge_image(pGauge->pImageForeground, TRUE);
-	
-	g_list_foreach (pGauge->pIndicatorList, (GFunc)_cairo_dock_free_gauge_indicator, NULL);
-	g_list_free (pGauge->pIndicatorList);
+	_release_theme (pGauge->pTheme);  // the images and indicators belong to the theme.
+	pGauge->pTheme = NULL;
 }
 
 
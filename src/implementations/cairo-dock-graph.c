@@ -42,12 +42,329 @@ typedef struct _Graph {
 	GLuint iBackgroundTexture;
 	gint iMargin;
 	gboolean bMixGraphs;
+	cairo_surface_t *pHistorySurface;  // the values already drawn, scrolled at each new value.
+	cairo_surface_t *pScrollSurface;  // back buffer used to scroll the history.
+	gboolean bHistoryValid;  // FALSE to redraw the history entirely.
+	guint iHistoryNbPushedValues;  // number of values pushed when the history was drawn.
+	gint iHistoryMemorySize;
+	gdouble *pHistoryMinMax;  // range of the values when the history was drawn.
+	CairoDataRendererAngleTable angles;  // angles of the circle graphs.
+	gfloat *pValues;  // buffer for the normalized values of the graph being drawn.
+	gint iValuesBufferSize;
+	GLfloat *pVertices;  // buffers for the vertices of the graph being drawn in OpenGL, and their colors.
+	GLfloat *pColors;
+	gint iVerticesBufferSize;
 	} Graph;
 
 
 extern gboolean g_bUseOpenGL;
 
 
+// get the position of the i-th graph, and its height (only for line/plain/bar graphs).
+static int _get_graph_position (Graph *pGraph, int i, double fHeight, double *x, double *y)
+{
+	int iMargin = pGraph->iMargin;
+	int iCurrentGraph, iGraphTop, iGraphBottom, iHeight = 0;
+	if (pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE || pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)
+	{
+		*x = 0.;
+		*y = (pGraph->bMixGraphs ? 0. : i * fHeight);
+	}
+	else
+	{
+		iCurrentGraph = pGraph->bMixGraphs ? 0 : i;
+		iGraphTop = floor (iCurrentGraph * fHeight) + iMargin; // Position of previous graph axis (if any).
+		iGraphBottom = floor ((iCurrentGraph + 1) * fHeight) + iMargin; // Position of current graph axis
+		iHeight = iGraphBottom - iGraphTop; // Current graph height.
+		*x = iMargin;
+		*y = iGraphTop;
+	}
+	return iHeight;
+}
+
+static int _place_graph (Graph *pGraph, cairo_t *pCairoContext, int i, double fHeight)
+{
+	double x, y;
+	int iHeight = _get_graph_position (pGraph, i, fHeight, &x, &y);
+	cairo_translate (pCairoContext, x, y);
+	cairo_pattern_t *pGradationPattern = pGraph->pGradationPatterns[i];
+	if (pGradationPattern != NULL)
+		cairo_set_source (pCairoContext, pGradationPattern);
+	else
+		cairo_set_source_rgb (pCairoContext,
+			pGraph->fLowColor[3*i+0],
+			pGraph->fLowColor[3*i+1],
+			pGraph->fLowColor[3*i+2]);
+	return iHeight;
+}
+
+// get the n last normalized values of the i-th value, the oldest first.
+static const gfloat *_get_normalized_values (Graph *pGraph, int i, int n)
+{
+	if (pGraph->iValuesBufferSize < n)
+	{
+		pGraph->pValues = g_renew (gfloat, pGraph->pValues, n);
+		pGraph->iValuesBufferSize = n;
+	}
+	cairo_data_renderer_get_normalized_history (CAIRO_DATA_RENDERER (pGraph), i, n, pGraph->pValues);
+	return pGraph->pValues;
+}
+
+// draw the n last values of a line/plain/bar graph, the current one on the right. fLeft is where the plain graph is closed on the left.
+static void _draw_values (Graph *pGraph, cairo_t *pCairoContext, int i, int iWidth, int iHeight, int n, double fLeft)
+{
+	n = MIN (n, cairo_data_renderer_get_history_size (CAIRO_DATA_RENDERER (pGraph)));
+	if (n < 1)
+		return;
+	const gfloat *pValues = _get_normalized_values (pGraph, i, n) + n - 1;  // pValues[-t] is the value at the time -t.
+	double fValue;
+	int t;
+	cairo_set_line_width (pCairoContext, 1);
+	if (pGraph->iType == CAIRO_DOCK_GRAPH_BAR)
+	{
+		for (t = 0; t < n; t ++)
+		{
+			fValue = pValues[-t];
+			if (fValue > CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> no draw
+			{
+				cairo_move_to (pCairoContext,
+					iWidth - t - .5, // - .5 to align line draw on pixel
+					iHeight);
+				cairo_rel_line_to (pCairoContext,
+					0.,
+					- fValue * iHeight);
+				cairo_stroke (pCairoContext);
+			}
+		}
+		return;
+	}
+	
+	cairo_set_line_join (pCairoContext, CAIRO_LINE_JOIN_ROUND);
+	fValue = pValues[0];
+	if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
+		fValue = 0;
+	cairo_move_to (pCairoContext,
+		iWidth - .5,
+		(1 - fValue) * (iHeight - 1) + .5) ; // - .5 to align line draw on pixel and + 1 px down because size is reduced
+	for (t = 1; t < n; t ++)
+	{
+		fValue = pValues[-t];
+		if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
+			fValue = 0;
+		cairo_line_to (pCairoContext,
+			iWidth - t - .5,
+			(1 - fValue) * (iHeight - 1) + .5); // - .5 to align line draw on pixel and + 1 px down because size is reduced
+	}
+	if (pGraph->iType == CAIRO_DOCK_GRAPH_PLAIN)
+	{
+		cairo_line_to (pCairoContext,
+			fLeft,
+			iHeight - .5); // - .5 to align next line draw on pixel
+		cairo_line_to (pCairoContext,
+			iWidth - .5,
+			iHeight - .5);
+		cairo_close_path (pCairoContext);
+		cairo_fill_preserve (pCairoContext);
+	}
+	cairo_stroke (pCairoContext);
+}
+
+static void _update_angle_table (Graph *pGraph)
+{
+	if (pGraph->iType != CAIRO_DOCK_GRAPH_CIRCLE && pGraph->iType != CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)
+		return;
+	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
+	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
+	int n = MIN (pData->iMemorySize, pRenderer->iWidth - 2*pGraph->iMargin);
+	if (n < 1)
+		return;
+	// each value is drawn as an arc from -(t-.5)/n to -(t+.5)/n turn, so the angles are shared by 2 consecutive values: angle k is at -(k-.5)/n turn, for k in [0, n].
+	cairo_data_renderer_compute_angle_table (&pGraph->angles, n + 1, 2*G_PI*(.5/n), -2*G_PI*((n-.5)/n));
+}
+
+static void _draw_circle (Graph *pGraph, cairo_t *pCairoContext, int i, int iWidth, double fHeight, int n)
+{
+	if (n < 1)
+		return;
+	if (pGraph->angles.iNbAngles != n + 1)  // the history has been resized
+		_update_angle_table (pGraph);
+	const double *pCos = pGraph->angles.pCos, *pSin = pGraph->angles.pSin;
+	const gfloat *pValues = _get_normalized_values (pGraph, i, n) + n - 1;  // pValues[-t] is the value at the time -t.
+	int iMargin = pGraph->iMargin;
+	double r;
+	int t;
+	cairo_set_line_width (pCairoContext, 1);
+	cairo_set_line_join (pCairoContext, CAIRO_LINE_JOIN_ROUND);
+	double radius = MIN (iWidth, fHeight)/2;
+	double xc = iMargin + iWidth/2, yc = iMargin + fHeight/2;
+	for (t = 0; t < n; t ++)
+	{
+		r = (pValues[-t] <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1 ? 0 : pValues[-t]) * radius;  // undef value -> let's draw 0
+		if (t == 0)
+			cairo_move_to (pCairoContext,
+				xc + r * pCos[0],
+				yc + r * pSin[0]);
+		else
+			cairo_line_to (pCairoContext,
+				xc + r * pCos[t],
+				yc + r * pSin[t]);
+		cairo_line_to (pCairoContext,
+			xc + r * pCos[t+1],
+			yc + r * pSin[t+1]);
+	}
+	if (pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)
+	{
+		cairo_close_path (pCairoContext);
+		cairo_fill_preserve (pCairoContext);
+	}
+	cairo_stroke (pCairoContext);
+}
+
+  /////////////
+ // HISTORY //
+/////////////
+
+// Line, plain and bar graphs are drawn on a history surface that scrolls by one column at each new value, so that only the new column has to be rasterized (the whole path used to be rebuilt and stroked each time, for each value). The scroll is a blit into a second surface, then both are swapped.
+#define GRAPH_HISTORY_NB_REDRAWN_COLUMNS 2  // the new column, and the previous one, which must be joined to the new value.
+
+static void _invalidate_history (Graph *pGraph)
+{
+	pGraph->bHistoryValid = FALSE;
+}
+
+static void _destroy_history (Graph *pGraph)
+{
+	if (pGraph->pHistorySurface != NULL)
+	{
+		cairo_surface_destroy (pGraph->pHistorySurface);
+		pGraph->pHistorySurface = NULL;
+	}
+	if (pGraph->pScrollSurface != NULL)
+	{
+		cairo_surface_destroy (pGraph->pScrollSurface);
+		pGraph->pScrollSurface = NULL;
+	}
+	g_free (pGraph->pHistoryMinMax);
+	pGraph->pHistoryMinMax = NULL;
+	_invalidate_history (pGraph);
+}
+
+static gboolean _history_can_scroll (Graph *pGraph)
+{
+	if (pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE || pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)  // every value moves at each update
+		return FALSE;
+	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
+	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
+	return (pData->iMemorySize >= pRenderer->iWidth - 2*pGraph->iMargin);  // the graph is full-width, so its left side is never re-shaped (the plain graph is closed on the left side of the graph, not of the values).
+}
+
+static void _draw_history (Graph *pGraph, cairo_t *pCairoContext, int iNbDrawings, int n, gboolean bScroll)
+{
+	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
+	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
+	int iMargin = pGraph->iMargin;
+	int iWidth = pRenderer->iWidth - 2*iMargin;
+	double fHeight = pRenderer->iHeight - 2*iMargin;
+	fHeight /= iNbDrawings;
+	int i, iHeight;
+	for (i = 0; i < iNbValues; i ++)
+	{
+		cairo_save (pCairoContext);
+		iHeight = _place_graph (pGraph, pCairoContext, i, fHeight);
+		if (bScroll)  // only redraw the last columns; neighbour points are included to join the lines the same way as a full draw.
+		{
+			cairo_rectangle (pCairoContext,
+				iWidth - GRAPH_HISTORY_NB_REDRAWN_COLUMNS,
+				0.,
+				GRAPH_HISTORY_NB_REDRAWN_COLUMNS,
+				iHeight);
+			cairo_clip (pCairoContext);
+			if (i == 0 || ! pGraph->bMixGraphs)  // mixed graphs share the same area, clear it only once.
+			{
+				cairo_save (pCairoContext);
+				cairo_set_operator (pCairoContext, CAIRO_OPERATOR_CLEAR);
+				cairo_paint (pCairoContext);
+				cairo_restore (pCairoContext);
+			}
+			_draw_values (pGraph, pCairoContext, i, iWidth, iHeight, GRAPH_HISTORY_NB_REDRAWN_COLUMNS + 1, iWidth - GRAPH_HISTORY_NB_REDRAWN_COLUMNS - .5);
+		}
+		else
+		{
+			_draw_values (pGraph, pCairoContext, i, iWidth, iHeight, n, .5); // - .5 to align line draw on pixel and + 1 to align with last value position
+		}
+		cairo_restore (pCairoContext);
+	}
+}
+
+static void _update_history (Graph *pGraph, int iNbDrawings, int n)
+{
+	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
+	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
+	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
+	
+	//\______________ create the surfaces.
+	if (pGraph->pHistorySurface == NULL)
+	{
+		pGraph->pHistorySurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, pRenderer->iWidth, pRenderer->iHeight);
+		pGraph->pScrollSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, pRenderer->iWidth, pRenderer->iHeight);
+		pGraph->pHistoryMinMax = g_new (gdouble, 2 * iNbValues);
+		_invalidate_history (pGraph);
+	}
+	
+	//\______________ check what has changed since the last draw.
+	guint iNbNewValues;
+	if (! pGraph->bHistoryValid
+	|| pGraph->iHistoryMemorySize != pData->iMemorySize
+	|| memcmp (pGraph->pHistoryMinMax, pData->pMinMaxValues, 2 * iNbValues * sizeof (gdouble)) != 0)  // the scale has changed, every point moves.
+		iNbNewValues = G_MAXUINT;
+	else
+		iNbNewValues = pData->iNbPushedValues - pGraph->iHistoryNbPushedValues;  // not the distance between the ring indexes, which is 0 if a whole ring of values has been pushed meanwhile.
+	if (iNbNewValues == 0)  // nothing new (the icon is just redrawn)
+		return;
+	
+	cairo_t *pCairoContext;
+	if (iNbNewValues == 1)
+	{
+		//\______________ scroll the history by 1 column to the left.
+		cairo_surface_t *pSurface = pGraph->pScrollSurface;
+		pGraph->pScrollSurface = pGraph->pHistorySurface;
+		pGraph->pHistorySurface = pSurface;
+		
+		pCairoContext = cairo_create (pGraph->pHistorySurface);
+		cairo_save (pCairoContext);
+		cairo_rectangle (pCairoContext,
+			pGraph->iMargin,
+			0.,
+			pRenderer->iWidth - 2*pGraph->iMargin,
+			pRenderer->iHeight);
+		cairo_clip (pCairoContext);  // don't let the oldest column slide into the margin.
+		cairo_set_operator (pCairoContext, CAIRO_OPERATOR_SOURCE);
+		cairo_set_source_surface (pCairoContext, pGraph->pScrollSurface, -1., 0.);
+		cairo_paint (pCairoContext);
+		cairo_restore (pCairoContext);
+		
+		//\______________ rasterize the new column.
+		_draw_history (pGraph, pCairoContext, iNbDrawings, n, TRUE);
+	}
+	else
+	{
+		//\______________ redraw all the values.
+		pCairoContext = cairo_create (pGraph->pHistorySurface);
+		cairo_set_operator (pCairoContext, CAIRO_OPERATOR_CLEAR);
+		cairo_paint (pCairoContext);
+		cairo_set_operator (pCairoContext, CAIRO_OPERATOR_OVER);
+		
+		_draw_history (pGraph, pCairoContext, iNbDrawings, n, FALSE);
+	}
+	cairo_destroy (pCairoContext);
+	
+	pGraph->bHistoryValid = TRUE;
+	pGraph->iHistoryNbPushedValues = pData->iNbPushedValues;
+	pGraph->iHistoryMemorySize = pData->iMemorySize;
+	memcpy (pGraph->pHistoryMinMax, pData->pMinMaxValues, 2 * iNbValues * sizeof (gdouble));
+}
+
+
 static void render (Graph *pGraph, cairo_t *pCairoContext)
 {
 	g_return_if_fail (pGraph != NULL);
@@ -63,7 +380,8 @@ static void render (Graph *pGraph, cairo_t *pCairoContext)
 		cairo_paint (pCairoContext);
 	}
 
-	g_return_if_fail (pRenderer->iRank != 0); // workaround: FIXME
+	if (pGraph->pGradationPatterns == NULL)  // not loaded, the renderer had no size yet.
+		return;
 	int iNbDrawings = iNbValues / pRenderer->iRank;
 	if (iNbDrawings == 0)
 		return;
@@ -73,144 +391,159 @@ static void render (Graph *pGraph, cairo_t *pCairoContext)
 	double fHeight = pRenderer->iHeight - 2*iMargin;
 	fHeight /= iNbDrawings;
 	
-	double fValue;
-	cairo_pattern_t *pGradationPattern;
-	int t, n = MIN (pData->iMemorySize, iWidth);  // for iteration over the memorized values.
-	int i, iCurrentGraph, iGraphTop, iGraphBottom, iHeight = 0;
+	int n = MIN (pData->iMemorySize, iWidth);  // for iteration over the memorized values.
+	int i, iHeight;
+	if (_history_can_scroll (pGraph))
+	{
+		_update_history (pGraph, iNbDrawings, n);
+		cairo_set_source_surface (pCairoContext, pGraph->pHistorySurface, 0., 0.);
+		cairo_paint (pCairoContext);
+		for (i = 0; i < iNbValues; i ++)
+			cairo_dock_render_overlays_to_context (pRenderer, i, pCairoContext);
+		return;
+	}
+	
 	for (i = 0; i < iNbValues; i ++)
 	{
 		cairo_save (pCairoContext);
+		iHeight = _place_graph (pGraph, pCairoContext, i, fHeight);
 		if (pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE || pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)
-		{
-			if (! pGraph->bMixGraphs)
-				cairo_translate (pCairoContext,
-					0.,
-					i * fHeight);
-		}
-		else
-		{
-			iCurrentGraph = pGraph->bMixGraphs ? 0 : i;
-			iGraphTop = floor (iCurrentGraph * fHeight) + iMargin; // Position of previous graph axis (if any).
-			iGraphBottom = floor ((iCurrentGraph + 1) * fHeight) + iMargin; // Position of current graph axis
-			iHeight = iGraphBottom - iGraphTop; // Current graph height.
-			cairo_translate (pCairoContext,
-				iMargin,
-				iGraphTop);
-		}
-		pGradationPattern = pGraph->pGradationPatterns[i];
-		if (pGradationPattern != NULL)
-			cairo_set_source (pCairoContext, pGradationPattern);
+			_draw_circle (pGraph, pCairoContext, i, iWidth, fHeight, n);
 		else
-			cairo_set_source_rgb (pCairoContext,
-				pGraph->fLowColor[3*i+0],
-				pGraph->fLowColor[3*i+1],
-				pGraph->fLowColor[3*i+2]);
+			_draw_values (pGraph, pCairoContext, i, iWidth, iHeight, n, .5); // - .5 to align line draw on pixel and + 1 to align with last value position
+		cairo_restore (pCairoContext);
 		
-		switch (pGraph->iType)
+		cairo_dock_render_overlays_to_context (pRenderer, i, pCairoContext);
+	}
+}
+
+  ///////////////////
+ // RENDER OPENGL //
+///////////////////
+
+// In OpenGL, all the values of a graph are sent at once as arrays of vertices and colors, instead of being drawn with cairo and then uploaded into the icon's texture. The color of a vertex is the one the gradation pattern has at its position, since the pattern goes linearly from the low color at the value 0 to the high color at the value 1; the colors in-between are interpolated by OpenGL the same way.
+
+static void _reserve_vertices (Graph *pGraph, int iNbVertices)
+{
+	if (pGraph->iVerticesBufferSize < iNbVertices)
+	{
+		pGraph->pVertices = g_renew (GLfloat, pGraph->pVertices, 2 * iNbVertices);
+		pGraph->pColors = g_renew (GLfloat, pGraph->pColors, 3 * iNbVertices);
+		pGraph->iVerticesBufferSize = iNbVertices;
+	}
+}
+
+static inline void _set_vertex (Graph *pGraph, int k, int i, double x, double y, double fValue)
+{
+	const gdouble *fLowColor = &pGraph->fLowColor[3*i], *fHighColor = &pGraph->fHighColor[3*i];
+	pGraph->pVertices[2*k] = x;
+	pGraph->pVertices[2*k+1] = y;
+	pGraph->pColors[3*k] = fLowColor[0] + (fHighColor[0] - fLowColor[0]) * fValue;
+	pGraph->pColors[3*k+1] = fLowColor[1] + (fHighColor[1] - fLowColor[1]) * fValue;
+	pGraph->pColors[3*k+2] = fLowColor[2] + (fHighColor[2] - fLowColor[2]) * fValue;
+}
+
+static void _draw_vertices (Graph *pGraph, GLenum iMode, int iFirst, int iNbVertices)
+{
+	glVertexPointer (2, GL_FLOAT, 0, pGraph->pVertices);
+	glColorPointer (3, GL_FLOAT, 0, pGraph->pColors);
+	glDrawArrays (iMode, iFirst, iNbVertices);
+}
+
+// same as _draw_values.
+static void _draw_values_opengl (Graph *pGraph, int i, int iWidth, int iHeight, int n)
+{
+	n = MIN (n, cairo_data_renderer_get_history_size (CAIRO_DATA_RENDERER (pGraph)));
+	if (n < 1)
+		return;
+	const gfloat *pValues = _get_normalized_values (pGraph, i, n) + n - 1;  // pValues[-t] is the value at the time -t.
+	double fValue;
+	int t, k = 0;
+	if (pGraph->iType == CAIRO_DOCK_GRAPH_BAR)
+	{
+		_reserve_vertices (pGraph, 2 * n);
+		for (t = 0; t < n; t ++)
 		{
-			case CAIRO_DOCK_GRAPH_LINE:
-			case CAIRO_DOCK_GRAPH_PLAIN:
-			default :
-				cairo_set_line_width (pCairoContext, 1);
-				cairo_set_line_join (pCairoContext, CAIRO_LINE_JOIN_ROUND);
-				fValue = cairo_data_renderer_get_normalized_current_value (pRenderer, i);
-				if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
-					fValue = 0;
-				cairo_move_to (pCairoContext,
-					iWidth - .5,
-					(1 - fValue) * (iHeight - 1) + .5) ; // - .5 to align line draw on pixel and + 1 px down because size is reduced
-				for (t = 1; t < n; t ++)
-				{
-					fValue = cairo_data_renderer_get_normalized_value (pRenderer, i, -t);
-					if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
-						fValue = 0;
-					cairo_line_to (pCairoContext,
-						iWidth - t - .5,
-						(1 - fValue) * (iHeight - 1) + .5); // - .5 to align line draw on pixel and + 1 px down because size is reduced
-				}
-				if (pGraph->iType == CAIRO_DOCK_GRAPH_PLAIN)
-				{
-					cairo_line_to (pCairoContext,
-						.5, // - .5 to align line draw on pixel and + 1 to align with last value position
-						iHeight - .5); // - .5 to align next line draw on pixel
-					cairo_rel_line_to (pCairoContext,
-						iWidth - 1,
-						0.);
-					cairo_close_path (pCairoContext);
-					cairo_fill_preserve (pCairoContext);
-				}
-				cairo_stroke (pCairoContext);
-			break;
-			
-			case CAIRO_DOCK_GRAPH_BAR:
+			fValue = pValues[-t];
+			if (fValue > CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> no draw
 			{
-				cairo_set_line_width (pCairoContext, 1);
-				for (t = 0; t < n; t ++)
-				{
-					fValue = cairo_data_renderer_get_normalized_value (pRenderer, i, -t);
-					if (fValue > CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> no draw
-					{
-						cairo_move_to (pCairoContext,
-							iWidth - t - .5, // - .5 to align line draw on pixel
-							iHeight);
-						cairo_rel_line_to (pCairoContext,
-							0.,
-							- fValue * iHeight);
-						cairo_stroke (pCairoContext);
-					}
-				}
+				_set_vertex (pGraph, k++, i, iWidth - t - .5, iHeight, 0.);
+				_set_vertex (pGraph, k++, i, iWidth - t - .5, iHeight - fValue * iHeight, fValue);
 			}
-			break;
-			
-			case CAIRO_DOCK_GRAPH_CIRCLE:
-			case CAIRO_DOCK_GRAPH_CIRCLE_PLAIN:
-				cairo_set_line_width (pCairoContext, 1);
-				cairo_set_line_join (pCairoContext, CAIRO_LINE_JOIN_ROUND);
-				fValue = cairo_data_renderer_get_normalized_current_value (pRenderer, i);
-				if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
-					fValue = 0;
-				double angle, radius = MIN (iWidth, fHeight)/2;
-				angle = -2*G_PI*(-.5/pData->iMemorySize);
-				cairo_move_to (pCairoContext,
-					iMargin + iWidth/2 + radius * (fValue * cos (angle)),
-					iMargin + fHeight/2 + radius * (fValue * sin (angle)));
-				angle = -2*G_PI*(.5/pData->iMemorySize);
-				cairo_line_to (pCairoContext,
-					iMargin + iWidth/2 + radius * (fValue * cos (angle)),
-					iMargin + fHeight/2 + radius * (fValue * sin (angle)));
-				for (t = 1; t < n; t ++)
-				{
-					fValue = cairo_data_renderer_get_normalized_value (pRenderer, i, -t);
-					if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
-						fValue = 0;
-					angle = -2*G_PI*((t-.5)/n);
-					cairo_line_to (pCairoContext,
-						iMargin + iWidth/2 + radius * (fValue * cos (angle)),
-						iMargin + fHeight/2 + radius * (fValue * sin (angle)));
-					angle = -2*G_PI*((t+.5)/n);
-					cairo_line_to (pCairoContext,
-						iMargin + iWidth/2 + radius * (fValue * cos (angle)),
-						iMargin + fHeight/2 + radius * (fValue * sin (angle)));
-				}
-				if (pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)
-				{
-					cairo_close_path (pCairoContext);
-					cairo_fill_preserve (pCairoContext);
-				}
-				cairo_stroke (pCairoContext);
-			break;
 		}
-		cairo_restore (pCairoContext);
-		
-		cairo_dock_render_overlays_to_context (pRenderer, i, pCairoContext);
+		_draw_vertices (pGraph, GL_LINES, 0, k);
+		return;
+	}
+	
+	// the line is in the n first vertices, and for a plain graph, the bottom of each column is added after it (so that the fill is a strip of alternate top/bottom vertices).
+	gboolean bPlain = (pGraph->iType == CAIRO_DOCK_GRAPH_PLAIN);
+	_reserve_vertices (pGraph, bPlain ? 3 * n : n);
+	for (t = 0; t < n; t ++)
+	{
+		fValue = pValues[-t];
+		if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
+			fValue = 0;
+		_set_vertex (pGraph, t, i, iWidth - t - .5, (1 - fValue) * (iHeight - 1) + .5, fValue);  // - .5 to align line draw on pixel and + 1 px down because size is reduced
+	}
+	if (bPlain)
+	{
+		for (t = 0; t < n; t ++)
+		{
+			memcpy (&pGraph->pVertices[2*(n+2*t)], &pGraph->pVertices[2*t], 2 * sizeof (GLfloat));
+			memcpy (&pGraph->pColors[3*(n+2*t)], &pGraph->pColors[3*t], 3 * sizeof (GLfloat));
+			_set_vertex (pGraph, n+2*t+1, i, iWidth - t - .5, iHeight - .5, 0.);
+		}
+		_draw_vertices (pGraph, GL_TRIANGLE_STRIP, n, 2 * n);
+	}
+	_draw_vertices (pGraph, GL_LINE_STRIP, 0, n);
+}
+
+// same as _draw_circle.
+static void _draw_circle_opengl (Graph *pGraph, int i, int iWidth, double fHeight, int n)
+{
+	if (n < 1)
+		return;
+	if (pGraph->angles.iNbAngles != n + 1)  // the history has been resized
+		_update_angle_table (pGraph);
+	const double *pCos = pGraph->angles.pCos, *pSin = pGraph->angles.pSin;
+	const gfloat *pValues = _get_normalized_values (pGraph, i, n) + n - 1;  // pValues[-t] is the value at the time -t.
+	int iMargin = pGraph->iMargin;
+	double radius = MIN (iWidth, fHeight)/2;
+	double xc = iMargin + iWidth/2, yc = iMargin + fHeight/2;
+	double fValue;
+	int t;
+	
+	// the center first, for the fill, then the arc of each value, and the first point again to close the fan.
+	_reserve_vertices (pGraph, 2 * n + 2);
+	_set_vertex (pGraph, 0, i, xc, yc, 0.);
+	for (t = 0; t < n; t ++)
+	{
+		fValue = pValues[-t];
+		if (fValue <= CAIRO_DATA_RENDERER_UNDEF_VALUE+1)  // undef value -> let's draw 0
+			fValue = 0;
+		_set_vertex (pGraph, 2*t+1, i, xc + fValue * radius * pCos[t], yc + fValue * radius * pSin[t], fValue);
+		_set_vertex (pGraph, 2*t+2, i, xc + fValue * radius * pCos[t+1], yc + fValue * radius * pSin[t+1], fValue);
+	}
+	if (pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)
+	{
+		memcpy (&pGraph->pVertices[2*(2*n+1)], &pGraph->pVertices[2], 2 * sizeof (GLfloat));
+		memcpy (&pGraph->pColors[3*(2*n+1)], &pGraph->pColors[3], 3 * sizeof (GLfloat));
+		_draw_vertices (pGraph, GL_TRIANGLE_FAN, 0, 2 * n + 2);
+		_draw_vertices (pGraph, GL_LINE_LOOP, 1, 2 * n);
+	}
+	else
+	{
+		_draw_vertices (pGraph, GL_LINE_STRIP, 1, 2 * n);
 	}
 }
-/* not used
+
 static void render_opengl (Graph *pGraph)
 {
 	g_return_if_fail (pGraph != NULL);
 	
 	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
+	CairoDataToRenderer *pData = cairo_data_renderer_get_data (pRenderer);
+	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
 	
 	if (pGraph->iBackgroundTexture != 0)
 	{
@@ -221,9 +554,54 @@ static void render_opengl (Graph *pGraph)
 		_cairo_dock_disable_texture ();
 	}
 	
-	/// to be continued ...
+	if (pGraph->pGradationPatterns == NULL)  // not loaded, the renderer had no size yet.
+		return;
+	int iNbDrawings = iNbValues / pRenderer->iRank;
+	if (iNbDrawings == 0)
+		return;
+	
+	int iMargin = pGraph->iMargin;
+	int iWidth = pRenderer->iWidth - 2*iMargin;
+	double fHeight = pRenderer->iHeight - 2*iMargin;
+	fHeight /= iNbDrawings;
+	int n = MIN (pData->iMemorySize, iWidth);  // for iteration over the memorized values.
+	
+	//\______________ draw in the same coordinates as cairo: origin at the top-left corner, y downwards.
+	glPushMatrix ();
+	glTranslatef (- pRenderer->iWidth / 2., pRenderer->iHeight / 2., 0.);
+	glScalef (1., -1., 1.);
+	
+	glEnable (GL_BLEND);
+	_cairo_dock_set_blend_alpha ();
+	glEnable (GL_LINE_SMOOTH);
+	glHint (GL_LINE_SMOOTH_HINT, GL_NICEST);
+	glLineWidth (1.);
+	glEnableClientState (GL_VERTEX_ARRAY);
+	glEnableClientState (GL_COLOR_ARRAY);
+	
+	double x, y;
+	int i, iHeight;
+	for (i = 0; i < iNbValues; i ++)
+	{
+		glPushMatrix ();
+		iHeight = _get_graph_position (pGraph, i, fHeight, &x, &y);
+		glTranslatef (x, y, 0.);
+		if (pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE || pGraph->iType == CAIRO_DOCK_GRAPH_CIRCLE_PLAIN)
+			_draw_circle_opengl (pGraph, i, iWidth, fHeight, n);
+		else
+			_draw_values_opengl (pGraph, i, iWidth, iHeight, n);
+		glPopMatrix ();
+	}
+	
+	glDisableClientState (GL_COLOR_ARRAY);
+	glDisableClientState (GL_VERTEX_ARRAY);
+	glDisable (GL_LINE_SMOOTH);
+	glDisable (GL_BLEND);
+	glPopMatrix ();
+	
+	for (i = 0; i < iNbValues; i ++)
+		cairo_dock_render_overlays_to_texture (pRenderer, i);
 }
-*/
 
 static inline cairo_surface_t *_cairo_dock_create_graph_background (double fWidth, double fHeight, int iMargin, gdouble *pBackGroundColor, CairoDockTypeGraph iType, int iNbDrawings)
 {
@@ -435,14 +813,15 @@ static void load (Graph *pGraph, G_GNUC_UNUSED Icon *pIcon, CairoGraphAttribute
 {
 	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
 	
+	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
+	pRenderer->iRank = (pAttribute->bMixGraphs && iNbValues > 0 ? iNbValues : 1);  // never 0, even if the graph is not loaded below, since we divide by it.
+	
 	int iWidth = pRenderer->iWidth, iHeight = pRenderer->iHeight;
 	if (iWidth == 0 || iHeight == 0)
 		return ;
 
-	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
 	pGraph->iType = pAttribute->iType;
 	pGraph->bMixGraphs = pAttribute->bMixGraphs;
-	pRenderer->iRank = (pAttribute->bMixGraphs ? iNbValues : 1);
 
 	pGraph->fHighColor = g_new0 (double, 3 * iNbValues);
 	pGraph->fLowColor = g_new0 (double, 3 * iNbValues);
@@ -461,6 +840,8 @@ static void load (Graph *pGraph, G_GNUC_UNUSED Icon *pIcon, CairoGraphAttribute
 	}
 
 	pGraph->iMargin = floor (MIN (iWidth, iHeight) / 32);
+	_invalidate_history (pGraph);
+	_update_angle_table (pGraph);
 
 	if (pAttribute->fBackGroundColor != NULL)
 		memcpy (pGraph->fBackGroundColor, pAttribute->fBackGroundColor, 4 * sizeof (double));
@@ -471,7 +852,7 @@ static void load (Graph *pGraph, G_GNUC_UNUSED Icon *pIcon, CairoGraphAttribute
 		pGraph->fBackGroundColor,
 		pGraph->iType,
 		iNbValues / pRenderer->iRank);
-	if (g_bUseOpenGL && 0)
+	if (g_bUseOpenGL)
 		pGraph->iBackgroundTexture = cairo_dock_create_texture_from_surface (pGraph->pBackgroundSurface);
 	
 	// on complete le data-renderer.
@@ -483,14 +864,18 @@ static void reload (Graph *pGraph)
 {
 	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
 	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
+	if (pGraph->pGradationPatterns == NULL)  // not loaded (no size at that time), nothing to reload.
+		return;
 	int iWidth = pRenderer->iWidth, iHeight = pRenderer->iHeight;
 	pGraph->iMargin = floor (MIN (iWidth, iHeight) / 32);
+	_destroy_history (pGraph);  // it will be re-created at the new size on the next render.
+	_update_angle_table (pGraph);
 	if (pGraph->pBackgroundSurface != NULL)
 		cairo_surface_destroy (pGraph->pBackgroundSurface);
 	pGraph->pBackgroundSurface = _cairo_dock_create_graph_background (iWidth, iHeight, pGraph->iMargin, pGraph->fBackGroundColor, pGraph->iType, iNbValues / pRenderer->iRank);
 	if (pGraph->iBackgroundTexture != 0)
 		_cairo_dock_delete_texture (pGraph->iBackgroundTexture);
-	if (g_bUseOpenGL && 0)
+	if (g_bUseOpenGL)
 		pGraph->iBackgroundTexture = cairo_dock_create_texture_from_surface (pGraph->pBackgroundSurface);
 	else
 		pGraph->iBackgroundTexture = 0;
@@ -516,6 +901,11 @@ static void unload (Graph *pGraph)
 		cairo_surface_destroy (pGraph->pBackgroundSurface);
 	if (pGraph->iBackgroundTexture != 0)
 		_cairo_dock_delete_texture (pGraph->iBackgroundTexture);
+	_destroy_history (pGraph);
+	cairo_data_renderer_reset_angle_table (&pGraph->angles);
+	g_free (pGraph->pValues);
+	g_free (pGraph->pVertices);
+	g_free (pGraph->pColors);
 	
 	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pGraph);
 	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
@@ -544,7 +934,7 @@ void cairo_dock_register_data_renderer_graph (void)
 	// fill the properties we need
 	pRecord->interface.load              = (CairoDataRendererLoadFunc) load;
 	pRecord->interface.render            = (CairoDataRendererRenderFunc) render;
-	pRecord->interface.render_opengl     = (CairoDataRendererRenderOpenGLFunc) NULL;
+	pRecord->interface.render_opengl     = (CairoDataRendererRenderOpenGLFunc) render_opengl;
 	pRecord->interface.reload            = (CairoDataRendererReloadFunc) reload;
 	pRecord->interface.unload            = (CairoDataRendererUnloadFunc) unload;
 	pRecord->iStructSize                 = sizeof (Graph);
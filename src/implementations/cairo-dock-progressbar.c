@@ -37,10 +37,18 @@
 #include "cairo-dock-progressbar.h"
 
 
+// the images of a bar, shared by all the progress bars of the same size and colors.
 typedef struct {
-	CairoDataRenderer dataRenderer;
-	cairo_surface_t *pBarSurface;
+	gchar *cKey;
+	gint iRefCount;
+	cairo_surface_t *pBarSurface;  // the gradation, on the whole width.
+	cairo_surface_t *pFullBarSurface;  // the bar at the maximum value, with its outline; any value is drawn by clipping it.
 	GLuint iBarTexture;
+} ProgressBarStyle;
+
+typedef struct {
+	CairoDataRenderer dataRenderer;
+	ProgressBarStyle *pStyle;
 	gint iBarThickness;
 	gchar *cImageGradation;
 	gdouble fColorGradation[8];  // 2 rgba colors
@@ -53,29 +61,32 @@ typedef struct {
 
 extern gboolean g_bUseOpenGL;
 
+static GHashTable *s_hBarStyles = NULL;  // key -> ProgressBarStyle
+
   //////////////////////////////////////
  /////////////// LOAD /////////////////
 //////////////////////////////////////
 
-static void _make_bar_surface (ProgressBar *pProgressBar)
+static cairo_surface_t *_make_bar_surface (ProgressBar *pProgressBar)
 {
 	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pProgressBar);
 	int iWidth = pRenderer->iWidth;
+	cairo_surface_t *pBarSurface = NULL;
 	
 	if (pProgressBar->cImageGradation != NULL)  // an image is provided
 	{
-		pProgressBar->pBarSurface = cairo_dock_create_surface_from_image_simple (
+		pBarSurface = cairo_dock_create_surface_from_image_simple (
 			pProgressBar->cImageGradation,
 			iWidth,
 			pProgressBar->iBarThickness);
 	}
 	
-	if (pProgressBar->pBarSurface == NULL)  // no image was provided, or it was not valid.
+	if (pBarSurface == NULL)  // no image was provided, or it was not valid.
 	{
 		// create a surface to bufferize the pattern.
-		pProgressBar->pBarSurface = cairo_dock_create_blank_surface (iWidth, pProgressBar->iBarThickness);
+		pBarSurface = cairo_dock_create_blank_surface (iWidth, pProgressBar->iBarThickness);
 		
-		cairo_t *ctx = cairo_create (pProgressBar->pBarSurface);
+		cairo_t *ctx = cairo_create (pBarSurface);
 		cairo_pattern_t *pGradationPattern = NULL;
 		if (myIndicatorsParam.bBarUseDefaultColors)
 		{
@@ -88,7 +99,7 @@ static void _make_bar_surface (ProgressBar *pProgressBar)
 				0.,
 				iWidth,
 				0.);  // de gauche a droite.
-			g_return_if_fail (cairo_pattern_status (pGradationPattern) == CAIRO_STATUS_SUCCESS);
+			g_return_val_if_fail (cairo_pattern_status (pGradationPattern) == CAIRO_STATUS_SUCCESS, pBarSurface);
 			
 			cairo_pattern_set_extend (pGradationPattern, CAIRO_EXTEND_NONE);
 			
@@ -122,7 +133,96 @@ static void _make_bar_surface (ProgressBar *pProgressBar)
 			cairo_pattern_destroy (pGradationPattern);
 		cairo_destroy (ctx);
 	}
-	pProgressBar->iBarTexture = cairo_dock_create_texture_from_surface (pProgressBar->pBarSurface);
+	return pBarSurface;
+}
+
+// draw the bar at the maximum value, the same way render() would do.
+static cairo_surface_t *_make_full_bar_surface (ProgressBar *pProgressBar, cairo_surface_t *pBarSurface)
+{
+	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pProgressBar);
+	int iWidth = pRenderer->iWidth;
+	double r = .5*pProgressBar->iBarThickness;  // radius
+	cairo_surface_t *pFullBarSurface = cairo_dock_create_blank_surface (iWidth, pProgressBar->iBarThickness);
+	cairo_t *ctx = cairo_create (pFullBarSurface);
+	cairo_set_line_cap (ctx, CAIRO_LINE_CAP_ROUND);
+	
+	// outline
+	if (myIndicatorsParam.bBarUseDefaultColors || myIndicatorsParam.fBarColorOutline.rgba.alpha != 0.)
+	{
+		if (myIndicatorsParam.bBarUseDefaultColors)
+			gldi_style_colors_set_line_color (ctx);
+		else
+			gldi_color_set_cairo (ctx, &myIndicatorsParam.fBarColorOutline);
+		cairo_set_line_width (ctx, pProgressBar->iBarThickness);
+		
+		cairo_move_to (ctx, r, r);
+		cairo_rel_line_to (ctx, iWidth - 2*r, 0);
+		
+		cairo_stroke (ctx);
+	}
+	
+	// bar
+	cairo_set_source_surface (ctx, pBarSurface, 0, 0);
+	cairo_set_line_width (ctx, pProgressBar->iBarThickness-2);
+	
+	cairo_move_to (ctx, r+1, r);
+	cairo_rel_line_to (ctx, iWidth - 2*r - 2, 0);
+	
+	cairo_stroke (ctx);
+	
+	cairo_destroy (ctx);
+	return pFullBarSurface;
+}
+
+// the images depend on the size, the colors of the bar, and the global colors of the outline.
+static gchar *_get_style_key (ProgressBar *pProgressBar)
+{
+	const gdouble *c = pProgressBar->fColorGradation;
+	const GldiColor *o = &myIndicatorsParam.fBarColorOutline;
+	return g_strdup_printf ("%dx%d:%s:%d:%g,%g,%g,%g;%g,%g,%g,%g:%g,%g,%g,%g",
+		CAIRO_DATA_RENDERER (pProgressBar)->iWidth,
+		pProgressBar->iBarThickness,
+		pProgressBar->cImageGradation ? pProgressBar->cImageGradation : "",
+		myIndicatorsParam.bBarUseDefaultColors ? gldi_style_colors_get_stamp () : -1,
+		c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7],
+		o->rgba.red, o->rgba.green, o->rgba.blue, o->rgba.alpha);
+}
+
+static ProgressBarStyle *_get_style (ProgressBar *pProgressBar)
+{
+	if (s_hBarStyles == NULL)
+		s_hBarStyles = g_hash_table_new (g_str_hash, g_str_equal);  // the key belongs to the style.
+	
+	gchar *cKey = _get_style_key (pProgressBar);
+	ProgressBarStyle *pStyle = g_hash_table_lookup (s_hBarStyles, cKey);
+	if (pStyle != NULL)
+	{
+		g_free (cKey);
+		pStyle->iRefCount ++;
+		return pStyle;
+	}
+	
+	pStyle = g_new0 (ProgressBarStyle, 1);
+	pStyle->cKey = cKey;
+	pStyle->iRefCount = 1;
+	pStyle->pBarSurface = _make_bar_surface (pProgressBar);
+	pStyle->pFullBarSurface = _make_full_bar_surface (pProgressBar, pStyle->pBarSurface);
+	pStyle->iBarTexture = cairo_dock_create_texture_from_surface (pStyle->pBarSurface);
+	g_hash_table_insert (s_hBarStyles, pStyle->cKey, pStyle);
+	return pStyle;
+}
+
+static void _release_style (ProgressBarStyle *pStyle)
+{
+	if (pStyle == NULL || -- pStyle->iRefCount > 0)
+		return;
+	g_hash_table_remove (s_hBarStyles, pStyle->cKey);
+	cairo_surface_destroy (pStyle->pBarSurface);
+	cairo_surface_destroy (pStyle->pFullBarSurface);
+	if (pStyle->iBarTexture != 0)
+		_cairo_dock_delete_texture (pStyle->iBarTexture);
+	g_free (pStyle->cKey);
+	g_free (pStyle);
 }
 
 static void load (ProgressBar *pProgressBar, Icon *pIcon, CairoProgressBarAttribute *pAttribute)
@@ -166,7 +266,7 @@ static void load (ProgressBar *pProgressBar, Icon *pIcon, CairoProgressBarAttrib
 		}
 	}
 	
-	_make_bar_surface (pProgressBar);
+	pProgressBar->pStyle = _get_style (pProgressBar);
 	
 	// set the size for the overlay.
 	pRenderer->iHeight = pRenderer->iRank * pProgressBar->iBarThickness + 1;
@@ -179,15 +279,16 @@ static void load (ProgressBar *pProgressBar, Icon *pIcon, CairoProgressBarAttrib
 
 static void render (ProgressBar *pProgressBar, cairo_t *pCairoContext)
 {
-	g_return_if_fail (pProgressBar != NULL);
+	g_return_if_fail (pProgressBar != NULL && pProgressBar->pStyle != NULL);
 	g_return_if_fail (pCairoContext != NULL && cairo_status (pCairoContext) == CAIRO_STATUS_SUCCESS);
 	
 	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pProgressBar);
 	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
 	int iWidth = pRenderer->iWidth, iHeight = pRenderer->iHeight;
+	gboolean bOutline = (myIndicatorsParam.bBarUseDefaultColors || myIndicatorsParam.fBarColorOutline.rgba.alpha != 0.);
 	
 	double r = .5*pProgressBar->iBarThickness;  // radius
-	double x, y, v;
+	double x, y, v, xo, xb;
 	int i;
 	for (i = 0; i < iNbValues; i ++)
 	{
@@ -199,32 +300,27 @@ static void render (ProgressBar *pProgressBar, cairo_t *pCairoContext)
 		{
 			cairo_save (pCairoContext);
 			cairo_translate (pCairoContext, x, y);
-			cairo_set_line_cap (pCairoContext, CAIRO_LINE_CAP_ROUND);
-			r = .5*pProgressBar->iBarThickness;
+			xo = r + (iWidth - 2*r) * v;  // end of the outline
+			xb = r + 1 + (iWidth - 2*r - 2) * v;  // end of the bar
 			
-			// outline
-			if (myIndicatorsParam.bBarUseDefaultColors || myIndicatorsParam.fBarColorOutline.rgba.alpha != 0.)
+			// the round end of the outline; the rest of it is in the full bar.
+			if (bOutline)
 			{
 				if (myIndicatorsParam.bBarUseDefaultColors)
 					gldi_style_colors_set_line_color (pCairoContext);
 				else
 					gldi_color_set_cairo (pCairoContext, &myIndicatorsParam.fBarColorOutline);
-				cairo_set_line_width (pCairoContext, pProgressBar->iBarThickness);
-				
-				cairo_move_to (pCairoContext, r, r);
-				cairo_rel_line_to (pCairoContext, (iWidth -2*r) * v, 0);
-				
-				cairo_stroke (pCairoContext);
+				cairo_arc (pCairoContext, xo, r, r, -G_PI/2, G_PI/2);
+				cairo_fill (pCairoContext);
 			}
 			
-			// bar
-			cairo_set_source_surface (pCairoContext, pProgressBar->pBarSurface, 0, 0);
-			cairo_set_line_width (pCairoContext, pProgressBar->iBarThickness-2);
-			
-			cairo_move_to (pCairoContext, r+1, r);
-			cairo_rel_line_to (pCairoContext, (iWidth -2*r-2) * v, 0);
-			
-			cairo_stroke (pCairoContext);
+			// the full bar, cut at the value with a round end; above .5, the outline ends after the bar (xo > xb), so its top and bottom rows must go up to xo.
+			cairo_rectangle (pCairoContext, 0., 0., MAX (xb, xo), pProgressBar->iBarThickness);
+			cairo_new_sub_path (pCairoContext);
+			cairo_arc (pCairoContext, xb, r, r - 1, 0., 2*G_PI);
+			cairo_clip (pCairoContext);
+			cairo_set_source_surface (pCairoContext, pProgressBar->pStyle->pFullBarSurface, 0., 0.);
+			cairo_paint (pCairoContext);
 			
 			cairo_restore (pCairoContext);
 		}
@@ -241,7 +337,7 @@ static void render (ProgressBar *pProgressBar, cairo_t *pCairoContext)
 
 static void render_opengl (ProgressBar *pProgressBar)
 {
-	g_return_if_fail (pProgressBar != NULL);
+	g_return_if_fail (pProgressBar != NULL && pProgressBar->pStyle != NULL);
 	
 	CairoDataRenderer *pRenderer = CAIRO_DATA_RENDERER (pProgressBar);
 	int iNbValues = cairo_data_renderer_get_nb_values (pRenderer);
@@ -267,7 +363,7 @@ static void render_opengl (ProgressBar *pProgressBar)
 			glColor4f (1., 1., 1., 1.);
 			_cairo_dock_set_blend_source ();  // doesn't really matter here.
 			_cairo_dock_enable_texture ();
-			glBindTexture (GL_TEXTURE_2D, pProgressBar->iBarTexture);
+			glBindTexture (GL_TEXTURE_2D, pProgressBar->pStyle->iBarTexture);
 			
 			GLfloat *pCoords = g_new0 (GLfloat, (pFramePath->iNbPoints+1) * _CD_PATH_DIM);
 			int i;
@@ -338,18 +434,10 @@ static void reload (ProgressBar *pProgressBar)
 		}
 	}
 	
-	// reload the bar surface
-	if (pProgressBar->pBarSurface)
-	{
-		cairo_surface_destroy (pProgressBar->pBarSurface);
-		pProgressBar->pBarSurface = NULL;
-	}
-	if (pProgressBar->iBarTexture != 0)
-	{
-		_cairo_dock_delete_texture (pProgressBar->iBarTexture);
-		pProgressBar->iBarTexture = 0;
-	}
-	_make_bar_surface (pProgressBar);
+	// get the bar images at the new size and colors; they are only made if no other bar already has them.
+	ProgressBarStyle *pStyle = _get_style (pProgressBar);
+	_release_style (pProgressBar->pStyle);
+	pProgressBar->pStyle = pStyle;
 	
 	// set the size for the overlay.
 	pRenderer->iHeight = pRenderer->iRank * pProgressBar->iBarThickness + 1;
@@ -362,10 +450,7 @@ static void reload (ProgressBar *pProgressBar)
 static void unload (ProgressBar *pProgressBar)
 {
 	cd_debug("");
-	if (pProgressBar->pBarSurface)
-		cairo_surface_destroy (pProgressBar->pBarSurface);
-	if (pProgressBar->iBarTexture)
-		_cairo_dock_delete_texture (pProgressBar->iBarTexture);
+	_release_style (pProgressBar->pStyle);
 	g_free (pProgressBar->cImageGradation);
 }
 
@@ -29,6 +29,9 @@
 
 #include <wayland-client.h>
 #include <wayland-client-protocol.h>
+#ifdef HAVE_WAYLAND_PROTOCOLS
+#include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
+#endif
 
 #include "cairo-dock-struct.h"
 #include "cairo-dock-utils.h"
@@ -52,6 +55,14 @@ extern GldiContainer *g_pPrimaryContainer;
 
 // private
 static struct wl_display *s_pDisplay = NULL;
+#ifdef HAVE_WAYLAND_PROTOCOLS
+static struct zwlr_foreign_toplevel_manager_v1 *s_pToplevelManager = NULL;
+static struct wl_seat *s_pSeat = NULL;
+static GldiWindowActor *s_pActiveWindow = NULL;
+static int s_iNumWindow = 1;  // used to order appli icons by age (=creation date).
+static int s_iStackOrder = 0;  // there is no z-order on Wayland, we use the order of activation instead.
+static gboolean s_bTaskbarReady = FALSE;  // FALSE while we get the initial list of windows
+#endif
 
 // signals
 typedef enum {
@@ -63,9 +74,43 @@ typedef struct _GldiWaylandWindowActor GldiWaylandWindowActor;
 struct _GldiWaylandWindowActor {
 	GldiWindowActor actor;
 	// Wayland-specific
-	struct wl_shell_surface *shell_surface;
+	#ifdef HAVE_WAYLAND_PROTOCOLS
+	struct zwlr_foreign_toplevel_handle_v1 *handle;
+	struct zwlr_foreign_toplevel_handle_v1 *parent;
+	#endif
 };
 
+#ifdef HAVE_WAYLAND_PROTOCOLS
+// what has changed since the last 'done' event
+typedef enum {
+	TOPLEVEL_TITLE_CHANGED  = 1<<0,
+	TOPLEVEL_APP_ID_CHANGED = 1<<1,
+	TOPLEVEL_STATE_CHANGED  = 1<<2,
+	TOPLEVEL_PARENT_CHANGED = 1<<3,
+	TOPLEVEL_OUTPUT_CHANGED = 1<<4
+	} GldiToplevelChanges;
+
+// a toplevel, as sent by the compositor; its properties are accumulated until the 'done' event, and then applied at once on the actor.
+typedef struct {
+	struct zwlr_foreign_toplevel_handle_v1 *handle;
+	GldiWaylandWindowActor *wactor;  // NULL until the first 'done' event
+	guint iChanges;  // a mask of GldiToplevelChanges
+	gchar *cTitle;
+	gchar *cAppId;
+	gboolean bMaximized;
+	gboolean bMinimized;
+	gboolean bActivated;
+	gboolean bFullScreen;
+	struct zwlr_foreign_toplevel_handle_v1 *parent;
+	struct wl_output *output;  // the output it was seen on last, NULL if unknown
+	} GldiWaylandToplevel;
+#endif
+
+// an output that we have bound (GDK binds its own proxies of the same outputs).
+typedef struct {
+	int iNumScreen;  // its place in g_desktopGeometry.pScreens, -1 until we get its geometry
+	} GldiWaylandOutput;
+
 struct desktop
 {
 	int iCurrentIndex;
@@ -73,31 +118,37 @@ struct desktop
 };
 static gboolean s_bInitializing = TRUE;  // each time a callback is called on startup, it will set this to TRUE, and we'll make a roundtrip to the server until no callback is called.
 
-static void _output_geometry_cb (G_GNUC_UNUSED void *data, G_GNUC_UNUSED struct wl_output *wl_output,
+static void _output_geometry_cb (void *data, G_GNUC_UNUSED struct wl_output *wl_output,
 	int32_t x, int32_t y,
 	G_GNUC_UNUSED int32_t physical_width, G_GNUC_UNUSED int32_t physical_height,
 	G_GNUC_UNUSED int32_t subpixel, G_GNUC_UNUSED const char *make, G_GNUC_UNUSED const char *model, G_GNUC_UNUSED int32_t output_transform)
 {
 	cd_debug ("Geometry: %d;%d", x, y);
-	g_desktopGeometry.iNbScreens ++;
-	if (!g_desktopGeometry.pScreens)
-		g_desktopGeometry.pScreens = g_new0 (GtkAllocation, 1);
-	else
-		g_desktopGeometry.pScreens = g_realloc (g_desktopGeometry.pScreens, g_desktopGeometry.iNbScreens * sizeof(GtkAllocation));
+	GldiWaylandOutput *pOutput = data;
+	if (pOutput->iNumScreen < 0)  // first time we hear about this output, add a screen (the geometry is sent again when it changes).
+	{
+		g_desktopGeometry.iNbScreens ++;
+		if (!g_desktopGeometry.pScreens)
+			g_desktopGeometry.pScreens = g_new0 (GtkAllocation, 1);
+		else
+			g_desktopGeometry.pScreens = g_realloc (g_desktopGeometry.pScreens, g_desktopGeometry.iNbScreens * sizeof(GtkAllocation));
+		pOutput->iNumScreen = g_desktopGeometry.iNbScreens - 1;
+	}
 	
-	g_desktopGeometry.pScreens[g_desktopGeometry.iNbScreens-1].x = x;
-	g_desktopGeometry.pScreens[g_desktopGeometry.iNbScreens-1].y = y;
+	g_desktopGeometry.pScreens[pOutput->iNumScreen].x = x;
+	g_desktopGeometry.pScreens[pOutput->iNumScreen].y = y;
 	s_bInitializing = TRUE;
 }
 
-static void _output_mode_cb (G_GNUC_UNUSED void *data, G_GNUC_UNUSED struct wl_output *wl_output,
+static void _output_mode_cb (void *data, G_GNUC_UNUSED struct wl_output *wl_output,
 	uint32_t flags, int32_t width, int32_t height, G_GNUC_UNUSED int32_t refresh)
 {
 	cd_debug ("Output mode: %dx%d, %d", width, height, flags);
-	if (flags & WL_OUTPUT_MODE_CURRENT)  // not the current one -> don't bother
+	GldiWaylandOutput *pOutput = data;
+	if ((flags & WL_OUTPUT_MODE_CURRENT) && pOutput->iNumScreen >= 0)  // not the current one -> don't bother
 	{
-		g_desktopGeometry.pScreens[g_desktopGeometry.iNbScreens-1].width = width;
-		g_desktopGeometry.pScreens[g_desktopGeometry.iNbScreens-1].height = height;
+		g_desktopGeometry.pScreens[pOutput->iNumScreen].width = width;
+		g_desktopGeometry.pScreens[pOutput->iNumScreen].height = height;
 		g_desktopGeometry.Xscreen.width = width;
 		g_desktopGeometry.Xscreen.height = height;
 	}
@@ -129,7 +180,371 @@ static const struct wl_output_listener output_listener = {
 	_output_scale_cb
 };
 
-static void _registry_global_cb (G_GNUC_UNUSED void *data, struct wl_registry *registry, uint32_t id, const char *interface, G_GNUC_UNUSED uint32_t version)
+#ifdef HAVE_WAYLAND_PROTOCOLS
+  ///////////////
+ /// TASKBAR ///
+///////////////
+
+static gchar *_get_class_from_app_id (const gchar *cAppId)
+{
+	gchar *cClass;
+	const gchar *str = strrchr (cAppId, '.');
+	if (g_str_has_suffix (cAppId, ".desktop"))  // some applications send the name of their .desktop file
+	{
+		cClass = g_ascii_strdown (cAppId, strlen (cAppId) - 8);
+		str = strrchr (cClass, '.');
+		if (str != NULL)  // reverse-DNS name (org.gnome.Nautilus), keep the last part, as it's the most meaningful one.
+		{
+			gchar *tmp = cClass;
+			cClass = g_strdup (str + 1);
+			g_free (tmp);
+		}
+	}
+	else if (str != NULL)
+		cClass = g_ascii_strdown (str + 1, -1);
+	else
+		cClass = g_ascii_strdown (cAppId, -1);
+	cairo_dock_remove_version_from_string (cClass);
+	return cClass;
+}
+
+// we don't know the position of the windows, only the output they're on: take the area of this output, or the whole desktop if we don't know it.
+static void _set_geometry_from_output (GldiWindowActor *actor, struct wl_output *output)
+{
+	GldiWaylandOutput *pOutput = (output != NULL ? wl_output_get_user_data (output) : NULL);
+	if (pOutput != NULL && pOutput->iNumScreen >= 0)
+	{
+		actor->windowGeometry = g_desktopGeometry.pScreens[pOutput->iNumScreen];
+	}
+	else
+	{
+		actor->windowGeometry.x = 0;
+		actor->windowGeometry.y = 0;
+		actor->windowGeometry.width = gldi_desktop_get_width ();
+		actor->windowGeometry.height = gldi_desktop_get_height ();
+	}
+}
+
+static void _apply_pending_state (GldiWaylandToplevel *toplevel, gboolean *bHiddenChanged, gboolean *bMaximizedChanged, gboolean *bFullScreenChanged, gchar **cOldClass, gchar **cOldWmClass)
+{
+	GldiWaylandWindowActor *wactor = toplevel->wactor;
+	GldiWindowActor *actor = (GldiWindowActor*)wactor;
+	if (toplevel->iChanges & TOPLEVEL_TITLE_CHANGED)
+	{
+		g_free (actor->cName);
+		actor->cName = toplevel->cTitle;
+		toplevel->cTitle = NULL;
+	}
+	if (toplevel->iChanges & TOPLEVEL_APP_ID_CHANGED)
+	{
+		*cOldClass = actor->cClass;
+		*cOldWmClass = actor->cWmClass;
+		actor->cClass = _get_class_from_app_id (toplevel->cAppId);
+		actor->cWmClass = toplevel->cAppId;
+		toplevel->cAppId = NULL;
+	}
+	if (toplevel->iChanges & TOPLEVEL_STATE_CHANGED)
+	{
+		*bHiddenChanged     = (toplevel->bMinimized != actor->bIsHidden);
+		*bMaximizedChanged  = (toplevel->bMaximized != actor->bIsMaximized);
+		*bFullScreenChanged = (toplevel->bFullScreen != actor->bIsFullScreen);
+		actor->bIsHidden     = toplevel->bMinimized;
+		actor->bIsMaximized  = toplevel->bMaximized;
+		actor->bIsFullScreen = toplevel->bFullScreen;
+	}
+	if (toplevel->iChanges & TOPLEVEL_PARENT_CHANGED)
+	{
+		wactor->parent = toplevel->parent;
+		actor->bIsTransientFor = (toplevel->parent != NULL);
+	}
+	if (toplevel->iChanges & TOPLEVEL_OUTPUT_CHANGED)
+		_set_geometry_from_output (actor, toplevel->output);
+	toplevel->iChanges = 0;
+}
+
+static void _set_active_window (GldiWindowActor *actor)
+{
+	if (actor == s_pActiveWindow)
+		return;
+	s_pActiveWindow = actor;
+	if (actor != NULL)
+	{
+		actor->iStackOrder = s_iStackOrder ++;
+		gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_Z_ORDER_CHANGED, NULL);
+	}
+	gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_ACTIVATED, actor);
+}
+
+static void _toplevel_title_cb (void *data, G_GNUC_UNUSED struct zwlr_foreign_toplevel_handle_v1 *handle, const char *title)
+{
+	GldiWaylandToplevel *toplevel = data;
+	g_free (toplevel->cTitle);
+	toplevel->cTitle = g_strdup (title);
+	toplevel->iChanges |= TOPLEVEL_TITLE_CHANGED;
+}
+
+static void _toplevel_app_id_cb (void *data, G_GNUC_UNUSED struct zwlr_foreign_toplevel_handle_v1 *handle, const char *app_id)
+{
+	GldiWaylandToplevel *toplevel = data;
+	g_free (toplevel->cAppId);
+	toplevel->cAppId = g_strdup (app_id);
+	toplevel->iChanges |= TOPLEVEL_APP_ID_CHANGED;
+}
+
+static inline gboolean _is_our_output (struct wl_output *output)
+{
+	return (output != NULL && wl_proxy_get_listener ((struct wl_proxy*)output) == (const void*)&output_listener);  // the compositor also sends the event for the proxy of GDK, ignore it.
+}
+
+static void _toplevel_output_enter_cb (void *data, G_GNUC_UNUSED struct zwlr_foreign_toplevel_handle_v1 *handle, struct wl_output *output)
+{
+	if (! _is_our_output (output))
+		return;
+	GldiWaylandToplevel *toplevel = data;
+	toplevel->output = output;  // if the window spans several outputs, the last one entered wins.
+	toplevel->iChanges |= TOPLEVEL_OUTPUT_CHANGED;
+}
+
+static void _toplevel_output_leave_cb (void *data, G_GNUC_UNUSED struct zwlr_foreign_toplevel_handle_v1 *handle, struct wl_output *output)
+{
+	GldiWaylandToplevel *toplevel = data;
+	if (! _is_our_output (output) || toplevel->output != output)
+		return;
+	toplevel->output = NULL;
+	toplevel->iChanges |= TOPLEVEL_OUTPUT_CHANGED;
+}
+
+static void _toplevel_state_cb (void *data, G_GNUC_UNUSED struct zwlr_foreign_toplevel_handle_v1 *handle, struct wl_array *state)
+{
+	GldiWaylandToplevel *toplevel = data;
+	toplevel->bMaximized = toplevel->bMinimized = toplevel->bActivated = toplevel->bFullScreen = FALSE;
+	uint32_t *s;
+	wl_array_for_each (s, state)
+	{
+		switch (*s)
+		{
+			case ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MAXIMIZED:
+				toplevel->bMaximized = TRUE;
+			break;
+			case ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MINIMIZED:
+				toplevel->bMinimized = TRUE;
+			break;
+			case ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED:
+				toplevel->bActivated = TRUE;
+			break;
+			case ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_FULLSCREEN:
+				toplevel->bFullScreen = TRUE;
+			break;
+			default:
+			break;
+		}
+	}
+	toplevel->iChanges |= TOPLEVEL_STATE_CHANGED;
+}
+
+static void _toplevel_done_cb (void *data, G_GNUC_UNUSED struct zwlr_foreign_toplevel_handle_v1 *handle)
+{
+	GldiWaylandToplevel *toplevel = data;
+	if (toplevel->iChanges == 0)  // nothing new
+		return;
+	
+	if (toplevel->wactor == NULL)  // first time we get a complete state: make a new actor
+	{
+		if (toplevel->cAppId == NULL)  // we need a class, wait until we get one
+		{
+			cd_debug ("this toplevel (%s) doesn't have any app-id yet", toplevel->cTitle);
+			return;
+		}
+		toplevel->wactor = (GldiWaylandWindowActor*)gldi_object_new (&myWaylandObjectMgr, toplevel);  // consumes the pending properties
+		GldiWindowActor *actor = (GldiWindowActor*)toplevel->wactor;
+		if (! s_bTaskbarReady)  // initial windows are not notified, they will be listed with gldi_windows_foreach(), like on X.
+		{
+			if (toplevel->bActivated)
+				s_pActiveWindow = actor;
+			return;
+		}
+		
+		// notify everybody
+		gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_CREATED, actor);
+		if (toplevel->bActivated)
+			_set_active_window (actor);
+		return;
+	}
+	
+	// apply all the changes at once, so that the actor is never seen in an intermediate state
+	GldiWindowActor *actor = (GldiWindowActor*)toplevel->wactor;
+	guint iChanges = toplevel->iChanges;
+	gboolean bHiddenChanged = FALSE, bMaximizedChanged = FALSE, bFullScreenChanged = FALSE;
+	gchar *cOldClass = NULL, *cOldWmClass = NULL;
+	_apply_pending_state (toplevel, &bHiddenChanged, &bMaximizedChanged, &bFullScreenChanged, &cOldClass, &cOldWmClass);
+	
+	// then notify everybody, once per kind of change
+	if (iChanges & TOPLEVEL_TITLE_CHANGED)
+		gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_NAME_CHANGED, actor);
+	if (iChanges & TOPLEVEL_OUTPUT_CHANGED)
+		gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_SIZE_POSITION_CHANGED, actor);
+	if ((iChanges & TOPLEVEL_APP_ID_CHANGED) && g_strcmp0 (cOldClass, actor->cClass) != 0)
+		gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_CLASS_CHANGED, actor, cOldClass, cOldWmClass);
+	if (bHiddenChanged || bMaximizedChanged || bFullScreenChanged)
+		gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_STATE_CHANGED, actor, bHiddenChanged, bMaximizedChanged, bFullScreenChanged);
+	if (iChanges & TOPLEVEL_STATE_CHANGED)
+	{
+		if (toplevel->bActivated)
+			_set_active_window (actor);
+		else if (s_pActiveWindow == actor)
+			_set_active_window (NULL);
+	}
+	g_free (cOldClass);
+	g_free (cOldWmClass);
+}
+
+static void _forget_parent (GldiWindowActor *actor, struct zwlr_foreign_toplevel_handle_v1 *parent)
+{
+	GldiWaylandWindowActor *wactor = (GldiWaylandWindowActor*)actor;
+	if (wactor->parent == parent)
+	{
+		wactor->parent = NULL;
+		actor->bIsTransientFor = FALSE;
+	}
+}
+
+static void _toplevel_closed_cb (void *data, struct zwlr_foreign_toplevel_handle_v1 *handle)
+{
+	GldiWaylandToplevel *toplevel = data;
+	if (toplevel->wactor != NULL)
+	{
+		GldiWindowActor *actor = (GldiWindowActor*)toplevel->wactor;
+		if (s_pActiveWindow == actor)
+			s_pActiveWindow = NULL;
+		gldi_windows_foreach (FALSE, (GFunc)_forget_parent, handle);  // the handle is about to be destroyed
+		
+		// notify everybody
+		gldi_object_notify (&myWindowObjectMgr, NOTIFICATION_WINDOW_DESTROYED, actor);
+		gldi_object_unref (GLDI_OBJECT(actor));
+	}
+	zwlr_foreign_toplevel_handle_v1_destroy (handle);
+	g_free (toplevel->cTitle);
+	g_free (toplevel->cAppId);
+	g_free (toplevel);
+}
+
+static void _toplevel_parent_cb (void *data, G_GNUC_UNUSED struct zwlr_foreign_toplevel_handle_v1 *handle, struct zwlr_foreign_toplevel_handle_v1 *parent)
+{
+	GldiWaylandToplevel *toplevel = data;
+	toplevel->parent = parent;
+	toplevel->iChanges |= TOPLEVEL_PARENT_CHANGED;
+}
+
+static const struct zwlr_foreign_toplevel_handle_v1_listener toplevel_handle_listener = {
+	_toplevel_title_cb,
+	_toplevel_app_id_cb,
+	_toplevel_output_enter_cb,
+	_toplevel_output_leave_cb,
+	_toplevel_state_cb,
+	_toplevel_done_cb,
+	_toplevel_closed_cb,
+	_toplevel_parent_cb
+};
+
+static void _toplevel_manager_toplevel_cb (G_GNUC_UNUSED void *data, G_GNUC_UNUSED struct zwlr_foreign_toplevel_manager_v1 *manager, struct zwlr_foreign_toplevel_handle_v1 *handle)
+{
+	cd_debug ("new toplevel");
+	GldiWaylandToplevel *toplevel = g_new0 (GldiWaylandToplevel, 1);
+	toplevel->handle = handle;
+	zwlr_foreign_toplevel_handle_v1_add_listener (handle,
+		&toplevel_handle_listener,
+		toplevel);
+	s_bInitializing = TRUE;
+}
+
+static void _toplevel_manager_finished_cb (G_GNUC_UNUSED void *data, struct zwlr_foreign_toplevel_manager_v1 *manager)
+{
+	cd_debug ("the compositor won't send us toplevels any more");
+	zwlr_foreign_toplevel_manager_v1_destroy (manager);
+	s_pToplevelManager = NULL;
+}
+
+static const struct zwlr_foreign_toplevel_manager_v1_listener toplevel_manager_listener = {
+	_toplevel_manager_toplevel_cb,
+	_toplevel_manager_finished_cb
+};
+
+static GldiWindowActor* _get_active_window (void)
+{
+	return s_pActiveWindow;
+}
+
+static void _show (GldiWindowActor *actor)
+{
+	GldiWaylandWindowActor *wactor = (GldiWaylandWindowActor *)actor;
+	if (actor->bIsHidden)
+		zwlr_foreign_toplevel_handle_v1_unset_minimized (wactor->handle);
+	if (s_pSeat != NULL)
+		zwlr_foreign_toplevel_handle_v1_activate (wactor->handle, s_pSeat);
+}
+
+static void _close (GldiWindowActor *actor)
+{
+	GldiWaylandWindowActor *wactor = (GldiWaylandWindowActor *)actor;
+	zwlr_foreign_toplevel_handle_v1_close (wactor->handle);
+}
+
+static void _minimize (GldiWindowActor *actor)
+{
+	GldiWaylandWindowActor *wactor = (GldiWaylandWindowActor *)actor;
+	zwlr_foreign_toplevel_handle_v1_set_minimized (wactor->handle);
+}
+
+static void _maximize (GldiWindowActor *actor, gboolean bMaximize)
+{
+	GldiWaylandWindowActor *wactor = (GldiWaylandWindowActor *)actor;
+	if (bMaximize)
+		zwlr_foreign_toplevel_handle_v1_set_maximized (wactor->handle);
+	else
+		zwlr_foreign_toplevel_handle_v1_unset_maximized (wactor->handle);
+}
+
+static void _set_fullscreen (GldiWindowActor *actor, gboolean bFullScreen)
+{
+	GldiWaylandWindowActor *wactor = (GldiWaylandWindowActor *)actor;
+	if (zwlr_foreign_toplevel_handle_v1_get_version (wactor->handle) < ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_SET_FULLSCREEN_SINCE_VERSION)
+		return;
+	if (bFullScreen)
+		zwlr_foreign_toplevel_handle_v1_set_fullscreen (wactor->handle, NULL);
+	else
+		zwlr_foreign_toplevel_handle_v1_unset_fullscreen (wactor->handle);
+}
+
+static cairo_surface_t* _get_icon_surface (GldiWindowActor *actor, int iWidth, int iHeight)
+{
+	return cairo_dock_create_surface_from_class (actor->cClass, iWidth, iHeight);  // there is no such thing as a window icon on Wayland.
+}
+
+static GldiWindowActor *_get_transient_for (GldiWindowActor *actor)
+{
+	GldiWaylandWindowActor *wactor = (GldiWaylandWindowActor *)actor;
+	if (wactor->parent == NULL)
+		return NULL;
+	GldiWaylandToplevel *parent = zwlr_foreign_toplevel_handle_v1_get_user_data (wactor->parent);
+	return (parent ? (GldiWindowActor*)parent->wactor : NULL);
+}
+
+static void _can_minimize_maximize_close (G_GNUC_UNUSED GldiWindowActor *actor, gboolean *bCanMinimize, gboolean *bCanMaximize, gboolean *bCanClose)
+{
+	// the protocol doesn't tell, assume everything is possible
+	*bCanMinimize = TRUE;
+	*bCanMaximize = TRUE;
+	*bCanClose = TRUE;
+}
+
+static guint _get_id (GldiWindowActor *actor)
+{
+	GldiWaylandWindowActor *wactor = (GldiWaylandWindowActor *)actor;
+	return wl_proxy_get_id ((struct wl_proxy*)wactor->handle);
+}
+#endif
+
+static void _registry_global_cb (G_GNUC_UNUSED void *data, struct wl_registry *registry, uint32_t id, const char *interface, G_GNUC_UNUSED uint32_t version)  // version is used only with the protocols
 {
 	cd_debug ("got a new global object, instance of %s, id=%d", interface, id);
 	if (!strcmp (interface, "wl_shell"))
@@ -143,10 +558,31 @@ static void _registry_global_cb (G_GNUC_UNUSED void *data, struct wl_registry *r
 			id,
 			&wl_output_interface,
 			1);
+		GldiWaylandOutput *pOutput = g_new0 (GldiWaylandOutput, 1);  // lives as long as the output, which we never release.
+		pOutput->iNumScreen = -1;
 		wl_output_add_listener (output,
 			&output_listener,
+			pOutput);
+	}
+	#ifdef HAVE_WAYLAND_PROTOCOLS
+	else if (!strcmp (interface, zwlr_foreign_toplevel_manager_v1_interface.name))  // the compositor can tell us about the windows
+	{
+		s_pToplevelManager = wl_registry_bind (registry,
+			id,
+			&zwlr_foreign_toplevel_manager_v1_interface,
+			MIN (version, 3));
+		zwlr_foreign_toplevel_manager_v1_add_listener (s_pToplevelManager,
+			&toplevel_manager_listener,
 			NULL);
 	}
+	else if (!strcmp (interface, "wl_seat") && s_pSeat == NULL)  // needed to activate a window
+	{
+		s_pSeat = wl_registry_bind (registry,
+			id,
+			&wl_seat_interface,
+			1);
+	}
+	#endif
 	s_bInitializing = TRUE;
 }
 
@@ -168,7 +604,11 @@ static const struct wl_registry_listener registry_listener = {
 static void init (void)
 {
 	//\__________________ listen for Wayland events
+	#ifdef GDK_WINDOWING_WAYLAND
+	s_pDisplay = gdk_wayland_display_get_wl_display (gdk_display_get_default ());  // share the connection of GDK: its event source will dispatch our events too, and our objects can be used with its surfaces.
+	#else
 	s_pDisplay = wl_display_connect (NULL);
+	#endif
 	
 	g_desktopGeometry.iNbDesktops = g_desktopGeometry.iNbViewportX = g_desktopGeometry.iNbViewportY = 1;
 	
@@ -181,10 +621,61 @@ static void init (void)
 		wl_display_roundtrip (s_pDisplay);
 	}
 	while (s_bInitializing);
+	#ifdef HAVE_WAYLAND_PROTOCOLS
+	s_bTaskbarReady = TRUE;
+	#endif
+	
+	//\__________________ Register backends
+	#ifdef HAVE_WAYLAND_PROTOCOLS
+	if (s_pToplevelManager != NULL)
+	{
+		GldiWindowManagerBackend wmb;
+		memset (&wmb, 0, sizeof (GldiWindowManagerBackend));
+		wmb.get_active_window = _get_active_window;
+		wmb.show = _show;
+		wmb.close = _close;
+		wmb.minimize = _minimize;
+		wmb.maximize = _maximize;
+		wmb.set_fullscreen = _set_fullscreen;
+		wmb.get_icon_surface = _get_icon_surface;
+		wmb.get_transient_for = _get_transient_for;
+		wmb.can_minimize_maximize_close = _can_minimize_maximize_close;
+		wmb.get_id = _get_id;
+		gldi_windows_manager_register_backend (&wmb);
+	}
+	else
+		cd_message ("The compositor doesn't support wlr-foreign-toplevel-management, the taskbar won't be available");
+	#endif
 	
 	gldi_register_egl_backend ();
 }
 
+  ///////////////
+ /// MANAGER ///
+///////////////
+
+#ifdef HAVE_WAYLAND_PROTOCOLS
+static void init_object (GldiObject *obj, gpointer attr)
+{
+	GldiWaylandWindowActor *wactor = (GldiWaylandWindowActor*)obj;
+	GldiWindowActor *actor = (GldiWindowActor*)wactor;
+	GldiWaylandToplevel *toplevel = (GldiWaylandToplevel*)attr;
+	
+	wactor->handle = toplevel->handle;
+	toplevel->wactor = wactor;
+	
+	actor->bDisplayed = TRUE;
+	actor->iNumDesktop = -1;  // no desktops on Wayland; the window is on its output, or everywhere until we know it.
+	_set_geometry_from_output (actor, NULL);
+	
+	gboolean bHiddenChanged, bMaximizedChanged, bFullScreenChanged;
+	gchar *cOldClass = NULL, *cOldWmClass = NULL;
+	_apply_pending_state (toplevel, &bHiddenChanged, &bMaximizedChanged, &bFullScreenChanged, &cOldClass, &cOldWmClass);  // nothing old yet
+	actor->iAge = s_iNumWindow ++;
+	actor->iStackOrder = s_iStackOrder ++;
+}
+#endif
+
 void gldi_register_wayland_manager (void)
 {
 	#ifdef GDK_WINDOWING_WAYLAND  // if GTK doesn't support Wayland, there is no point in trying
@@ -219,8 +710,9 @@ void gldi_register_wayland_manager (void)
 	myWaylandObjectMgr.cName   = "Wayland";
 	myWaylandObjectMgr.iObjectSize    = sizeof (GldiWaylandWindowActor);
 	// interface
-	///myWaylandObjectMgr.init_object    = init_object;
-	///myWaylandObjectMgr.reset_object   = reset_object;
+	#ifdef HAVE_WAYLAND_PROTOCOLS
+	myWaylandObjectMgr.init_object    = init_object;
+	#endif
 	// signals
 	gldi_object_install_notifications (&myWaylandObjectMgr, NB_NOTIFICATIONS_WAYLAND_MANAGER);
 	// parent object
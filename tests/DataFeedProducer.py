@@ -0,0 +1,69 @@
+#!/usr/bin/env python
+#
+# A producer for a data feed (see src/gldit/cairo-dock-data-feed.h), to test a data-renderer fed with a high rate of samples.
+# It creates the feed and writes samples into it until it's interrupted; the feed must then be set on the data-renderer of an icon with 'cairo_dock_set_data_feed_on_icon' (or 'CD_APPLET_SET_DATA_FEED_ON_MY_ICON' in an applet).
+#
+# Usage: ./DataFeedProducer.py [name] [number of values] [samples per second] [number of samples in the ring] [number of samples to write]
+# Each value is a sine wave with a different phase, so that the graphs can be checked visually.
+# If a number of samples to write is given, it stops after them, and the value i of the sample n is n * (number of values) + i, so that a reader can check what it gets (see tests/benchmarks/test-data-feed.c).
+
+import sys  # argv
+import os  # open, ftruncate
+import mmap
+import struct
+from math import sin, pi
+from time import sleep, time
+
+MAGIC = 0x46444443  # "CDDF"
+VERSION = 1
+HEADER = struct.Struct('=IIIIQ')  # magic, version, nb values, nb samples, write count
+
+class DataFeedProducer:
+	def __init__(self, name, nb_values, nb_samples):
+		self.nb_values = nb_values
+		self.nb_samples = nb_samples
+		self.sample = struct.Struct('=%df' % nb_values)
+		self.path = '/dev/shm/cairo-dock-feed-'+name  # where shm_open puts the objects on Linux
+		size = HEADER.size + nb_samples * self.sample.size
+		tmp_path = self.path + '.tmp'
+		fd = os.open (tmp_path, os.O_RDWR | os.O_CREAT | os.O_TRUNC, 0o600)
+		os.ftruncate (fd, size)
+		self.map = mmap.mmap (fd, size)
+		os.close (fd)
+		self.count = 0
+		HEADER.pack_into (self.map, 0, MAGIC, VERSION, nb_values, nb_samples, self.count)
+		os.rename (tmp_path, self.path)  # the feed appears once its header is written.
+
+	def write(self, values):
+		# write the sample first, then publish it by incrementing the counter.
+		self.sample.pack_into (self.map, HEADER.size + (self.count % self.nb_samples) * self.sample.size, *values)
+		self.count += 1
+		struct.pack_into ('=Q', self.map, HEADER.size - 8, self.count)
+
+	def close(self):
+		self.map.close()
+		os.unlink (self.path)
+
+
+if __name__ == '__main__':
+	name = sys.argv[1] if len(sys.argv) > 1 else 'test'
+	nb_values = int(sys.argv[2]) if len(sys.argv) > 2 else 2
+	rate = float(sys.argv[3]) if len(sys.argv) > 3 else 100.
+	nb_samples = int(sys.argv[4]) if len(sys.argv) > 4 else 256
+	nb_to_write = int(sys.argv[5]) if len(sys.argv) > 5 else 0
+
+	producer = DataFeedProducer (name, nb_values, nb_samples)
+	print ("writing %g samples/s of %d values into the feed '%s'" % (rate, nb_values, name))
+	t0 = time()
+	try:
+		while nb_to_write == 0 or producer.count < nb_to_write:
+			if nb_to_write == 0:
+				t = time() - t0
+				producer.write ([.5 + .5 * sin (2*pi*(t/2. + i/float(nb_values))) for i in range(nb_values)])
+			else:
+				producer.write ([producer.count * nb_values + i for i in range(nb_values)])
+			sleep (1./rate)
+	except KeyboardInterrupt:
+		pass
+	producer.close()
+	print ("%d samples written" % producer.count)
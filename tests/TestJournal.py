@@ -0,0 +1,73 @@
+from time import sleep
+import os
+from Test import Test
+from CairoDock import CairoDock
+
+def get_param(conf_file, group, key):
+	value = None
+	current_group = None
+	f = open(conf_file)
+	for line in f:
+		line = line.strip()
+		if line.startswith('['):
+			current_group = line[1:-1]
+		elif current_group == group and '=' in line and line.split('=',1)[0].strip() == key:
+			value = line.split('=',1)[1].strip()
+	f.close()
+	return value
+
+# test the journal of the conf files: the updates that were not written when the dock stopped are written at the next startup
+# Note: it restarts the dock, so it must be the last test.
+class TestJournal(Test):
+	def __init__(self, dock):
+		self.dt = 5  # time to restart the dock
+		Test.__init__(self, "Test journal", dock)
+
+	def restart_dock(self):
+		os.system ('cairo-dock -T -d "%s" &' % self.data_dir)
+		sleep(self.dt)
+		self.dock = CairoDock()
+		self.d = self.dock.iface
+
+	def run(self):
+
+		# get a launcher and the paths of the current theme
+		props = self.d.GetProperties('type=Launcher')
+		launcher_file = props[0]['config-file']
+		self.data_dir = os.path.dirname(os.path.dirname(self.get_conf_file()))  # <data dir>/current_theme/cairo-dock.conf
+		journal = self.data_dir + '/.conf-journal'
+		new_file = self.data_dir + '/test-journal.conf'  # a file that was being created
+		deleted_file = self.data_dir + '/test-journal-deleted.conf'  # a file that was deleted in the meantime
+
+		# stop the dock as if it had been killed before writing its conf files, and leave the journal of its updates
+		os.system ('killall -9 cairo-dock')
+		sleep(1)
+		f = open(journal, 'w')
+		f.write(launcher_file+'\t1\tDesktop Entry\tOrder\t123.5\n')
+		f.write(new_file+'\t0\tIcon\tdock name\t_MainDock_\n')
+		f.write(deleted_file+'\t1\tIcon\torder\t3\n')
+		f.write(launcher_file+'\t1\tDesktop Entry\tOrder\t456')  # torn last line: the dock stopped while writing it
+		f.close()
+
+		# restart it, the updates must be replayed, except the torn one
+		self.restart_dock()
+
+		if os.path.exists(journal):
+			self.print_error ('The journal has not been removed')
+
+		order = get_param(launcher_file, 'Desktop Entry', 'Order')
+		if order != '123.5':
+			self.print_error ('The order of the launcher has not been recovered (should be 123.5 but is %s)' % order)
+
+		if not os.path.exists(new_file):
+			self.print_error ('The new conf file has not been created')
+		elif get_param(new_file, 'Icon', 'dock name') != '_MainDock_':
+			self.print_error ('The new conf file has not been updated')
+
+		if os.path.exists(deleted_file):
+			self.print_error ('The deleted conf file has been created again')
+
+		if os.path.exists(new_file):
+			os.remove(new_file)
+
+		self.end()
@@ -0,0 +1,92 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Measures the time to read the config of all the managers from the main conf file, as it's done when the theme is loaded:
+//  - with the given conf file, where all the keys are present;
+//  - with an empty conf file, where each key is missing and is looked for at its other places before taking its default value (old conf files).
+// The parsing of the file is not counted.
+// Usage: bench-config [-n <nb iterations>] <cairo-dock.conf>   (for instance the one generated in <build dir>/data)
+
+#include <stdlib.h>
+
+#include "cairo-dock-manager.h"
+#include "cairo-dock-log.h"
+#include "bench-utils.h"
+
+static int s_iNbIterations = 200;
+
+// time of 1 read in us.
+static double _bench_get_config (const gchar *cContent)
+{
+	gint64 t = 0, t0;
+	int i;
+	for (i = 0; i < s_iNbIterations; i ++)
+	{
+		GKeyFile *pKeyFile = g_key_file_new ();
+		g_key_file_load_from_data (pKeyFile, cContent, -1, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, NULL);
+		t0 = bench_time ();
+		gldi_managers_get_config_from_key_file (pKeyFile);
+		t += bench_time () - t0;
+		g_key_file_free (pKeyFile);
+	}
+	return (double)t / s_iNbIterations;
+}
+
+int main (int argc, char *argv[])
+{
+	GOptionEntry pOptionsTable[] =
+	{
+		{"nb-iterations", 'n', G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_INT,
+			&s_iNbIterations,
+			"number of times the config is read for each measure", "N"},
+		{NULL, 0, 0, 0,
+			NULL,
+			NULL,
+			NULL}
+	};
+	GError *erreur = NULL;
+	if (! gtk_init_with_args (&argc, &argv, "<cairo-dock.conf>", pOptionsTable, NULL, &erreur))
+	{
+		g_printerr ("%s\n", erreur ? erreur->message : "couldn't open the display");
+		return 1;
+	}
+	if (argc < 2)
+	{
+		g_printerr ("usage: %s [-n N] <cairo-dock.conf>\n", argv[0]);
+		return 1;
+	}
+	s_iNbIterations = MAX (1, s_iNbIterations);
+
+	gchar *cContent = NULL;
+	if (! g_file_get_contents (argv[1], &cContent, NULL, &erreur))
+	{
+		g_printerr ("%s\n", erreur->message);
+		return 1;
+	}
+
+	gldi_init (GLDI_CAIRO);
+	cd_log_set_level (G_LOG_LEVEL_CRITICAL);  // a warning is displayed for each missing key.
+
+	g_print ("# time to read the config of all the managers (us), %d reads per measure\n", s_iNbIterations);
+	g_print ("%-24s %10.1f\n", "all keys present", _bench_get_config (cContent));
+	g_print ("%-24s %10.1f\n", "all keys missing", _bench_get_config (""));
+
+	g_free (cContent);
+	return 0;
+}
@@ -0,0 +1,195 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Measures the time to draw one update of a graph, for each type of graph and several sizes:
+//  - cairo: drawn with cairo on an image surface (the cairo backend);
+//  - cairo+upload: the same, then loaded into a texture (how graphs were drawn with OpenGL before they had their own OpenGL rendering);
+//  - opengl: drawn directly with OpenGL (the current OpenGL backend).
+// Then, for the graphs that keep their history on a surface (line, plain and bar), it compares the cairo rendering when the history
+// is scrolled (1 new value between 2 renders) to the rendering when it has to be redrawn entirely (here, 2 new values between 2 renders).
+// Usage: bench-graph [-n <nb updates>] [-c]   (-c to only measure cairo, for instance with no OpenGL available)
+
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <GL/gl.h>
+
+#include "cairo-dock-graph.h"
+#include "bench-utils.h"
+
+static int s_iNbUpdates = 500;
+static gboolean s_bCairoOnly = FALSE;
+
+static const gchar *s_cTypeNames[] = {"line", "plain", "bar", "circle", "circle-plain"};
+static const int s_iSizes[] = {32, 64, 128, 256, 512};
+
+static CairoDataRenderer *_new_graph (CairoDockTypeGraph iType, int iSize)
+{
+	static gdouble fHighColor[6] = {1., 0., 0., 0., 1., 0.};
+	static gdouble fLowColor[6] = {0., 0., 1., 1., 1., 0.};
+	CairoGraphAttribute attr;
+	memset (&attr, 0, sizeof (CairoGraphAttribute));
+	attr.rendererAttribute.cModelName = "graph";
+	attr.rendererAttribute.iNbValues = 2;
+	attr.rendererAttribute.iMemorySize = iSize;
+	attr.iType = iType;
+	attr.fHighColor = fHighColor;
+	attr.fLowColor = fLowColor;
+	attr.fBackGroundColor[3] = .5;
+	return bench_new_data_renderer (CAIRO_DATA_RENDERER_ATTRIBUTE (&attr), iSize, iSize);
+}
+
+static void _push_next_values (CairoDataRenderer *pRenderer, int i)
+{
+	double fValues[2] = {.5 + .5 * sin (i * .1), (i % 17) / 17.};
+	bench_push_values (pRenderer, fValues);
+}
+
+// time of 1 update in us, for the given way to draw it.
+static double _bench_cairo (CairoDockTypeGraph iType, int iSize, gboolean bUpload, int iNbValuesPerUpdate)
+{
+	CairoDataRenderer *pRenderer = _new_graph (iType, iSize);
+	cairo_surface_t *pSurface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, iSize, iSize);
+	GLuint iTexture = 0;
+	if (bUpload)
+		glGenTextures (1, &iTexture);
+
+	gint64 t0 = bench_time ();
+	int i, j;
+	for (i = 0; i < s_iNbUpdates; i ++)
+	{
+		for (j = 0; j < iNbValuesPerUpdate; j ++)
+			_push_next_values (pRenderer, i * iNbValuesPerUpdate + j);
+		cairo_t *pCairoContext = cairo_create (pSurface);
+		cairo_set_operator (pCairoContext, CAIRO_OPERATOR_CLEAR);
+		cairo_paint (pCairoContext);
+		cairo_set_operator (pCairoContext, CAIRO_OPERATOR_OVER);
+		pRenderer->interface.render (pRenderer, pCairoContext);
+		cairo_destroy (pCairoContext);
+		if (bUpload)  // as cairo_dock_update_icon_texture
+		{
+			cairo_surface_flush (pSurface);
+			glBindTexture (GL_TEXTURE_2D, iTexture);
+			glTexImage2D (GL_TEXTURE_2D, 0, 4, iSize, iSize, 0, GL_BGRA, GL_UNSIGNED_BYTE, cairo_image_surface_get_data (pSurface));
+		}
+	}
+	if (bUpload)
+		glFinish ();
+	gint64 t1 = bench_time ();
+
+	if (iTexture != 0)
+		glDeleteTextures (1, &iTexture);
+	cairo_surface_destroy (pSurface);
+	bench_free_data_renderer (pRenderer);
+	return (double)(t1 - t0) / s_iNbUpdates;
+}
+
+static double _bench_opengl (CairoDockTypeGraph iType, int iSize)
+{
+	CairoDataRenderer *pRenderer = _new_graph (iType, iSize);
+
+	gint64 t0 = bench_time ();
+	int i;
+	for (i = 0; i < s_iNbUpdates; i ++)
+	{
+		_push_next_values (pRenderer, i);
+		glClear (GL_COLOR_BUFFER_BIT);
+		glPushMatrix ();
+		glTranslatef (iSize/2, iSize/2, 0.);
+		pRenderer->interface.render_opengl (pRenderer);
+		glPopMatrix ();
+	}
+	glFinish ();
+	gint64 t1 = bench_time ();
+
+	bench_free_data_renderer (pRenderer);
+	return (double)(t1 - t0) / s_iNbUpdates;
+}
+
+int main (int argc, char *argv[])
+{
+	GOptionEntry pOptionsTable[] =
+	{
+		{"nb-updates", 'n', G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_INT,
+			&s_iNbUpdates,
+			"number of updates to draw for each measure", "N"},
+		{"cairo", 'c', G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_NONE,
+			&s_bCairoOnly,
+			"only measure the cairo rendering", NULL},
+		{NULL, 0, 0, 0,
+			NULL,
+			NULL,
+			NULL}
+	};
+	GError *erreur = NULL;
+	if (! gtk_init_with_args (&argc, &argv, NULL, pOptionsTable, NULL, &erreur))
+	{
+		g_printerr ("%s\n", erreur ? erreur->message : "couldn't open the display");
+		return 1;
+	}
+	s_iNbUpdates = MAX (1, s_iNbUpdates);
+
+	gldi_init (s_bCairoOnly ? GLDI_CAIRO : GLDI_OPENGL);
+	GldiContainer *pContainer = NULL;
+	if (! s_bCairoOnly)
+	{
+		int iMaxSize = s_iSizes[G_N_ELEMENTS (s_iSizes) - 1];
+		pContainer = bench_new_gl_container (iMaxSize, iMaxSize);
+		if (pContainer == NULL)
+		{
+			g_printerr ("OpenGL is not available, only cairo will be measured\n");
+			s_bCairoOnly = TRUE;
+		}
+	}
+
+	g_print ("# time of 1 update (us), %d updates per measure\n", s_iNbUpdates);
+	g_print ("%-13s %5s %10s %14s %10s\n", "type", "size", "cairo", "cairo+upload", "opengl");
+	guint t, s;
+	for (t = 0; t < G_N_ELEMENTS (s_cTypeNames); t ++)
+	{
+		for (s = 0; s < G_N_ELEMENTS (s_iSizes); s ++)
+		{
+			int iSize = s_iSizes[s];
+			g_print ("%-13s %5d %10.1f", s_cTypeNames[t], iSize, _bench_cairo (t, iSize, FALSE, 1));
+			if (s_bCairoOnly)
+				g_print (" %14s %10s\n", "-", "-");
+			else
+			{
+				double fUpload = _bench_cairo (t, iSize, TRUE, 1);
+				g_print (" %14.1f %10.1f\n", fUpload, _bench_opengl (t, iSize));
+			}
+		}
+	}
+
+	g_print ("\n# cairo, time of 1 update (us) when the history is scrolled or redrawn\n");
+	g_print ("%-13s %5s %10s %12s\n", "type", "width", "scroll", "full redraw");
+	for (t = CAIRO_DOCK_GRAPH_LINE; t <= CAIRO_DOCK_GRAPH_BAR; t ++)
+	{
+		for (s = 0; s < G_N_ELEMENTS (s_iSizes); s ++)
+		{
+			int iSize = s_iSizes[s];
+			double fScroll = _bench_cairo (t, iSize, FALSE, 1);
+			g_print ("%-13s %5d %10.1f %12.1f\n", s_cTypeNames[t], iSize, fScroll, _bench_cairo (t, iSize, FALSE, 2));
+		}
+	}
+
+	if (pContainer != NULL)
+		gldi_object_unref (GLDI_OBJECT (pContainer));
+	return 0;
+}
@@ -0,0 +1,112 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __BENCH_UTILS__
+#define  __BENCH_UTILS__
+
+// Helpers shared by the benchmarks and tests of this folder.
+// They need a display, since gldi is initialized the same way as the dock does (use 'xvfb-run' if there is none).
+
+#include <gtk/gtk.h>
+
+#include "cairo-dock-struct.h"
+#include "cairo-dock-core.h"  // gldi_init
+#include "cairo-dock-data-renderer.h"
+#include "cairo-dock-data-renderer-manager.h"  // cairo_dock_new_data_renderer
+#include "cairo-dock-container.h"
+#include "cairo-dock-opengl.h"
+
+extern gboolean g_bUseOpenGL;
+
+#define bench_time() g_get_monotonic_time ()  // us
+
+// create a data-renderer and load it at the given size, as cairo_dock_add_new_data_renderer_on_icon does, but without any icon.
+static inline CairoDataRenderer *bench_new_data_renderer (CairoDataRendererAttribute *pAttribute, int iWidth, int iHeight)
+{
+	CairoDataRenderer *pRenderer = cairo_dock_new_data_renderer (pAttribute->cModelName);
+	if (pRenderer == NULL)
+		return NULL;
+	CairoDataToRenderer *pData = &pRenderer->data;
+	pData->iNbValues = MAX (1, pAttribute->iNbValues);
+	pData->iMemorySize = MAX (2, pAttribute->iMemorySize);
+	pData->pValuesBuffer = g_new0 (gfloat, pData->iNbValues * pData->iMemorySize);
+	pData->iCurrentIndex = -1;
+	pData->pMinMaxValues = g_new (gdouble, 2 * pData->iNbValues);
+	int i;
+	for (i = 0; i < pData->iNbValues; i ++)
+	{
+		pData->pMinMaxValues[2*i] = 0.;
+		pData->pMinMaxValues[2*i+1] = 1.;
+	}
+	pRenderer->iWidth = iWidth;
+	pRenderer->iHeight = iHeight;
+	pRenderer->interface.load (pRenderer, NULL, pAttribute);
+	return pRenderer;
+}
+
+static inline void bench_free_data_renderer (CairoDataRenderer *pRenderer)
+{
+	if (pRenderer == NULL)
+		return;
+	if (pRenderer->interface.unload)
+		pRenderer->interface.unload (pRenderer);
+	g_free (pRenderer->data.pValuesBuffer);
+	g_free (pRenderer->data.pMinMaxValues);
+	g_free (pRenderer->pValuesText);
+	g_free (pRenderer);
+}
+
+// record a new set of values, as cairo_dock_render_new_data_on_icon does before drawing them.
+static inline void bench_push_values (CairoDataRenderer *pRenderer, const double *pValues)
+{
+	CairoDataToRenderer *pData = &pRenderer->data;
+	pData->iCurrentIndex ++;
+	if (pData->iCurrentIndex >= pData->iMemorySize)
+		pData->iCurrentIndex -= pData->iMemorySize;
+	int i;
+	for (i = 0; i < pData->iNbValues; i ++)
+		pData->pValuesBuffer[i * pData->iMemorySize + pData->iCurrentIndex] = pValues[i];
+	pData->bHasValue = TRUE;
+	pData->iNbPushedValues ++;
+}
+
+// a bare container with an OpenGL context, made current and set up to draw at the given size. NULL if OpenGL is not available.
+static inline GldiContainer *bench_new_gl_container (int iWidth, int iHeight)
+{
+	if (! g_bUseOpenGL)
+		return NULL;
+	GldiContainerAttr attr;
+	memset (&attr, 0, sizeof (GldiContainerAttr));
+	GldiContainer *pContainer = (GldiContainer*)gldi_object_new (&myContainerObjectMgr, &attr);
+	gtk_window_resize (GTK_WINDOW (pContainer->pWidget), iWidth, iHeight);
+	gtk_widget_show_all (pContainer->pWidget);
+	while (gtk_events_pending ())  // let it be realized, which creates its context.
+		gtk_main_iteration ();
+	pContainer->iWidth = iWidth;
+	pContainer->iHeight = iHeight;
+	if (! gldi_gl_container_make_current (pContainer))
+	{
+		gldi_object_unref (GLDI_OBJECT (pContainer));
+		return NULL;
+	}
+	gldi_gl_container_set_ortho_view (pContainer);
+	return pContainer;
+}
+
+#endif
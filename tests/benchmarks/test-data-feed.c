@@ -0,0 +1,278 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Starts tests/DataFeedProducer.py and reads its feed, to check that the samples get through:
+// - with a reader faster than the producer, every sample is read, while the ring of the feed wraps many times;
+// - with a reader slower than the producer, each read only gets the newest samples that are still valid, in order;
+// - with a data-renderer fed by cairo_dock_set_data_feed_on_icon, the values end up in its history, the last one included.
+// The producer writes the value i of the sample n as n * 2 + i, so the values tell which samples were read.
+// Usage: test-data-feed <DataFeedProducer.py> [python interpreter]
+
+#define _GNU_SOURCE  // kill
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>  // getpid
+#include <signal.h>  // kill
+#include <sys/wait.h>  // waitpid
+
+#include "cairo-dock-data-feed.h"
+#include "cairo-dock-graph.h"
+#include "bench-utils.h"
+
+#define NB_VALUES 2
+
+static const gchar *s_cProducer = NULL;
+static const gchar *s_cPython = NULL;
+static int s_iNbErrors = 0;
+
+#define _check(bCondition, cMessage, ...) do {\
+	if (! (bCondition)) {\
+		g_print ("  FAILED: "cMessage"\n", ##__VA_ARGS__);\
+		s_iNbErrors ++; }\
+	} while (0)
+
+// start the producer on a new feed, and wait until the feed exists. Return its name, or NULL if it couldn't be started.
+static gchar *_start_producer (int iRate, int iNbSamplesInRing, int iNbSamplesToWrite, GPid *pPid)
+{
+	static int s_iNbFeeds = 0;
+	gchar *cName = g_strdup_printf ("test-%d-%d", getpid (), s_iNbFeeds ++);
+	gchar *cRate = g_strdup_printf ("%d", iRate);
+	gchar *cRing = g_strdup_printf ("%d", iNbSamplesInRing);
+	gchar *cCount = g_strdup_printf ("%d", iNbSamplesToWrite);
+	gchar *cNbValues = g_strdup_printf ("%d", NB_VALUES);
+	const gchar *argv[8];
+	int i = 0;
+	if (s_cPython != NULL)
+		argv[i++] = s_cPython;
+	argv[i++] = s_cProducer;
+	argv[i++] = cName;
+	argv[i++] = cNbValues;
+	argv[i++] = cRate;
+	argv[i++] = cRing;
+	argv[i++] = cCount;
+	argv[i++] = NULL;
+
+	GError *erreur = NULL;
+	gboolean bStarted = g_spawn_async (NULL, (gchar**)argv, NULL, G_SPAWN_DO_NOT_REAP_CHILD | G_SPAWN_SEARCH_PATH, NULL, NULL, pPid, &erreur);
+	g_free (cRate);
+	g_free (cRing);
+	g_free (cCount);
+	g_free (cNbValues);
+	if (! bStarted)
+	{
+		g_print ("couldn't start the producer: %s\n", erreur->message);
+		g_error_free (erreur);
+		g_free (cName);
+		return NULL;
+	}
+
+	// the producer renames the feed into place once its header is written.
+	gchar *cPath = g_strdup_printf ("/dev/shm/cairo-dock-feed-%s", cName);
+	int t;
+	for (t = 0; t < 500 && ! g_file_test (cPath, G_FILE_TEST_EXISTS); t ++)
+		g_usleep (10000);
+	g_free (cPath);
+	if (t == 500)
+	{
+		g_print ("the producer didn't create its feed\n");
+		kill (*pPid, SIGTERM);
+		waitpid (*pPid, NULL, 0);
+		g_spawn_close_pid (*pPid);
+		g_free (cName);
+		return NULL;
+	}
+	return cName;
+}
+
+static gboolean _producer_is_done (GPid pid)
+{
+	int iStatus;
+	if (waitpid (pid, &iStatus, WNOHANG) != pid)
+		return FALSE;
+	_check (WIFEXITED (iStatus) && WEXITSTATUS (iStatus) == 0, "the producer failed");
+	g_spawn_close_pid (pid);
+	return TRUE;
+}
+
+// check the samples of a read: value 1 = value 0 + 1, and each sample follows the previous one. Return the index of the last sample.
+static int _check_samples (const gdouble *pValues, int iNbSamples, int iPrevSample, gboolean *bGap)
+{
+	int n, iSample;
+	for (n = 0; n < iNbSamples; n ++)
+	{
+		iSample = (int)pValues[n * NB_VALUES] / NB_VALUES;
+		_check (pValues[n * NB_VALUES] == iSample * NB_VALUES && pValues[n * NB_VALUES + 1] == pValues[n * NB_VALUES] + 1, "the sample %d is corrupted (%g, %g)", iSample, pValues[n * NB_VALUES], pValues[n * NB_VALUES + 1]);
+		if (iSample != iPrevSample + 1)
+		{
+			_check (n == 0 && iSample > iPrevSample, "the sample %d comes after the sample %d, in the same read", iSample, iPrevSample);
+			if (iPrevSample >= 0)
+				*bGap = TRUE;
+		}
+		iPrevSample = iSample;
+	}
+	return iPrevSample;
+}
+
+// read the feed every iDelay ms, iMaxSamples at most each time, until the producer is done.
+static void _test_reader (const gchar *cTest, int iRate, int iNbSamplesInRing, int iNbSamplesToWrite, int iDelay, int iMaxSamples)
+{
+	g_print ("%s (%d samples/s, a ring of %d samples, read every %d ms)\n", cTest, iRate, iNbSamplesInRing, iDelay);
+	GPid pid;
+	gchar *cName = _start_producer (iRate, iNbSamplesInRing, iNbSamplesToWrite, &pid);
+	if (cName == NULL)
+	{
+		s_iNbErrors ++;
+		return;
+	}
+	CairoDataFeed *pFeed = cairo_data_feed_open (cName, NB_VALUES);
+	_check (pFeed != NULL, "couldn't open the feed '%s'", cName);
+	g_free (cName);
+	if (pFeed == NULL)
+	{
+		while (! _producer_is_done (pid))
+			g_usleep (10000);
+		return;
+	}
+
+	gdouble *pValues = g_new (gdouble, iMaxSamples * NB_VALUES);
+	int iLastSample = -1, iNbRead = 0, iMaxRead = 0, n;
+	gboolean bGap = FALSE, bDone;
+	do
+	{
+		bDone = _producer_is_done (pid);  // read once more after it's done, to get the last samples.
+		n = cairo_data_feed_read (pFeed, pValues, iMaxSamples);
+		iLastSample = _check_samples (pValues, n, iLastSample, &bGap);
+		iNbRead += n;
+		iMaxRead = MAX (iMaxRead, n);
+		if (! bDone)
+			g_usleep (iDelay * 1000);
+	} while (! bDone);
+	cairo_data_feed_close (pFeed);
+	g_free (pValues);
+	g_print ("  %d samples read, %d at most at once, the last one is %d%s\n", iNbRead, iMaxRead, iLastSample, bGap ? ", some were skipped" : "");
+
+	_check (iLastSample == iNbSamplesToWrite - 1, "the last sample was not read");
+	_check (iMaxRead < iNbSamplesInRing, "a read returned %d samples, while the ring only holds %d valid ones", iMaxRead, iNbSamplesInRing - 1);
+	if (iDelay * iRate < 1000 * MIN (iMaxSamples, iNbSamplesInRing - 1))  // the reader keeps up with the producer.
+	{
+		_check (! bGap, "some samples were skipped");
+		_check (iNbRead > iNbSamplesInRing, "the ring didn't wrap");
+	}
+	else  // the producer overtakes the reader.
+	{
+		_check (bGap, "no samples were skipped, the reader is not slower than the producer");
+	}
+}
+
+static gboolean _quit_loop (GMainLoop *pLoop)
+{
+	g_main_loop_quit (pLoop);
+	return FALSE;
+}
+
+static void _on_producer_done (GPid pid, gint iStatus, GMainLoop *pLoop)
+{
+	_check (WIFEXITED (iStatus) && WEXITSTATUS (iStatus) == 0, "the producer failed");
+	g_spawn_close_pid (pid);
+	g_timeout_add (500, (GSourceFunc)_quit_loop, pLoop);  // let the renderer read the last samples (its feeds are still read every 40 ms).
+}
+
+static gboolean _on_timeout (GMainLoop *pLoop)
+{
+	_check (FALSE, "the producer didn't finish in time");
+	g_main_loop_quit (pLoop);
+	return FALSE;
+}
+
+// feed a graph with the producer, as an applet would with CD_APPLET_SET_DATA_FEED_ON_MY_ICON, and check its history.
+static void _test_renderer (int iRate, int iNbSamplesInRing, int iNbSamplesToWrite, int iHistorySize)
+{
+	g_print ("data-renderer (%d samples/s, a ring of %d samples, a history of %d values)\n", iRate, iNbSamplesInRing, iHistorySize);
+	CairoGraphAttribute attr;
+	memset (&attr, 0, sizeof (CairoGraphAttribute));
+	attr.rendererAttribute.cModelName = "graph";
+	attr.rendererAttribute.iNbValues = NB_VALUES;
+	attr.rendererAttribute.iMemorySize = iHistorySize;
+	attr.iType = CAIRO_DOCK_GRAPH_LINE;
+	CairoDataRenderer *pRenderer = bench_new_data_renderer (CAIRO_DATA_RENDERER_ATTRIBUTE (&attr), 32, 32);
+	_check (pRenderer != NULL, "couldn't create a graph");
+	if (pRenderer == NULL)
+		return;
+	Icon *pIcon = g_new0 (Icon, 1);  // no container: the values are only recorded.
+	pIcon->pDataRenderer = pRenderer;
+
+	GPid pid;
+	gchar *cName = _start_producer (iRate, iNbSamplesInRing, iNbSamplesToWrite, &pid);
+	if (cName == NULL)
+	{
+		s_iNbErrors ++;
+	}
+	else
+	{
+		gboolean bSet = cairo_dock_set_data_feed_on_icon (pIcon, cName);
+		_check (bSet, "couldn't set the feed '%s' on the icon", cName);
+		g_free (cName);
+
+		GMainLoop *pLoop = g_main_loop_new (NULL, FALSE);
+		g_child_watch_add (pid, (GChildWatchFunc)_on_producer_done, pLoop);
+		guint iSidTimeout = g_timeout_add_seconds (10 + iNbSamplesToWrite / iRate, (GSourceFunc)_on_timeout, pLoop);
+		g_main_loop_run (pLoop);
+		g_source_remove (iSidTimeout);
+		g_main_loop_unref (pLoop);
+		cairo_dock_set_data_feed_on_icon (pIcon, NULL);
+	}
+
+	int iNbPushed = pRenderer->data.iNbPushedValues;
+	int iLastSample = (int)cairo_data_renderer_get_value (pRenderer, 0, 0) / NB_VALUES;
+	g_print ("  %d samples recorded, the last one is %d\n", iNbPushed, iLastSample);
+	_check (iNbPushed > iNbSamplesInRing && iNbPushed > iHistorySize, "not enough samples were recorded");
+	_check (iLastSample == iNbSamplesToWrite - 1, "the last sample was not recorded");
+	int t;
+	for (t = 0; t > - MIN (iNbPushed, iHistorySize); t --)
+	{
+		_check (cairo_data_renderer_get_value (pRenderer, 1, t) == cairo_data_renderer_get_value (pRenderer, 0, t) + 1, "the value %d of the history is corrupted", t);
+		if (t < 0)
+			_check (cairo_data_renderer_get_value (pRenderer, 0, t) == cairo_data_renderer_get_value (pRenderer, 0, t+1) - NB_VALUES, "the history is not contiguous at %d", t);
+	}
+
+	pIcon->pDataRenderer = NULL;
+	bench_free_data_renderer (pRenderer);
+	g_free (pIcon);
+}
+
+int main (int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		g_print ("Usage: %s <DataFeedProducer.py> [python interpreter]\n", argv[0]);
+		return 1;
+	}
+	s_cProducer = argv[1];
+	s_cPython = (argc > 2 ? argv[2] : NULL);
+
+	gtk_init (&argc, &argv);
+	gldi_init (GLDI_CAIRO);
+
+	_test_reader ("fast reader", 200, 64, 600, 5, 64);  // 1 sample per read, 10 times around the ring.
+	_test_reader ("slow reader", 1000, 16, 2000, 100, 64);  // 100 samples written between 2 reads, only 15 can be read.
+	_test_renderer (200, 32, 400, 64);  // ~8 samples per read of the renderer (every 40 ms).
+
+	g_print ("%d error(s)\n", s_iNbErrors);
+	return (s_iNbErrors == 0 ? 0 : 1);
+}
@@ -0,0 +1,156 @@
+/**
+* This file is a part of the Cairo-Dock project
+*
+* Copyright : (C) see the 'copyright' file.
+* E-mail    : see the 'copyright' file.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 3
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Loads each gauge theme of a corpus (valid, invalid, malformed and fuzzed theme.xml files) and checks the rank we get,
+// or that the theme is rejected. It also counts the allocations made by libxml to load a theme, compared to a DOM parse of the same file
+// followed by a copy of the content of each element (what the loader used to do, before it read the file with a xmlTextReader):
+// the loader must not allocate more for a valid theme.
+// Usage: test-gauge-themes <corpus folder>   (the folder contains a 'ranks' file listing the themes and their expected rank)
+// The themes have no images, so the counts only cover the parsing.
+
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/parser.h>
+
+#include "cairo-dock-gauge.h"
+#include "bench-utils.h"
+
+static glong s_iNbAllocs = 0;
+
+static void *_count_malloc (size_t n)
+{
+	s_iNbAllocs ++;
+	return malloc (n);
+}
+static void *_count_realloc (void *p, size_t n)
+{
+	s_iNbAllocs ++;
+	return realloc (p, n);
+}
+static char *_count_strdup (const char *s)
+{
+	s_iNbAllocs ++;
+	return strdup (s);
+}
+
+// load the theme in a gauge, as an applet would; return its rank (0 if it was rejected).
+static int _load_theme (const gchar *cThemePath, glong *iNbAllocs)
+{
+	CairoGaugeAttribute attr;
+	memset (&attr, 0, sizeof (CairoGaugeAttribute));
+	attr.rendererAttribute.cModelName = "gauge";
+	attr.rendererAttribute.iNbValues = 1;
+	attr.cThemePath = cThemePath;
+	glong n = s_iNbAllocs;
+	CairoDataRenderer *pRenderer = bench_new_data_renderer (CAIRO_DATA_RENDERER_ATTRIBUTE (&attr), 32, 32);
+	*iNbAllocs = s_iNbAllocs - n;
+	int iRank = (pRenderer ? pRenderer->iRank : -1);
+	bench_free_data_renderer (pRenderer);  // releases the theme, so that the next load parses it again.
+	return iRank;
+}
+
+static void _read_nodes (xmlNodePtr pNode)
+{
+	xmlChar *cValue;
+	for (; pNode != NULL; pNode = pNode->next)
+	{
+		if (pNode->type != XML_ELEMENT_NODE)
+			continue;
+		cValue = xmlNodeGetContent (pNode);
+		xmlFree (cValue);
+		cValue = xmlGetProp (pNode, BAD_CAST "type");
+		if (cValue != NULL)
+			xmlFree (cValue);
+		_read_nodes (pNode->children);
+	}
+}
+
+static glong _parse_theme_dom (const gchar *cThemePath)
+{
+	gchar *cXmlFile = g_strdup_printf ("%s/theme.xml", cThemePath);
+	glong n = s_iNbAllocs;
+	xmlDocPtr pDoc = xmlReadFile (cXmlFile, NULL, XML_PARSE_NONET | XML_PARSE_NOBLANKS);
+	if (pDoc != NULL)
+		_read_nodes (xmlDocGetRootElement (pDoc));
+	n = s_iNbAllocs - n;
+	if (pDoc != NULL)
+		xmlFreeDoc (pDoc);
+	g_free (cXmlFile);
+	return n;
+}
+
+int main (int argc, char *argv[])
+{
+	xmlMemSetup (free, _count_malloc, _count_realloc, _count_strdup);  // before libxml allocates anything.
+	gtk_init (&argc, &argv);
+	if (argc < 2)
+	{
+		g_printerr ("usage: %s <corpus folder>\n", argv[0]);
+		return 1;
+	}
+	gldi_init (GLDI_CAIRO);
+
+	gchar *cRanksFile = g_strdup_printf ("%s/ranks", argv[1]);
+	gchar *cContent = NULL;
+	if (! g_file_get_contents (cRanksFile, &cContent, NULL, NULL))
+	{
+		g_printerr ("couldn't read %s\n", cRanksFile);
+		return 1;
+	}
+	g_free (cRanksFile);
+
+	int iNbErrors = 0;
+	g_print ("%-50s %8s %8s %10s %10s\n", "theme", "expected", "rank", "allocs", "dom allocs");
+	gchar **cLines = g_strsplit (cContent, "\n", -1);
+	int i;
+	for (i = 0; cLines[i] != NULL; i ++)
+	{
+		gchar **cFields = g_strsplit_set (cLines[i], " \t", 2);
+		if (cFields[0] == NULL || *cFields[0] == '\0' || *cFields[0] == '#' || cFields[1] == NULL)
+		{
+			g_strfreev (cFields);
+			continue;
+		}
+		gchar *cThemePath = g_strdup_printf ("%s/%s", argv[1], cFields[0]);
+		int iExpectedRank = atoi (cFields[1]);
+
+		glong iNbAllocs, iNbDomAllocs = _parse_theme_dom (cThemePath);
+		int iRank = _load_theme (cThemePath, &iNbAllocs);
+		g_print ("%-50s %8d %8d %10ld %10ld", cFields[0], iExpectedRank, iRank, iNbAllocs, iNbDomAllocs);
+		if (iRank != iExpectedRank)
+		{
+			g_print ("  <- wrong rank");
+			iNbErrors ++;
+		}
+		else if (iRank > 0 && iNbAllocs > iNbDomAllocs)  // a malformed file is rejected at some point by both, the counts are not comparable.
+		{
+			g_print ("  <- more allocations than a DOM parse");
+			iNbErrors ++;
+		}
+		g_print ("\n");
+		g_free (cThemePath);
+		g_strfreev (cFields);
+	}
+	g_strfreev (cLines);
+	g_free (cContent);
+
+	if (iNbErrors != 0)
+		g_print ("%d error(s)\n", iNbErrors);
+	return (iNbErrors == 0 ? 0 : 1);
+}
@@ -7,6 +7,7 @@
 #   cairo-dock -T -d ~/test
 #
 # They also require 'xdotool'
+# To run them in a headless Wayland session, use './run-wayland-headless.sh'
 #
 # Usage: ./main.y [name of a test]
 # In 'config.py', you can adjust some variables to fit your environment
@@ -23,6 +24,7 @@ from TestStackIcon import TestStackIcon
 from TestTaskbar import TestTaskbar, TestTaskbar2
 from TestIconManager import TestIconManager
 from TestDesklet import TestDesklet
+from TestJournal import TestJournal
 
 from CairoDock import CairoDock
 dock = CairoDock()
@@ -54,6 +56,8 @@ if __name__ == '__main__':
 			TestIconManager(dock).run()
 		elif sys.argv[1] == "TestDesklet":
 			TestDesklet(dock).run()
+		elif sys.argv[1] == "TestJournal":
+			TestJournal(dock).run()
 		else:
 			print ("Unknown test")
 	else:  # run them all
@@ -69,4 +73,5 @@ if __name__ == '__main__':
 		TestDockManager(dock).run()
 		TestIconManager(dock).run()
 		TestDesklet(dock).run()
+		TestJournal(dock).run()  # restarts the dock
 	
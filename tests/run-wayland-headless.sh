@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Runs some tests inside a headless Wayland session, to test the Wayland backend (taskbar, outputs) without any display.
+# It needs 'cage' (or any wlroots compositor, see below) and 'dbus-run-session'; the programs used by the tests are defined in 'config.py'.
+# A new theme is used, and removed afterwards.
+#
+# Usage: ./run-wayland-headless.sh [name of a test]   (by default, the taskbar tests)
+# To have several outputs, set WLR_HEADLESS_OUTPUTS (for instance WLR_HEADLESS_OUTPUTS=2).
+
+cd "$(dirname "$0")" || exit 1
+
+TESTS=${1:-"TestTaskbar TestTaskbar2"}
+DATA_DIR=$(mktemp -d)
+
+export WLR_BACKENDS=headless
+export WLR_LIBINPUT_NO_DEVICES=1
+export WLR_RENDERER=pixman
+export GDK_BACKEND=wayland
+unset DESKTOP_SESSION
+unset DISPLAY
+
+dbus-run-session -- cage -- sh -c "
+	cairo-dock -T -d '$DATA_DIR' &
+	sleep 5
+	for t in $TESTS; do python main.py \$t; done
+	killall cairo-dock"
+
+rm -rf "$DATA_DIR"